@@ -0,0 +1,955 @@
+#include "event_system_benchmarks.h"
+#include "../core/crc32c.h"
+#include "../core/custom_events.h"
+#include "../core/event_compression.h"
+#include "../core/event_logger.h"
+#include "../core/event_manager.h"
+#include "../core/event_schema.h"
+#include "../core/event_trace.h"
+#include "../core/event_wire_format.h"
+#include "../core/shared_data_event.h"
+#include "../core/typed_data_event.h"
+#include "../examples/advanced_patterns/event_compression_demo.h"
+#include "../examples/advanced_patterns/event_pooling_demo.h"
+#include "../examples/event_filters/selective_event_filter.h"
+#include <QApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMouseEvent>
+#include <QSemaphore>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QVector>
+#include <QXmlStreamReader>
+#include <QtGlobal>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+// 每次QBENCHMARK迭代中每个线程执行的操作数
+const int BatchSize = 1000;
+
+/**
+ * @brief 接收DataEvent并计数的对象
+ */
+class CountingReceiver : public QObject
+{
+public:
+    int received = 0;
+
+protected:
+    bool event(QEvent* event) override
+    {
+        if (event->type() == static_cast<QEvent::Type>(DataEventType)) {
+            ++received;
+            return true;
+        }
+        return QObject::event(event);
+    }
+};
+
+/**
+ * @brief 模拟传感器数据的消费者：取出QVector<float>样本并原地处理
+ *
+ * QVariant路径取出的是与事件共享的副本，修改时分离拷贝；类型化路径直接移出。
+ */
+class SampleReceiver : public QObject
+{
+public:
+    double sum = 0;
+
+protected:
+    bool event(QEvent* event) override
+    {
+        if (auto* typedEvent = TypedDataEvent<QVector<float>>::cast(event)) {
+            consume(typedEvent->take());
+            return true;
+        }
+        if (event->type() == static_cast<QEvent::Type>(DataEventType)) {
+            consume(static_cast<DataEvent*>(event)->data().value<QVector<float>>());
+            return true;
+        }
+        return QObject::event(event);
+    }
+
+private:
+    void consume(QVector<float> values)
+    {
+        values[0] += 1.0f;
+        sum += values[0] + values.last();
+    }
+};
+
+/**
+ * @brief 收到DataEvent后把序列化结果记入日志的接收者
+ */
+class JournalReceiver : public QObject
+{
+public:
+    qint64 journaled = 0;
+
+protected:
+    bool event(QEvent* event) override
+    {
+        if (event->type() == static_cast<QEvent::Type>(DataEventType)) {
+            journaled += static_cast<DataEvent*>(event)->serialize().size();
+            return true;
+        }
+        return QObject::event(event);
+    }
+};
+
+/**
+ * @brief 在threadCount个常驻线程中并发执行work，单线程时直接在当前线程执行
+ *
+ * 线程在QBENCHMARK之外按数据行创建一次，run()用一对信号量放行所有线程
+ * 执行一轮work并等待全部完成，线程创建和销毁不计入测量。
+ */
+class ConcurrentRunner
+{
+public:
+    ConcurrentRunner(int threadCount, std::function<void()> work)
+        : m_work(std::move(work))
+        , m_stopping(false)
+    {
+        if (threadCount <= 1) {
+            return;
+        }
+        for (int i = 0; i < threadCount; ++i) {
+            QThread* thread = QThread::create([this]() {
+                for (;;) {
+                    m_start.acquire();
+                    if (m_stopping) {
+                        return;
+                    }
+                    m_work();
+                    m_finish.release();
+                }
+            });
+            m_threads.append(thread);
+            thread->start();
+        }
+    }
+
+    ~ConcurrentRunner()
+    {
+        // m_stopping在放行前写入，信号量保证工作线程看到它
+        m_stopping = true;
+        m_start.release(m_threads.size());
+        for (QThread* thread : m_threads) {
+            thread->wait();
+            delete thread;
+        }
+    }
+
+    void run()
+    {
+        if (m_threads.isEmpty()) {
+            m_work();
+            return;
+        }
+        m_start.release(m_threads.size());
+        m_finish.acquire(m_threads.size());
+    }
+
+private:
+    std::function<void()> m_work;
+    QList<QThread*> m_threads;
+    QSemaphore m_start;
+    QSemaphore m_finish;
+    bool m_stopping;
+};
+
+QString dataTag(const QString& mode, int payload, int threads, int ops)
+{
+    QString tag = QString("payload=%1/threads=%2/ops=%3").arg(payload).arg(threads).arg(ops);
+    return mode.isEmpty() ? tag : QString("mode=%1/%2").arg(mode, tag);
+}
+
+} // namespace
+
+void EventSystemBenchmarks::initTestCase()
+{
+    // 关闭各组件在热点路径上的qDebug输出，避免测到日志开销
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    EventManager::instance();
+    EventLogger::instance();
+}
+
+void EventSystemBenchmarks::postVsSendEvent_data()
+{
+    QTest::addColumn<bool>("post");
+    QTest::addColumn<int>("payloadBytes");
+    QTest::addColumn<int>("threads");
+
+    for (bool post : {false, true}) {
+        for (int payload : {0, 1024, 64 * 1024}) {
+            for (int threads : {1, 2, 4, 8}) {
+                QTest::newRow(qPrintable(dataTag(post ? "post" : "send", payload, threads, BatchSize)))
+                    << post << payload << threads;
+            }
+        }
+    }
+}
+
+void EventSystemBenchmarks::postVsSendEvent()
+{
+    QFETCH(bool, post);
+    QFETCH(int, payloadBytes);
+    QFETCH(int, threads);
+
+    const QVariant payload(QByteArray(payloadBytes, 'x'));
+
+    if (post) {
+        // 多个生产者线程投递到GUI线程中的同一个接收者，然后统一分派
+        CountingReceiver receiver;
+        ConcurrentRunner runner(threads, [&receiver, &payload]() {
+            for (int i = 0; i < BatchSize; ++i) {
+                QCoreApplication::postEvent(&receiver, new DataEvent(payload));
+            }
+        });
+        QBENCHMARK {
+            runner.run();
+            QCoreApplication::sendPostedEvents(&receiver, DataEventType);
+        }
+        QVERIFY(receiver.received > 0);
+    } else {
+        // sendEvent只能发往当前线程的对象，每个线程使用自己的接收者
+        ConcurrentRunner runner(threads, [&payload]() {
+            CountingReceiver receiver;
+            for (int i = 0; i < BatchSize; ++i) {
+                DataEvent event(payload);
+                QCoreApplication::sendEvent(&receiver, &event);
+            }
+        });
+        QBENCHMARK {
+            runner.run();
+        }
+    }
+}
+
+void EventSystemBenchmarks::logEvent_data()
+{
+    QTest::addColumn<int>("detailsLength");
+    QTest::addColumn<int>("threads");
+
+    for (int length : {16, 1024}) {
+        for (int threads : {1, 2, 4}) {
+            QTest::newRow(qPrintable(dataTag(QString(), length, threads, BatchSize)))
+                << length << threads;
+        }
+    }
+}
+
+void EventSystemBenchmarks::logEvent()
+{
+    QFETCH(int, detailsLength);
+    QFETCH(int, threads);
+
+    EventLogger* logger = EventLogger::instance();
+    logger->clearHistory();
+    logger->setMaxRecords(BatchSize);
+
+    QObject receiver;
+    receiver.setObjectName("BenchmarkReceiver");
+
+    EventLogger::EventRecord record;
+    record.receiver = &receiver;
+    record.eventType = QEvent::User;
+    record.eventName = "BenchmarkEvent";
+    record.details = QString(detailsLength, QChar('d'));
+    record.accepted = true;
+
+    ConcurrentRunner runner(threads, [logger, &record]() {
+        for (int i = 0; i < BatchSize; ++i) {
+            logger->logEvent(record);
+        }
+    });
+    QBENCHMARK {
+        runner.run();
+    }
+
+    logger->clearHistory();
+    logger->setMaxRecords(10000);
+}
+
+void EventSystemBenchmarks::eventPoolAcquireRelease_data()
+{
+    QTest::addColumn<int>("entries");
+    QTest::addColumn<int>("threads");
+
+    for (int entries : {0, 4, 16}) {
+        for (int threads : {1, 2, 4, 8}) {
+            QTest::newRow(qPrintable(dataTag(QString(), entries, threads, BatchSize)))
+                << entries << threads;
+        }
+    }
+}
+
+void EventSystemBenchmarks::eventPoolAcquireRelease()
+{
+    QFETCH(int, entries);
+    QFETCH(int, threads);
+
+    QList<int> keys;
+    for (int i = 0; i < entries; ++i) {
+        keys.append(EventPayload::internKey(QString("key_%1").arg(i)));
+    }
+
+    EventPool<PooledEvent> pool(BatchSize);
+
+    ConcurrentRunner runner(threads, [&pool, &keys]() {
+        for (int i = 0; i < BatchSize; ++i) {
+            PooledEvent* event = pool.acquireEvent();
+            for (int key : keys) {
+                event->setData(key, i);
+            }
+            pool.releaseEvent(event);
+        }
+    });
+    QBENCHMARK {
+        runner.run();
+    }
+}
+
+void EventSystemBenchmarks::pooledBulkProcessing_data()
+{
+    QTest::addColumn<bool>("pooled");
+    QTest::addColumn<int>("events");
+
+    for (bool pooled : {false, true}) {
+        for (int events : {1000, 100000}) {
+            QTest::newRow(qPrintable(dataTag(pooled ? "pool" : "heap", events, 1, events)))
+                << pooled << events;
+        }
+    }
+}
+
+void EventSystemBenchmarks::pooledBulkProcessing()
+{
+    QFETCH(bool, pooled);
+    QFETCH(int, events);
+
+    const int valueKey = EventPayload::internKey("value");
+
+    // 先交错分配、释放一部分，模拟长时间运行后碎片化的堆
+    EventPool<PooledEvent> pool(events);
+    QList<PooledEvent*> batch;
+    batch.reserve(events);
+    for (int i = 0; i < events; ++i) {
+        batch.append(pooled ? pool.acquireEvent() : new PooledEvent());
+        if (!pooled && i % 2 == 0) {
+            delete new QByteArray(64, 'x');
+        }
+    }
+    for (int i = 0; i < events; ++i) {
+        batch[i]->setPriority(i % 10);
+        batch[i]->setData(valueKey, i);
+    }
+
+    // 只测量批量遍历处理
+    qint64 checksum = 0;
+    QBENCHMARK {
+        for (PooledEvent* event : batch) {
+            checksum += event->priority() + event->getData(valueKey).toInt();
+            event->setInUse(!event->isInUse());
+        }
+    }
+    QVERIFY(checksum != 0);
+
+    for (PooledEvent* event : batch) {
+        if (pooled) {
+            pool.releaseEvent(event);
+        } else {
+            delete event;
+        }
+    }
+}
+
+void EventSystemBenchmarks::mouseCompression_data()
+{
+    QTest::addColumn<int>("movesPerFlush");
+
+    // 压缩在GUI线程中进行，不扫描线程数
+    for (int moves : {10, 100, 1000}) {
+        QTest::newRow(qPrintable(dataTag(QString(), moves, 1, moves))) << moves;
+    }
+}
+
+void EventSystemBenchmarks::mouseCompression()
+{
+    QFETCH(int, movesPerFlush);
+
+    EventCompressionDemo demo;
+    demo.resize(800, 600);
+
+    QBENCHMARK {
+        for (int i = 0; i < movesPerFlush; ++i) {
+            QPointF position(i % 800, i % 600);
+            QMouseEvent move(QEvent::MouseMove, position, position, Qt::NoButton,
+                             Qt::NoButton, Qt::NoModifier);
+            QCoreApplication::sendEvent(&demo, &move);
+        }
+        demo.flushCoalescedEvents();
+    }
+}
+
+void EventSystemBenchmarks::filterChain_data()
+{
+    QTest::addColumn<int>("filters");
+    QTest::addColumn<int>("threads");
+
+    for (int filters : {0, 1, 4, 16}) {
+        for (int threads : {1, 4}) {
+            QTest::newRow(qPrintable(dataTag(QString(), filters, threads, BatchSize)))
+                << filters << threads;
+        }
+    }
+}
+
+void EventSystemBenchmarks::filterChain()
+{
+    QFETCH(int, filters);
+    QFETCH(int, threads);
+
+    ConcurrentRunner runner(threads, [filters]() {
+        // 过滤器和被监视对象必须在同一线程
+        CountingReceiver receiver;
+        QList<SelectiveEventFilter*> chain;
+        for (int i = 0; i < filters; ++i) {
+            SelectiveEventFilter* filter = new SelectiveEventFilter();
+            receiver.installEventFilter(filter);
+            chain.append(filter);
+        }
+
+        for (int i = 0; i < BatchSize; ++i) {
+            DataEvent event;
+            QCoreApplication::sendEvent(&receiver, &event);
+        }
+
+        qDeleteAll(chain);
+    });
+    QBENCHMARK {
+        runner.run();
+    }
+}
+
+void EventSystemBenchmarks::dataEventSerialization_data()
+{
+    QTest::addColumn<QString>("kind");
+    QTest::addColumn<int>("payloadBytes");
+    QTest::addColumn<int>("threads");
+
+    for (int payload : {64, 4096, 1024 * 1024}) {
+        // 大负载减少每次迭代的操作数，使各行的迭代时间处于同一量级
+        int ops = qBound(1, 4 * 1024 * 1024 / payload, BatchSize);
+        for (int threads : {1, 4}) {
+            QTest::newRow(qPrintable(dataTag("bytes", payload, threads, ops)))
+                << QString("bytes") << payload << threads;
+            QTest::newRow(qPrintable(dataTag("map", payload, threads, ops)))
+                << QString("map") << payload << threads;
+        }
+    }
+}
+
+void EventSystemBenchmarks::dataEventSerialization()
+{
+    QFETCH(QString, kind);
+    QFETCH(int, payloadBytes);
+    QFETCH(int, threads);
+
+    const int ops = qBound(1, 4 * 1024 * 1024 / payloadBytes, BatchSize);
+
+    QVariant payload;
+    if (kind == "bytes") {
+        payload = QByteArray(payloadBytes, 'x');
+    } else {
+        // 以约64字节一项的字符串映射近似同样大小的结构化负载
+        QVariantMap map;
+        for (int i = 0; i < qMax(1, payloadBytes / 64); ++i) {
+            map.insert(QString("field_%1").arg(i), QString(24, QChar('v')));
+        }
+        payload = map;
+    }
+
+    ConcurrentRunner runner(threads, [&payload, ops]() {
+        DataEvent source(payload);
+        DataEvent target;
+        for (int i = 0; i < ops; ++i) {
+            source.setData(payload);    // 使序列化缓存失效，每次都真正编码
+            QByteArray bytes = source.serialize();
+            target.deserialize(bytes);
+            target.data();      // 反序列化是惰性的，强制解码以计入完整往返
+        }
+    });
+    QBENCHMARK {
+        runner.run();
+    }
+}
+
+void EventSystemBenchmarks::commandEventParameters_data()
+{
+    QTest::addColumn<QString>("keyKind");
+    QTest::addColumn<int>("params");
+
+    for (int params : {4, 8, 32}) {
+        QTest::newRow(qPrintable(dataTag("name", params, 1, BatchSize)))
+            << QString("name") << params;
+        QTest::newRow(qPrintable(dataTag("id", params, 1, BatchSize)))
+            << QString("id") << params;
+    }
+}
+
+void EventSystemBenchmarks::commandEventParameters()
+{
+    QFETCH(QString, keyKind);
+    QFETCH(int, params);
+
+    QStringList names;
+    QList<int> keys;
+    for (int i = 0; i < params; ++i) {
+        names.append(QString("param_%1").arg(i));
+        keys.append(EventPayload::internKey(names.last()));
+    }
+    const bool byId = keyKind == "id";
+
+    qint64 checksum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < BatchSize; ++i) {
+            CommandEvent event("benchmark");
+            for (int p = 0; p < params; ++p) {
+                if (byId) {
+                    event.setParameter(keys[p], i + p);
+                } else {
+                    event.setParameter(names[p], i + p);
+                }
+            }
+            for (int p = 0; p < params; ++p) {
+                checksum += byId ? event.parameter(keys[p]).toInt()
+                                 : event.parameter(names[p]).toInt();
+            }
+        }
+    }
+    QVERIFY(checksum != 0);
+}
+
+void EventSystemBenchmarks::eventCompression_data()
+{
+    QTest::addColumn<int>("codec");
+    QTest::addColumn<bool>("dictionary");
+
+    QTest::newRow(qPrintable(dataTag("none", 0, 1, BatchSize)))
+        << int(EventCompression::NoCodec) << false;
+    QTest::newRow(qPrintable(dataTag("lz", 0, 1, BatchSize)))
+        << int(EventCompression::Lz) << false;
+    QTest::newRow(qPrintable(dataTag("lz_dict", 0, 1, BatchSize)))
+        << int(EventCompression::Lz) << true;
+    QTest::newRow(qPrintable(dataTag("zlib", 0, 1, BatchSize)))
+        << int(EventCompression::Zlib) << false;
+}
+
+void EventSystemBenchmarks::eventCompression()
+{
+    QFETCH(int, codec);
+    QFETCH(bool, dictionary);
+
+    // 模拟一段录制：少量命令名和参数名反复出现，参数值各不相同
+    const QStringList commands = { "move_to", "set_speed", "open_valve", "close_valve", "report_status" };
+    QList<QByteArray> recording;
+    for (int i = 0; i < BatchSize; ++i) {
+        CommandEvent event(commands[i % commands.size()]);
+        event.setParameter("device_id", QString("unit_%1").arg(i % 16));
+        event.setParameter("sequence", i);
+        event.setParameter("position_x", i * 0.5);
+        event.setParameter("position_y", i * 0.25);
+        event.setParameter("operator", "automation");
+        recording.append(event.serialize());
+    }
+
+    // 用前1/4训练，其余数据压缩时只依赖字典中的公共片段
+    const quint32 dictionaryId = dictionary
+        ? EventCompression::registerDictionary(CommandEventType,
+              EventCompression::trainDictionary(recording.mid(0, BatchSize / 4)))
+        : 0;
+
+    qint64 rawBytes = 0;
+    qint64 storedBytes = 0;
+    for (const QByteArray& raw : recording) {
+        rawBytes += raw.size();
+        storedBytes += EventCompression::compress(raw, EventCompression::Codec(codec), dictionaryId).size();
+    }
+    qInfo().noquote() << QString("%1: %2 -> %3 bytes (%4%)")
+        .arg(QTest::currentDataTag()).arg(rawBytes).arg(storedBytes)
+        .arg(100.0 * storedBytes / rawBytes, 0, 'f', 1);
+
+    qint64 checksum = 0;
+    QBENCHMARK {
+        for (const QByteArray& raw : recording) {
+            const QByteArray stored = EventCompression::compress(raw, EventCompression::Codec(codec), dictionaryId);
+            checksum += EventCompression::decompress(stored).size();
+        }
+    }
+    QVERIFY(checksum > 0);
+}
+
+void EventSystemBenchmarks::typedDataEvent_data()
+{
+    QTest::addColumn<bool>("typed");
+    QTest::addColumn<int>("samples");
+
+    for (int samples : {16, 1024, 65536}) {
+        const int ops = qBound(1, 4 * 1024 * 1024 / (samples * int(sizeof(float))), BatchSize);
+        QTest::newRow(qPrintable(dataTag("variant", samples, 1, ops))) << false << samples;
+        QTest::newRow(qPrintable(dataTag("typed", samples, 1, ops))) << true << samples;
+    }
+}
+
+void EventSystemBenchmarks::typedDataEvent()
+{
+    QFETCH(bool, typed);
+    QFETCH(int, samples);
+
+    const int ops = qBound(1, 4 * 1024 * 1024 / (samples * int(sizeof(float))), BatchSize);
+
+    SampleReceiver receiver;
+    QBENCHMARK {
+        for (int i = 0; i < ops; ++i) {
+            QVector<float> values(samples, float(i));
+            if (typed) {
+                TypedDataEvent<QVector<float>> event(std::move(values));
+                QCoreApplication::sendEvent(&receiver, &event);
+            } else {
+                DataEvent event(QVariant::fromValue(values));
+                values = QVector<float>();      // 与类型化路径一样只留事件持有数据
+                QCoreApplication::sendEvent(&receiver, &event);
+            }
+        }
+    }
+    QVERIFY(receiver.sum != 0);
+}
+
+void EventSystemBenchmarks::sharedFanOut_data()
+{
+    QTest::addColumn<bool>("shared");
+    QTest::addColumn<int>("receivers");
+
+    const int payload = 1024 * 1024;
+    for (int receivers : {10, 100}) {
+        QTest::newRow(qPrintable(dataTag("copy", payload, 1, receivers))) << false << receivers;
+        QTest::newRow(qPrintable(dataTag("shared", payload, 1, receivers))) << true << receivers;
+    }
+}
+
+void EventSystemBenchmarks::sharedFanOut()
+{
+    QFETCH(bool, shared);
+    QFETCH(int, receivers);
+
+    const QByteArray payload(1024 * 1024, 'x');
+    QList<JournalReceiver*> targets;
+    for (int i = 0; i < receivers; ++i) {
+        targets.append(new JournalReceiver());
+    }
+
+    QBENCHMARK {
+        // 事件保留到本轮结束，模拟接收者尚未处理完时同时存活的事件
+        QList<DataEvent*> events;
+        const SharedPayload sharedPayload(payload);
+        for (JournalReceiver* target : targets) {
+            DataEvent* event = shared ? new SharedDataEvent(sharedPayload) : new DataEvent(payload);
+            QCoreApplication::sendEvent(target, event);
+            events.append(event);
+        }
+        qDeleteAll(events);
+    }
+
+    QVERIFY(targets.first()->journaled > 0);
+    qDeleteAll(targets);
+}
+
+void EventSystemBenchmarks::wireChecksum_data()
+{
+    QTest::addColumn<bool>("checksummed");
+    QTest::addColumn<int>("payloadBytes");
+
+    for (int payload : {64, 4096, 1024 * 1024}) {
+        int ops = qBound(1, 4 * 1024 * 1024 / payload, BatchSize);
+        QTest::newRow(qPrintable(dataTag("crc32c", payload, 1, ops))) << true << payload;
+        QTest::newRow(qPrintable(dataTag("bounds", payload, 1, ops))) << false << payload;
+    }
+}
+
+void EventSystemBenchmarks::wireChecksum()
+{
+    QFETCH(bool, checksummed);
+    QFETCH(int, payloadBytes);
+
+    const int ops = qBound(1, 4 * 1024 * 1024 / payloadBytes, BatchSize);
+
+    const QByteArray blob(payloadBytes, 'x');
+    EventWireWriter writer(DataEventType, 0);
+    writer.addBytes(u"payload", blob);
+    QByteArray frame = writer.finish();
+    if (!checksummed) {
+        // 清掉标志位，视图只做边界检查
+        EventWire::Header header;
+        std::memcpy(&header, frame.constData(), sizeof(header));
+        header.flags &= ~quint16(EventWire::Checksummed);
+        std::memcpy(frame.data(), &header, sizeof(header));
+    }
+    static bool reported = false;
+    if (!reported) {
+        qInfo() << "CRC32C hardware acceleration:" << Crc32c::isHardwareAccelerated();
+        reported = true;
+    }
+
+    int valid = 0;
+    QBENCHMARK {
+        for (int i = 0; i < ops; ++i) {
+            valid += EventWireView(frame).isValid() ? 1 : 0;
+        }
+    }
+    QVERIFY(valid > 0);
+}
+
+void EventSystemBenchmarks::traceBulkLoad_data()
+{
+    QTest::addColumn<int>("payloadBytes");
+    QTest::addColumn<int>("threads");
+
+    for (int payload : {256, 16384}) {
+        const int frames = qBound(1, 64 * 1024 * 1024 / payload, 64 * BatchSize);
+        for (int threads : {1, 2, 4, 8}) {
+            QTest::newRow(qPrintable(dataTag("trace", payload, threads, frames)))
+                << payload << threads;
+        }
+    }
+}
+
+void EventSystemBenchmarks::traceBulkLoad()
+{
+    QFETCH(int, payloadBytes);
+    QFETCH(int, threads);
+
+    const int frames = qBound(1, 64 * 1024 * 1024 / payloadBytes, 64 * BatchSize);
+
+    // 结构化负载，加载时需要逐字段解码
+    QVariantMap map;
+    for (int i = 0; i < qMax(1, payloadBytes / 64); ++i) {
+        map.insert(QString("field_%1").arg(i), QString(24, QChar('v')));
+    }
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    EventTraceWriter writer(&file);
+    for (int i = 0; i < frames; ++i) {
+        map.insert("sequence", i);
+        QVERIFY(writer.append(DataEvent(map)));
+    }
+    QVERIFY(writer.finish());
+    QVERIFY(file.seek(0));
+
+    EventTraceReader reader(&file);
+    reader.setMaxThreads(threads);
+    QVERIFY(reader.open());
+
+    qint64 loaded = 0;
+    QBENCHMARK {
+        QList<BaseCustomEvent*> events;
+        QVERIFY(reader.loadEvents(&events));
+        loaded += events.size();
+        qDeleteAll(events);
+    }
+    QVERIFY(loaded >= frames);
+}
+
+void EventSystemBenchmarks::schemaLookup_data()
+{
+    QTest::addColumn<QString>("mode");
+    QTest::addColumn<int>("params");
+
+    for (int params : {4, 16, 64}) {
+        for (const char* mode : {"name", "id", "promote"}) {
+            QTest::newRow(qPrintable(dataTag(mode, params, 1, BatchSize))) << QString(mode) << params;
+        }
+    }
+}
+
+void EventSystemBenchmarks::schemaLookup()
+{
+    QFETCH(QString, mode);
+    QFETCH(int, params);
+
+    // 模式只在本用例内使用，不登记到全局
+    EventSchema schema(CommandEventType, 2);
+    QStringList names;
+    for (int i = 0; i < params; ++i) {
+        names.append(QString("param_%1").arg(i));
+        schema.addField(quint16(i + 1), names.last());
+    }
+    const auto shared = std::make_shared<const EventSchema>(schema);
+
+    // promote模拟模式段出现之前录制的事件：没有字段ID，按名称映射
+    const QString command("benchmark");
+    EventWireWriter writer(CommandEventType, 0);
+    writer.addString(QStringView(), command);
+    for (int i = 0; i < params; ++i) {
+        writer.addInt(names[i], i);
+    }
+    if (mode != "promote") {
+        writer.setSchemaVersion(schema.version());
+        for (int i = 0; i < params; ++i) {
+            writer.setFieldId(i + 1, quint16(i + 1));
+        }
+    }
+    const EventWireView view(writer.finish());
+    QVERIFY(view.isValid());
+
+    const bool byName = mode == "name";
+    qint64 checksum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < BatchSize; ++i) {
+            if (byName) {
+                for (int p = 0; p < params; ++p) {
+                    checksum += view.toInt(view.indexOf(names[p], 1));
+                }
+            } else {
+                // 绑定计入每次迭代，与deserialize()的开销一致
+                const EventSchemaView bound(view, shared, 1);
+                for (int p = 0; p < params; ++p) {
+                    checksum += view.toInt(bound.indexOf(quint16(p + 1)));
+                }
+            }
+        }
+    }
+    QVERIFY(checksum > 0);
+}
+
+namespace {
+
+/**
+ * @brief 把QtTest的XML结果转换为JSON
+ * @param xmlPath QtTest XML输出文件
+ * @param jsonPath JSON输出文件
+ * @return 是否写入成功
+ */
+bool writeJsonReport(const QString& xmlPath, const QString& jsonPath)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot read benchmark XML output" << xmlPath;
+        return false;
+    }
+
+    QJsonArray results;
+    QString currentFunction;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) {
+            continue;
+        }
+
+        if (xml.name() == QLatin1String("TestFunction")) {
+            currentFunction = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            const QString tag = attributes.value("tag").toString();
+
+            // 解析 "key=value/..." 格式的数据标签
+            QJsonObject params;
+            for (const QString& part : tag.split('/', Qt::SkipEmptyParts)) {
+                int separator = part.indexOf('=');
+                if (separator <= 0) {
+                    continue;
+                }
+                const QString key = part.left(separator);
+                const QString value = part.mid(separator + 1);
+                bool isNumber = false;
+                qlonglong number = value.toLongLong(&isNumber);
+                params.insert(key, isNumber ? QJsonValue(number) : QJsonValue(value));
+            }
+
+            QJsonObject result;
+            result.insert("benchmark", currentFunction);
+            result.insert("tag", tag);
+            result.insert("params", params);
+            result.insert("metric", attributes.value("metric").toString());
+            result.insert("value", attributes.value("value").toDouble());
+            result.insert("iterations", attributes.value("iterations").toInt());
+            results.append(result);
+        }
+    }
+
+    if (xml.hasError()) {
+        qWarning() << "Failed to parse benchmark XML:" << xml.errorString();
+        return false;
+    }
+
+    QJsonObject report;
+    report.insert("suite", "EventSystemBenchmarks");
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("qtVersion", QString::fromLatin1(qVersion()));
+    report.insert("idealThreadCount", QThread::idealThreadCount());
+    report.insert("results", results);
+
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write benchmark JSON report" << jsonPath;
+        return false;
+    }
+    jsonFile.write(QJsonDocument(report).toJson());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // 无界面运行：未指定平台插件时使用offscreen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    // 取出 --json <文件>，其余参数原样交给QtTest
+    QStringList arguments = app.arguments();
+    QString jsonPath;
+    int jsonIndex = arguments.indexOf("--json");
+    if (jsonIndex > 0 && jsonIndex + 1 < arguments.size()) {
+        jsonPath = arguments.at(jsonIndex + 1);
+        arguments.removeAt(jsonIndex + 1);
+        arguments.removeAt(jsonIndex);
+    }
+
+    EventSystemBenchmarks benchmarks;
+    if (jsonPath.isEmpty()) {
+        return QTest::qExec(&benchmarks, arguments);
+    }
+
+    // 同时输出可读文本和XML，结束后把XML转换为JSON
+    QTemporaryFile xmlFile;
+    if (!xmlFile.open()) {
+        qWarning() << "Cannot create temporary file for benchmark results";
+        return 1;
+    }
+    const QString xmlPath = xmlFile.fileName();
+    xmlFile.close();
+
+    arguments << "-o" << xmlPath + ",xml" << "-o" << "-,txt";
+    int result = QTest::qExec(&benchmarks, arguments);
+
+    if (!writeJsonReport(xmlPath, jsonPath)) {
+        return result != 0 ? result : 1;
+    }
+    qInfo() << "Benchmark results written to" << jsonPath;
+    return result;
+}
@@ -0,0 +1,112 @@
+#ifndef EVENT_SYSTEM_BENCHMARKS_H
+#define EVENT_SYSTEM_BENCHMARKS_H
+
+#include <QObject>
+#include <QTest>
+
+/**
+ * @brief EventSystemBenchmarks 事件系统无界面性能基准测试
+ *
+ * 使用QtTest的QBENCHMARK测量事件系统热点路径，每项测试都按
+ * 负载大小和线程数做数据驱动扫描。数据标签采用 "key=value/..."
+ * 格式，传入 --json <文件> 时会把结果转换为JSON以便回归跟踪。
+ *
+ * 每次QBENCHMARK迭代中每个线程执行 ops 次操作，ops 同样写在标签里，
+ * 用 value / (ops * threads) 即可得到单次操作的耗时。
+ */
+class EventSystemBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 初始化单例并关闭调试输出
+     */
+    void initTestCase();
+
+    /**
+     * @brief postEvent 与 sendEvent 对比
+     */
+    void postVsSendEvent_data();
+    void postVsSendEvent();
+
+    /**
+     * @brief EventLogger::logEvent 记录开销
+     */
+    void logEvent_data();
+    void logEvent();
+
+    /**
+     * @brief EventPool 获取/释放开销
+     */
+    void eventPoolAcquireRelease_data();
+    void eventPoolAcquireRelease();
+
+    /**
+     * @brief 批量处理池化事件与逐个堆分配事件的对比（可配合 -perfcounter cache-misses）
+     */
+    void pooledBulkProcessing_data();
+    void pooledBulkProcessing();
+
+    /**
+     * @brief EventCompressionDemo 鼠标事件压缩开销
+     */
+    void mouseCompression_data();
+    void mouseCompression();
+
+    /**
+     * @brief 事件过滤器链开销
+     */
+    void filterChain_data();
+    void filterChain();
+
+    /**
+     * @brief DataEvent 序列化/反序列化开销
+     */
+    void dataEventSerialization_data();
+    void dataEventSerialization();
+
+    /**
+     * @brief CommandEvent 参数写入/查找开销（键名与驻留键ID对比）
+     */
+    void commandEventParameters_data();
+    void commandEventParameters();
+
+    /**
+     * @brief 录制用CommandEvent的压缩/解压开销，压缩率以qInfo输出
+     */
+    void eventCompression_data();
+    void eventCompression();
+
+    /**
+     * @brief QVector<float>负载经DataEvent(QVariant)与TypedDataEvent投递的开销
+     */
+    void typedDataEvent_data();
+    void typedDataEvent();
+
+    /**
+     * @brief 同一负载投递给多个接收者、各自序列化记录（独立事件与共享负载对比）
+     */
+    void sharedFanOut_data();
+    void sharedFanOut();
+
+    /**
+     * @brief 线格式帧校验开销（CRC32C校验与只做边界检查对比）
+     */
+    void wireChecksum_data();
+    void wireChecksum();
+
+    /**
+     * @brief 从录制文件批量加载事件（单线程与多线程解码对比）
+     */
+    void traceBulkLoad_data();
+    void traceBulkLoad();
+
+    /**
+     * @brief 反序列化事件的参数查找：按名称、按字段ID、旧事件经模式映射
+     */
+    void schemaLookup_data();
+    void schemaLookup();
+};
+
+#endif // EVENT_SYSTEM_BENCHMARKS_H
@@ -0,0 +1,225 @@
+#include "allocation_profiler.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+namespace {
+
+// 常量初始化的POD，线程局部访问不会触发动态初始化或分配
+struct ThreadCounters {
+    quint64 allocations;
+    quint64 allocatedBytes;
+    quint64 deallocations;
+};
+
+thread_local ThreadCounters t_counters = { 0, 0, 0 };
+std::atomic<bool> g_enabled(false);
+
+#ifdef EVENT_ALLOCATION_PROFILER
+// 按对齐要求分配；对齐分配的内存必须由alignedFree释放
+void* alignedMalloc(std::size_t size, std::align_val_t alignment) noexcept
+{
+    const std::size_t align = qMax(static_cast<std::size_t>(alignment), sizeof(void*));
+#ifdef Q_OS_WIN
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, align, size ? size : 1) != 0) {
+        return nullptr;
+    }
+    return ptr;
+#endif
+}
+
+void alignedFree(void* ptr) noexcept
+{
+#ifdef Q_OS_WIN
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+#endif // EVENT_ALLOCATION_PROFILER
+
+} // namespace
+
+bool AllocationProfiler::isSupported()
+{
+#ifdef EVENT_ALLOCATION_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AllocationProfiler::setEnabled(bool enabled)
+{
+    g_enabled.store(enabled && isSupported(), std::memory_order_relaxed);
+    return isSupported();
+}
+
+bool AllocationProfiler::isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+AllocationProfiler::Counters AllocationProfiler::currentThreadCounters()
+{
+    Counters counters;
+    counters.allocations = t_counters.allocations;
+    counters.allocatedBytes = t_counters.allocatedBytes;
+    counters.deallocations = t_counters.deallocations;
+    return counters;
+}
+
+AllocationProfiler::Counters AllocationProfiler::delta(const Counters& begin, const Counters& end)
+{
+    Counters result;
+    result.allocations = end.allocations - begin.allocations;
+    result.allocatedBytes = end.allocatedBytes - begin.allocatedBytes;
+    result.deallocations = end.deallocations - begin.deallocations;
+    return result;
+}
+
+void AllocationProfiler::recordAllocation(std::size_t size) noexcept
+{
+    if (g_enabled.load(std::memory_order_relaxed)) {
+        ++t_counters.allocations;
+        t_counters.allocatedBytes += size;
+    }
+}
+
+void AllocationProfiler::recordDeallocation() noexcept
+{
+    if (g_enabled.load(std::memory_order_relaxed)) {
+        ++t_counters.deallocations;
+    }
+}
+
+#ifdef EVENT_ALLOCATION_PROFILER
+// 全局operator new/delete替换：在malloc/free之上计数
+
+void* operator new(std::size_t size)
+{
+    AllocationProfiler::recordAllocation(size);
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    AllocationProfiler::recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr) {
+        AllocationProfiler::recordDeallocation();
+        std::free(ptr);
+    }
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    ::operator delete(ptr);
+}
+
+// 超对齐类型（如事件池按slab大小对齐的slab）走以下重载
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    AllocationProfiler::recordAllocation(size);
+    void* ptr = alignedMalloc(size, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    AllocationProfiler::recordAllocation(size);
+    return alignedMalloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, alignment, tag);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    if (ptr) {
+        AllocationProfiler::recordDeallocation();
+        alignedFree(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept
+{
+    ::operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+    ::operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+    ::operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    ::operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    ::operator delete(ptr, alignment);
+}
+#endif // EVENT_ALLOCATION_PROFILER
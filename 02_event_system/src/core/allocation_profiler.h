@@ -0,0 +1,73 @@
+#ifndef ALLOCATION_PROFILER_H
+#define ALLOCATION_PROFILER_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * @brief AllocationProfiler 堆分配分析器
+ *
+ * 以 ENABLE_ALLOCATION_PROFILER 构建选项编译时，替换全局
+ * operator new/delete（含std::align_val_t对齐版本及其nothrow、sized
+ * 变体），把分配次数和字节数累加到线程局部计数器。
+ * 钩子本身不加锁也不分配内存；EventPerformanceAnalyzer在事件
+ * 开始和结束时读取计数器，把差值归因到正在分派的事件类型和接收者。
+ *
+ * 未编译钩子时所有接口仍然可用，isSupported()返回false，计数器恒为0。
+ */
+class AllocationProfiler
+{
+public:
+    /**
+     * @brief 线程局部分配计数
+     */
+    struct Counters {
+        quint64 allocations;        // 分配次数
+        quint64 allocatedBytes;     // 分配字节数（请求大小）
+        quint64 deallocations;      // 释放次数
+
+        Counters() : allocations(0), allocatedBytes(0), deallocations(0) {}
+    };
+
+    /**
+     * @brief 检查是否编译了全局operator new/delete钩子
+     * @return 是否支持分配跟踪
+     */
+    static bool isSupported();
+
+    /**
+     * @brief 启用或禁用分配计数（所有线程）
+     * @param enabled 是否启用
+     * @return 是否支持分配跟踪
+     */
+    static bool setEnabled(bool enabled);
+
+    /**
+     * @brief 检查分配计数是否启用
+     * @return 是否启用
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief 获取当前线程的累计分配计数
+     * @return 分配计数
+     */
+    static Counters currentThreadCounters();
+
+    /**
+     * @brief 计算两次读数之间的增量
+     * @param begin 起始读数
+     * @param end 结束读数
+     * @return 增量
+     */
+    static Counters delta(const Counters& begin, const Counters& end);
+
+    // 以下两个方法由operator new/delete钩子调用，不得分配内存
+    static void recordAllocation(std::size_t size) noexcept;
+    static void recordDeallocation() noexcept;
+
+private:
+    AllocationProfiler() = delete;
+};
+
+#endif // ALLOCATION_PROFILER_H
@@ -0,0 +1,132 @@
+#include "coalescing_interval_controller.h"
+#include <QtMath>
+
+CoalescingIntervalController::CoalescingIntervalController(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_lastTimeMs(0)
+    , m_hasCost(false)
+{
+    m_clock.start();
+    connect(m_timer, &QTimer::timeout, this, [this]() { evaluate(); });
+}
+
+CoalescingIntervalController::~CoalescingIntervalController()
+{
+}
+
+void CoalescingIntervalController::attach(EventCoalescer* coalescer)
+{
+    m_coalescer = coalescer;
+    m_hasCost = false;
+    resetBaseline();
+}
+
+void CoalescingIntervalController::setConfig(const Config& config)
+{
+    m_config = config;
+    m_config.cpuBudget = qBound(0.01, m_config.cpuBudget, 1.0);
+    m_config.minIntervalMs = qMax(0, m_config.minIntervalMs);
+    m_config.maxIntervalMs = qMax(m_config.minIntervalMs, m_config.maxIntervalMs);
+    m_config.costSmoothing = qBound(0.01, m_config.costSmoothing, 1.0);
+    m_config.decayFactor = qBound(0.01, m_config.decayFactor, 1.0);
+
+    if (m_timer->isActive()) {
+        m_timer->start(m_config.sampleIntervalMs);
+    }
+}
+
+void CoalescingIntervalController::start()
+{
+    if (m_coalescer) {
+        m_coalescer->setFlushPolicy(EventCoalescer::FlushOnInterval);
+        m_metrics.intervalMs = m_coalescer->interval();
+    }
+    resetBaseline();
+    m_timer->start(m_config.sampleIntervalMs);
+}
+
+void CoalescingIntervalController::stop()
+{
+    m_timer->stop();
+}
+
+bool CoalescingIntervalController::isRunning() const
+{
+    return m_timer->isActive();
+}
+
+int CoalescingIntervalController::evaluate()
+{
+    if (!m_coalescer) {
+        return 0;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    const EventCoalescer::Metrics current = m_coalescer->metrics();
+    const qint64 elapsedMs = now - m_lastTimeMs;
+
+    // 统计被重置过，以当前值重新作为基线
+    if (current.submitted < m_last.submitted || current.deliveries < m_last.deliveries) {
+        resetBaseline();
+        return m_coalescer->interval();
+    }
+    if (elapsedMs <= 0) {
+        return m_coalescer->interval();
+    }
+
+    const quint64 submitted = current.submitted - m_last.submitted;
+    const quint64 delivered = current.delivered - m_last.delivered;
+    const quint64 flushes = current.flushes - m_last.flushes;
+    const quint64 deliveries = current.deliveries - m_last.deliveries;
+    const qint64 handlerNs = current.handlerNs - m_last.handlerNs;
+    const qint64 latencyNs = current.latencyNs - m_last.latencyNs;
+    m_last = current;
+    m_lastTimeMs = now;
+
+    m_metrics.evaluations++;
+    m_metrics.inputRate = submitted * 1000.0 / elapsedMs;
+    m_metrics.flushRate = flushes * 1000.0 / elapsedMs;
+    m_metrics.cpuLoad = handlerNs / (elapsedMs * 1e6);
+    m_metrics.compressionRatio = submitted > 0
+        ? 1.0 - static_cast<double>(delivered) / submitted : 0.0;
+
+    // 交付代价只在本周期有交付时更新；处理耗时和等待包含直接交付，按全部交付次数平均
+    if (deliveries > 0) {
+        const double costUs = handlerNs / 1000.0 / deliveries;
+        m_metrics.deliveryCostUs = m_hasCost
+            ? m_metrics.deliveryCostUs + (costUs - m_metrics.deliveryCostUs) * m_config.costSmoothing
+            : costUs;
+        m_metrics.meanLatencyMs = latencyNs / 1e6 / deliveries;
+        m_hasCost = true;
+    }
+
+    // 逐事件交付的CPU占用在预算内就用最小间隔，否则按预算限制交付频率
+    const double costMs = m_metrics.deliveryCostUs / 1000.0;
+    int target = m_config.minIntervalMs;
+    if (m_metrics.inputRate * costMs / 1000.0 > m_config.cpuBudget) {
+        target = qCeil(costMs / m_config.cpuBudget);
+    }
+    target = qBound(m_config.minIntervalMs, target, m_config.maxIntervalMs);
+    m_metrics.targetIntervalMs = target;
+
+    const int interval = m_coalescer->interval();
+    int next = target;
+    if (target < interval) {
+        next = interval - qCeil((interval - target) * m_config.decayFactor);
+    }
+
+    if (next != interval) {
+        m_coalescer->setInterval(next);
+        m_metrics.adjustments++;
+        emit intervalChanged(next);
+    }
+    m_metrics.intervalMs = next;
+    return next;
+}
+
+void CoalescingIntervalController::resetBaseline()
+{
+    m_last = m_coalescer ? m_coalescer->metrics() : EventCoalescer::Metrics();
+    m_lastTimeMs = m_clock.elapsed();
+}
@@ -0,0 +1,112 @@
+#ifndef COALESCING_INTERVAL_CONTROLLER_H
+#define COALESCING_INTERVAL_CONTROLLER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "event_coalescer.h"
+
+/**
+ * @brief CoalescingIntervalController 合并间隔自适应控制器
+ *
+ * 周期性读取 EventCoalescer 的提交数、刷新数和处理函数耗时，估算输入速率
+ * 和每次交付的平均代价，据此调整合并窗口：
+ * - 即使每个事件单独交付，处理函数占用的CPU也不超过预算时，使用最小间隔，
+ *   事件几乎没有额外延迟；
+ * - 否则把间隔设为 平均交付代价 / CPU预算，使交付频率受预算约束。
+ *
+ * 负载上升时立即放大间隔保护CPU，负载下降时按衰减系数逐步缩小，避免抖动。
+ * 指标中同时给出实测排队延迟和CPU占用，便于在两者之间权衡调参。
+ */
+class CoalescingIntervalController : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 控制参数
+     */
+    struct Config {
+        int sampleIntervalMs;       // 采样周期
+        double cpuBudget;           // 处理函数可占用的CPU比例（单核）
+        int minIntervalMs;          // 合并间隔下限
+        int maxIntervalMs;          // 合并间隔上限
+        double costSmoothing;       // 交付代价的指数平滑系数
+        double decayFactor;         // 间隔缩小时每次向目标靠近的比例
+
+        Config()
+            : sampleIntervalMs(250), cpuBudget(0.2), minIntervalMs(0)
+            , maxIntervalMs(200), costSmoothing(0.3), decayFactor(0.5) {}
+    };
+
+    /**
+     * @brief 控制器指标
+     */
+    struct Metrics {
+        quint64 evaluations;        // 评估次数
+        quint64 adjustments;        // 间隔调整次数
+        double inputRate;           // 输入速率（事件/秒）
+        double flushRate;           // 交付速率（批/秒）
+        double deliveryCostUs;      // 平滑后的单次交付代价（微秒）
+        double cpuLoad;             // 处理函数实测CPU占用（单核比例）
+        double meanLatencyMs;       // 每次交付中最早事件的平均排队延迟
+        double compressionRatio;    // 采样周期内被合并掉的事件占比
+        int intervalMs;             // 当前合并间隔
+        int targetIntervalMs;       // 按当前负载计算的目标间隔
+
+        Metrics()
+            : evaluations(0), adjustments(0), inputRate(0.0), flushRate(0.0)
+            , deliveryCostUs(0.0), cpuLoad(0.0), meanLatencyMs(0.0)
+            , compressionRatio(0.0), intervalMs(0), targetIntervalMs(0) {}
+    };
+
+    explicit CoalescingIntervalController(QObject* parent = nullptr);
+    ~CoalescingIntervalController() override;
+
+    /**
+     * @brief 绑定要控制的合并器（不取得所有权）
+     */
+    void attach(EventCoalescer* coalescer);
+    EventCoalescer* coalescer() const { return m_coalescer; }
+
+    void setConfig(const Config& config);
+    Config config() const { return m_config; }
+
+    /**
+     * @brief 开始控制，合并器切换为FlushOnInterval策略
+     */
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief 立即采样并调整一次
+     * @return 调整后的合并间隔
+     */
+    int evaluate();
+
+    Metrics metrics() const { return m_metrics; }
+
+signals:
+    /**
+     * @brief 合并间隔发生变化
+     */
+    void intervalChanged(int intervalMs);
+
+private:
+    void resetBaseline();
+
+    QPointer<EventCoalescer> m_coalescer;
+    Config m_config;
+    Metrics m_metrics;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+
+    // 上次采样
+    EventCoalescer::Metrics m_last;
+    qint64 m_lastTimeMs;
+    bool m_hasCost;
+};
+
+#endif // COALESCING_INTERVAL_CONTROLLER_H
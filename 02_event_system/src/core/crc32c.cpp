@@ -0,0 +1,260 @@
+#include "crc32c.h"
+#include <QSysInfo>
+#include <QtEndian>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define CRC32C_X86
+#  include <nmmintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define CRC32C_ARM64
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <arm_acle.h>
+#    if !defined(__ARM_FEATURE_CRC32) && defined(__linux__)
+#      include <sys/auxv.h>
+#      include <asm/hwcap.h>
+#    endif
+#  endif
+#endif
+
+namespace {
+
+const quint32 Polynomial = 0x82F63B78;     // 反射形式
+
+/**
+ * @brief slicing-by-8查找表：每次处理8字节
+ */
+struct Tables {
+    quint32 table[8][256];
+
+    Tables()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (Polynomial & (0u - (crc & 1)));
+            }
+            table[0][i] = crc;
+        }
+        for (quint32 i = 0; i < 256; ++i) {
+            for (int slice = 1; slice < 8; ++slice) {
+                const quint32 previous = table[slice - 1][i];
+                table[slice][i] = (previous >> 8) ^ table[0][previous & 0xFF];
+            }
+        }
+    }
+};
+
+quint32 softwareCrc(quint32 crc, const uchar* data, qsizetype length)
+{
+    static const Tables tables;
+    const auto& t = tables.table;
+
+    while (length >= 8) {
+        quint32 low;
+        quint32 high;
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + 4, 4);
+        if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            low = qbswap(low);
+            high = qbswap(high);
+        }
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+inline quint64 load64(const uchar* data)
+{
+    quint64 word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+#if defined(CRC32C_X86)
+
+#  if defined(__GNUC__) || defined(__clang__)
+#    define CRC32C_HW_TARGET __attribute__((target("sse4.2")))
+#  else
+#    define CRC32C_HW_TARGET
+#  endif
+
+CRC32C_HW_TARGET inline quint32 crcWord(quint32 crc, quint64 word)
+{
+#  if defined(__x86_64__) || defined(_M_X64)
+    return quint32(_mm_crc32_u64(crc, word));
+#  else
+    crc = _mm_crc32_u32(crc, quint32(word));
+    return _mm_crc32_u32(crc, quint32(word >> 32));
+#  endif
+}
+
+CRC32C_HW_TARGET inline quint32 crcByte(quint32 crc, uchar byte)
+{
+    return _mm_crc32_u8(crc, byte);
+}
+
+bool detectHardware()
+{
+#  if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#  else
+    return __builtin_cpu_supports("sse4.2");
+#  endif
+}
+
+#elif defined(CRC32C_ARM64)
+
+#  if !defined(_MSC_VER) && !defined(__ARM_FEATURE_CRC32)
+#    define CRC32C_HW_TARGET __attribute__((target("arch=armv8-a+crc")))
+#  else
+#    define CRC32C_HW_TARGET
+#  endif
+
+CRC32C_HW_TARGET inline quint32 crcWord(quint32 crc, quint64 word)
+{
+    return __crc32cd(crc, word);
+}
+
+CRC32C_HW_TARGET inline quint32 crcByte(quint32 crc, uchar byte)
+{
+    return __crc32cb(crc, byte);
+}
+
+bool detectHardware()
+{
+#  if defined(_MSC_VER) || defined(__ARM_FEATURE_CRC32)
+    return true;
+#  elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#  else
+    return false;
+#  endif
+}
+
+#endif
+
+#if defined(CRC32C_X86) || defined(CRC32C_ARM64)
+
+/**
+ * crc指令有3个周期的延迟但每周期可发射一条，单路串行只能用到三分之一的
+ * 吞吐量。大块数据分成三段同时计算，再把前两段的结果“补零”移位后合并：
+ *   crc(A|B|C) = shift(shift(crc(A)) ^ crc(B)) ^ crc(C)
+ * 其中shift是在寄存器后追加StripeBytes个零字节，对寄存器是线性变换，按字节查表。
+ */
+const qsizetype StripeBytes = 4096;
+
+struct ZeroShift {
+    quint32 table[4][256];
+
+    quint32 apply(quint32 crc) const
+    {
+        return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF]
+             ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+    }
+};
+
+CRC32C_HW_TARGET quint32 appendZeros(quint32 crc)
+{
+    for (qsizetype i = 0; i < StripeBytes; i += 8) {
+        crc = crcWord(crc, 0);
+    }
+    return crc;
+}
+
+const ZeroShift& zeroShift()
+{
+    static const ZeroShift shift = []() {
+        ZeroShift result;
+        for (int byte = 0; byte < 4; ++byte) {
+            for (quint32 value = 0; value < 256; ++value) {
+                result.table[byte][value] = appendZeros(value << (8 * byte));
+            }
+        }
+        return result;
+    }();
+    return shift;
+}
+
+CRC32C_HW_TARGET quint32 hardwareCrc(quint32 crc, const uchar* data, qsizetype length)
+{
+    if (length >= 3 * StripeBytes) {
+        const ZeroShift& shift = zeroShift();
+        do {
+            quint32 a = crc;
+            quint32 b = 0;
+            quint32 c = 0;
+            for (qsizetype i = 0; i < StripeBytes; i += 8) {
+                a = crcWord(a, load64(data + i));
+                b = crcWord(b, load64(data + StripeBytes + i));
+                c = crcWord(c, load64(data + 2 * StripeBytes + i));
+            }
+            crc = shift.apply(shift.apply(a) ^ b) ^ c;
+            data += 3 * StripeBytes;
+            length -= 3 * StripeBytes;
+        } while (length >= 3 * StripeBytes);
+    }
+
+    while (length >= 8) {
+        crc = crcWord(crc, load64(data));
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = crcByte(crc, *data++);
+    }
+    return crc;
+}
+
+#endif
+
+bool hardwareAvailable()
+{
+#if defined(CRC32C_X86) || defined(CRC32C_ARM64)
+    static const bool available = detectHardware();
+    return available;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+quint32 Crc32c::update(quint32 crc, const void* data, qsizetype length)
+{
+    return hardwareAvailable() ? updateHardware(crc, data, length) : updateSoftware(crc, data, length);
+}
+
+quint32 Crc32c::updateSoftware(quint32 crc, const void* data, qsizetype length)
+{
+    return ~softwareCrc(~crc, static_cast<const uchar*>(data), length);
+}
+
+quint32 Crc32c::updateHardware(quint32 crc, const void* data, qsizetype length)
+{
+#if defined(CRC32C_X86) || defined(CRC32C_ARM64)
+    if (hardwareAvailable()) {
+        return ~hardwareCrc(~crc, static_cast<const uchar*>(data), length);
+    }
+#endif
+    return updateSoftware(crc, data, length);
+}
+
+bool Crc32c::isHardwareAccelerated()
+{
+    return hardwareAvailable();
+}
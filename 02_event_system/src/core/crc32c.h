@@ -0,0 +1,41 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <QtGlobal>
+
+/**
+ * @brief CRC32C（Castagnoli）校验
+ *
+ * 运行时选择实现：x86上使用SSE4.2的crc32指令，ARMv8上使用CRC扩展指令，
+ * 其他平台使用查表（slicing-by-8）实现。各实现结果完全一致，可以在不同
+ * 机器之间交换。
+ */
+namespace Crc32c {
+
+/**
+ * @brief 在已有校验值上继续累加
+ * @param crc 上一段的结果，首段传0
+ */
+quint32 update(quint32 crc, const void* data, qsizetype length);
+
+inline quint32 compute(const void* data, qsizetype length)
+{
+    return update(0, data, length);
+}
+
+/**
+ * @brief 指定实现的累加，结果与update()相同，供测试和基准对照
+ *
+ * updateHardware()在不支持硬件指令的机器上退回查表实现。
+ */
+quint32 updateSoftware(quint32 crc, const void* data, qsizetype length);
+quint32 updateHardware(quint32 crc, const void* data, qsizetype length);
+
+/**
+ * @brief 当前是否使用硬件指令
+ */
+bool isHardwareAccelerated();
+
+} // namespace Crc32c
+
+#endif // CRC32C_H
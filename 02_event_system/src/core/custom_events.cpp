@@ -1,7 +1,9 @@
 #include "custom_events.h"
+#include "event_compression.h"
 #include <QDateTime>
 #include <QDebug>
 #include <QIODevice>
+#include <cstring>
 
 // BaseCustomEvent 实现
 BaseCustomEvent::BaseCustomEvent(Type type)
@@ -10,39 +12,137 @@ BaseCustomEvent::BaseCustomEvent(Type type)
 {
 }
 
+bool BaseCustomEvent::writeTo(QIODevice* device) const
+{
+    return EventWire::writeChunked(device, serialize());
+}
+
+bool BaseCustomEvent::readFrom(QIODevice* device)
+{
+    if (!device || !device->isReadable()) {
+        return false;
+    }
+    
+    // 线格式头部和压缩信封头部都带有总长度，只读取本事件的字节
+    const QByteArray head = device->peek(sizeof(EventWire::Header));
+    qint64 size = -1;
+    if (EventCompression::isCompressed(head)) {
+        size = EventCompression::envelopeSize(head);
+    } else if (head.size() == qsizetype(sizeof(EventWire::Header)) && EventWire::isWireFormat(head)) {
+        EventWire::Header header;
+        std::memcpy(&header, head.constData(), sizeof(header));
+        size = header.totalSize;
+    }
+    if (size < 0) {
+        return false;
+    }
+    
+    const QByteArray data = device->read(size);
+    return data.size() == size && deserialize(data);
+}
+
+QByteArray BaseCustomEvent::serializeCompressed() const
+{
+    return EventCompression::compress(type(), serialize());
+}
+
 // DataEvent 实现
 DataEvent::DataEvent(const QVariant& data)
     : BaseCustomEvent(static_cast<Type>(DataEventType))
     , m_data(data)
+    , m_pending(false)
+    , m_unboxed(false)
+    , m_serializedSize(-1)
+{
+}
+
+DataEvent::DataEvent(QMetaType payloadType)
+    : BaseCustomEvent(static_cast<Type>(DataEventType))
+    , m_pending(false)
+    , m_unboxed(true)
+    , m_payloadType(payloadType)
+    , m_serializedSize(-1)
 {
 }
 
 QVariant DataEvent::data() const
 {
+    materialize();
     return m_data;
 }
 
 void DataEvent::setData(const QVariant& data)
 {
     m_data = data;
+    m_wire = EventWireView();
+    m_pending = false;
+    m_unboxed = false;
+    invalidateCaches();
+}
+
+void DataEvent::payloadChanged()
+{
+    m_data = QVariant();
+    m_wire = EventWireView();
+    m_pending = false;
+    m_unboxed = true;
+    invalidateCaches();
 }
 
 QByteArray DataEvent::serialize() const
 {
-    QByteArray result;
-    QDataStream stream(&result, QIODevice::WriteOnly);
-    
-    // 写入时间戳
-    stream << m_timestamp;
+    // 未修改的反序列化事件直接转发原缓冲区
+    if (m_wire.isValid()) {
+        return m_wire.buffer();
+    }
     
-    // 写入数据
-    stream << m_data;
+    if (m_serialized.isNull()) {
+        EventWireWriter writer(DataEventType, m_timestamp);
+        addFields(writer);
+        m_serialized = writer.finish();
+        m_serializedSize = m_serialized.size();
+    }
+    return m_serialized;
+}
+
+qsizetype DataEvent::serializedSize() const
+{
+    if (m_wire.isValid()) {
+        return m_wire.buffer().size();
+    }
     
-    return result;
+    if (m_serializedSize < 0) {
+        EventWireWriter writer(DataEventType, m_timestamp);
+        addFields(writer);
+        m_serializedSize = writer.size();
+    }
+    return m_serializedSize;
 }
 
 bool DataEvent::deserialize(const QByteArray& data)
 {
+    if (EventCompression::isCompressed(data)) {
+        const QByteArray raw = EventCompression::decompress(data);
+        return !raw.isEmpty() && deserialize(raw);
+    }
+    
+    if (EventWire::isWireFormat(data)) {
+        EventWireView view(data);
+        if (!view.isValid() || view.eventType() != DataEventType) {
+            return false;
+        }
+        
+        // 只保留缓冲区，值在首次访问时解码
+        m_timestamp = view.timestamp();
+        m_wire = view;
+        m_data = QVariant();
+        m_pending = true;
+        m_unboxed = false;
+        invalidateCaches();
+        return true;
+    }
+    
+    // 旧版QDataStream格式
     QDataStream stream(data);
     
     try {
@@ -52,42 +152,174 @@ bool DataEvent::deserialize(const QByteArray& data)
         // 读取数据
         stream >> m_data;
         
+        m_wire = EventWireView();
+        m_pending = false;
+        m_unboxed = false;
+        invalidateCaches();
         return stream.status() == QDataStream::Ok;
     } catch (...) {
         return false;
     }
 }
 
+bool DataEvent::writeTo(QIODevice* device) const
+{
+    // 已有完整缓冲区时直接分块写出
+    if (m_wire.isValid()) {
+        return EventWire::writeChunked(device, m_wire.buffer());
+    }
+    if (!m_serialized.isNull()) {
+        return EventWire::writeChunked(device, m_serialized);
+    }
+    
+    EventWireWriter writer(DataEventType, m_timestamp);
+    addFields(writer);
+    return writer.writeTo(device);
+}
+
+bool DataEvent::readFrom(QIODevice* device)
+{
+    // 压缩信封需要整体解压，交给基类读取
+    if (device && EventCompression::isCompressed(device->peek(sizeof(quint32)))) {
+        return BaseCustomEvent::readFrom(device);
+    }
+    
+    EventWireStreamReader reader(device);
+    if (!reader.readHeader() || reader.eventType() != DataEventType) {
+        return false;
+    }
+    
+    QVariant data;
+    if (reader.flags() & EventWire::MapRoot) {
+        QVariantMap map;
+        QString name;
+        QVariant value;
+        while (reader.hasNext()) {
+            if (!reader.readNext(&name, &value)) {
+                return false;
+            }
+            map.insert(name, value);
+        }
+        data = map;
+    } else if (!reader.readNext(nullptr, &data)) {
+        return false;
+    }
+    if (!reader.finish()) {
+        return false;
+    }
+    
+    setData(data);
+    m_timestamp = reader.timestamp();
+    return true;
+}
+
 QString DataEvent::description() const
 {
-    return QString("DataEvent: type=%1, size=%2 bytes")
-           .arg(dataTypeName())
-           .arg(serialize().size());
+    if (m_description.isNull()) {
+        m_description = QString("DataEvent: type=%1, size=%2 bytes")
+                        .arg(dataTypeName())
+                        .arg(serializedSize());
+    }
+    return m_description;
 }
 
 bool DataEvent::isValid() const
 {
+    if (m_unboxed) {
+        // 类型化负载总是有值，其余派生类的负载要装箱后才能判断
+        if (m_payloadType.isValid()) {
+            return true;
+        }
+        materialize();
+    }
+    if (m_pending) {
+        return (m_wire.flags() & EventWire::MapRoot)
+               || m_wire.fieldType(0) != EventWire::Null;
+    }
     return m_data.isValid();
 }
 
 QString DataEvent::dataTypeName() const
 {
+    // 类型化负载和未解码的负载都不必为取类型名而构造QVariant
+    if (m_unboxed && m_payloadType.isValid()) {
+        return QString(m_payloadType.name());
+    }
+    if (m_pending) {
+        const int metaType = (m_wire.flags() & EventWire::MapRoot)
+                           ? int(QMetaType::QVariantMap) : m_wire.fieldMetaType(0);
+        if (metaType != QMetaType::UnknownType) {
+            return QString(QMetaType(metaType).name());
+        }
+    }
+    
+    materialize();
     return QString(m_data.typeName());
 }
 
+void DataEvent::materialize() const
+{
+    if (m_unboxed) {
+        m_unboxed = false;
+        m_data = boxPayload();
+        return;
+    }
+    if (!m_pending) {
+        return;
+    }
+    m_pending = false;
+    
+    if (m_wire.flags() & EventWire::MapRoot) {
+        QVariantMap map;
+        for (int i = 0; i < m_wire.fieldCount(); ++i) {
+            map.insert(m_wire.fieldName(i).toString(), m_wire.value(i));
+        }
+        m_data = map;
+    } else {
+        m_data = m_wire.value(0);
+    }
+}
+
+void DataEvent::addFields(EventWireWriter& writer) const
+{
+    materialize();
+    
+    if (m_data.metaType().id() == QMetaType::QVariantMap) {
+        // 直接引用m_data内部的映射，键和值在finish()前保持有效
+        const QVariantMap& map = *static_cast<const QVariantMap*>(m_data.constData());
+        writer.setFlags(EventWire::MapRoot);
+        writer.reserve(map.size());
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            writer.addVariant(it.key(), it.value());
+        }
+    } else {
+        writer.addVariant(QStringView(), m_data);
+    }
+}
+
+void DataEvent::invalidateCaches()
+{
+    m_serialized = QByteArray();
+    m_serializedSize = -1;
+    m_description = QString();
+}
+
 // CommandEvent 实现
 CommandEvent::CommandEvent(const QString& command, const QVariantMap& params)
     : BaseCustomEvent(static_cast<Type>(CommandEventType))
     , m_command(command)
-    , m_parameters(params)
+    , m_pending(false)
 {
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        m_parameters.setValue(it.key(), it.value());
+    }
 }
 
 QVariant CommandEvent::data() const
 {
     QVariantMap result;
     result["command"] = m_command;
-    result["parameters"] = m_parameters;
+    result["parameters"] = parameters();
     return result;
 }
 
@@ -96,29 +328,60 @@ void CommandEvent::setData(const QVariant& data)
     if (data.canConvert<QVariantMap>()) {
         QVariantMap map = data.toMap();
         m_command = map.value("command").toString();
-        m_parameters = map.value("parameters").toMap();
+        setParameters(map.value("parameters").toMap());
     }
 }
 
 QByteArray CommandEvent::serialize() const
 {
-    QByteArray result;
-    QDataStream stream(&result, QIODevice::WriteOnly);
-    
-    // 写入时间戳
-    stream << m_timestamp;
-    
-    // 写入命令
-    stream << m_command;
+    // 未修改的反序列化事件直接转发原缓冲区
+    if (m_wire.isValid()) {
+        return m_wire.buffer();
+    }
     
-    // 写入参数
-    stream << m_parameters;
+    EventWireWriter writer(CommandEventType, m_timestamp);
+    addFields(writer);
+    return writer.finish();
+}
+
+qsizetype CommandEvent::serializedSize() const
+{
+    if (m_wire.isValid()) {
+        return m_wire.buffer().size();
+    }
     
-    return result;
+    EventWireWriter writer(CommandEventType, m_timestamp);
+    addFields(writer);
+    return writer.size();
 }
 
 bool CommandEvent::deserialize(const QByteArray& data)
 {
+    if (EventCompression::isCompressed(data)) {
+        const QByteArray raw = EventCompression::decompress(data);
+        return !raw.isEmpty() && deserialize(raw);
+    }
+    
+    if (EventWire::isWireFormat(data)) {
+        EventWireView view(data);
+        if (!view.isValid() || view.eventType() != CommandEventType
+            || view.fieldType(0) != EventWire::String) {
+            return false;
+        }
+        
+        // 只解码命令，参数按需读取
+        m_timestamp = view.timestamp();
+        m_command = view.toStringView(0).toString();
+        m_parameters.clear();
+        m_wire = view;
+        m_pending = true;
+        
+        const auto schema = EventSchema::find(CommandEventType);
+        m_schemaView = schema ? EventSchemaView(view, schema, 1) : EventSchemaView();
+        return true;
+    }
+    
+    // 旧版QDataStream格式
     QDataStream stream(data);
     
     try {
@@ -129,7 +392,9 @@ bool CommandEvent::deserialize(const QByteArray& data)
         stream >> m_command;
         
         // 读取参数
-        stream >> m_parameters;
+        QVariantMap params;
+        stream >> params;
+        setParameters(params);
         
         return stream.status() == QDataStream::Ok;
     } catch (...) {
@@ -137,11 +402,85 @@ bool CommandEvent::deserialize(const QByteArray& data)
     }
 }
 
+bool CommandEvent::writeTo(QIODevice* device) const
+{
+    if (m_wire.isValid()) {
+        return EventWire::writeChunked(device, m_wire.buffer());
+    }
+    
+    EventWireWriter writer(CommandEventType, m_timestamp);
+    addFields(writer);
+    return writer.writeTo(device);
+}
+
+bool CommandEvent::readFrom(QIODevice* device)
+{
+    // 压缩信封需要整体解压，交给基类读取
+    if (device && EventCompression::isCompressed(device->peek(sizeof(quint32)))) {
+        return BaseCustomEvent::readFrom(device);
+    }
+    
+    EventWireStreamReader reader(device);
+    if (!reader.readHeader() || reader.eventType() != CommandEventType) {
+        return false;
+    }
+    
+    QVariant command;
+    if (!reader.readNext(nullptr, &command) || command.metaType().id() != QMetaType::QString) {
+        return false;
+    }
+    
+    // 有模式时把旧名称换成当前名称
+    const auto schema = EventSchema::find(CommandEventType);
+    
+    EventPayload params;
+    QString name;
+    QVariant value;
+    for (int index = 1; reader.hasNext(); ++index) {
+        if (!reader.readNext(&name, &value)) {
+            return false;
+        }
+        if (schema) {
+            const quint16 id = reader.fieldId(index) != 0 ? reader.fieldId(index) : schema->idOf(name);
+            const int slot = id != 0 ? schema->slotOf(id) : -1;
+            if (slot >= 0) {
+                name = schema->fields().at(slot).name;
+            }
+        }
+        // 来自外部数据的键名不驻留，随负载一起回收
+        params.setValue(name, value, false);
+    }
+    if (!reader.finish()) {
+        return false;
+    }
+    
+    // 旧录制中缺少的字段补上模式默认值
+    if (schema) {
+        for (const EventSchema::Field& field : schema->fields()) {
+            if (field.defaultValue.isValid() && !params.contains(field.name)) {
+                params.setValue(field.name, field.defaultValue);
+            }
+        }
+    }
+    
+    // 全部读取成功后才替换当前内容
+    m_command = command.toString();
+    m_parameters.clear();
+    for (int i = 0; i < params.size(); ++i) {
+        m_parameters.setValue(params.nameAt(i), params.valueAt(i), false);
+    }
+    m_timestamp = reader.timestamp();
+    m_wire = EventWireView();
+    m_schemaView = EventSchemaView();
+    m_pending = false;
+    return true;
+}
+
 QString CommandEvent::description() const
 {
     return QString("CommandEvent: command='%1', params=%2")
            .arg(m_command)
-           .arg(m_parameters.size());
+           .arg(parameterCount());
 }
 
 QString CommandEvent::command() const
@@ -151,40 +490,203 @@ QString CommandEvent::command() const
 
 void CommandEvent::setCommand(const QString& command)
 {
+    materialize();
     m_command = command;
+    m_wire = EventWireView();
 }
 
 QVariantMap CommandEvent::parameters() const
 {
-    return m_parameters;
+    materialize();
+    
+    QVariantMap result;
+    for (int i = 0; i < m_parameters.size(); ++i) {
+        result.insert(m_parameters.nameAt(i).toString(), m_parameters.valueAt(i));
+    }
+    return result;
 }
 
 void CommandEvent::setParameters(const QVariantMap& params)
 {
-    m_parameters = params;
+    m_parameters.clear();
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        m_parameters.setValue(it.key(), it.value());
+    }
+    m_wire = EventWireView();
+    m_schemaView = EventSchemaView();
+    m_pending = false;
 }
 
 void CommandEvent::setParameter(const QString& key, const QVariant& value)
 {
-    m_parameters[key] = value;
+    materialize();
+    m_parameters.setValue(key, value);
+    m_wire = EventWireView();
 }
 
 QVariant CommandEvent::parameter(const QString& key, const QVariant& defaultValue) const
 {
-    return m_parameters.value(key, defaultValue);
+    if (m_pending) {
+        return pendingParameter(key, defaultValue);
+    }
+    return m_parameters.contains(key) ? m_parameters.value(key) : defaultValue;
 }
 
 bool CommandEvent::hasParameter(const QString& key) const
 {
+    if (m_pending) {
+        return hasPendingParameter(key);
+    }
     return m_parameters.contains(key);
 }
 
 void CommandEvent::removeParameter(const QString& key)
 {
-    m_parameters.remove(key);
+    materialize();
+    if (m_parameters.remove(key)) {
+        m_wire = EventWireView();
+    }
+}
+
+void CommandEvent::setParameter(int key, const QVariant& value)
+{
+    materialize();
+    m_parameters.setValue(key, value);
+    m_wire = EventWireView();
+}
+
+QVariant CommandEvent::parameter(int key, const QVariant& defaultValue) const
+{
+    if (m_pending) {
+        return pendingParameter(EventPayload::keyView(key), defaultValue);
+    }
+    return m_parameters.contains(key) ? m_parameters.value(key) : defaultValue;
+}
+
+bool CommandEvent::hasParameter(int key) const
+{
+    if (m_pending) {
+        return hasPendingParameter(EventPayload::keyView(key));
+    }
+    return m_parameters.contains(key);
+}
+
+void CommandEvent::removeParameter(int key)
+{
+    materialize();
+    if (m_parameters.remove(key)) {
+        m_wire = EventWireView();
+    }
+}
+
+int CommandEvent::parameterCount() const
+{
+    return m_pending ? m_wire.fieldCount() - 1 + schemaDefaultCount() : m_parameters.size();
 }
 
 bool CommandEvent::isValid() const
 {
     return !m_command.isEmpty();
-}
\ No newline at end of file
+}
+
+void CommandEvent::addFields(EventWireWriter& writer) const
+{
+    const int count = m_parameters.size();
+    writer.reserve(count + 1);
+    
+    // 第0个字段是命令，其后按写入顺序排列参数
+    writer.addString(QStringView(), m_command);
+    for (int i = 0; i < count; ++i) {
+        writer.addVariant(m_parameters.nameAt(i), m_parameters.valueAt(i));
+    }
+    
+    if (const auto schema = EventSchema::find(CommandEventType)) {
+        writer.setSchemaVersion(schema->version());
+        for (int i = 0; i < count; ++i) {
+            writer.setFieldId(i + 1, schema->idOf(m_parameters.nameAt(i)));
+        }
+    }
+}
+
+int CommandEvent::wireIndexOf(QStringView key) const
+{
+    // 模式认识的参数按字段ID查找，旧名称写入的参数也能找到
+    if (m_schemaView.isValid()) {
+        const quint16 id = m_schemaView.schema()->idOf(key);
+        if (id != 0) {
+            return m_schemaView.indexOf(id);
+        }
+    }
+    return m_wire.indexOf(key, 1);
+}
+
+QVariant CommandEvent::schemaDefault(QStringView key) const
+{
+    // 只有事件中确实缺少该字段时才使用默认值
+    if (!m_schemaView.isValid()) {
+        return QVariant();
+    }
+    const EventSchema* schema = m_schemaView.schema();
+    const quint16 id = schema->idOf(key);
+    if (id == 0 || m_schemaView.contains(id)) {
+        return QVariant();
+    }
+    return schema->fields().at(schema->slotOf(id)).defaultValue;
+}
+
+int CommandEvent::schemaDefaultCount() const
+{
+    if (!m_schemaView.isValid()) {
+        return 0;
+    }
+    int count = 0;
+    for (const EventSchema::Field& field : m_schemaView.schema()->fields()) {
+        if (field.defaultValue.isValid() && !m_schemaView.contains(field.id)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+QVariant CommandEvent::pendingParameter(QStringView key, const QVariant& defaultValue) const
+{
+    const int index = wireIndexOf(key);
+    if (index >= 0) {
+        return m_wire.value(index);
+    }
+    const QVariant fallback = schemaDefault(key);
+    return fallback.isValid() ? fallback : defaultValue;
+}
+
+bool CommandEvent::hasPendingParameter(QStringView key) const
+{
+    return wireIndexOf(key) >= 0 || schemaDefault(key).isValid();
+}
+
+void CommandEvent::materialize() const
+{
+    if (!m_pending) {
+        return;
+    }
+    m_pending = false;
+    
+    // 有模式时按当前名称保存参数；模式中的名称数量有限，可以驻留，
+    // 其余录制中的键名不驻留，避免驻留表无限增长
+    for (int i = 1; i < m_wire.fieldCount(); ++i) {
+        if (m_schemaView.fieldIdAt(i) != 0) {
+            m_parameters.setValue(m_schemaView.fieldName(i), m_wire.value(i));
+        } else {
+            m_parameters.setValue(m_wire.fieldName(i), m_wire.value(i), false);
+        }
+    }
+    
+    // 旧录制中缺少的字段补上模式默认值
+    if (m_schemaView.isValid()) {
+        for (const EventSchema::Field& field : m_schemaView.schema()->fields()) {
+            if (field.defaultValue.isValid() && !m_schemaView.contains(field.id)) {
+                m_parameters.setValue(field.name, field.defaultValue);
+            }
+        }
+    }
+    m_schemaView = EventSchemaView();
+}
@@ -7,6 +7,11 @@
 #include <QString>
 #include <QDataStream>
 #include <QByteArray>
+#include <QIODevice>
+#include "event_payload.h"
+#include "event_pool.h"
+#include "event_schema.h"
+#include "event_wire_format.h"
 
 // 自定义事件类型枚举
 enum CustomEventType {
@@ -33,6 +38,30 @@ public:
     virtual QByteArray serialize() const = 0;
     virtual bool deserialize(const QByteArray& data) = 0;
     
+    /**
+     * @brief 流式序列化：把与serialize()相同的字节流分块写入设备
+     *
+     * 默认实现先serialize()再整体写入；DataEvent和CommandEvent直接从
+     * 字段分块写出，不在内存中生成完整缓冲区，适合录制/日志落盘大事件。
+     */
+    virtual bool writeTo(QIODevice* device) const;
+    
+    /**
+     * @brief 流式反序列化：从设备读取一个事件，设备停在该事件之后
+     *
+     * 默认实现读出整个事件后调用deserialize()；DataEvent和CommandEvent
+     * 逐字段读入，不保留中间缓冲区。
+     */
+    virtual bool readFrom(QIODevice* device);
+    
+    /**
+     * @brief 按该事件类型的 EventCompression 策略压缩serialize()的结果
+     *
+     * 策略不压缩或压缩后不更小时与serialize()相同；deserialize()和
+     * readFrom()自动识别压缩信封，录制/回放两端无需区分。
+     */
+    QByteArray serializeCompressed() const;
+    
     // 事件描述
     virtual QString description() const = 0;
     
@@ -46,9 +75,17 @@ protected:
 /**
  * @brief 数据传递事件
  * 
- * 支持QVariant数据的传递和获取，适用于各种数据类型的传输
+ * 支持QVariant数据的传递和获取，适用于各种数据类型的传输。
+ * 通过 PoolAllocated 从 DataEvent 专用的存储池分配，Qt分派后的delete会归还池中。
+ *
+ * serialize()输出 EventWire 线格式：QVariantMap按键展开为字段，其余值为
+ * 单个无名字段。deserialize()只保留缓冲区，首次调用data()时才解码；
+ * 未修改过的事件再次serialize()直接返回原缓冲区。
+ *
+ * 序列化结果、序列化长度和description()都缓存在事件上，setData()和
+ * deserialize()使其失效；description()只估算长度，不会触发编码。
  */
-class DataEvent : public BaseCustomEvent
+class DataEvent : public BaseCustomEvent, public PoolAllocated<DataEvent>
 {
 public:
     explicit DataEvent(const QVariant& data = QVariant());
@@ -60,22 +97,85 @@ public:
     QByteArray serialize() const override;
     bool deserialize(const QByteArray& data) override;
     
+    bool writeTo(QIODevice* device) const override;
+    bool readFrom(QIODevice* device) override;
+    
     QString description() const override;
     
+    /**
+     * @brief serialize()结果的字节数，按字段逐个估算而不实际编码
+     */
+    virtual qsizetype serializedSize() const;
+    
     // 数据类型检查
     bool isValid() const;
     QString dataTypeName() const;
     
+    /**
+     * @brief 反序列化得到的线格式视图，可原位读取字段而不构造QVariant
+     *
+     * 事件不是由deserialize()得到或之后被修改过时返回无效视图。
+     */
+    const EventWireView& wireView() const { return m_wire; }
+    
+    /**
+     * @brief TypedDataEvent<T> 携带的负载类型，普通DataEvent返回无效QMetaType
+     */
+    QMetaType payloadType() const { return m_payloadType; }
+    
+protected:
+    /**
+     * @brief 供派生类使用：负载由派生类保存，需要QVariant时才调用boxPayload()
+     *
+     * payloadType只应由 TypedDataEvent<T> 设置为T，其他派生类传入无效QMetaType。
+     */
+    explicit DataEvent(QMetaType payloadType);
+    
+    virtual QVariant boxPayload() const { return QVariant(); }
+    
+    /**
+     * @brief 派生类修改了负载：丢弃已装箱的值和序列化缓存
+     */
+    void payloadChanged();
+    
 private:
-    QVariant m_data;
+    void materialize() const;
+    void addFields(EventWireWriter& writer) const;
+    void invalidateCaches();
+    
+    mutable QVariant m_data;
+    mutable EventWireView m_wire;
+    mutable bool m_pending;     // m_data尚未从m_wire解码
+    mutable bool m_unboxed;     // m_data尚未由boxPayload()生成
+    QMetaType m_payloadType;
+    
+    // 由setData()/deserialize()失效的缓存
+    mutable QByteArray m_serialized;
+    mutable qsizetype m_serializedSize;     // -1表示尚未计算
+    mutable QString m_description;
 };
 
 /**
  * @brief 命令事件
  * 
- * 支持命令和参数的封装传递，适用于命令模式的事件通信
+ * 支持命令和参数的封装传递，适用于命令模式的事件通信。
+ * 通过 PoolAllocated 从 CommandEvent 专用的存储池分配。
+ *
+ * 参数保存在 EventPayload 中：键名驻留为整数ID，少量参数放在对象内的
+ * 扁平数组里，查找是对整数键的短线性扫描；参数多于内联容量时再扩展到
+ * 竞技场内存。热点路径可先用 EventPayload::internKey 取得键ID，再调用
+ * 整数键重载，省去每次的键名查表。反序列化得到的参数名不驻留，
+ * 读取参数不会访问驻留表的锁。
+ *
+ * 线格式中第0个字段是命令，其后每个参数一个字段。deserialize()只解码
+ * 命令，parameter()/hasParameter()直接在缓冲区上按名称查找单个字段，
+ * 需要整个参数表或修改参数时才解码全部参数。
+ *
+ * 为CommandEventType登记 EventSchema 后，序列化时为参数写入字段ID；
+ * 反序列化的事件按ID查找参数，旧录制中改过名的参数以当前名称读出，
+ * 缺少的字段按模式中的默认值（有效时）视为存在。
  */
-class CommandEvent : public BaseCustomEvent
+class CommandEvent : public BaseCustomEvent, public PoolAllocated<CommandEvent>
 {
 public:
     explicit CommandEvent(const QString& command = QString(), 
@@ -88,6 +188,9 @@ public:
     QByteArray serialize() const override;
     bool deserialize(const QByteArray& data) override;
     
+    bool writeTo(QIODevice* device) const override;
+    bool readFrom(QIODevice* device) override;
+    
     QString description() const override;
     
     // 命令相关接口
@@ -103,12 +206,50 @@ public:
     bool hasParameter(const QString& key) const;
     void removeParameter(const QString& key);
     
+    // 以驻留键ID访问参数
+    void setParameter(int key, const QVariant& value);
+    QVariant parameter(int key, const QVariant& defaultValue = QVariant()) const;
+    bool hasParameter(int key) const;
+    void removeParameter(int key);
+    
+    int parameterCount() const;
+    
+    /**
+     * @brief serialize()结果的字节数，不实际编码
+     */
+    qsizetype serializedSize() const;
+    
     // 验证
     bool isValid() const;
     
+    /**
+     * @brief 反序列化得到的线格式视图，参数字段从下标1开始
+     *
+     * 事件不是由deserialize()得到或之后被修改过时返回无效视图。
+     */
+    const EventWireView& wireView() const { return m_wire; }
+    
+    /**
+     * @brief 按登记的模式解读的参数视图，可按字段ID读取参数
+     *
+     * 只在反序列化后、参数尚未解码时有效；没有登记模式时返回无效视图。
+     */
+    const EventSchemaView& schemaView() const { return m_schemaView; }
+    
 private:
+    void materialize() const;
+    void addFields(EventWireWriter& writer) const;
+    int wireIndexOf(QStringView key) const;
+    QVariant schemaDefault(QStringView key) const;
+    int schemaDefaultCount() const;
+    QVariant pendingParameter(QStringView key, const QVariant& defaultValue) const;
+    bool hasPendingParameter(QStringView key) const;
+    
     QString m_command;
-    QVariantMap m_parameters;
+    mutable EventPayload m_parameters;
+    mutable EventWireView m_wire;
+    mutable EventSchemaView m_schemaView;
+    mutable bool m_pending;     // m_parameters尚未从m_wire解码
 };
 
 #endif // CUSTOM_EVENTS_H
\ No newline at end of file
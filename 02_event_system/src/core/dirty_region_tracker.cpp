@@ -0,0 +1,253 @@
+#include "dirty_region_tracker.h"
+#include <QVarLengthArray>
+
+DirtyRegionTracker::DirtyRegionTracker(const QSize& area, int tileSize)
+    : m_tileSize(qMax(1, tileSize))
+    , m_columns(0)
+    , m_rows(0)
+    , m_maxRects(8)
+    , m_perRectCost(static_cast<qint64>(m_tileSize) * m_tileSize)
+    , m_dirtyTiles(0)
+{
+    setArea(area);
+}
+
+void DirtyRegionTracker::setArea(const QSize& area)
+{
+    const bool wasDirty = isDirty();
+
+    m_area = area.isValid() ? area : QSize(0, 0);
+    m_columns = (m_area.width() + m_tileSize - 1) / m_tileSize;
+    m_rows = (m_area.height() + m_tileSize - 1) / m_tileSize;
+    m_tiles.fill(0, m_columns * m_rows);
+    m_dirtyTiles = 0;
+
+    // 旧网格上的脏瓦片无法映射到新网格，保守地整体重绘
+    if (wasDirty) {
+        markAllDirty();
+    }
+}
+
+void DirtyRegionTracker::setTileSize(int tileSize)
+{
+    tileSize = qMax(1, tileSize);
+    if (tileSize == m_tileSize) return;
+
+    m_tileSize = tileSize;
+    setArea(m_area);
+}
+
+void DirtyRegionTracker::setMaxRects(int maxRects)
+{
+    m_maxRects = qMax(1, maxRects);
+}
+
+void DirtyRegionTracker::setPerRectCost(qint64 pixels)
+{
+    m_perRectCost = qMax<qint64>(0, pixels);
+}
+
+void DirtyRegionTracker::markDirty(const QRect& rect)
+{
+    const QRect clipped = rect.normalized() & QRect(QPoint(0, 0), m_area);
+    if (clipped.isEmpty()) return;
+
+    m_metrics.requests++;
+    m_metrics.requestedPixels += areaOf(clipped);
+
+    const int left = clipped.left() / m_tileSize;
+    const int right = clipped.right() / m_tileSize;
+    const int top = clipped.top() / m_tileSize;
+    const int bottom = clipped.bottom() / m_tileSize;
+    for (int row = top; row <= bottom; ++row) {
+        quint8* tile = m_tiles.data() + row * m_columns + left;
+        for (int column = left; column <= right; ++column, ++tile) {
+            if (!*tile) {
+                *tile = 1;
+                m_dirtyTiles++;
+            }
+        }
+    }
+}
+
+void DirtyRegionTracker::markDirty(const QRegion& region)
+{
+    for (const QRect& rect : region) {
+        markDirty(rect);
+    }
+}
+
+void DirtyRegionTracker::markAllDirty()
+{
+    markDirty(QRect(QPoint(0, 0), m_area));
+}
+
+QRegion DirtyRegionTracker::region() const
+{
+    return buildRegion(nullptr, nullptr);
+}
+
+QRegion DirtyRegionTracker::takeRegion()
+{
+    if (!isDirty()) {
+        return QRegion();
+    }
+
+    bool boundingBox = false;
+    int rectCount = 0;
+    QRegion result = buildRegion(&boundingBox, &rectCount);
+
+    m_metrics.flushes++;
+    m_metrics.rectsEmitted += rectCount;
+    if (boundingBox) {
+        m_metrics.boundingBoxFlushes++;
+    }
+    for (const QRect& rect : result) {
+        m_metrics.repaintedPixels += areaOf(rect);
+    }
+
+    clear();
+    return result;
+}
+
+void DirtyRegionTracker::clear()
+{
+    if (m_dirtyTiles > 0) {
+        m_tiles.fill(0);
+        m_dirtyTiles = 0;
+    }
+}
+
+QRegion DirtyRegionTracker::buildRegion(bool* boundingBox, int* rectCount) const
+{
+    if (!isDirty()) {
+        return QRegion();
+    }
+
+    const QList<QRect> rects = mergeToLimit(tileRects());
+
+    // 合并出的外接框可能互相重叠，QRegion求并集时会按横向条带重新拆分，
+    // 代价和上限都按并集后实际输出的矩形计算
+    QRect bounds;
+    QRegion merged;
+    for (const QRect& rect : rects) {
+        const QRect pixels = toPixels(rect);
+        bounds |= pixels;
+        merged += pixels;
+    }
+
+    // 估算两种方案的重绘代价：面积之和加上每个矩形的固定开销
+    qint64 rectsCost = 0;
+    for (const QRect& rect : merged) {
+        rectsCost += areaOf(rect) + m_perRectCost;
+    }
+    const qint64 boundsCost = areaOf(bounds) + m_perRectCost;
+
+    const int mergedCount = merged.rectCount();
+    const bool useBounds = mergedCount > 1 && (mergedCount > m_maxRects || boundsCost <= rectsCost);
+    const QRegion result = useBounds ? QRegion(bounds) : merged;
+    if (boundingBox) *boundingBox = useBounds;
+    if (rectCount) *rectCount = result.rectCount();
+    return result;
+}
+
+QList<QRect> DirtyRegionTracker::tileRects() const
+{
+    // 逐行提取连续脏瓦片段，与上一行左右边界相同的段纵向合并
+    QList<QRect> finished;
+    QList<QRect> open;
+
+    for (int row = 0; row < m_rows; ++row) {
+        const quint8* tiles = m_tiles.constData() + row * m_columns;
+        QList<QRect> extended;
+
+        int column = 0;
+        while (column < m_columns) {
+            if (!tiles[column]) {
+                ++column;
+                continue;
+            }
+            const int start = column;
+            while (column < m_columns && tiles[column]) {
+                ++column;
+            }
+
+            QRect span(start, row, column - start, 1);
+            for (int i = 0; i < open.size(); ++i) {
+                if (open[i].left() == span.left() && open[i].right() == span.right()) {
+                    span.setTop(open[i].top());
+                    open.removeAt(i);
+                    break;
+                }
+            }
+            extended.append(span);
+        }
+
+        finished.append(open);
+        open = extended;
+    }
+
+    finished.append(open);
+    return finished;
+}
+
+QList<QRect> DirtyRegionTracker::mergeToLimit(QList<QRect> rects) const
+{
+    if (rects.size() > MaxGreedyRects) {
+        return mergeIntoBands(rects);
+    }
+
+    // 贪心合并：每次选外接框新增面积最小的一对
+    while (rects.size() > m_maxRects) {
+        int bestFirst = 0;
+        int bestSecond = 1;
+        qint64 bestWaste = -1;
+        for (int i = 0; i < rects.size(); ++i) {
+            for (int j = i + 1; j < rects.size(); ++j) {
+                const qint64 waste = areaOf(rects[i] | rects[j]) - areaOf(rects[i]) - areaOf(rects[j]);
+                if (bestWaste < 0 || waste < bestWaste) {
+                    bestWaste = waste;
+                    bestFirst = i;
+                    bestSecond = j;
+                }
+            }
+        }
+
+        const QRect merged = rects[bestFirst] | rects[bestSecond];
+        rects.removeAt(bestSecond);
+        rects.removeAt(bestFirst);
+        rects.removeIf([&merged](const QRect& rect) { return merged.contains(rect); });
+        rects.append(merged);
+    }
+    return rects;
+}
+
+QList<QRect> DirtyRegionTracker::mergeIntoBands(const QList<QRect>& rects) const
+{
+    // 把网格按行等分为不超过m_maxRects个条带，每个矩形并入其顶边所在条带的外接框
+    const int bandRows = (m_rows + m_maxRects - 1) / m_maxRects;
+    QVarLengthArray<QRect, 32> bands(qMin(m_maxRects, (m_rows + bandRows - 1) / bandRows));
+    for (const QRect& rect : rects) {
+        bands[rect.top() / bandRows] |= rect;
+    }
+
+    QList<QRect> merged;
+    for (const QRect& band : bands) {
+        if (!band.isNull()) {
+            merged.append(band);
+        }
+    }
+    return merged;
+}
+
+QRect DirtyRegionTracker::toPixels(const QRect& tiles) const
+{
+    return QRect(tiles.left() * m_tileSize, tiles.top() * m_tileSize,
+                 tiles.width() * m_tileSize, tiles.height() * m_tileSize)
+           & QRect(QPoint(0, 0), m_area);
+}
+
+qint64 DirtyRegionTracker::areaOf(const QRect& rect)
+{
+    return rect.isEmpty() ? 0 : static_cast<qint64>(rect.width()) * rect.height();
+}
@@ -0,0 +1,120 @@
+#ifndef DIRTY_REGION_TRACKER_H
+#define DIRTY_REGION_TRACKER_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QRect>
+#include <QRegion>
+#include <QSize>
+#include <QVector>
+
+/**
+ * @brief DirtyRegionTracker 基于瓦片网格的脏区域跟踪器
+ *
+ * 把更新请求对齐到固定大小的瓦片上记录，取出时先按行合并连续脏瓦片、
+ * 再纵向合并跨度相同的行段，得到少量矩形；矩形数超过上限时反复合并
+ * 外接框增加面积最小的一对。贪心合并是O(n³)，矩形多于 MaxGreedyRects
+ * 时改为一遍扫描，按矩形顶边所在的横向条带各取外接框。最后按估算像素
+ * 代价（面积加每个矩形的固定开销）在"外接框整块重绘"和"多矩形重绘"
+ * 之间取较便宜者；合并后的矩形求并集时若仍多于上限，同样退回外接框。
+ * 结果直接交给QWidget::update(QRegion)。
+ *
+ * 与逐个QRect求并集相比，高频小块更新（如连续绘制的笔画）不会让区域
+ * 碎成大量小矩形，也不会退化成整窗重绘。
+ */
+class DirtyRegionTracker
+{
+public:
+    static constexpr int MaxGreedyRects = 64;   // 超过此数不再逐对贪心合并
+
+    /**
+     * @brief 跟踪统计
+     */
+    struct Metrics {
+        quint64 requests;           // markDirty调用次数
+        quint64 flushes;            // 取出非空区域的次数
+        quint64 boundingBoxFlushes; // 选择外接框重绘的次数
+        quint64 rectsEmitted;       // 累计输出的矩形数（按输出区域的rectCount()计）
+        qint64 requestedPixels;     // 请求矩形面积之和（重叠部分重复计）
+        qint64 repaintedPixels;     // 实际输出区域面积之和
+
+        Metrics()
+            : requests(0), flushes(0), boundingBoxFlushes(0), rectsEmitted(0)
+            , requestedPixels(0), repaintedPixels(0) {}
+    };
+
+    /**
+     * @brief 构造函数
+     * @param area 被跟踪区域大小（通常为控件大小）
+     * @param tileSize 瓦片边长（像素）
+     */
+    explicit DirtyRegionTracker(const QSize& area = QSize(), int tileSize = 32);
+
+    /**
+     * @brief 设置被跟踪区域，网格按新大小重建，已有脏区域整体作废并标记全部重绘
+     */
+    void setArea(const QSize& area);
+    QSize area() const { return m_area; }
+
+    void setTileSize(int tileSize);
+    int tileSize() const { return m_tileSize; }
+
+    /**
+     * @brief 输出矩形数上限
+     */
+    void setMaxRects(int maxRects);
+    int maxRects() const { return m_maxRects; }
+
+    /**
+     * @brief 每个矩形的固定重绘开销（折算为像素数），用于多矩形与外接框的取舍
+     */
+    void setPerRectCost(qint64 pixels);
+    qint64 perRectCost() const { return m_perRectCost; }
+
+    /**
+     * @brief 标记脏区域，超出跟踪区域的部分被裁掉
+     */
+    void markDirty(const QRect& rect);
+    void markDirty(const QRegion& region);
+    void markAllDirty();
+
+    bool isDirty() const { return m_dirtyTiles > 0; }
+
+    /**
+     * @brief 计算当前脏区域但不清空
+     */
+    QRegion region() const;
+
+    /**
+     * @brief 取出当前脏区域并清空
+     */
+    QRegion takeRegion();
+
+    void clear();
+
+    Metrics metrics() const { return m_metrics; }
+    void resetMetrics() { m_metrics = Metrics(); }
+
+private:
+    friend class TestDirtyRegionTracker;
+
+    QRegion buildRegion(bool* boundingBox, int* rectCount) const;
+    QList<QRect> tileRects() const;
+    QList<QRect> mergeToLimit(QList<QRect> rects) const;
+    QList<QRect> mergeIntoBands(const QList<QRect>& rects) const;
+    QRect toPixels(const QRect& tiles) const;
+    static qint64 areaOf(const QRect& rect);
+
+    QSize m_area;
+    int m_tileSize;
+    int m_columns;
+    int m_rows;
+    int m_maxRects;
+    qint64 m_perRectCost;
+
+    QVector<quint8> m_tiles;
+    int m_dirtyTiles;
+    Metrics m_metrics;
+};
+
+#endif // DIRTY_REGION_TRACKER_H
@@ -0,0 +1,366 @@
+#include "event_coalescer.h"
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QScreen>
+#include <QSharedPointer>
+
+namespace {
+
+// 屏幕刷新率未知时按60Hz计算帧间隔
+const qreal DefaultRefreshRate = 60.0;
+
+QVariant sumValues(const QVariant& total, const QVariant& value)
+{
+    if (!total.isValid()) {
+        return value;
+    }
+
+    switch (value.metaType().id()) {
+    case QMetaType::QPoint:
+        return total.toPoint() + value.toPoint();
+    case QMetaType::QPointF:
+        return total.toPointF() + value.toPointF();
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+        return total.toLongLong() + value.toLongLong();
+    default:
+        return total.toDouble() + value.toDouble();
+    }
+}
+
+QRegion toRegion(const QVariant& value)
+{
+    switch (value.metaType().id()) {
+    case QMetaType::QRect:
+        return QRegion(value.toRect());
+    case QMetaType::QRectF:
+        return QRegion(value.toRectF().toAlignedRect());
+    case QMetaType::QRegion:
+        return value.value<QRegion>();
+    default:
+        return QRegion();
+    }
+}
+
+} // namespace
+
+EventCoalescer::EventCoalescer(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_flushPolicy(FlushOnFrame)
+    , m_intervalMs(50)
+    , m_enabled(true)
+    , m_mouseMoveChannel(-1)
+    , m_replaying(false)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &EventCoalescer::flush);
+    m_clock.start();
+}
+
+EventCoalescer::~EventCoalescer()
+{
+    // 通常作为被安装控件的子对象析构，此时控件已在销毁中，不再重放积压事件；
+    // 事件过滤器随本对象销毁由Qt自动移除
+}
+
+int EventCoalescer::addChannel(const QString& name, MergeStrategy strategy, Handler handler)
+{
+    Channel channel;
+    channel.name = name;
+    channel.strategy = strategy;
+    channel.handler = std::move(handler);
+    channel.pending = 0;
+    channel.firstPendingNs = 0;
+    m_channels.append(channel);
+    return m_channels.size() - 1;
+}
+
+QString EventCoalescer::channelName(int channel) const
+{
+    return isValidChannel(channel) ? m_channels.at(channel).name : QString();
+}
+
+void EventCoalescer::submit(int channel, const QVariant& value)
+{
+    if (!isValidChannel(channel)) return;
+
+    Channel& target = m_channels[channel];
+    if (target.pending == 0) {
+        target.firstPendingNs = m_clock.nsecsElapsed();
+    }
+    merge(target, value);
+    target.pending++;
+    target.metrics.submitted++;
+
+    if (m_enabled) {
+        scheduleFlush();
+    } else {
+        deliverPending(channel, false);
+    }
+}
+
+void EventCoalescer::submit(int channel, const QString& key, const QVariant& value)
+{
+    QVariantMap entry;
+    entry.insert(key, value);
+    submit(channel, entry);
+}
+
+int EventCoalescer::pendingCount(int channel) const
+{
+    return isValidChannel(channel) ? m_channels.at(channel).pending : 0;
+}
+
+void EventCoalescer::flush()
+{
+    m_timer->stop();
+    for (int i = 0; i < m_channels.size(); ++i) {
+        deliverPending(i, true);
+    }
+}
+
+void EventCoalescer::flushChannel(int channel)
+{
+    if (!isValidChannel(channel)) return;
+    deliverPending(channel, true);
+}
+
+void EventCoalescer::setFlushPolicy(FlushPolicy policy)
+{
+    m_flushPolicy = policy;
+    m_timer->setTimerType(policy == FlushOnFrame ? Qt::PreciseTimer : Qt::CoarseTimer);
+}
+
+void EventCoalescer::setInterval(int intervalMs)
+{
+    m_intervalMs = qMax(0, intervalMs);
+}
+
+int EventCoalescer::effectiveInterval() const
+{
+    if (m_flushPolicy == FlushOnInterval) {
+        return m_intervalMs;
+    }
+
+    QScreen* screen = m_widget ? m_widget->screen() : QGuiApplication::primaryScreen();
+    qreal refreshRate = screen ? screen->refreshRate() : DefaultRefreshRate;
+    if (refreshRate <= 0.0) {
+        refreshRate = DefaultRefreshRate;
+    }
+    return qMax(1, qRound(1000.0 / refreshRate));
+}
+
+void EventCoalescer::setEnabled(bool enabled)
+{
+    if (!enabled) {
+        flush();
+    }
+    m_enabled = enabled;
+}
+
+void EventCoalescer::install(QWidget* widget)
+{
+    uninstall();
+    if (!widget) return;
+
+    if (m_mouseMoveChannel < 0) {
+        m_mouseMoveChannel = addChannel("mouseMove", LatestWins,
+            [this](const QVariant& merged, int) { replayEvent(merged); });
+    }
+
+    m_widget = widget;
+    m_widget->installEventFilter(this);
+}
+
+void EventCoalescer::uninstall()
+{
+    if (!m_widget) return;
+
+    flushChannel(m_mouseMoveChannel);
+    m_widget->removeEventFilter(this);
+    m_widget = nullptr;
+}
+
+void EventCoalescer::setInstalled(QWidget* widget, bool installed)
+{
+    if (installed) {
+        if (m_widget != widget) {
+            install(widget);
+        }
+    } else if (isInstalledOn(widget)) {
+        uninstall();
+    }
+}
+
+EventCoalescer::Metrics EventCoalescer::metrics() const
+{
+    Metrics total;
+    for (const Channel& channel : m_channels) {
+        total.submitted += channel.metrics.submitted;
+        total.delivered += channel.metrics.delivered;
+        total.flushes += channel.metrics.flushes;
+        total.deliveries += channel.metrics.deliveries;
+        total.handlerNs += channel.metrics.handlerNs;
+        total.latencyNs += channel.metrics.latencyNs;
+    }
+    return total;
+}
+
+EventCoalescer::Metrics EventCoalescer::channelMetrics(int channel) const
+{
+    return isValidChannel(channel) ? m_channels.at(channel).metrics : Metrics();
+}
+
+void EventCoalescer::resetMetrics()
+{
+    for (Channel& channel : m_channels) {
+        channel.metrics = Metrics();
+    }
+}
+
+bool EventCoalescer::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched != m_widget || m_replaying) {
+        return QObject::eventFilter(watched, event);
+    }
+
+    switch (event->type()) {
+    case QEvent::MouseMove:
+        if (m_enabled) {
+            // 拷贝一份事件，原事件到此为止，刷新时只重放最新的一份
+            submit(m_mouseMoveChannel, QVariant::fromValue(QSharedPointer<QEvent>(event->clone())));
+            return true;
+        }
+        break;
+
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::Leave:
+    case QEvent::Hide:
+        // 其他输入到达前先交付积压的移动，保持输入顺序
+        flushChannel(m_mouseMoveChannel);
+        break;
+
+    case QEvent::Paint:
+    case QEvent::UpdateRequest:
+        if (m_flushPolicy == FlushOnFrame) {
+            flushChannel(m_mouseMoveChannel);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+bool EventCoalescer::isValidChannel(int channel) const
+{
+    return channel >= 0 && channel < m_channels.size();
+}
+
+void EventCoalescer::merge(Channel& channel, const QVariant& value)
+{
+    switch (channel.strategy) {
+    case LatestWins:
+        channel.value = value;
+        break;
+    case RegionUnion:
+        channel.region += toRegion(value);
+        break;
+    case KeyWiseLastWriter: {
+        const QVariantMap entries = value.toMap();
+        for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+            channel.entries.insert(it.key(), it.value());
+        }
+        break;
+    }
+    case Sum:
+        channel.value = sumValues(channel.value, value);
+        break;
+    }
+}
+
+void EventCoalescer::deliverPending(int channel, bool batched)
+{
+    Channel& source = m_channels[channel];
+    if (source.pending == 0) {
+        return;
+    }
+
+    // 先取出待交付数据再调用处理函数，处理函数中的新提交进入下一批
+    const int sourceCount = source.pending;
+    int deliveredCount = 1;
+    QVariant merged;
+    switch (source.strategy) {
+    case RegionUnion:
+        merged = QVariant::fromValue(source.region);
+        source.region = QRegion();
+        break;
+    case KeyWiseLastWriter:
+        deliveredCount = source.entries.size();
+        merged = source.entries;
+        source.entries.clear();
+        break;
+    case LatestWins:
+    case Sum:
+        merged = source.value;
+        source.value = QVariant();
+        break;
+    }
+
+    const qint64 startNs = m_clock.nsecsElapsed();
+    source.pending = 0;
+    source.metrics.delivered += deliveredCount;
+    source.metrics.deliveries++;
+    source.metrics.latencyNs += startNs - source.firstPendingNs;
+    if (batched) {
+        source.metrics.flushes++;
+    }
+
+    // 处理函数可能添加通道导致m_channels重新分配，这里拷贝一份
+    const Handler handler = source.handler;
+    if (handler) {
+        handler(merged, sourceCount);
+        m_channels[channel].metrics.handlerNs += m_clock.nsecsElapsed() - startNs;
+    }
+
+    if (batched) {
+        emit channelFlushed(channel, sourceCount, deliveredCount);
+    }
+}
+
+void EventCoalescer::scheduleFlush()
+{
+    if (!m_timer->isActive()) {
+        m_timer->start(effectiveInterval());
+    }
+}
+
+void EventCoalescer::replayEvent(const QVariant& merged)
+{
+    QSharedPointer<QEvent> event = merged.value<QSharedPointer<QEvent>>();
+    if (!event || !m_widget) return;
+
+    const bool replaying = m_replaying;
+    m_replaying = true;
+    QCoreApplication::sendEvent(m_widget, event.data());
+    m_replaying = replaying;
+}
@@ -0,0 +1,194 @@
+#ifndef EVENT_COALESCER_H
+#define EVENT_COALESCER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+#include <QRegion>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <QVariantMap>
+#include <QWidget>
+#include <functional>
+
+/**
+ * @brief EventCoalescer 通用事件合并器
+ *
+ * 把高频到达的同类事件先放进通道，按刷新策略统一合并后交付一次：
+ * - LatestWins        只保留最新值（鼠标位置、滑块值）
+ * - RegionUnion       合并QRect/QRegion为一个重绘区域
+ * - KeyWiseLastWriter 按键保留最新值，交付QVariantMap
+ * - Sum               累加数值或QPoint/QPointF（滚轮增量、计数）
+ *
+ * 刷新策略为定时（FlushOnInterval）或按帧（FlushOnFrame，间隔取屏幕
+ * 刷新率）。通过install()安装到控件后，会自动合并该控件的鼠标移动事件，
+ * 在按键、点击等其他输入到达前和控件绘制前先行刷新，保证事件顺序，
+ * 控件本身无需任何改动。
+ */
+class EventCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 合并策略
+     */
+    enum MergeStrategy {
+        LatestWins = 0,
+        RegionUnion,
+        KeyWiseLastWriter,
+        Sum
+    };
+    Q_ENUM(MergeStrategy)
+
+    /**
+     * @brief 刷新策略
+     */
+    enum FlushPolicy {
+        FlushOnInterval = 0,
+        FlushOnFrame
+    };
+    Q_ENUM(FlushPolicy)
+
+    /**
+     * @brief 合并统计
+     */
+    struct Metrics {
+        quint64 submitted;      // 提交的原始事件数
+        quint64 delivered;      // 合并后交付的事件数（按键合并时按唯一键计）
+        quint64 flushes;        // 批量刷新次数
+        quint64 deliveries;     // 交付次数，含关闭合并时的直接交付
+        qint64 handlerNs;       // 处理函数累计耗时（每次交付都计入）
+        qint64 latencyNs;       // 每次交付中最早事件从提交到交付的累计等待
+
+        Metrics() : submitted(0), delivered(0), flushes(0), deliveries(0), handlerNs(0), latencyNs(0) {}
+
+        // 被合并掉的事件占比
+        double compressionRatio() const
+        {
+            return submitted > 0 ? 1.0 - static_cast<double>(delivered) / submitted : 0.0;
+        }
+    };
+
+    /**
+     * @brief 通道处理函数
+     * @param merged 合并结果（RegionUnion为QRegion，KeyWiseLastWriter为QVariantMap）
+     * @param sourceCount 本次合并的原始事件数
+     */
+    using Handler = std::function<void(const QVariant& merged, int sourceCount)>;
+
+    explicit EventCoalescer(QObject* parent = nullptr);
+    ~EventCoalescer() override;
+
+    /**
+     * @brief 添加合并通道
+     * @return 通道号
+     */
+    int addChannel(const QString& name, MergeStrategy strategy, Handler handler);
+    QString channelName(int channel) const;
+    int channelCount() const { return m_channels.size(); }
+
+    /**
+     * @brief 提交一个事件值；KeyWiseLastWriter通道可直接提交QVariantMap
+     */
+    void submit(int channel, const QVariant& value);
+
+    /**
+     * @brief 向KeyWiseLastWriter通道提交一个键值
+     */
+    void submit(int channel, const QString& key, const QVariant& value);
+
+    int pendingCount(int channel) const;
+
+    /**
+     * @brief 立即交付所有通道的待合并事件
+     */
+    void flush();
+    void flushChannel(int channel);
+
+    void setFlushPolicy(FlushPolicy policy);
+    FlushPolicy flushPolicy() const { return m_flushPolicy; }
+
+    /**
+     * @brief FlushOnInterval策略下的合并窗口（毫秒），0表示在下一轮事件循环交付
+     */
+    void setInterval(int intervalMs);
+    int interval() const { return m_intervalMs; }
+
+    /**
+     * @brief 当前策略实际使用的刷新间隔（毫秒）
+     */
+    int effectiveInterval() const;
+
+    /**
+     * @brief 关闭后提交的事件立即交付；关闭时先刷新已有事件
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief 安装到控件，合并其鼠标移动事件
+     */
+    void install(QWidget* widget);
+    void uninstall();
+    QWidget* installedWidget() const { return m_widget; }
+
+    /**
+     * @brief 按开关安装到控件或从该控件卸载，供“合并输入”之类的选项直接调用
+     *
+     * 关闭时只在当前安装的正是该控件时才卸载，不影响安装在其他控件上的合并器。
+     */
+    void setInstalled(QWidget* widget, bool installed);
+    bool isInstalledOn(const QWidget* widget) const { return widget && m_widget == widget; }
+    int mouseMoveChannel() const { return m_mouseMoveChannel; }
+
+    Metrics metrics() const;
+    Metrics channelMetrics(int channel) const;
+    void resetMetrics();
+
+signals:
+    /**
+     * @brief 通道完成一次批量交付
+     * @param channel 通道号
+     * @param sourceCount 合并的原始事件数
+     * @param deliveredCount 交付的事件数
+     */
+    void channelFlushed(int channel, int sourceCount, int deliveredCount);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    struct Channel {
+        QString name;
+        MergeStrategy strategy;
+        Handler handler;
+        QVariant value;         // LatestWins / Sum
+        QRegion region;         // RegionUnion
+        QVariantMap entries;    // KeyWiseLastWriter
+        int pending;
+        qint64 firstPendingNs;  // 本批首个事件的提交时间
+        Metrics metrics;
+    };
+
+    bool isValidChannel(int channel) const;
+    void merge(Channel& channel, const QVariant& value);
+    void deliverPending(int channel, bool batched);
+    void scheduleFlush();
+    void replayEvent(const QVariant& merged);
+
+    QList<Channel> m_channels;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    FlushPolicy m_flushPolicy;
+    int m_intervalMs;
+    bool m_enabled;
+
+    QPointer<QWidget> m_widget;
+    int m_mouseMoveChannel;
+    bool m_replaying;
+};
+
+#endif // EVENT_COALESCER_H
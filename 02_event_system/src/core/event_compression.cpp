@@ -0,0 +1,436 @@
+#include "event_compression.h"
+#include "event_wire_format.h"
+#include <QDebug>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QSysInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// 全局策略与字典表
+QReadWriteLock g_compressionLock;
+QHash<int, EventCompression::Policy> g_policies;
+QHash<int, quint32> g_activeDictionaries;
+QHash<quint32, QByteArray> g_dictionaries;
+
+const quint16 HostByteOrderFlag = QSysInfo::ByteOrder == QSysInfo::BigEndian ? EventWire::BigEndian : 0;
+
+// Lz块格式参数
+const int HashBits = 13;
+const qsizetype MinMatch = 4;
+const qsizetype LastLiterals = 5;       // 块末尾至少保留的字面量字节
+const qsizetype MatchSearchEnd = 12;    // 距块末尾不足此长度时不再查找匹配
+const qsizetype MaxOffset = 65535;
+
+// 字典训练的片段长度与步长
+const qsizetype SegmentBytes = 16;
+const qsizetype SegmentStride = 8;
+
+inline quint32 read32(const char* data)
+{
+    quint32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline int hashOf(quint32 sequence)
+{
+    return int((sequence * 2654435761u) >> (32 - HashBits));
+}
+
+// FNV-1a，字典ID只用于识别内容，0保留为“未使用字典”
+quint32 contentId(const QByteArray& bytes)
+{
+    quint32 hash = 2166136261u;
+    for (char c : bytes) {
+        hash = (hash ^ quint8(c)) * 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+void writeLength(char*& out, qsizetype length)
+{
+    while (length >= 255) {
+        *out++ = char(255);
+        length -= 255;
+    }
+    *out++ = char(length);
+}
+
+/**
+ * @brief 写出一个序列：令牌、字面量、偏移和匹配长度
+ * @param matchLength 小于0时为块末尾只含字面量的序列
+ */
+void writeSequence(char*& out, const char* literals, qsizetype literalLength,
+                   qsizetype offset, qsizetype matchLength)
+{
+    char* token = out++;
+    *token = char(qMin<qsizetype>(literalLength, 15) << 4);
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    std::memcpy(out, literals, literalLength);
+    out += literalLength;
+
+    if (matchLength < 0) {
+        return;
+    }
+    *out++ = char(offset & 0xFF);
+    *out++ = char(offset >> 8);
+    const qsizetype code = matchLength - MinMatch;
+    *token = char(*token | qMin<qsizetype>(code, 15));
+    if (code >= 15) {
+        writeLength(out, code - 15);
+    }
+}
+
+/**
+ * @brief 压缩src[start, end)，src[0, start)为字典，匹配可以引用字典
+ */
+QByteArray lzCompress(const char* src, qsizetype start, qsizetype end)
+{
+    const qsizetype inputSize = end - start;
+    QByteArray result(inputSize + inputSize / 255 + 16, Qt::Uninitialized);
+    char* out = result.data();
+
+    int table[1 << HashBits];
+    std::fill(table, table + (1 << HashBits), -1);
+
+    // 字典中离输入最近的64 KiB窗口先入表
+    for (qsizetype p = qMax<qsizetype>(0, start - MaxOffset); p + MinMatch <= start; ++p) {
+        table[hashOf(read32(src + p))] = int(p);
+    }
+
+    const qsizetype matchLimit = end - LastLiterals;
+    const qsizetype searchLimit = end - MatchSearchEnd;
+    qsizetype anchor = start;
+    qsizetype p = start;
+    while (p < searchLimit) {
+        const quint32 sequence = read32(src + p);
+        const int slot = hashOf(sequence);
+        qsizetype match = table[slot];
+        table[slot] = int(p);
+
+        if (match < 0 || p - match > MaxOffset || read32(src + match) != sequence) {
+            // 连续未命中时逐渐加大步长，不可压缩的数据很快跳过
+            p += 1 + ((p - anchor) >> 6);
+            continue;
+        }
+
+        // 向前扩展到上一个序列末尾，向后扩展到块末尾的字面量区之前
+        while (p > anchor && match > 0 && src[p - 1] == src[match - 1]) {
+            --p;
+            --match;
+        }
+        qsizetype length = MinMatch;
+        while (p + length < matchLimit && src[match + length] == src[p + length]) {
+            ++length;
+        }
+
+        writeSequence(out, src + anchor, p - anchor, p - match, length);
+        p += length;
+        anchor = p;
+        table[hashOf(read32(src + p - 2))] = int(p - 2);
+    }
+    writeSequence(out, src + anchor, end - anchor, 0, -1);
+
+    result.truncate(out - result.constData());
+    return result;
+}
+
+/**
+ * @brief 解压Lz块到out，所有长度和偏移都做边界检查
+ */
+bool lzDecompress(const char* in, qsizetype inSize, const QByteArray& dictionary,
+                  char* out, qsizetype outSize)
+{
+    const uchar* ip = reinterpret_cast<const uchar*>(in);
+    const uchar* const end = ip + inSize;
+    const qsizetype dictionarySize = dictionary.size();
+    qsizetype op = 0;
+
+    auto readLength = [&](qsizetype& length) {
+        uchar byte;
+        do {
+            if (ip >= end) {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+            if (length > outSize) {
+                return false;
+            }
+        } while (byte == 255);
+        return true;
+    };
+
+    for (;;) {
+        if (ip >= end) {
+            return false;
+        }
+        const uchar token = *ip++;
+
+        qsizetype literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) {
+            return false;
+        }
+        if (literals > end - ip || literals > outSize - op) {
+            return false;
+        }
+        std::memcpy(out + op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // 最后一个序列只有字面量
+        if (ip == end) {
+            return op == outSize;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        const qsizetype offset = qsizetype(ip[0]) | (qsizetype(ip[1]) << 8);
+        ip += 2;
+        qsizetype length = token & 15;
+        if (length == 15 && !readLength(length)) {
+            return false;
+        }
+        length += MinMatch;
+        if (offset == 0 || offset > op + dictionarySize || length > outSize - op) {
+            return false;
+        }
+
+        qsizetype from = op - offset;
+        if (from < 0) {
+            // 引用落在字典里的部分
+            const qsizetype fromDictionary = qMin(-from, length);
+            std::memcpy(out + op, dictionary.constData() + dictionarySize + from, fromDictionary);
+            op += fromDictionary;
+            length -= fromDictionary;
+            from = 0;
+        }
+        if (op - from >= length) {
+            std::memcpy(out + op, out + from, length);
+            op += length;
+        } else {
+            // 重叠匹配（重复模式）逐字节向前复制
+            while (length-- > 0) {
+                out[op++] = out[from++];
+            }
+        }
+    }
+}
+
+} // namespace
+
+void EventCompression::setPolicy(int eventType, const Policy& policy)
+{
+    QWriteLocker locker(&g_compressionLock);
+    g_policies.insert(eventType, policy);
+}
+
+EventCompression::Policy EventCompression::policy(int eventType)
+{
+    QReadLocker locker(&g_compressionLock);
+    return g_policies.value(eventType);
+}
+
+QByteArray EventCompression::trainDictionary(const QList<QByteArray>& samples, qsizetype capacity)
+{
+    capacity = qBound<qsizetype>(0, capacity, MaxDictionaryBytes);
+
+    // 统计每个片段出现在多少个样本中
+    QHash<QByteArray, int> frequency;
+    for (const QByteArray& sample : samples) {
+        QSet<QByteArray> seen;
+        for (qsizetype offset = 0; offset + SegmentBytes <= sample.size(); offset += SegmentStride) {
+            const QByteArray segment = sample.mid(offset, SegmentBytes);
+            if (!seen.contains(segment)) {
+                seen.insert(segment);
+                frequency[segment]++;
+            }
+        }
+    }
+
+    struct Candidate {
+        QByteArray segment;
+        int count;
+    };
+    QList<Candidate> candidates;
+    for (auto it = frequency.constBegin(); it != frequency.constEnd(); ++it) {
+        if (it.value() >= 2) {
+            candidates.append({ it.key(), it.value() });
+        }
+    }
+
+    // 按出现次数排序，次数相同时按内容排序使训练结果确定
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.count != b.count ? a.count > b.count : a.segment < b.segment;
+    });
+    const qsizetype slots = capacity / SegmentBytes;
+    if (candidates.size() > slots) {
+        candidates.resize(slots);
+    }
+
+    QByteArray dictionary;
+    dictionary.reserve(candidates.size() * SegmentBytes);
+    for (qsizetype i = candidates.size() - 1; i >= 0; --i) {
+        dictionary.append(candidates[i].segment);
+    }
+    return dictionary;
+}
+
+quint32 EventCompression::registerDictionary(int eventType, const QByteArray& dictionary)
+{
+    if (dictionary.isEmpty()) {
+        return 0;
+    }
+
+    // 超出偏移范围的前部永远无法被引用
+    const QByteArray content = dictionary.size() > MaxDictionaryBytes
+        ? dictionary.right(MaxDictionaryBytes) : dictionary;
+    const quint32 id = contentId(content);
+
+    QWriteLocker locker(&g_compressionLock);
+    g_dictionaries.insert(id, content);
+    g_activeDictionaries.insert(eventType, id);
+    return id;
+}
+
+quint32 EventCompression::dictionaryId(int eventType)
+{
+    QReadLocker locker(&g_compressionLock);
+    return g_activeDictionaries.value(eventType, 0);
+}
+
+bool EventCompression::isCompressed(QByteArrayView buffer)
+{
+    return buffer.size() >= qsizetype(sizeof(quint32)) && read32(buffer.data()) == Magic;
+}
+
+qint64 EventCompression::envelopeSize(QByteArrayView header)
+{
+    if (header.size() < qsizetype(sizeof(Header)) || !isCompressed(header)) {
+        return -1;
+    }
+    Header parsed;
+    std::memcpy(&parsed, header.data(), sizeof(parsed));
+    return qint64(sizeof(Header)) + parsed.storedSize;
+}
+
+QByteArray EventCompression::compress(int eventType, const QByteArray& raw)
+{
+    const Policy current = policy(eventType);
+    if (current.codec == NoCodec || raw.size() < current.minimumSize) {
+        return raw;
+    }
+    const quint32 dictionary = current.codec == Lz && current.useDictionary ? dictionaryId(eventType) : 0;
+    return compress(raw, current.codec, dictionary, current.zlibLevel);
+}
+
+QByteArray EventCompression::compress(const QByteArray& raw, Codec codec, quint32 dictionaryId, int zlibLevel)
+{
+    // Lz的哈希表以int保存位置
+    if (raw.isEmpty() || raw.size() > std::numeric_limits<int>::max() - MaxDictionaryBytes) {
+        return raw;
+    }
+
+    QByteArray stored;
+    switch (codec) {
+    case Lz: {
+        QByteArray dictionary;
+        if (dictionaryId != 0) {
+            QReadLocker locker(&g_compressionLock);
+            dictionary = g_dictionaries.value(dictionaryId);
+        }
+        if (dictionary.isEmpty()) {
+            dictionaryId = 0;
+            stored = lzCompress(raw.constData(), 0, raw.size());
+        } else {
+            // 字典放在输入之前，作为可引用的历史数据
+            const QByteArray window = dictionary + raw;
+            stored = lzCompress(window.constData(), dictionary.size(), window.size());
+        }
+        break;
+    }
+    case Zlib:
+        dictionaryId = 0;
+        stored = qCompress(raw, zlibLevel);
+        break;
+    default:
+        return raw;
+    }
+
+    // 压缩后不更小时保留原始数据，解码端不必区分
+    if (stored.isEmpty() || qint64(sizeof(Header)) + stored.size() >= raw.size()) {
+        return raw;
+    }
+
+    Header header;
+    header.magic = Magic;
+    header.codec = codec;
+    header.reserved = 0;
+    header.flags = HostByteOrderFlag;
+    header.rawSize = quint32(raw.size());
+    header.storedSize = quint32(stored.size());
+    header.dictionaryId = dictionaryId;
+
+    QByteArray envelope(qsizetype(sizeof(Header)) + stored.size(), Qt::Uninitialized);
+    std::memcpy(envelope.data(), &header, sizeof(header));
+    std::memcpy(envelope.data() + sizeof(header), stored.constData(), stored.size());
+    return envelope;
+}
+
+QByteArray EventCompression::decompress(const QByteArray& data)
+{
+    if (!isCompressed(data)) {
+        return data;
+    }
+    if (data.size() < qsizetype(sizeof(Header))) {
+        return QByteArray();
+    }
+
+    Header header;
+    std::memcpy(&header, data.constData(), sizeof(header));
+    if ((header.flags & EventWire::BigEndian) != HostByteOrderFlag
+        || qint64(sizeof(Header)) + header.storedSize != data.size()) {
+        return QByteArray();
+    }
+    const char* stored = data.constData() + sizeof(Header);
+
+    switch (header.codec) {
+    case Lz: {
+        QByteArray dictionary;
+        if (header.dictionaryId != 0) {
+            QReadLocker locker(&g_compressionLock);
+            dictionary = g_dictionaries.value(header.dictionaryId);
+            if (dictionary.isEmpty()) {
+                qWarning() << "EventCompression: dictionary" << Qt::hex << header.dictionaryId
+                           << "is not registered";
+                return QByteArray();
+            }
+        }
+        QByteArray raw(qsizetype(header.rawSize), Qt::Uninitialized);
+        if (!lzDecompress(stored, header.storedSize, dictionary, raw.data(), raw.size())) {
+            return QByteArray();
+        }
+        return raw;
+    }
+    case Zlib: {
+        // qCompress的前4字节是大端的原始长度，先核对再解压，避免按损坏的长度分配
+        if (header.storedSize < 4
+            || qFromBigEndian<quint32>(stored) != header.rawSize) {
+            return QByteArray();
+        }
+        const QByteArray raw = qUncompress(reinterpret_cast<const uchar*>(stored), header.storedSize);
+        return raw.size() == qsizetype(header.rawSize) ? raw : QByteArray();
+    }
+    default:
+        return QByteArray();
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef EVENT_COMPRESSION_H
+#define EVENT_COMPRESSION_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief 事件序列化结果的可选压缩层
+ *
+ * 录制和日志中的自定义事件高度重复（相同的命令、参数名、偏移表布局），
+ * 压缩后以信封格式保存：定长头部 + 压缩数据。
+ *
+ *   Header      20字节：魔数、编解码器、标志、原始长度、压缩长度、字典ID
+ *
+ * 编解码器：
+ *   Lz   内置LZ77块格式（LZ4式令牌布局），速度优先，支持预置字典：字典
+ *        视为输入之前的历史数据，小事件也能引用其中的命令和参数名
+ *   Zlib qCompress/qUncompress，压缩率更高，不使用字典
+ *
+ * 是否压缩由按事件类型设置的 Policy 决定，默认不压缩。字典用
+ * trainDictionary() 从样本事件训练，registerDictionary() 登记到事件类型；
+ * 信封记录字典内容的哈希ID，解码端必须登记过同一字典。
+ *
+ * 多字节字段按写入端的本机字节序存放，与 EventWire 线格式一致。
+ */
+namespace EventCompression {
+
+enum : quint32 { Magic = 0x5A575645 };     // "EVWZ"
+enum : qsizetype { DefaultDictionaryBytes = 8 * 1024 };
+enum : qsizetype { MaxDictionaryBytes = 64 * 1024 - 1 };   // Lz偏移为16位
+
+enum Codec : quint8 {
+    NoCodec = 0,
+    Lz,
+    Zlib
+};
+
+struct Header {
+    quint32 magic;
+    quint8 codec;           // Codec
+    quint8 reserved;
+    quint16 flags;          // EventWire::BigEndian
+    quint32 rawSize;
+    quint32 storedSize;     // 头部之后的压缩数据字节数
+    quint32 dictionaryId;   // 0表示未使用字典
+};
+
+static_assert(sizeof(Header) == 20, "EventCompression::Header layout");
+
+/**
+ * @brief 事件类型的压缩策略
+ */
+struct Policy {
+    Codec codec;
+    int minimumSize;        // 小于此字节数的事件不压缩
+    bool useDictionary;     // 该类型登记了字典时使用（仅Lz）
+    int zlibLevel;          // Zlib压缩级别，-1为默认
+
+    Policy() : codec(NoCodec), minimumSize(128), useDictionary(true), zlibLevel(-1) {}
+};
+
+void setPolicy(int eventType, const Policy& policy);
+Policy policy(int eventType);
+
+/**
+ * @brief 从样本事件训练字典
+ *
+ * 把每个样本按8字节对齐切成16字节片段（线格式的名称和值都按8字节对齐），
+ * 统计各片段出现在多少个样本中，按出现次数从高到低选取，出现次数最高的
+ * 放在字典末尾，离输入最近、偏移最短。只出现在单个样本中的片段不入选。
+ * @param samples serialize()得到的样本
+ * @param capacity 字典上限字节数，不超过MaxDictionaryBytes
+ */
+QByteArray trainDictionary(const QList<QByteArray>& samples, qsizetype capacity = DefaultDictionaryBytes);
+
+/**
+ * @brief 登记字典并设为该事件类型压缩时使用的字典
+ *
+ * 同一类型再次登记时旧字典仍保留用于解码已有数据。
+ * @return 字典ID（字典内容的哈希），字典为空时返回0
+ */
+quint32 registerDictionary(int eventType, const QByteArray& dictionary);
+
+/**
+ * @brief 该事件类型当前使用的字典ID，未登记时返回0
+ */
+quint32 dictionaryId(int eventType);
+
+/**
+ * @brief 判断缓冲区是否以压缩信封魔数开头
+ */
+bool isCompressed(QByteArrayView buffer);
+
+/**
+ * @brief 信封总长度（头部+压缩数据），头部无效时返回-1
+ */
+qint64 envelopeSize(QByteArrayView header);
+
+/**
+ * @brief 按事件类型的策略压缩；策略不压缩或压缩后不更小时原样返回raw
+ */
+QByteArray compress(int eventType, const QByteArray& raw);
+
+/**
+ * @brief 以指定编解码器和字典压缩，不查询策略
+ */
+QByteArray compress(const QByteArray& raw, Codec codec, quint32 dictionaryId = 0, int zlibLevel = -1);
+
+/**
+ * @brief 解压信封；不是压缩信封时原样返回，数据损坏或字典未登记时返回空QByteArray
+ */
+QByteArray decompress(const QByteArray& data);
+
+} // namespace EventCompression
+
+#endif // EVENT_COMPRESSION_H
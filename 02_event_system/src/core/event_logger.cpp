@@ -15,7 +15,8 @@ EventLogger::EventLogger(QObject *parent)
       m_maxRecords(10000), // 默认最大记录数
       m_enabled(true),
       m_performanceMonitoringEnabled(true),
-      m_eventsInLastSecond(0) {
+      m_eventsInLastSecond(0),
+      m_snapshotTimer(nullptr) {
   // 连接到EventManager的信号
   EventManager *eventManager = EventManager::instance();
   connect(eventManager, &EventManager::eventPosted, this,
@@ -23,6 +24,13 @@ EventLogger::EventLogger(QObject *parent)
   connect(eventManager, &EventManager::eventProcessed, this,
           &EventLogger::onEventProcessed);
 
+  // 定期发布性能快照，指标导出线程只读快照
+  m_snapshotTimer = new QTimer(this);
+  connect(m_snapshotTimer, &QTimer::timeout, this,
+          &EventLogger::publishPerformanceSnapshot);
+  m_snapshotTimer->start(1000);
+  publishPerformanceSnapshot();
+
   qDebug() << "EventLogger initialized";
 }
 
@@ -554,6 +562,52 @@ QHash<QString, QVariant> EventLogger::getPerformanceStats() const {
     return stats;
 }
 
+std::shared_ptr<const EventLogger::PerformanceSnapshot> EventLogger::performanceSnapshot() const {
+    return std::atomic_load(&m_performanceSnapshot);
+}
+
+void EventLogger::publishPerformanceSnapshot() {
+    auto snapshot = std::make_shared<PerformanceSnapshot>();
+    {
+        QMutexLocker locker(&m_historyMutex);
+        snapshot->totalEvents = m_eventHistory.size();
+    }
+
+    // QHash/QList为隐式共享，加锁期间只增加引用计数，统计在锁外计算
+    QHash<QEvent::Type, QList<qint64>> processingTimes;
+    QList<QPair<QDateTime, int>> countHistory;
+    {
+        QMutexLocker locker(&m_performanceMutex);
+        processingTimes = m_eventProcessingTimes;
+        countHistory = m_eventCountHistory;
+    }
+
+    const QDateTime oneSecondAgo = QDateTime::currentDateTime().addSecs(-1);
+    for (const auto& entry : countHistory) {
+        if (entry.first >= oneSecondAgo) {
+            snapshot->eventsPerSecond += entry.second;
+        }
+    }
+
+    EventManager* manager = EventManager::instance();
+    for (auto it = processingTimes.constBegin(); it != processingTimes.constEnd(); ++it) {
+        const QList<qint64>& times = it.value();
+        TypeStats typeStats;
+        typeStats.sampleCount = times.size();
+        if (!times.isEmpty()) {
+            qint64 totalTime = 0;
+            for (qint64 time : times) {
+                totalTime += time;
+            }
+            typeStats.avgTimeMs = static_cast<double>(totalTime) / times.size() / 1000000.0;
+        }
+        snapshot->eventTypes.insert(manager->getEventTypeName(it.key()), typeStats);
+    }
+
+    std::atomic_store(&m_performanceSnapshot,
+                      std::shared_ptr<const PerformanceSnapshot>(std::move(snapshot)));
+}
+
 void EventLogger::resetPerformanceStats() {
     QMutexLocker locker(&m_performanceMutex);
     
@@ -9,6 +9,10 @@
 #include <QMutex>
 #include <QAbstractTableModel>
 #include <QVariant>
+#include <QHash>
+#include <memory>
+
+class QTimer;
 
 /**
  * @brief EventLogger 事件日志记录器
@@ -151,6 +155,35 @@ public:
      */
     QHash<QString, QVariant> getPerformanceStats() const;
 
+    /**
+     * @brief 单个事件类型的性能统计
+     */
+    struct TypeStats {
+        int sampleCount;            // 保留的最近样本数
+        double avgTimeMs;           // 平均处理时间（毫秒）
+
+        TypeStats() : sampleCount(0), avgTimeMs(0.0) {}
+    };
+
+    /**
+     * @brief 性能统计快照：getPerformanceStats()主要数据的不可变副本（供指标导出）
+     */
+    struct PerformanceSnapshot {
+        int totalEvents;                        // 保存的事件记录数
+        int eventsPerSecond;                    // 最近一秒的事件数
+        QHash<QString, TypeStats> eventTypes;   // 按事件类型名称的统计
+
+        PerformanceSnapshot() : totalEvents(0), eventsPerSecond(0) {}
+    };
+
+    /**
+     * @brief 获取最新发布的性能统计快照（无锁，可从任意线程调用）
+     *
+     * 快照由日志记录器所在线程每秒发布一次，读取方不会与logEvent()争用m_performanceMutex。
+     * @return 性能统计快照，不为空
+     */
+    std::shared_ptr<const PerformanceSnapshot> performanceSnapshot() const;
+
     /**
      * @brief 重置性能统计数据
      */
@@ -250,6 +283,11 @@ private:
      */
     void collectPerformanceData(const EventRecord& record);
 
+    /**
+     * @brief 复制性能数据并原子发布快照（在日志记录器所在线程调用）
+     */
+    void publishPerformanceSnapshot();
+
     // 静态实例
     static EventLogger* s_instance;
     static QMutex s_mutex;
@@ -284,6 +322,10 @@ private:
     int m_eventsInLastSecond;                                   // 上一秒的事件数量
     QList<QPair<QDateTime, int>> m_eventCountHistory;           // 事件数量历史记录
     mutable QMutex m_performanceMutex;
+
+    // 定期发布性能快照；快照通过 std::atomic_load / std::atomic_store 访问
+    QTimer* m_snapshotTimer;
+    std::shared_ptr<const PerformanceSnapshot> m_performanceSnapshot;
 };
 
 /**
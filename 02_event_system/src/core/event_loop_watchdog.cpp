@@ -0,0 +1,125 @@
+#include "event_loop_watchdog.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+struct EventLoopWatchdog::PongState {
+    QMutex mutex;
+    QWaitCondition condition;
+    quint64 sequence = 0;
+};
+
+EventLoopWatchdog::EventLoopWatchdog(QObject* target, int pingIntervalMs, int stallThresholdMs,
+                                     QObject* parent)
+    : QThread(parent)
+    , m_target(target)
+    , m_pingIntervalMs(qMax(1, pingIntervalMs))
+    , m_stallThresholdMs(qMax(1, stallThresholdMs))
+    , m_pong(std::make_shared<PongState>())
+{
+    setObjectName("EventLoopWatchdog");
+}
+
+EventLoopWatchdog::~EventLoopWatchdog()
+{
+    stop();
+}
+
+void EventLoopWatchdog::stop()
+{
+    requestInterruption();
+    {
+        // 持锁唤醒，避免看门狗线程在检查标志后、进入等待前错过唤醒
+        QMutexLocker locker(&m_pong->mutex);
+        m_pong->condition.wakeAll();
+    }
+    wait();
+}
+
+bool EventLoopWatchdog::waitForPong(quint64 sequence, QDeadlineTimer deadline)
+{
+    QMutexLocker locker(&m_pong->mutex);
+    while (m_pong->sequence < sequence && !isInterruptionRequested()) {
+        if (!m_pong->condition.wait(&m_pong->mutex, deadline)) {
+            break;
+        }
+    }
+    return m_pong->sequence >= sequence;
+}
+
+void EventLoopWatchdog::run()
+{
+    EventPerformanceAnalyzer* analyzer = EventPerformanceAnalyzer::instance();
+
+    QElapsedTimer clock;
+    clock.start();
+    quint64 sequence = 0;
+
+    qDebug() << "EventLoopWatchdog started: interval =" << m_pingIntervalMs
+             << "ms, stall threshold =" << m_stallThresholdMs << "ms";
+
+    while (!isInterruptionRequested()) {
+        QObject* target = m_target.data();
+        if (!target) {
+            break; // 目标对象已销毁
+        }
+
+        // 投递ping，GUI线程处理到它时写回序号并唤醒看门狗线程
+        const quint64 pingSequence = ++sequence;
+        std::shared_ptr<PongState> pong = m_pong;
+        const qint64 pingSentNs = clock.nsecsElapsed();
+        QMetaObject::invokeMethod(target, [pong, pingSequence]() {
+            QMutexLocker locker(&pong->mutex);
+            pong->sequence = pingSequence;
+            pong->condition.wakeAll();
+        }, Qt::QueuedConnection);
+
+        // 阻塞等待回应，最多等到停顿阈值；期间不轮询
+        bool stallReported = false;
+        EventPerformanceAnalyzer::StallRecord stall;
+        if (!waitForPong(pingSequence, QDeadlineTimer(m_stallThresholdMs, Qt::PreciseTimer))) {
+            if (isInterruptionRequested()) {
+                break;
+            }
+
+            // 捕获停顿发生时GUI线程正在处理的事件
+            const qint64 lagNs = clock.nsecsElapsed() - pingSentNs;
+            EventPerformanceAnalyzer::DispatchInfo dispatch = analyzer->currentGuiDispatch();
+            stall.startTime = QDateTime::currentDateTime().addMSecs(-lagNs / 1000000);
+            stall.durationMs = lagNs / 1000000;
+            stall.eventType = dispatch.eventType;
+            stall.receiverClass = dispatch.receiverClass
+                                  ? QString::fromLatin1(dispatch.receiverClass)
+                                  : QString();
+            stall.finished = false;
+            stallReported = true;
+
+            analyzer->recordStall(stall);
+            emit stallDetected(stall);
+
+            // 停顿已报告，继续等待回应以得到最终持续时间
+            waitForPong(pingSequence, QDeadlineTimer(QDeadlineTimer::Forever));
+        }
+
+        if (isInterruptionRequested()) {
+            break;
+        }
+
+        const qint64 lagNs = clock.nsecsElapsed() - pingSentNs;
+        analyzer->recordEventLoopLag(lagNs);
+
+        if (stallReported) {
+            stall.durationMs = lagNs / 1000000;
+            stall.finished = true;
+            analyzer->recordStall(stall);
+            emit stallResolved(stall);
+        }
+
+        // 间隔期间不会有新的回应，只会因超时或stop()醒来
+        waitForPong(pingSequence + 1, QDeadlineTimer(m_pingIntervalMs));
+    }
+
+    qDebug() << "EventLoopWatchdog stopped";
+}
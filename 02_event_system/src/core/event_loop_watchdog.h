@@ -0,0 +1,80 @@
+#ifndef EVENT_LOOP_WATCHDOG_H
+#define EVENT_LOOP_WATCHDOG_H
+
+#include <QThread>
+#include <QDeadlineTimer>
+#include <QPointer>
+#include <memory>
+#include "event_performance_analyzer.h"
+
+/**
+ * @brief EventLoopWatchdog 事件循环响应性看门狗
+ *
+ * 在独立线程中以固定间隔向GUI线程投递"ping"，测量事件循环
+ * 多久之后才处理到它（即事件循环延迟）。当延迟超过停顿阈值时，
+ * 从EventPerformanceAnalyzer读取GUI线程此刻正在处理的事件类型
+ * 和接收者类名，实现真实的停顿归因。
+ */
+class EventLoopWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param target GUI线程中的对象，ping将投递给它
+     * @param pingIntervalMs ping间隔（毫秒）
+     * @param stallThresholdMs 停顿阈值（毫秒）
+     * @param parent 父对象
+     */
+    EventLoopWatchdog(QObject* target, int pingIntervalMs, int stallThresholdMs,
+                      QObject* parent = nullptr);
+
+    /**
+     * @brief 析构函数，停止并等待看门狗线程
+     */
+    ~EventLoopWatchdog() override;
+
+    /**
+     * @brief 请求停止并等待线程结束
+     */
+    void stop();
+
+signals:
+    /**
+     * @brief 检测到停顿时发出（在看门狗线程中发出，停顿仍在进行）
+     * @param record 停顿记录
+     */
+    void stallDetected(const EventPerformanceAnalyzer::StallRecord& record);
+
+    /**
+     * @brief 停顿结束时发出，包含最终持续时间
+     * @param record 停顿记录
+     */
+    void stallResolved(const EventPerformanceAnalyzer::StallRecord& record);
+
+protected:
+    /**
+     * @brief 看门狗主循环
+     */
+    void run() override;
+
+private:
+    struct PongState;
+
+    /**
+     * @brief 等待GUI线程回应序号不小于sequence的ping
+     * @return 收到回应返回true；超时或请求停止返回false
+     */
+    bool waitForPong(quint64 sequence, QDeadlineTimer deadline);
+
+    QPointer<QObject> m_target;
+    int m_pingIntervalMs;
+    int m_stallThresholdMs;
+
+    // GUI线程最近一次回应的ping序号及其条件变量；以共享指针持有，
+    // 看门狗销毁后仍滞留在队列中的ping也能安全执行
+    std::shared_ptr<PongState> m_pong;
+};
+
+#endif // EVENT_LOOP_WATCHDOG_H
@@ -1,4 +1,5 @@
 #include "event_manager.h"
+#include "event_performance_analyzer.h"
 #include <QCoreApplication>
 #include <QMutexLocker>
 #include <QDebug>
@@ -92,8 +93,11 @@ bool EventManager::sendCustomEvent(QObject* receiver, QEvent* event)
 
     QEvent::Type eventType = event->type();
     
-    // 使用Qt的事件系统同步发送事件
+    // 使用Qt的事件系统同步发送事件，分派过程计入性能分析器（GUI线程上同时供看门狗归因停顿）
+    EventPerformanceAnalyzer* analyzer = EventPerformanceAnalyzer::instance();
+    int timerId = analyzer->startEventTiming(eventType, receiver);
     bool accepted = QCoreApplication::sendEvent(receiver, event);
+    analyzer->endEventTiming(timerId);
     
     // 发出事件处理信号
     emit eventProcessed(receiver, eventType, accepted);
@@ -49,7 +49,7 @@ public:
     void postCustomEvent(QObject* receiver, QEvent* event);
 
     /**
-     * @brief 同步发送自定义事件
+     * @brief 同步发送自定义事件，分派耗时记入 EventPerformanceAnalyzer
      * @param receiver 接收事件的对象
      * @param event 要发送的事件
      * @return 事件是否被接受
@@ -0,0 +1,434 @@
+#include "event_payload.h"
+#include "event_pool.h"
+#include <QHash>
+#include <QReadWriteLock>
+#include <QDebug>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace {
+
+// 全局键驻留表：名称只追加不释放，写入在锁内完成后再发布计数，
+// 读取方按计数无锁访问名称
+QReadWriteLock g_keyLock;
+QHash<QString, int> g_keyIds;
+const QString* g_keyNames[EventPayload::MaxInternedKeys];
+std::atomic<int> g_keyCount{0};
+std::atomic<bool> g_keyTableFullReported{false};
+
+QStringView internedName(int key)
+{
+    return key >= 0 && key < g_keyCount.load(std::memory_order_acquire) ? QStringView(*g_keyNames[key]) : QStringView();
+}
+
+// 以原始字节保存的基本类型
+bool isRawType(const QMetaType& type)
+{
+    switch (type.id()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+    case QMetaType::QChar:
+        return type.sizeOf() <= 8;
+    default:
+        return false;
+    }
+}
+
+// 不超过此长度的字符串/字节数组拷贝进竞技场，更长的保存隐式共享的QVariant
+const qsizetype MaxArenaCopyBytes = EventPayload::ChunkBytes / 4;
+
+bool isLargeShared(const QVariant& value)
+{
+    switch (value.metaType().id()) {
+    case QMetaType::QString:
+        return static_cast<const QString*>(value.constData())->size() * qsizetype(sizeof(QChar)) > MaxArenaCopyBytes;
+    case QMetaType::QByteArray:
+        return static_cast<const QByteArray*>(value.constData())->size() > MaxArenaCopyBytes;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+int EventPayload::internKey(const QString& name)
+{
+    {
+        QReadLocker locker(&g_keyLock);
+        auto it = g_keyIds.constFind(name);
+        if (it != g_keyIds.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&g_keyLock);
+    auto it = g_keyIds.constFind(name);
+    if (it != g_keyIds.constEnd()) {
+        return it.value();
+    }
+    const int key = g_keyCount.load(std::memory_order_relaxed);
+    if (key >= MaxInternedKeys) {
+        if (!g_keyTableFullReported.exchange(true)) {
+            qWarning() << "EventPayload: 键驻留表已满，之后的新键名改为本地保存:" << name;
+        }
+        return InvalidKey;
+    }
+    g_keyNames[key] = new QString(name);
+    g_keyIds.insert(name, key);
+    g_keyCount.store(key + 1, std::memory_order_release);
+    return key;
+}
+
+int EventPayload::findKey(const QString& name)
+{
+    QReadLocker locker(&g_keyLock);
+    return g_keyIds.value(name, InvalidKey);
+}
+
+QString EventPayload::keyName(int key)
+{
+    const QStringView name = internedName(key);
+    return name.isNull() ? QString() : *g_keyNames[key];
+}
+
+QStringView EventPayload::keyView(int key)
+{
+    return internedName(key);
+}
+
+void* EventPayload::Chunk::operator new(std::size_t size)
+{
+    return PoolAllocated<Chunk>::operator new(size);
+}
+
+void EventPayload::Chunk::operator delete(void* block, std::size_t size)
+{
+    PoolAllocated<Chunk>::operator delete(block, size);
+}
+
+EventPayload::EventPayload()
+    : m_slots(m_inlineSlots)
+    , m_count(0)
+    , m_capacity(InlineSlots)
+    , m_variants(0)
+    , m_localNames(0)
+    , m_cursor(m_inlineArena)
+    , m_end(m_inlineArena + InlineBytes)
+    , m_chunks(nullptr)
+    , m_currentChunk(nullptr)
+    , m_largeBlocks(nullptr)
+    , m_bytesUsed(0)
+{
+}
+
+EventPayload::~EventPayload()
+{
+    clear();
+
+    while (m_chunks) {
+        Chunk* next = m_chunks->next;
+        delete m_chunks;
+        m_chunks = next;
+    }
+}
+
+void EventPayload::setValue(int key, const QVariant& value)
+{
+    const QStringView name = internedName(key);
+    if (name.isNull()) return;
+
+    Slot* slot = findSlot(key);
+    if (!slot) {
+        slot = appendSlot(key, name);
+    }
+    assign(slot, value);
+}
+
+QVariant EventPayload::value(int key) const
+{
+    const Slot* slot = findSlot(key);
+    return slot ? read(*slot) : QVariant();
+}
+
+bool EventPayload::contains(int key) const
+{
+    return findSlot(key) != nullptr;
+}
+
+void EventPayload::setValue(QStringView name, const QVariant& value, bool intern)
+{
+    Slot* slot = findSlot(name);
+    if (!slot) {
+        const int key = intern ? internKey(name.toString()) : InvalidKey;
+        if (key != InvalidKey) {
+            slot = appendSlot(key, internedName(key));
+        } else {
+            // 本地键名拷贝进竞技场，随clear()回收
+            void* data = allocate(name.size() * sizeof(QChar), alignof(QChar));
+            std::memcpy(data, name.data(), name.size() * sizeof(QChar));
+            slot = appendSlot(InvalidKey, QStringView(static_cast<const QChar*>(data), name.size()));
+            m_localNames++;
+        }
+    }
+    assign(slot, value);
+}
+
+QVariant EventPayload::value(QStringView name) const
+{
+    const Slot* slot = findSlot(name);
+    return slot ? read(*slot) : QVariant();
+}
+
+bool EventPayload::contains(QStringView name) const
+{
+    return findSlot(name) != nullptr;
+}
+
+bool EventPayload::remove(int key)
+{
+    Slot* slot = findSlot(key);
+    if (!slot) {
+        return false;
+    }
+    removeSlot(slot);
+    return true;
+}
+
+bool EventPayload::remove(QStringView name)
+{
+    Slot* slot = findSlot(name);
+    if (!slot) {
+        return false;
+    }
+    removeSlot(slot);
+    return true;
+}
+
+QList<int> EventPayload::keys() const
+{
+    QList<int> result;
+    result.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        result.append(m_slots[i].key);
+    }
+    return result;
+}
+
+QVariant EventPayload::valueAt(int index) const
+{
+    return read(m_slots[index]);
+}
+
+void EventPayload::clear()
+{
+    // 只有原位构造的QVariant需要逐个析构；原始字节和拷贝进竞技场的字符串
+    // 随游标回拨一并丢弃，没有QVariant时不遍历槽
+    if (m_variants > 0) {
+        for (int i = 0; i < m_count; ++i) {
+            releaseSlot(m_slots[i]);
+        }
+    }
+
+    m_slots = m_inlineSlots;
+    m_count = 0;
+    m_capacity = InlineSlots;
+    m_localNames = 0;
+    m_cursor = m_inlineArena;
+    m_end = m_inlineArena + InlineBytes;
+    m_currentChunk = nullptr;
+    m_bytesUsed = 0;
+
+    while (m_largeBlocks) {
+        LargeBlock* next = m_largeBlocks->next;
+        ::operator delete(m_largeBlocks);
+        m_largeBlocks = next;
+    }
+}
+
+std::size_t EventPayload::arenaBytesUsed() const
+{
+    return m_bytesUsed;
+}
+
+EventPayload::Slot* EventPayload::findSlot(int key) const
+{
+    for (int i = 0; i < m_count; ++i) {
+        if (m_slots[i].key == key) {
+            return &m_slots[i];
+        }
+    }
+    // 同名的键可能先以本地键名写入过
+    return m_localNames > 0 ? findSlot(internedName(key)) : nullptr;
+}
+
+EventPayload::Slot* EventPayload::findSlot(QStringView name) const
+{
+    for (int i = 0; i < m_count; ++i) {
+        if (m_slots[i].name == name) {
+            return &m_slots[i];
+        }
+    }
+    return nullptr;
+}
+
+EventPayload::Slot* EventPayload::appendSlot(int key, QStringView name)
+{
+    if (m_count == m_capacity) {
+        // 槽数组放不下时在竞技场中分配两倍容量，旧数组随clear()一起回收
+        int capacity = m_capacity * 2;
+        Slot* slots = static_cast<Slot*>(allocate(capacity * sizeof(Slot), alignof(Slot)));
+        std::memcpy(static_cast<void*>(slots), m_slots, m_count * sizeof(Slot));
+        m_slots = slots;
+        m_capacity = capacity;
+    }
+
+    Slot* slot = &m_slots[m_count++];
+    slot->key = key;
+    slot->kind = Empty;
+    slot->capacity = 0;
+    slot->name = name;
+    return slot;
+}
+
+void EventPayload::assign(Slot* slot, const QVariant& value)
+{
+    const QMetaType type = value.metaType();
+    const bool isString = type.id() == QMetaType::QString;
+
+    if (!value.isValid()) {
+        releaseSlot(*slot);
+    } else if (isRawType(type)) {
+        releaseSlot(*slot);
+        slot->kind = Raw;
+        std::memcpy(slot->raw, value.constData(), type.sizeOf());
+    } else if ((isString || type.id() == QMetaType::QByteArray) && !isLargeShared(value)) {
+        const Kind kind = isString ? String : Bytes;
+        const void* source;
+        quint32 length;
+        std::size_t bytes;
+        if (isString) {
+            const QString* string = static_cast<const QString*>(value.constData());
+            source = string->constData();
+            length = string->size();
+            bytes = length * sizeof(QChar);
+        } else {
+            const QByteArray* array = static_cast<const QByteArray*>(value.constData());
+            source = array->constData();
+            length = array->size();
+            bytes = length;
+        }
+
+        // 同类数据放得下时写回原来的空间，反复覆盖同一个键不占用新的竞技场内存
+        void* data;
+        if (slot->kind == kind && bytes <= slot->capacity) {
+            data = const_cast<void*>(slot->data);
+        } else {
+            releaseSlot(*slot);
+            data = allocate(bytes, isString ? alignof(QChar) : 1);
+            slot->capacity = bytes;
+        }
+        std::memcpy(data, source, bytes);
+        slot->kind = kind;
+        slot->length = length;
+        slot->data = data;
+    } else if (slot->kind == Variant) {
+        // 已构造的QVariant原位赋值，覆盖同一个键不占用新的竞技场内存
+        *slot->variant = value;
+    } else {
+        // 大字符串/字节数组和其他类型保存QVariant，写入读取只增加引用计数
+        releaseSlot(*slot);
+        slot->kind = Variant;
+        slot->variant = new (allocate(sizeof(QVariant), alignof(QVariant))) QVariant(value);
+        m_variants++;
+    }
+
+    slot->typeId = type.id();
+}
+
+QVariant EventPayload::read(const Slot& slot) const
+{
+    switch (slot.kind) {
+    case Raw:
+        return QVariant(QMetaType(slot.typeId), slot.raw);
+    case String:
+        return QString(static_cast<const QChar*>(slot.data), slot.length);
+    case Bytes:
+        return QByteArray(static_cast<const char*>(slot.data), slot.length);
+    case Variant:
+        return *slot.variant;
+    case Empty:
+        break;
+    }
+    return QVariant();
+}
+
+void EventPayload::removeSlot(Slot* slot)
+{
+    releaseSlot(*slot);
+    if (slot->key == InvalidKey) {
+        m_localNames--;
+    }
+    Slot* end = m_slots + m_count;
+    std::memmove(static_cast<void*>(slot), slot + 1, (end - slot - 1) * sizeof(Slot));
+    m_count--;
+}
+
+void EventPayload::releaseSlot(Slot& slot)
+{
+    if (slot.kind == Variant) {
+        slot.variant->~QVariant();
+        m_variants--;
+    }
+    slot.kind = Empty;
+}
+
+void* EventPayload::allocate(std::size_t size, std::size_t alignment)
+{
+    for (;;) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_cursor);
+        std::uintptr_t aligned = (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        char* start = reinterpret_cast<char*>(aligned);
+        if (start + size <= m_end) {
+            m_bytesUsed += (start + size) - m_cursor;
+            m_cursor = start + size;
+            return start;
+        }
+
+        if (size + alignment > ChunkBytes) {
+            // 超出块大小的请求单独分配，clear()时释放
+            LargeBlock* large = static_cast<LargeBlock*>(::operator new(sizeof(LargeBlock) + size));
+            large->next = m_largeBlocks;
+            m_largeBlocks = large;
+            m_bytesUsed += size;
+            return large + 1;
+        }
+
+        // 切换到下一个已保留的块，没有则新取一块追加到链表末尾
+        Chunk* next = m_currentChunk ? m_currentChunk->next : m_chunks;
+        if (!next) {
+            next = new Chunk;
+            if (m_currentChunk) {
+                m_currentChunk->next = next;
+            } else {
+                m_chunks = next;
+            }
+        }
+        m_currentChunk = next;
+        m_cursor = next->data;
+        m_end = next->data + ChunkBytes;
+    }
+}
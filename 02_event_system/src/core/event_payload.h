@@ -0,0 +1,175 @@
+#ifndef EVENT_PAYLOAD_H
+#define EVENT_PAYLOAD_H
+
+#include <QString>
+#include <QStringView>
+#include <QVariant>
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * @brief EventPayload 竞技场式事件负载存储
+ *
+ * 以驻留后的整数键代替QString键，键值对存放在对象内的定长扁平数组中；
+ * 基本类型按原始字节保存在槽内，不超过1KB的字符串、字节数组按原始数据
+ * 追加到对象内的缓冲区（bump分配），内联缓冲区用尽时再从
+ * PoolAllocated<Chunk> 的存储池取整块内存。更长的字符串、字节数组以及
+ * 其他类型（QVariantMap等）以QVariant原位构造在竞技场中，隐式共享，
+ * 写入和读取都只增加引用计数，不拷贝数据。
+ *
+ * clear()只回拨游标和计数，已取得的内存块留给下一次使用，因此池化事件
+ * 被重用时负载内存也随之重用。只有QVariant需要析构：负载中没有QVariant
+ * 时（基本类型和短字符串的常见情况）clear()为O(1)，否则遍历一次槽数组。
+ * 覆盖已有键时，同类新值放得下就写回原来的空间，QVariant则原位赋值，
+ * 反复更新同一个键不会让竞技场增长。
+ *
+ * 全局驻留表最多容纳 MaxInternedKeys 个键名，驻留后的键名永不释放。
+ * 来自外部数据、数量不受控制的键名应以 intern = false 写入，此时键名
+ * 拷贝进本负载的竞技场，随clear()一起回收；驻留表已满时同样退回这种
+ * 本地键名。按名称的读取只扫描本负载的槽，不访问驻留表。
+ */
+class EventPayload
+{
+public:
+    enum {
+        InlineSlots = 8,            // 内联键值槽数量
+        InlineBytes = 256,          // 内联竞技场字节数
+        ChunkBytes = 4096           // 溢出块大小
+    };
+
+    static constexpr int InvalidKey = -1;
+    static constexpr int MaxInternedKeys = 4096;
+
+    /**
+     * @brief 驻留键名，相同名称始终返回相同ID（线程安全）
+     * @param name 键名
+     * @return 键ID，驻留表已满时返回InvalidKey
+     */
+    static int internKey(const QString& name);
+
+    /**
+     * @brief 查找已驻留的键，不会新增
+     * @param name 键名
+     * @return 键ID，未驻留时返回InvalidKey
+     */
+    static int findKey(const QString& name);
+
+    /**
+     * @brief 获取键ID对应的名称（无锁）
+     */
+    static QString keyName(int key);
+
+    /**
+     * @brief 键ID对应名称的视图（无锁，不拷贝），驻留的名称永不释放，视图始终有效
+     */
+    static QStringView keyView(int key);
+
+    EventPayload();
+    ~EventPayload();
+
+    void setValue(int key, const QVariant& value);
+    QVariant value(int key) const;
+    bool contains(int key) const;
+
+    /**
+     * @brief 按名称写入
+     * @param intern 为true时先驻留键名；为false或驻留表已满时使用本地键名
+     */
+    void setValue(QStringView name, const QVariant& value, bool intern = true);
+    QVariant value(QStringView name) const;
+    bool contains(QStringView name) const;
+
+    /**
+     * @brief 删除键值对，其余键保持写入顺序；竞技场内存到clear()时才回收
+     * @return 键是否存在
+     */
+    bool remove(int key);
+    bool remove(QStringView name);
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // 所有键ID，按首次写入顺序；本地键名的项为InvalidKey
+    QList<int> keys() const;
+
+    // 按写入顺序逐项访问，index在[0, size())内
+    int keyAt(int index) const { return m_slots[index].key; }
+    QStringView nameAt(int index) const { return m_slots[index].name; }
+    QVariant valueAt(int index) const;
+
+    /**
+     * @brief 清空负载并回拨竞技场，保留已取得的内存块
+     */
+    void clear();
+
+    /**
+     * @brief 竞技场已使用的字节数（含内联缓冲区）
+     */
+    std::size_t arenaBytesUsed() const;
+
+private:
+    Q_DISABLE_COPY(EventPayload)
+
+    enum Kind : quint8 {
+        Empty,
+        Raw,            // 不超过8字节的基本类型，按原始字节保存
+        String,         // UTF-16数据在竞技场中
+        Bytes,          // 字节数据在竞技场中
+        Variant         // 竞技场中原位构造的QVariant
+    };
+
+    struct Slot {
+        int key;                    // 本地键名为InvalidKey
+        int typeId;
+        Kind kind;
+        quint32 length;
+        quint32 capacity;           // String/Bytes在竞技场中占用的字节数
+        QStringView name;           // 指向驻留表或竞技场中的键名
+        union {
+            unsigned char raw[8];
+            const void* data;
+            QVariant* variant;
+        };
+    };
+
+    struct Chunk {
+        Chunk* next;
+        alignas(std::max_align_t) char data[ChunkBytes];
+
+        Chunk() : next(nullptr) {}      // 数据区不做初始化
+
+        // 转发到 PoolAllocated<Chunk>，定义在实现文件中以免头文件依赖事件池
+        static void* operator new(std::size_t size);
+        static void operator delete(void* block, std::size_t size);
+    };
+
+    struct alignas(std::max_align_t) LargeBlock {
+        LargeBlock* next;
+    };
+
+    Slot* findSlot(int key) const;
+    Slot* findSlot(QStringView name) const;
+    Slot* appendSlot(int key, QStringView name);
+    void assign(Slot* slot, const QVariant& value);
+    QVariant read(const Slot& slot) const;
+    void removeSlot(Slot* slot);
+    void releaseSlot(Slot& slot);
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    Slot m_inlineSlots[InlineSlots];
+    Slot* m_slots;
+    int m_count;
+    int m_capacity;
+    int m_variants;             // 需要在clear()时析构的QVariant数
+    int m_localNames;           // 使用本地键名的槽数
+
+    // 竞技场：m_chunks链表在clear()后保留，m_currentChunk为空表示仍在内联缓冲区
+    alignas(std::max_align_t) char m_inlineArena[InlineBytes];
+    char* m_cursor;
+    char* m_end;
+    Chunk* m_chunks;
+    Chunk* m_currentChunk;
+    LargeBlock* m_largeBlocks;
+    std::size_t m_bytesUsed;
+};
+
+#endif // EVENT_PAYLOAD_H
@@ -1,26 +1,54 @@
 #include "event_performance_analyzer.h"
 #include "event_manager.h"
+#include "event_loop_watchdog.h"
 #include <QDebug>
 #include <QMutexLocker>
 #include <QApplication>
+#include <QSet>
+#include <QThread>
 #include <algorithm>
 
 // 静态成员初始化
 EventPerformanceAnalyzer* EventPerformanceAnalyzer::s_instance = nullptr;
 QMutex EventPerformanceAnalyzer::s_mutex;
 
+const qint64 EventPerformanceAnalyzer::LatencyHistogram::BucketBoundsNs[BucketCount] = {
+    100000,         // 0.1ms
+    500000,         // 0.5ms
+    1000000,        // 1ms
+    2500000,        // 2.5ms
+    5000000,        // 5ms
+    10000000,       // 10ms
+    25000000,       // 25ms
+    50000000,       // 50ms
+    100000000,      // 100ms
+    500000000       // 500ms
+};
+
 EventPerformanceAnalyzer::EventPerformanceAnalyzer(QObject* parent)
     : QObject(parent)
+    , m_totalStalls(0)
+    , m_guiEventType(QEvent::None)
+    , m_guiReceiverClass(nullptr)
+    , m_watchdog(nullptr)
     , m_enabled(true)
     , m_slowThresholdMs(10.0)           // 10ms阈值
     , m_highFrequencyThreshold(100)     // 每秒100个事件
+    , m_hardwareCountersEnabled(false)  // 硬件计数器默认关闭
     , m_analysisTimer(nullptr)
+    , m_exportTimer(nullptr)
     , m_nextTimerId(1)
 {
     // 设置定期分析定时器
     m_analysisTimer = new QTimer(this);
     connect(m_analysisTimer, &QTimer::timeout, this, &EventPerformanceAnalyzer::performPeriodicAnalysis);
     m_analysisTimer->start(5000); // 每5秒分析一次
+
+    // 定期发布导出快照，指标导出线程只读快照
+    m_exportTimer = new QTimer(this);
+    connect(m_exportTimer, &QTimer::timeout, this, &EventPerformanceAnalyzer::publishExportSnapshot);
+    m_exportTimer->start(1000);
+    publishExportSnapshot();
     
     qDebug() << "EventPerformanceAnalyzer initialized";
 }
@@ -42,6 +70,7 @@ int EventPerformanceAnalyzer::startEventTiming(QEvent::Type eventType, QObject*
     if (!m_enabled) {
         return -1;
     }
+    bool sampleCounters = m_hardwareCountersEnabled;
     configLocker.unlock();
 
     QMutexLocker dataLocker(&m_dataMutex);
@@ -51,6 +80,25 @@ int EventPerformanceAnalyzer::startEventTiming(QEvent::Type eventType, QObject*
     data.eventType = eventType;
     data.object = object;
     data.startTime = QDateTime::currentDateTime();
+    
+    // 在GUI线程上发布当前分派信息，供看门狗归因停顿
+    QCoreApplication* app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread()) {
+        data.onGuiThread = true;
+        data.previousDispatch.eventType = static_cast<QEvent::Type>(m_guiEventType.loadRelaxed());
+        data.previousDispatch.receiverClass = m_guiReceiverClass.loadRelaxed();
+        m_guiReceiverClass.storeRelease(object ? object->metaObject()->className() : nullptr);
+        m_guiEventType.storeRelease(static_cast<int>(eventType));
+    }
+    
+    // 最后读取计数器和启动计时，尽量不把簿记开销算进事件处理
+    if (AllocationProfiler::isEnabled()) {
+        data.allocationStart = AllocationProfiler::currentThreadCounters();
+        data.allocationsValid = true;
+    }
+    if (sampleCounters) {
+        data.countersValid = HardwareCounterSampler::forCurrentThread()->read(data.counterStart);
+    }
     data.timer.start();
     
     return timerId;
@@ -62,6 +110,17 @@ void EventPerformanceAnalyzer::endEventTiming(int timerId)
         return; // 无效的计时器ID
     }
 
+    // 先读取计数器，避免把数据锁的等待时间和簿记分配计入
+    AllocationProfiler::Counters allocationEnd = AllocationProfiler::currentThreadCounters();
+    HardwareCounterSampler::Sample counterEnd;
+    bool endCountersValid = false;
+    {
+        QMutexLocker configLocker(&m_configMutex);
+        if (m_hardwareCountersEnabled) {
+            endCountersValid = HardwareCounterSampler::forCurrentThread()->read(counterEnd);
+        }
+    }
+
     QMutexLocker dataLocker(&m_dataMutex);
     
     if (!m_activeTimers.contains(timerId)) {
@@ -71,11 +130,36 @@ void EventPerformanceAnalyzer::endEventTiming(int timerId)
     TimingData& data = m_activeTimers[timerId];
     qint64 elapsedNs = data.timer.nsecsElapsed();
     
+    // 记录堆分配增量
+    if (data.allocationsValid) {
+        AllocationProfiler::Counters delta = AllocationProfiler::delta(data.allocationStart, allocationEnd);
+        m_eventAllocations[data.eventType].accumulate(delta);
+        if (data.object) {
+            m_classAllocations[QString::fromLatin1(data.object->metaObject()->className())].accumulate(delta);
+        }
+    }
+    
+    // 恢复外层分派信息
+    if (data.onGuiThread) {
+        m_guiReceiverClass.storeRelease(data.previousDispatch.receiverClass);
+        m_guiEventType.storeRelease(static_cast<int>(data.previousDispatch.eventType));
+    }
+    
+    // 记录硬件计数器增量（开始和结束必须在同一线程采样）
+    if (data.countersValid && endCountersValid) {
+        HardwareCounterSampler::Sample delta = HardwareCounterSampler::delta(data.counterStart, counterEnd);
+        m_eventCounters[data.eventType].accumulate(delta);
+        if (data.object) {
+            m_classCounters[QString::fromLatin1(data.object->metaObject()->className())].accumulate(delta);
+        }
+    }
+    
     // 记录事件类型的处理时间
     if (!m_eventTimings.contains(data.eventType)) {
         m_eventTimings[data.eventType] = QList<qint64>();
     }
     m_eventTimings[data.eventType].append(elapsedNs);
+    m_eventHistograms[data.eventType].record(elapsedNs);
     
     // 限制每种事件类型的记录数量
     if (m_eventTimings[data.eventType].size() > 1000) {
@@ -111,7 +195,10 @@ EventPerformanceAnalyzer::getEventTypeMetrics(QEvent::Type eventType) const
         return PerformanceMetrics();
     }
     
-    return calculateMetrics(m_eventTimings[eventType]);
+    PerformanceMetrics metrics = calculateMetrics(m_eventTimings[eventType]);
+    metrics.hardwareCounters = m_eventCounters.value(eventType);
+    metrics.allocationStats = m_eventAllocations.value(eventType);
+    return metrics;
 }
 
 EventPerformanceAnalyzer::PerformanceMetrics 
@@ -123,7 +210,27 @@ EventPerformanceAnalyzer::getObjectMetrics(QObject* object) const
         return PerformanceMetrics();
     }
     
-    return calculateMetrics(m_objectTimings[object]);
+    PerformanceMetrics metrics = calculateMetrics(m_objectTimings[object]);
+    if (object) {
+        QString className = QString::fromLatin1(object->metaObject()->className());
+        metrics.hardwareCounters = m_classCounters.value(className);
+        metrics.allocationStats = m_classAllocations.value(className);
+    }
+    return metrics;
+}
+
+QHash<QString, EventPerformanceAnalyzer::HardwareCounters>
+EventPerformanceAnalyzer::getReceiverClassCounters() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_classCounters;
+}
+
+QHash<QString, EventPerformanceAnalyzer::AllocationStats>
+EventPerformanceAnalyzer::getReceiverClassAllocations() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_classAllocations;
 }
 
 EventPerformanceAnalyzer::PerformanceMetrics 
@@ -133,12 +240,35 @@ EventPerformanceAnalyzer::getOverallMetrics() const
     
     QList<qint64> allTimings;
     
+    HardwareCounters allCounters;
+    
     // 收集所有计时数据
     for (auto it = m_eventTimings.begin(); it != m_eventTimings.end(); ++it) {
         allTimings.append(it.value());
     }
     
-    return calculateMetrics(allTimings);
+    // 汇总硬件计数器
+    for (auto it = m_eventCounters.begin(); it != m_eventCounters.end(); ++it) {
+        allCounters.cycles += it.value().cycles;
+        allCounters.instructions += it.value().instructions;
+        allCounters.cacheMisses += it.value().cacheMisses;
+        allCounters.branchMisses += it.value().branchMisses;
+        allCounters.sampleCount += it.value().sampleCount;
+    }
+    
+    // 汇总堆分配
+    AllocationStats allAllocations;
+    for (auto it = m_eventAllocations.begin(); it != m_eventAllocations.end(); ++it) {
+        allAllocations.allocations += it.value().allocations;
+        allAllocations.allocatedBytes += it.value().allocatedBytes;
+        allAllocations.deallocations += it.value().deallocations;
+        allAllocations.sampleCount += it.value().sampleCount;
+    }
+    
+    PerformanceMetrics metrics = calculateMetrics(allTimings);
+    metrics.hardwareCounters = allCounters;
+    metrics.allocationStats = allAllocations;
+    return metrics;
 }
 
 QList<EventPerformanceAnalyzer::OptimizationSuggestion> 
@@ -154,6 +284,8 @@ EventPerformanceAnalyzer::analyzePerformance() const
     QMutexLocker locker(&m_dataMutex);
     for (auto it = m_eventTimings.begin(); it != m_eventTimings.end(); ++it) {
         PerformanceMetrics metrics = calculateMetrics(it.value());
+        metrics.hardwareCounters = m_eventCounters.value(it.key());
+        metrics.allocationStats = m_eventAllocations.value(it.key());
         QList<OptimizationSuggestion> typeIssues = detectIssues(metrics);
         
         // 为每个建议添加事件类型信息
@@ -165,6 +297,53 @@ EventPerformanceAnalyzer::analyzePerformance() const
         suggestions.append(typeIssues);
     }
     
+    // 按接收者类名分析硬件计数器和堆分配
+    QSet<QString> classNames;
+    for (auto it = m_classCounters.begin(); it != m_classCounters.end(); ++it) {
+        classNames.insert(it.key());
+    }
+    for (auto it = m_classAllocations.begin(); it != m_classAllocations.end(); ++it) {
+        classNames.insert(it.key());
+    }
+    for (const QString& className : classNames) {
+        PerformanceMetrics metrics;
+        metrics.minProcessingTime = 0;
+        metrics.hardwareCounters = m_classCounters.value(className);
+        metrics.allocationStats = m_classAllocations.value(className);
+        metrics.eventCount = qMax(metrics.hardwareCounters.sampleCount, metrics.allocationStats.sampleCount);
+        
+        for (OptimizationSuggestion& suggestion : detectIssues(metrics)) {
+            suggestion.description = QString("[%1] %2").arg(className, suggestion.description);
+            suggestions.append(suggestion);
+        }
+    }
+    
+    // 根据看门狗捕获的停顿给出带归因的建议
+    const int recentStallCount = 5;
+    for (int i = qMax(0, m_stallRecords.size() - recentStallCount); i < m_stallRecords.size(); ++i) {
+        const StallRecord& stall = m_stallRecords.at(i);
+        QString culprit = stall.eventType == QEvent::None
+            ? QString("未插桩的处理")
+            : QString("%1 -> %2").arg(EventManager::instance()->getEventTypeName(stall.eventType),
+                                      stall.receiverClass.isEmpty() ? QString("?") : stall.receiverClass);
+        
+        if (!stall.finished) {
+            suggestions.append(OptimizationSuggestion(
+                DeadLock,
+                QString("[%1] 主线程已停顿 %2ms 且尚未恢复").arg(culprit).arg(stall.durationMs),
+                "检查该处理函数中的阻塞调用、锁等待或死循环",
+                10
+            ));
+        } else {
+            suggestions.append(OptimizationSuggestion(
+                Bottleneck,
+                QString("[%1] 主线程停顿 %2ms").arg(culprit).arg(stall.durationMs),
+                "将耗时工作移出GUI线程，或拆分为多个小批次处理",
+                9
+            ));
+        }
+    }
+    
     // 按优先级排序
     std::sort(suggestions.begin(), suggestions.end(), 
               [](const OptimizationSuggestion& a, const OptimizationSuggestion& b) {
@@ -227,7 +406,19 @@ void EventPerformanceAnalyzer::resetAnalysis()
     m_eventTimings.clear();
     m_objectTimings.clear();
     m_trendData.clear();
+    m_eventCounters.clear();
+    m_classCounters.clear();
+    m_eventAllocations.clear();
+    m_classAllocations.clear();
+    m_stallRecords.clear();
+    m_eventLoopLags.clear();
+    m_eventHistograms.clear();
+    m_lagHistogram = LatencyHistogram();
+    m_totalStalls = 0;
     m_nextTimerId = 1;
+    locker.unlock();
+
+    publishExportSnapshot();
     
     qDebug() << "Performance analysis data reset";
 }
@@ -255,6 +446,171 @@ void EventPerformanceAnalyzer::setPerformanceThresholds(double slowThresholdMs,
              << "ms, high frequency =" << highFrequencyThreshold << "events/sec";
 }
 
+bool EventPerformanceAnalyzer::setHardwareCountersEnabled(bool enabled)
+{
+    // 在调用线程上打开计数器，以便立即报告是否可用
+    bool available = HardwareCounterSampler::forCurrentThread()->isAvailable();
+    
+    QMutexLocker locker(&m_configMutex);
+    m_hardwareCountersEnabled = enabled;
+    
+    qDebug() << "Hardware counter sampling" << (enabled ? "enabled" : "disabled")
+             << "- available:" << available;
+    
+    return available;
+}
+
+bool EventPerformanceAnalyzer::isHardwareCountersEnabled() const
+{
+    QMutexLocker locker(&m_configMutex);
+    return m_hardwareCountersEnabled;
+}
+
+bool EventPerformanceAnalyzer::setAllocationTrackingEnabled(bool enabled)
+{
+    // 分配计数是进程级开关，由AllocationProfiler自身保存
+    bool supported = AllocationProfiler::setEnabled(enabled);
+    
+    qDebug() << "Allocation tracking" << (enabled ? "enabled" : "disabled")
+             << "- supported:" << supported;
+    
+    return supported;
+}
+
+bool EventPerformanceAnalyzer::isAllocationTrackingEnabled() const
+{
+    return AllocationProfiler::isEnabled();
+}
+
+void EventPerformanceAnalyzer::startStallDetection(int pingIntervalMs, int stallThresholdMs)
+{
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app) {
+        qWarning() << "EventPerformanceAnalyzer::startStallDetection: no application instance";
+        return;
+    }
+
+    stopStallDetection();
+
+    m_watchdog = new EventLoopWatchdog(app, pingIntervalMs, stallThresholdMs, this);
+    connect(app, &QCoreApplication::aboutToQuit, this, &EventPerformanceAnalyzer::stopStallDetection,
+            Qt::UniqueConnection);
+    m_watchdog->start();
+}
+
+void EventPerformanceAnalyzer::stopStallDetection()
+{
+    if (m_watchdog) {
+        m_watchdog->stop();
+        delete m_watchdog;
+        m_watchdog = nullptr;
+    }
+}
+
+bool EventPerformanceAnalyzer::isStallDetectionRunning() const
+{
+    return m_watchdog && m_watchdog->isRunning();
+}
+
+EventPerformanceAnalyzer::DispatchInfo EventPerformanceAnalyzer::currentGuiDispatch() const
+{
+    // 两个字段分别读取，可能短暂不一致，对停顿归因足够
+    DispatchInfo info;
+    info.eventType = static_cast<QEvent::Type>(m_guiEventType.loadAcquire());
+    info.receiverClass = m_guiReceiverClass.loadAcquire();
+    return info;
+}
+
+void EventPerformanceAnalyzer::recordStall(const StallRecord& record)
+{
+    QMutexLocker locker(&m_dataMutex);
+    
+    // 同一停顿结束时覆盖进行中的记录
+    if (!m_stallRecords.isEmpty() && !m_stallRecords.last().finished) {
+        m_stallRecords.last() = record;
+    } else {
+        m_stallRecords.append(record);
+        ++m_totalStalls;
+    }
+    
+    // 限制停顿记录数量
+    if (m_stallRecords.size() > 100) {
+        m_stallRecords.removeFirst();
+    }
+}
+
+void EventPerformanceAnalyzer::recordEventLoopLag(qint64 lagNs)
+{
+    QMutexLocker locker(&m_dataMutex);
+    
+    m_eventLoopLags.append(lagNs);
+    m_lagHistogram.record(lagNs);
+    if (m_eventLoopLags.size() > 1000) {
+        m_eventLoopLags.removeFirst();
+    }
+}
+
+QList<EventPerformanceAnalyzer::StallRecord> EventPerformanceAnalyzer::getStallRecords() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_stallRecords;
+}
+
+EventPerformanceAnalyzer::PerformanceMetrics EventPerformanceAnalyzer::getEventLoopLagMetrics() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return calculateMetrics(m_eventLoopLags);
+}
+
+QHash<QEvent::Type, EventPerformanceAnalyzer::LatencyHistogram>
+EventPerformanceAnalyzer::getLatencyHistograms() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_eventHistograms;
+}
+
+EventPerformanceAnalyzer::LatencyHistogram EventPerformanceAnalyzer::getEventLoopLagHistogram() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_lagHistogram;
+}
+
+quint64 EventPerformanceAnalyzer::getTotalStallCount() const
+{
+    QMutexLocker locker(&m_dataMutex);
+    return m_totalStalls;
+}
+
+std::shared_ptr<const EventPerformanceAnalyzer::ExportSnapshot> EventPerformanceAnalyzer::exportSnapshot() const
+{
+    return std::atomic_load(&m_exportSnapshot);
+}
+
+void EventPerformanceAnalyzer::publishExportSnapshot()
+{
+    auto snapshot = std::make_shared<ExportSnapshot>();
+    {
+        // QHash为隐式共享，加锁期间只增加引用计数
+        QMutexLocker locker(&m_dataMutex);
+        snapshot->eventHistograms = m_eventHistograms;
+        snapshot->eventCounters = m_eventCounters;
+        snapshot->lagHistogram = m_lagHistogram;
+        snapshot->totalStalls = m_totalStalls;
+    }
+
+    // 类型名称在发布线程解析一次，导出线程不必获取EventManager的锁
+    EventManager* manager = EventManager::instance();
+    for (auto it = snapshot->eventHistograms.constBegin(); it != snapshot->eventHistograms.constEnd(); ++it) {
+        snapshot->typeNames.insert(it.key(), manager->getEventTypeName(it.key()));
+    }
+    for (auto it = snapshot->eventCounters.constBegin(); it != snapshot->eventCounters.constEnd(); ++it) {
+        if (!snapshot->typeNames.contains(it.key())) {
+            snapshot->typeNames.insert(it.key(), manager->getEventTypeName(it.key()));
+        }
+    }
+    std::atomic_store(&m_exportSnapshot, std::shared_ptr<const ExportSnapshot>(std::move(snapshot)));
+}
+
 void EventPerformanceAnalyzer::performPeriodicAnalysis()
 {
     QMutexLocker configLocker(&m_configMutex);
@@ -327,6 +683,70 @@ EventPerformanceAnalyzer::detectIssues(const PerformanceMetrics& metrics) const
     int highFreqThreshold = m_highFrequencyThreshold;
     configLocker.unlock();
 
+    // 检查硬件计数器反映的微架构瓶颈
+    const HardwareCounters& counters = metrics.hardwareCounters;
+    if (counters.sampleCount > 0 && counters.instructions > 0) {
+        double ipc = counters.instructionsPerCycle();
+        double cacheMpki = counters.cacheMissesPerKiloInstruction();
+        double branchMpki = counters.branchMissesPerKiloInstruction();
+        
+        if (cacheMpki > 10.0) {
+            OptimizationSuggestion suggestion(
+                CacheBound,
+                QString("缓存未命中率高: %1 次/千指令, IPC %2")
+                    .arg(cacheMpki, 0, 'f', 1).arg(ipc, 0, 'f', 2),
+                "处理受内存访问限制，考虑使用连续存储、减少指针追踪或复用缓冲区",
+                ipc < 0.5 ? 8 : 6
+            );
+            issues.append(suggestion);
+        }
+        
+        if (branchMpki > 5.0) {
+            OptimizationSuggestion suggestion(
+                BranchBound,
+                QString("分支预测失败率高: %1 次/千指令, IPC %2")
+                    .arg(branchMpki, 0, 'f', 1).arg(ipc, 0, 'f', 2),
+                "处理受分支预测限制，考虑按事件类型分批处理或用查表替代条件分支",
+                ipc < 0.5 ? 7 : 5
+            );
+            issues.append(suggestion);
+        }
+    }
+    
+    // 检查堆分配频率
+    const AllocationStats& allocations = metrics.allocationStats;
+    if (allocations.sampleCount > 0) {
+        double allocsPerEvent = allocations.allocationsPerEvent();
+        double bytesPerEvent = allocations.bytesPerEvent();
+        
+        if (allocsPerEvent > 20.0 || bytesPerEvent > 64.0 * 1024.0) {
+            OptimizationSuggestion suggestion(
+                HeapChurn,
+                QString("堆分配频繁: 平均每个事件 %1 次分配, %2 字节")
+                    .arg(allocsPerEvent, 0, 'f', 1).arg(bytesPerEvent, 0, 'f', 0),
+                "考虑复用缓冲区、预留容器容量或使用事件对象池，避免在处理函数中构造临时对象",
+                7
+            );
+            issues.append(suggestion);
+        }
+        
+        // 分配远多于释放：处理函数把内存留在了堆上
+        if (allocations.allocations > allocations.deallocations + static_cast<quint64>(allocations.sampleCount) * 4) {
+            OptimizationSuggestion suggestion(
+                MemoryLeak,
+                QString("分配多于释放: %1 次分配, %2 次释放")
+                    .arg(allocations.allocations).arg(allocations.deallocations),
+                "检查处理函数中是否有未释放的对象或无限增长的缓存",
+                6
+            );
+            issues.append(suggestion);
+        }
+    }
+    
+    if (metrics.totalProcessingTime == 0) {
+        return issues; // 只有计数器数据
+    }
+
     // 检查处理速度慢的问题
     double avgTimeMs = static_cast<double>(metrics.avgProcessingTime) / 1000000.0;
     if (avgTimeMs > slowThreshold) {
@@ -370,9 +790,18 @@ void EventPerformanceAnalyzer::updateTrendData()
     // 注意：此方法应在已获取m_dataMutex锁的情况下调用
     QDateTime now = QDateTime::currentDateTime();
     
-    // 计算当前的平均处理时间
-    PerformanceMetrics currentMetrics = getOverallMetrics();
-    double avgTimeMs = static_cast<double>(currentMetrics.avgProcessingTime) / 1000000.0;
+    // 计算当前的平均处理时间（直接遍历，getOverallMetrics会再次加锁）
+    qint64 totalTime = 0;
+    int totalCount = 0;
+    for (auto it = m_eventTimings.begin(); it != m_eventTimings.end(); ++it) {
+        for (qint64 timing : it.value()) {
+            totalTime += timing;
+        }
+        totalCount += it.value().size();
+    }
+    double avgTimeMs = totalCount > 0
+        ? static_cast<double>(totalTime) / totalCount / 1000000.0
+        : 0.0;
     
     m_trendData.append(qMakePair(now, avgTimeMs));
     
@@ -8,6 +8,13 @@
 #include <QMutex>
 #include <QTimer>
 #include <QDateTime>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <memory>
+#include "hardware_counter_sampler.h"
+#include "allocation_profiler.h"
+
+class EventLoopWatchdog;
 
 /**
  * @brief EventPerformanceAnalyzer 事件性能分析器
@@ -20,6 +27,74 @@ class EventPerformanceAnalyzer : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief 硬件计数器累计值（需启用硬件计数器采样）
+     */
+    struct HardwareCounters {
+        quint64 cycles;                 // CPU周期数
+        quint64 instructions;           // 退休指令数
+        quint64 cacheMisses;            // 缓存未命中次数
+        quint64 branchMisses;           // 分支预测失败次数
+        int sampleCount;                // 有效采样次数
+
+        HardwareCounters()
+            : cycles(0), instructions(0), cacheMisses(0),
+              branchMisses(0), sampleCount(0) {}
+
+        void accumulate(const HardwareCounterSampler::Sample& sample) {
+            cycles += sample.cycles;
+            instructions += sample.instructions;
+            cacheMisses += sample.cacheMisses;
+            branchMisses += sample.branchMisses;
+            ++sampleCount;
+        }
+
+        // 每周期指令数
+        double instructionsPerCycle() const {
+            return cycles > 0 ? static_cast<double>(instructions) / cycles : 0.0;
+        }
+
+        // 每千条指令的缓存未命中数
+        double cacheMissesPerKiloInstruction() const {
+            return instructions > 0 ? cacheMisses * 1000.0 / instructions : 0.0;
+        }
+
+        // 每千条指令的分支预测失败数
+        double branchMissesPerKiloInstruction() const {
+            return instructions > 0 ? branchMisses * 1000.0 / instructions : 0.0;
+        }
+    };
+
+    /**
+     * @brief 堆分配累计值（需启用分配跟踪）
+     */
+    struct AllocationStats {
+        quint64 allocations;            // 分配次数
+        quint64 allocatedBytes;         // 分配字节数
+        quint64 deallocations;          // 释放次数
+        int sampleCount;                // 有效采样次数
+
+        AllocationStats()
+            : allocations(0), allocatedBytes(0), deallocations(0), sampleCount(0) {}
+
+        void accumulate(const AllocationProfiler::Counters& counters) {
+            allocations += counters.allocations;
+            allocatedBytes += counters.allocatedBytes;
+            deallocations += counters.deallocations;
+            ++sampleCount;
+        }
+
+        // 每个事件的平均分配次数
+        double allocationsPerEvent() const {
+            return sampleCount > 0 ? static_cast<double>(allocations) / sampleCount : 0.0;
+        }
+
+        // 每个事件的平均分配字节数
+        double bytesPerEvent() const {
+            return sampleCount > 0 ? static_cast<double>(allocatedBytes) / sampleCount : 0.0;
+        }
+    };
+
     /**
      * @brief 性能指标结构体
      */
@@ -32,6 +107,8 @@ public:
         double eventsPerSecond;         // 每秒事件数
         QDateTime firstEventTime;       // 第一个事件时间
         QDateTime lastEventTime;        // 最后一个事件时间
+        HardwareCounters hardwareCounters; // 硬件计数器（未启用时sampleCount为0）
+        AllocationStats allocationStats;   // 堆分配统计（未启用时sampleCount为0）
         
         PerformanceMetrics() 
             : totalProcessingTime(0), minProcessingTime(LLONG_MAX), 
@@ -48,7 +125,10 @@ public:
         HighFrequency = 2,      // 事件频率过高
         MemoryLeak = 4,         // 可能的内存泄漏
         DeadLock = 8,           // 可能的死锁
-        Bottleneck = 16         // 性能瓶颈
+        Bottleneck = 16,        // 性能瓶颈
+        CacheBound = 32,        // 受缓存未命中限制
+        BranchBound = 64,       // 受分支预测失败限制
+        HeapChurn = 128         // 频繁的堆分配
     };
     Q_DECLARE_FLAGS(PerformanceIssues, PerformanceIssue)
 
@@ -68,6 +148,71 @@ public:
             : issue(i), description(desc), suggestion(sugg), priority(prio) {}
     };
 
+    /**
+     * @brief 累计延迟直方图（自重置以来单调递增，供指标导出）
+     */
+    struct LatencyHistogram {
+        enum { BucketCount = 10 };
+        static const qint64 BucketBoundsNs[BucketCount];   // 各桶上界（纳秒），超出最后一桶计入+Inf
+
+        quint64 buckets[BucketCount];   // 落入各桶的次数（非累计）
+        quint64 count;                  // 总次数
+        qint64 sumNs;                   // 总耗时（纳秒）
+
+        LatencyHistogram() : count(0), sumNs(0) {
+            for (int i = 0; i < BucketCount; ++i) {
+                buckets[i] = 0;
+            }
+        }
+
+        void record(qint64 ns) {
+            for (int i = 0; i < BucketCount; ++i) {
+                if (ns <= BucketBoundsNs[i]) {
+                    ++buckets[i];
+                    break;
+                }
+            }
+            ++count;
+            sumNs += ns;
+        }
+    };
+
+    /**
+     * @brief 主线程停顿记录
+     */
+    struct StallRecord {
+        QDateTime startTime;        // 停顿开始时间（估算）
+        qint64 durationMs;          // 停顿持续时间（毫秒）
+        QEvent::Type eventType;     // 停顿时正在处理的事件类型，None表示未插桩的处理
+        QString receiverClass;      // 停顿时正在处理事件的接收者类名
+        bool finished;              // 停顿是否已结束
+
+        StallRecord() : durationMs(0), eventType(QEvent::None), finished(false) {}
+    };
+
+    /**
+     * @brief 导出快照：累计直方图和计数器的不可变副本（供指标导出）
+     */
+    struct ExportSnapshot {
+        QHash<QEvent::Type, LatencyHistogram> eventHistograms;      // 各事件类型的处理时间直方图
+        QHash<QEvent::Type, HardwareCounters> eventCounters;        // 各事件类型的硬件计数器
+        LatencyHistogram lagHistogram;                              // 事件循环延迟直方图
+        quint64 totalStalls;                                        // 停顿总数
+        QHash<QEvent::Type, QString> typeNames;                     // 快照中出现的事件类型名称
+
+        ExportSnapshot() : totalStalls(0) {}
+    };
+
+    /**
+     * @brief GUI线程当前分派信息（供看门狗线程读取）
+     */
+    struct DispatchInfo {
+        QEvent::Type eventType;     // 正在处理的事件类型
+        const char* receiverClass;  // 接收者类名（指向元对象的静态字符串）
+
+        DispatchInfo() : eventType(QEvent::None), receiverClass(nullptr) {}
+    };
+
     /**
      * @brief 获取单例实例
      * @return 性能分析器实例
@@ -102,6 +247,18 @@ public:
      */
     PerformanceMetrics getObjectMetrics(QObject* object) const;
 
+    /**
+     * @brief 获取按接收者类名聚合的硬件计数器
+     * @return 类名到硬件计数器的映射
+     */
+    QHash<QString, HardwareCounters> getReceiverClassCounters() const;
+
+    /**
+     * @brief 获取按接收者类名聚合的堆分配统计
+     * @return 类名到分配统计的映射
+     */
+    QHash<QString, AllocationStats> getReceiverClassAllocations() const;
+
     /**
      * @brief 获取总体性能指标
      * @return 总体性能指标
@@ -152,6 +309,106 @@ public:
      */
     void setPerformanceThresholds(double slowThresholdMs, int highFrequencyThreshold);
 
+    /**
+     * @brief 启用或禁用硬件计数器采样（Linux perf_event_open）
+     * @param enabled 是否启用
+     * @return 当前线程上计数器是否可用，不可用时仅记录耗时
+     */
+    bool setHardwareCountersEnabled(bool enabled);
+
+    /**
+     * @brief 检查硬件计数器采样是否启用
+     * @return 是否启用
+     */
+    bool isHardwareCountersEnabled() const;
+
+    /**
+     * @brief 启用或禁用堆分配跟踪
+     * @param enabled 是否启用
+     * @return 是否编译了分配钩子（ENABLE_ALLOCATION_PROFILER），不支持时仅记录耗时
+     */
+    bool setAllocationTrackingEnabled(bool enabled);
+
+    /**
+     * @brief 检查堆分配跟踪是否启用
+     * @return 是否启用
+     */
+    bool isAllocationTrackingEnabled() const;
+
+    /**
+     * @brief 启动事件循环看门狗，测量GUI线程响应延迟并归因停顿
+     * @param pingIntervalMs ping间隔（毫秒）
+     * @param stallThresholdMs 停顿阈值（毫秒）
+     */
+    void startStallDetection(int pingIntervalMs = 10, int stallThresholdMs = 100);
+
+    /**
+     * @brief 停止事件循环看门狗
+     */
+    void stopStallDetection();
+
+    /**
+     * @brief 检查看门狗是否在运行
+     * @return 是否在运行
+     */
+    bool isStallDetectionRunning() const;
+
+    /**
+     * @brief 获取GUI线程当前正在处理的事件（可从任意线程调用）
+     * @return 分派信息
+     */
+    DispatchInfo currentGuiDispatch() const;
+
+    /**
+     * @brief 记录一次停顿（同一停顿进行中和结束时各调用一次）
+     * @param record 停顿记录
+     */
+    void recordStall(const StallRecord& record);
+
+    /**
+     * @brief 记录一次事件循环延迟采样
+     * @param lagNs 延迟（纳秒）
+     */
+    void recordEventLoopLag(qint64 lagNs);
+
+    /**
+     * @brief 获取停顿记录
+     * @return 停顿记录列表（按时间顺序）
+     */
+    QList<StallRecord> getStallRecords() const;
+
+    /**
+     * @brief 获取事件循环延迟指标（处理时间字段即延迟）
+     * @return 延迟指标
+     */
+    PerformanceMetrics getEventLoopLagMetrics() const;
+
+    /**
+     * @brief 获取各事件类型的累计处理时间直方图
+     * @return 事件类型到直方图的映射
+     */
+    QHash<QEvent::Type, LatencyHistogram> getLatencyHistograms() const;
+
+    /**
+     * @brief 获取事件循环延迟的累计直方图
+     * @return 延迟直方图
+     */
+    LatencyHistogram getEventLoopLagHistogram() const;
+
+    /**
+     * @brief 获取自重置以来检测到的停顿总数
+     * @return 停顿总数
+     */
+    quint64 getTotalStallCount() const;
+
+    /**
+     * @brief 获取最新发布的导出快照（无锁，可从任意线程调用）
+     *
+     * 快照由分析器所在线程每秒发布一次，读取方不会与事件计时争用m_dataMutex。
+     * @return 导出快照，不为空
+     */
+    std::shared_ptr<const ExportSnapshot> exportSnapshot() const;
+
 signals:
     /**
      * @brief 检测到性能问题时发出的信号
@@ -205,14 +462,26 @@ private:
      */
     void updateTrendData();
 
+    /**
+     * @brief 复制累计数据并原子发布导出快照（在分析器所在线程调用）
+     */
+    void publishExportSnapshot();
+
     // 计时器数据结构
     struct TimingData {
         QElapsedTimer timer;
         QEvent::Type eventType;
         QObject* object;
         QDateTime startTime;
+        HardwareCounterSampler::Sample counterStart;    // 开始时的计数器读数
+        bool countersValid;                             // 是否采到了起始读数
+        bool onGuiThread;                               // 是否在GUI线程中计时
+        AllocationProfiler::Counters allocationStart;   // 开始时的分配计数
+        bool allocationsValid;                          // 是否采到了起始分配计数
+        DispatchInfo previousDispatch;                  // 嵌套分派时外层的分派信息
         
-        TimingData() : eventType(QEvent::None), object(nullptr) {}
+        TimingData() : eventType(QEvent::None), object(nullptr), countersValid(false),
+                       onGuiThread(false), allocationsValid(false) {}
     };
 
     // 静态实例
@@ -224,17 +493,38 @@ private:
     QHash<QEvent::Type, QList<qint64>> m_eventTimings;  // 事件类型计时数据
     QHash<QObject*, QList<qint64>> m_objectTimings;     // 对象计时数据
     QList<QPair<QDateTime, double>> m_trendData;        // 趋势数据
+    QHash<QEvent::Type, HardwareCounters> m_eventCounters;  // 事件类型硬件计数器
+    QHash<QString, HardwareCounters> m_classCounters;       // 接收者类名硬件计数器
+    QHash<QEvent::Type, AllocationStats> m_eventAllocations;    // 事件类型堆分配统计
+    QHash<QString, AllocationStats> m_classAllocations;         // 接收者类名堆分配统计
+    QList<StallRecord> m_stallRecords;                  // 停顿记录
+    QList<qint64> m_eventLoopLags;                      // 事件循环延迟采样
+    QHash<QEvent::Type, LatencyHistogram> m_eventHistograms;    // 累计处理时间直方图
+    LatencyHistogram m_lagHistogram;                    // 累计事件循环延迟直方图
+    quint64 m_totalStalls;                              // 停顿总数
+    
+    // GUI线程当前分派（无锁，供看门狗线程读取）
+    QAtomicInteger<int> m_guiEventType;
+    QAtomicPointer<const char> m_guiReceiverClass;
+    
+    // 事件循环看门狗
+    EventLoopWatchdog* m_watchdog;
     
     // 配置
     bool m_enabled;
     double m_slowThresholdMs;           // 慢处理阈值（毫秒）
     int m_highFrequencyThreshold;      // 高频率阈值（每秒事件数）
+    bool m_hardwareCountersEnabled;    // 是否采样硬件计数器
     
     // 计时器和互斥锁
     QTimer* m_analysisTimer;
+    QTimer* m_exportTimer;
     int m_nextTimerId;
     mutable QMutex m_dataMutex;
     mutable QMutex m_configMutex;
+
+    // 通过 std::atomic_load / std::atomic_store 访问
+    std::shared_ptr<const ExportSnapshot> m_exportSnapshot;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(EventPerformanceAnalyzer::PerformanceIssues)
@@ -0,0 +1,856 @@
+#include "event_pool.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#define EVENT_POOL_HAS_BACKTRACE
+#endif
+
+namespace {
+
+// 仓库栈顶：低32位为弹匣索引+1（0表示空栈），高32位为版本号
+const quint64 DepotIndexMask = 0xffffffffULL;
+
+std::atomic<quint64> g_nextPoolSerial(1);
+
+// 存活的事件池，线程退出时据此判断绑定的池是否已销毁
+QMutex g_livePoolsMutex;
+QHash<quint64, EventStoragePool*> g_livePools;
+
+// 单写者计数器：只有绑定线程写入，其他线程只读统计
+inline void bumpCounter(std::atomic<quint64>& counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void addCached(std::atomic<int>& cached, int delta)
+{
+    cached.store(cached.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+inline std::size_t roundUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 最小slab大小，slab按自身大小对齐，块地址按掩码即可找到所属slab
+const std::size_t MinSlabBytes = 64 * 1024;
+const int MinBlocksPerSlab = 8;
+
+/**
+ * @brief 把内存区域的页面放置策略设为本地节点
+ *
+ * MPOL_LOCAL：页面分配在首次触碰它的线程所在的NUMA节点。内核不支持
+ * NUMA或系统调用失败时保持默认策略（通常同样是首次触碰）。
+ */
+void bindToLocalNode(void* address, std::size_t length)
+{
+#if defined(Q_OS_LINUX) && defined(SYS_mbind)
+    const int MpolLocal = 4;
+    syscall(SYS_mbind, address, length, MpolLocal, nullptr, 0UL, 0U);
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(length);
+#endif
+}
+
+int currentNumaNode()
+{
+#if defined(Q_OS_LINUX) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return -1;
+}
+
+} // namespace
+
+/**
+ * @brief slab头部，独占slab开头的若干缓存行，之后是等距排列的块
+ */
+struct EventStoragePool::Slab
+{
+    int blockCount;
+    int numaNode;
+};
+
+struct alignas(EventStoragePool::CacheLineSize) EventStoragePool::Magazine
+{
+    void* rounds[MagazineSize];
+    int count;
+    std::atomic<quint32> next;
+
+    Magazine() : count(0), next(0) {}
+};
+
+// 线程缓存按缓存行对齐，不同线程的热点状态不会落在同一缓存行
+struct alignas(EventStoragePool::CacheLineSize) EventStoragePool::ThreadCache
+{
+    Magazine storage[2];
+    Magazine* loaded;
+    Magazine* previous;
+    std::atomic<int> cachedCount;
+    std::atomic<quint64> fastAcquires;
+    std::atomic<quint64> fastReleases;
+    std::atomic<quint64> depotExchanges;
+    std::atomic<quint64> depotRefills;
+    bool bound;     // 受m_mutex保护
+
+    ThreadCache()
+        : loaded(&storage[0]), previous(&storage[1]), cachedCount(0)
+        , fastAcquires(0), fastReleases(0), depotExchanges(0), depotRefills(0), bound(false) {}
+};
+
+struct EventStoragePool::AuditState
+{
+    enum { MaxFrames = 8 };
+
+    struct Entry {
+        const char* site;
+        Qt::HANDLE thread;
+        qint64 acquiredMs;
+        void* frames[MaxFrames];
+        int frameCount;
+    };
+
+    mutable QMutex mutex;
+    QElapsedTimer clock;
+    QHash<const void*, Entry> outstanding;
+    QSet<const void*> released;     // 审计期间已归还且尚未再次获取的块
+    quint64 doubleReleases;
+    std::atomic<bool> captureBacktraces;
+
+    AuditState() : doubleReleases(0), captureBacktraces(false) { clock.start(); }
+};
+
+/**
+ * @brief 线程到事件池缓存的绑定表
+ *
+ * 线程退出时把仍存活的池的本地弹匣归还仓库，缓存本身留给池复用。
+ */
+struct EventPoolThreadBindings
+{
+    struct Binding {
+        EventStoragePool* pool;
+        quint64 serial;
+        EventStoragePool::ThreadCache* cache;
+    };
+
+    QVarLengthArray<Binding, 4> bindings;
+
+    ~EventPoolThreadBindings()
+    {
+        QMutexLocker locker(&g_livePoolsMutex);
+        for (const Binding& binding : bindings) {
+            if (g_livePools.value(binding.serial) == binding.pool) {
+                binding.pool->retireThreadCache(binding.cache);
+            }
+        }
+    }
+};
+
+namespace {
+thread_local EventPoolThreadBindings t_poolBindings;
+}
+
+EventStoragePool::EventStoragePool(std::size_t blockSize, int initialSize,
+                                   BlockHook constructBlock, BlockHook destroyBlock)
+    : m_magazineCount(qMax(16, initialSize * 2 / MagazineSize + 16))
+    , m_fullDepot(0)
+    , m_emptyDepot(0)
+    , m_depotEvents(0)
+    , m_casRetries(0)
+    , m_auditEnabled(false)
+    , m_slowPathAcquires(0)
+    , m_overflowSpills(0)
+    , m_allocationMisses(0)
+    , m_growthStep(qMax(static_cast<int>(MagazineSize), initialSize / 2))
+    , m_overflowCount(0)
+    , m_audit(nullptr)
+    , m_totalEvents(0)
+    , m_blockSize(blockSize)
+    , m_blockStride(roundUp(qMax<std::size_t>(blockSize, 1), CacheLineSize))
+    , m_slabHeaderBytes(roundUp(sizeof(Slab), CacheLineSize))
+    , m_slabBytes(MinSlabBytes)
+    , m_blocksPerSlab(0)
+    , m_initialSize(initialSize)
+    , m_serial(g_nextPoolSerial.fetch_add(1, std::memory_order_relaxed))
+    , m_constructBlock(constructBlock)
+    , m_destroyBlock(destroyBlock)
+{
+    // slab至少容纳MinBlocksPerSlab个块，大小保持为2的幂以便按掩码定位
+    while (m_slabBytes - m_slabHeaderBytes < m_blockStride * MinBlocksPerSlab) {
+        m_slabBytes *= 2;
+    }
+    m_blocksPerSlab = static_cast<int>((m_slabBytes - m_slabHeaderBytes) / m_blockStride);
+
+    // 所有弹匣初始都在空弹匣栈中
+    m_magazines.reset(new Magazine[m_magazineCount]);
+    for (int i = 0; i < m_magazineCount; ++i) {
+        m_magazines[i].next.store(i + 1 < m_magazineCount ? i + 2 : 0, std::memory_order_relaxed);
+    }
+    m_emptyDepot.store(1, std::memory_order_release);
+
+    {
+        QMutexLocker locker(&g_livePoolsMutex);
+        g_livePools.insert(m_serial, this);
+    }
+
+    createBlocks(initialSize);
+}
+
+EventStoragePool::~EventStoragePool()
+{
+    {
+        QMutexLocker locker(&g_livePoolsMutex);
+        g_livePools.remove(m_serial);
+    }
+
+    // 析构时池已不再被其他线程使用，块都位于slab中，直接整块释放；
+    // 对象池先析构空闲块中的对象（未归还对象的析构函数不会执行）
+    if (m_destroyBlock) {
+        QList<void*> blocks;
+        drainShared(blocks);
+        for (ThreadCache* cache : m_threadCaches) {
+            for (Magazine* magazine : { cache->loaded, cache->previous }) {
+                for (int i = 0; i < magazine->count; ++i) {
+                    blocks.append(magazine->rounds[i]);
+                }
+            }
+        }
+        for (void* block : blocks) {
+            m_destroyBlock(block);
+        }
+    }
+    qDeleteAll(m_threadCaches);
+    m_threadCaches.clear();
+    delete m_audit.load(std::memory_order_acquire);
+
+    for (Slab* slab : m_slabs) {
+        slab->~Slab();
+        ::operator delete(static_cast<void*>(slab), std::align_val_t(m_slabBytes));
+    }
+    m_slabs.clear();
+}
+
+void* EventStoragePool::allocate()
+{
+    ThreadCache* cache = threadCache();
+
+    if (cache->loaded->count > 0) {
+        bumpCounter(cache->fastAcquires);
+    } else if (cache->previous->count > 0) {
+        std::swap(cache->loaded, cache->previous);
+        bumpCounter(cache->fastAcquires);
+    } else {
+        refill(cache);
+    }
+
+    void* block = cache->loaded->rounds[--cache->loaded->count];
+    addCached(cache->cachedCount, -1);
+    return block;
+}
+
+void EventStoragePool::deallocate(void* block)
+{
+    if (!block) return;
+
+    ThreadCache* cache = threadCache();
+
+    if (cache->loaded->count == MagazineSize) {
+        if (cache->previous->count == 0) {
+            std::swap(cache->loaded, cache->previous);
+        } else {
+            spill(cache);
+        }
+    }
+
+    cache->loaded->rounds[cache->loaded->count++] = block;
+    addCached(cache->cachedCount, 1);
+    bumpCounter(cache->fastReleases);
+}
+
+int EventStoragePool::availableEvents() const
+{
+    int available = m_depotEvents.load(std::memory_order_relaxed)
+                  + m_overflowCount.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    for (const ThreadCache* cache : m_threadCaches) {
+        available += cache->cachedCount.load(std::memory_order_relaxed);
+    }
+    return available;
+}
+
+EventStoragePool::ContentionStats EventStoragePool::contentionStats() const
+{
+    ContentionStats stats;
+    stats.casRetries = m_casRetries.load(std::memory_order_relaxed);
+    stats.slowPathAcquires = m_slowPathAcquires.load(std::memory_order_relaxed);
+    stats.overflowSpills = m_overflowSpills.load(std::memory_order_relaxed);
+    stats.allocationMisses = m_allocationMisses.load(std::memory_order_relaxed);
+    stats.acquires = stats.slowPathAcquires;
+
+    QMutexLocker locker(&m_mutex);
+    for (const ThreadCache* cache : m_threadCaches) {
+        stats.fastAcquires += cache->fastAcquires.load(std::memory_order_relaxed);
+        stats.fastReleases += cache->fastReleases.load(std::memory_order_relaxed);
+        stats.depotExchanges += cache->depotExchanges.load(std::memory_order_relaxed);
+        stats.acquires += cache->fastAcquires.load(std::memory_order_relaxed)
+                        + cache->depotRefills.load(std::memory_order_relaxed);
+        if (cache->bound) {
+            stats.threadCaches++;
+        }
+    }
+    return stats;
+}
+
+void EventStoragePool::expandPool(int additionalSize)
+{
+    createBlocks(additionalSize);
+}
+
+int EventStoragePool::slabCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_slabs.size();
+}
+
+qint64 EventStoragePool::reservedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<qint64>(m_slabs.size()) * static_cast<qint64>(m_slabBytes);
+}
+
+QHash<int, int> EventStoragePool::slabsPerNumaNode() const
+{
+    QHash<int, int> result;
+    QMutexLocker locker(&m_mutex);
+    for (const Slab* slab : m_slabs) {
+        result[slab->numaNode]++;
+    }
+    return result;
+}
+
+void EventStoragePool::shrinkPool()
+{
+    // 最多释放一半的共享可用内存块，线程本地弹匣不受影响
+    QList<void*> blocks;
+    int count = drainShared(blocks);
+    releaseFreeSlabs(blocks, count / 2);
+}
+
+int EventStoragePool::trimTo(int targetTotal)
+{
+    int excess = totalEvents() - qMax(0, targetTotal);
+    if (excess <= 0) {
+        return 0;
+    }
+
+    QList<void*> blocks;
+    drainShared(blocks);
+    return releaseFreeSlabs(blocks, excess);
+}
+
+void EventStoragePool::setGrowthStep(int blocks)
+{
+    m_growthStep.store(qMax(1, blocks), std::memory_order_relaxed);
+}
+
+void EventStoragePool::setAuditEnabled(bool enabled, bool captureBacktraces)
+{
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (enabled && !audit) {
+        QMutexLocker locker(&m_mutex);
+        audit = m_audit.load(std::memory_order_acquire);
+        if (!audit) {
+            audit = new AuditState();
+            m_audit.store(audit, std::memory_order_release);
+        }
+    }
+
+    if (audit) {
+        // 状态对象保留到池析构，已读到开启标志的线程仍可安全访问
+        QMutexLocker locker(&audit->mutex);
+        audit->outstanding.clear();
+        audit->released.clear();
+        audit->captureBacktraces.store(captureBacktraces, std::memory_order_relaxed);
+    }
+
+    m_auditEnabled.store(enabled, std::memory_order_release);
+}
+
+void EventStoragePool::auditAcquire(const void* block, const char* site)
+{
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (!audit) return;
+
+    AuditState::Entry entry;
+    entry.site = site;
+    entry.thread = QThread::currentThreadId();
+    entry.acquiredMs = audit->clock.elapsed();
+    entry.frameCount = 0;
+#ifdef EVENT_POOL_HAS_BACKTRACE
+    if (audit->captureBacktraces.load(std::memory_order_relaxed)) {
+        entry.frameCount = backtrace(entry.frames, AuditState::MaxFrames);
+    }
+#endif
+
+    QMutexLocker locker(&audit->mutex);
+    audit->outstanding.insert(block, entry);
+    audit->released.remove(block);
+}
+
+bool EventStoragePool::auditRelease(const void* block)
+{
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (!audit) return true;
+
+    {
+        QMutexLocker locker(&audit->mutex);
+        if (audit->outstanding.remove(block)) {
+            audit->released.insert(block);
+            return true;
+        }
+        if (!audit->released.contains(block)) {
+            // 审计开启之前获取的对象
+            return true;
+        }
+        audit->doubleReleases++;
+    }
+
+    qWarning().noquote() << QString("EventPool: 检测到重复释放 %1，已忽略本次释放")
+                            .arg(QString::asprintf("%p", block));
+#ifdef EVENT_POOL_HAS_BACKTRACE
+    void* frames[AuditState::MaxFrames];
+    int frameCount = backtrace(frames, AuditState::MaxFrames);
+    char** symbols = backtrace_symbols(frames, frameCount);
+    if (symbols) {
+        for (int i = 1; i < frameCount; ++i) {
+            qWarning().noquote() << "    " << symbols[i];
+        }
+        free(symbols);
+    }
+#endif
+    return false;
+}
+
+QList<EventStoragePool::AuditRecord> EventStoragePool::outstandingEvents(qint64 minHeldMs) const
+{
+    QList<AuditRecord> records;
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (!audit) return records;
+
+    QMutexLocker locker(&audit->mutex);
+    const qint64 now = audit->clock.elapsed();
+    for (auto it = audit->outstanding.constBegin(); it != audit->outstanding.constEnd(); ++it) {
+        const AuditState::Entry& entry = it.value();
+        if (now - entry.acquiredMs < minHeldMs) {
+            continue;
+        }
+
+        AuditRecord record;
+        record.object = it.key();
+        record.site = entry.site ? QString::fromUtf8(entry.site) : QString();
+        record.thread = entry.thread;
+        record.heldMs = now - entry.acquiredMs;
+#ifdef EVENT_POOL_HAS_BACKTRACE
+        if (entry.frameCount > 0) {
+            char** symbols = backtrace_symbols(entry.frames, entry.frameCount);
+            if (symbols) {
+                for (int i = 0; i < entry.frameCount; ++i) {
+                    record.backtrace.append(QString::fromLocal8Bit(symbols[i]));
+                }
+                free(symbols);
+            }
+        }
+#endif
+        records.append(record);
+    }
+    locker.unlock();
+
+    std::sort(records.begin(), records.end(), [](const AuditRecord& a, const AuditRecord& b) {
+        return a.heldMs > b.heldMs;
+    });
+    return records;
+}
+
+int EventStoragePool::reportLongHeldEvents(qint64 thresholdMs) const
+{
+    const QList<AuditRecord> records = outstandingEvents(thresholdMs);
+    for (const AuditRecord& record : records) {
+        qWarning().noquote() << QString("EventPool: 对象 %1 已持有 %2 ms，获取位置: %3")
+                                .arg(QString::asprintf("%p", record.object))
+                                .arg(record.heldMs)
+                                .arg(record.site.isEmpty() ? QString("未知") : record.site);
+        for (const QString& frame : record.backtrace) {
+            qWarning().noquote() << "    " << frame;
+        }
+    }
+    return records.size();
+}
+
+int EventStoragePool::outstandingCount() const
+{
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (!audit) return 0;
+
+    QMutexLocker locker(&audit->mutex);
+    return audit->outstanding.size();
+}
+
+quint64 EventStoragePool::doubleReleaseCount() const
+{
+    AuditState* audit = m_audit.load(std::memory_order_acquire);
+    if (!audit) return 0;
+
+    QMutexLocker locker(&audit->mutex);
+    return audit->doubleReleases;
+}
+
+void EventStoragePool::clearPool()
+{
+    QList<void*> blocks;
+    drainShared(blocks);
+
+    // 调用线程的本地弹匣也一并清空
+    for (const EventPoolThreadBindings::Binding& binding : t_poolBindings.bindings) {
+        if (binding.pool == this && binding.serial == m_serial) {
+            ThreadCache* cache = binding.cache;
+            for (Magazine* magazine : { cache->loaded, cache->previous }) {
+                for (int i = 0; i < magazine->count; ++i) {
+                    blocks.append(magazine->rounds[i]);
+                }
+                addCached(cache->cachedCount, -magazine->count);
+                magazine->count = 0;
+            }
+            break;
+        }
+    }
+
+    releaseFreeSlabs(blocks, blocks.size());
+}
+
+EventStoragePool::ThreadCache* EventStoragePool::threadCache()
+{
+    for (const EventPoolThreadBindings::Binding& binding : t_poolBindings.bindings) {
+        if (binding.pool == this && binding.serial == m_serial) {
+            return binding.cache;
+        }
+    }
+    return bindThreadCache();
+}
+
+EventStoragePool::ThreadCache* EventStoragePool::bindThreadCache()
+{
+    ThreadCache* cache = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (ThreadCache* candidate : m_threadCaches) {
+            if (!candidate->bound) {
+                cache = candidate;
+                break;
+            }
+        }
+        if (!cache) {
+            cache = new ThreadCache();
+            m_threadCaches.append(cache);
+        }
+        cache->bound = true;
+    }
+
+    // 顺便清理已销毁池留下的绑定
+    QVarLengthArray<EventPoolThreadBindings::Binding, 4>& bindings = t_poolBindings.bindings;
+    {
+        QMutexLocker locker(&g_livePoolsMutex);
+        for (int i = bindings.size() - 1; i >= 0; --i) {
+            if (g_livePools.value(bindings[i].serial) != bindings[i].pool) {
+                bindings.remove(i);
+            }
+        }
+    }
+
+    bindings.append({ this, m_serial, cache });
+    return cache;
+}
+
+void EventStoragePool::retireThreadCache(ThreadCache* cache)
+{
+    for (Magazine* magazine : { cache->loaded, cache->previous }) {
+        stash(magazine->rounds, magazine->count);
+        addCached(cache->cachedCount, -magazine->count);
+        magazine->count = 0;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    cache->bound = false;
+}
+
+void EventStoragePool::refill(ThreadCache* cache)
+{
+    // 调用时loaded和previous都为空
+    Magazine* loaded = cache->loaded;
+
+    int index = depotPop(m_fullDepot);
+    if (index >= 0) {
+        Magazine& full = m_magazines[index];
+        std::copy(full.rounds, full.rounds + full.count, loaded->rounds);
+        loaded->count = full.count;
+        m_depotEvents.fetch_sub(full.count, std::memory_order_relaxed);
+        full.count = 0;
+        depotPush(m_emptyDepot, index);
+
+        addCached(cache->cachedCount, loaded->count);
+        bumpCounter(cache->depotExchanges);
+        bumpCounter(cache->depotRefills);
+        return;
+    }
+
+    m_slowPathAcquires.fetch_add(1, std::memory_order_relaxed);
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_overflow.isEmpty() && loaded->count < MagazineSize) {
+            loaded->rounds[loaded->count++] = m_overflow.pop();
+        }
+        m_overflowCount.fetch_sub(loaded->count, std::memory_order_relaxed);
+    }
+
+    if (loaded->count == 0) {
+        // 池为空，按增长步长新建slab，首批块直接装入本线程弹匣
+        m_allocationMisses.fetch_add(1, std::memory_order_relaxed);
+        createSlabs(qMax(1, m_growthStep.load(std::memory_order_relaxed)), loaded);
+    }
+
+    addCached(cache->cachedCount, loaded->count);
+}
+
+void EventStoragePool::spill(ThreadCache* cache)
+{
+    // loaded和previous都已装满：把previous交给仓库，再与loaded互换
+    Magazine* previous = cache->previous;
+    stash(previous->rounds, previous->count);
+    addCached(cache->cachedCount, -previous->count);
+    previous->count = 0;
+    std::swap(cache->loaded, cache->previous);
+    bumpCounter(cache->depotExchanges);
+}
+
+void EventStoragePool::stash(void* const* blocks, int count)
+{
+    while (count > 0) {
+        int index = depotPop(m_emptyDepot);
+        if (index < 0) {
+            break;
+        }
+
+        Magazine& magazine = m_magazines[index];
+        int batch = qMin(count, static_cast<int>(MagazineSize));
+        std::copy(blocks, blocks + batch, magazine.rounds);
+        magazine.count = batch;
+        m_depotEvents.fetch_add(batch, std::memory_order_relaxed);
+        depotPush(m_fullDepot, index);
+
+        blocks += batch;
+        count -= batch;
+    }
+
+    if (count > 0) {
+        // 仓库已满，溢出到后备栈
+        m_overflowSpills.fetch_add(1, std::memory_order_relaxed);
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < count; ++i) {
+            m_overflow.push(blocks[i]);
+        }
+        m_overflowCount.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+int EventStoragePool::drainShared(QList<void*>& blocks)
+{
+    int drained = 0;
+
+    int index;
+    while ((index = depotPop(m_fullDepot)) >= 0) {
+        Magazine& magazine = m_magazines[index];
+        for (int i = 0; i < magazine.count; ++i) {
+            blocks.append(magazine.rounds[i]);
+        }
+        m_depotEvents.fetch_sub(magazine.count, std::memory_order_relaxed);
+        drained += magazine.count;
+        magazine.count = 0;
+        depotPush(m_emptyDepot, index);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    drained += m_overflow.size();
+    m_overflowCount.fetch_sub(m_overflow.size(), std::memory_order_relaxed);
+    while (!m_overflow.isEmpty()) {
+        blocks.append(m_overflow.pop());
+    }
+    return drained;
+}
+
+int EventStoragePool::depotPop(std::atomic<quint64>& head)
+{
+    quint64 current = head.load(std::memory_order_acquire);
+    for (;;) {
+        quint32 slot = static_cast<quint32>(current & DepotIndexMask);
+        if (slot == 0) {
+            return -1;
+        }
+
+        // next可能已被并发修改，版本号保证此时CAS失败
+        quint64 next = m_magazines[slot - 1].next.load(std::memory_order_relaxed);
+        quint64 replacement = ((current >> 32) + 1) << 32 | next;
+        if (head.compare_exchange_weak(current, replacement,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+            return static_cast<int>(slot - 1);
+        }
+        m_casRetries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EventStoragePool::depotPush(std::atomic<quint64>& head, int index)
+{
+    Magazine& magazine = m_magazines[index];
+    quint64 current = head.load(std::memory_order_relaxed);
+    for (;;) {
+        magazine.next.store(static_cast<quint32>(current & DepotIndexMask), std::memory_order_relaxed);
+        quint64 replacement = ((current >> 32) + 1) << 32 | static_cast<quint64>(index + 1);
+        if (head.compare_exchange_weak(current, replacement,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+            return;
+        }
+        m_casRetries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EventStoragePool::createBlocks(int count)
+{
+    createSlabs(count, nullptr);
+}
+
+void EventStoragePool::createSlabs(int count, Magazine* loaded)
+{
+    void* batch[MagazineSize];
+
+    for (int created = 0; created < count; created += m_blocksPerSlab) {
+        // slab在调用线程上分配并首次触碰，页面落在该线程所在的NUMA节点
+        void* memory = ::operator new(m_slabBytes, std::align_val_t(m_slabBytes));
+        bindToLocalNode(memory, m_slabBytes);
+        std::memset(memory, 0, m_slabBytes);
+
+        Slab* slab = new (memory) Slab;
+        slab->blockCount = m_blocksPerSlab;
+        slab->numaNode = currentNumaNode();
+        if (m_constructBlock) {
+            for (int i = 0; i < m_blocksPerSlab; ++i) {
+                m_constructBlock(blockAt(slab, i));
+            }
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            m_slabs.append(slab);
+        }
+        m_totalEvents.fetch_add(m_blocksPerSlab, std::memory_order_relaxed);
+
+        // 弹匣从末尾弹出，逆序装入使分配按地址递增，利于批量处理时的顺序预取
+        int next = 0;
+        while (next < m_blocksPerSlab) {
+            int size = qMin(m_blocksPerSlab - next, static_cast<int>(MagazineSize));
+            Magazine* target = nullptr;
+            if (loaded && loaded->count == 0) {
+                target = loaded;
+            }
+            for (int i = 0; i < size; ++i) {
+                void* block = blockAt(slab, next + size - 1 - i);
+                if (target) {
+                    target->rounds[i] = block;
+                } else {
+                    batch[i] = block;
+                }
+            }
+            if (target) {
+                target->count = size;
+            } else {
+                stash(batch, size);
+            }
+            next += size;
+        }
+    }
+}
+
+EventStoragePool::Slab* EventStoragePool::slabOf(void* block) const
+{
+    return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(block) & ~(m_slabBytes - 1));
+}
+
+void* EventStoragePool::blockAt(Slab* slab, int index) const
+{
+    return reinterpret_cast<char*>(slab) + m_slabHeaderBytes + index * m_blockStride;
+}
+
+int EventStoragePool::releaseFreeSlabs(QList<void*>& blocks, int maxBlocks)
+{
+    // 统计每个slab有多少块在空闲列表中，整块空闲的slab才能释放
+    QHash<Slab*, int> freeBlocks;
+    for (void* block : blocks) {
+        freeBlocks[slabOf(block)]++;
+    }
+
+    QSet<Slab*> released;
+    int releasedBlocks = 0;
+    for (auto it = freeBlocks.constBegin(); it != freeBlocks.constEnd(); ++it) {
+        if (it.value() == it.key()->blockCount
+            && releasedBlocks + it.value() <= maxBlocks) {
+            released.insert(it.key());
+            releasedBlocks += it.value();
+        }
+    }
+
+    // 其余块放回仓库
+    QList<void*> kept;
+    kept.reserve(blocks.size() - releasedBlocks);
+    for (void* block : blocks) {
+        if (!released.contains(slabOf(block))) {
+            kept.append(block);
+        }
+    }
+    stash(kept.constData(), kept.size());
+
+    if (!released.isEmpty()) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_slabs.removeIf([&released](Slab* slab) { return released.contains(slab); });
+        }
+        for (Slab* slab : released) {
+            if (m_destroyBlock) {
+                for (int i = 0; i < slab->blockCount; ++i) {
+                    m_destroyBlock(blockAt(slab, i));
+                }
+            }
+            slab->~Slab();
+            ::operator delete(static_cast<void*>(slab), std::align_val_t(m_slabBytes));
+        }
+        m_totalEvents.fetch_sub(releasedBlocks, std::memory_order_relaxed);
+    }
+    return releasedBlocks;
+}
@@ -0,0 +1,343 @@
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QStack>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @brief EventStoragePool 定长事件存储池
+ *
+ * 管理固定大小的原始内存块，是 EventPool<T> 和类级 operator new/delete
+ * 的底层实现。两层结构：每个线程持有两个本地弹匣（loaded/previous），
+ * 分配和释放只操作本线程弹匣，不加锁也不做原子读改写；弹匣耗尽或装满时
+ * 才与全局仓库整匣交换。仓库是带版本号的Treiber栈（无锁，防ABA），
+ * 仓库容量用尽时溢出到受m_mutex保护的后备栈，新建内存块也只在慢路径进行。
+ *
+ * 内存块以slab为单位连续分配：块间距向上取整到缓存行，slab按自身大小
+ * 对齐，因此每个对象都从独立缓存行开始，相邻对象之间不会伪共享。slab在
+ * 请求它的线程上分配并首次触碰，Linux上还会设置MPOL_LOCAL，使页面落在
+ * 该线程所在的NUMA节点。只有整块空闲的slab才会被释放回系统。
+ *
+ * 可选的块钩子把存储池变成对象池：新建的块立即原位构造对象，slab释放
+ * 前析构其中的对象，对象在获取/归还之间一直存活，由使用方负责重置。
+ *
+ * 审计模式（setAuditEnabled）记录每个未归还对象的获取位置、线程和时间，
+ * 可列出持有超过阈值的对象并拦截重复释放。关闭时快速路径只多一次
+ * relaxed原子读和一个预测命中的分支。
+ */
+class EventStoragePool
+{
+public:
+    // 线程本地弹匣容量；缓存行大小
+    enum { MagazineSize = 32, CacheLineSize = 64 };
+
+    // 竞争统计
+    struct ContentionStats {
+        quint64 fastAcquires;       // 本地弹匣命中的获取次数
+        quint64 fastReleases;       // 本地弹匣命中的释放次数
+        quint64 depotExchanges;     // 与全局仓库交换弹匣的次数
+        quint64 casRetries;         // 仓库CAS失败重试次数
+        quint64 slowPathAcquires;   // 进入加锁慢路径的获取次数
+        quint64 overflowSpills;     // 仓库已满、溢出到后备栈的次数
+        quint64 acquires;           // 获取总次数
+        quint64 allocationMisses;   // 池中无可用块、必须新建的获取次数
+        int threadCaches;           // 已绑定的线程缓存数
+
+        ContentionStats()
+            : fastAcquires(0), fastReleases(0), depotExchanges(0), casRetries(0)
+            , slowPathAcquires(0), overflowSpills(0), acquires(0), allocationMisses(0)
+            , threadCaches(0) {}
+    };
+
+    /**
+     * @brief 审计记录：一个尚未归还的对象
+     */
+    struct AuditRecord {
+        const void* object;         // 对象地址
+        QString site;               // 获取位置标签（未提供时为空）
+        QStringList backtrace;      // 获取时的调用栈（需开启调用栈采集）
+        Qt::HANDLE thread;          // 获取线程
+        qint64 heldMs;              // 已持有时长
+
+        AuditRecord() : object(nullptr), thread(nullptr), heldMs(0) {}
+    };
+
+    // 块钩子：construct在块新建后调用，destroy在空闲块随slab释放或池析构时调用
+    typedef void (*BlockHook)(void* block);
+
+    EventStoragePool(std::size_t blockSize, int initialSize,
+                     BlockHook constructBlock = nullptr, BlockHook destroyBlock = nullptr);
+    ~EventStoragePool();
+
+    // 分配/归还一个内存块
+    void* allocate();
+    void deallocate(void* block);
+
+    // 统计信息（可用数包含各线程弹匣中的缓存，并发时为近似值）
+    std::size_t blockSize() const { return m_blockSize; }
+    std::size_t blockStride() const { return m_blockStride; }
+    int blocksPerSlab() const { return m_blocksPerSlab; }
+    std::size_t slabBytes() const { return m_slabBytes; }
+    int slabCount() const;
+    qint64 reservedBytes() const;                 // 当前全部slab占用的字节数
+    QHash<int, int> slabsPerNumaNode() const;     // 节点号 -> slab数，-1表示未知
+    int totalEvents() const { return m_totalEvents.load(std::memory_order_relaxed); }
+    int availableEvents() const;
+    int usedEvents() const { return totalEvents() - availableEvents(); }
+    ContentionStats contentionStats() const;
+
+    // 池管理（shrinkPool/trimTo/clearPool只回收仓库、后备栈和调用线程的弹匣，
+    // 并且只释放整块空闲的slab；expandPool按整slab向上取整）
+    void expandPool(int additionalSize);
+    void shrinkPool();
+    void clearPool();
+
+    /**
+     * @brief 释放共享的可用块，使总数尽量降到targetTotal
+     * @return 实际释放的块数
+     */
+    int trimTo(int targetTotal);
+
+    /**
+     * @brief 池耗尽时一次新建的块数，默认为初始大小的一半（至少一个弹匣）
+     */
+    void setGrowthStep(int blocks);
+    int growthStep() const { return m_growthStep.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 开启/关闭审计模式，关闭时丢弃已有记录
+     * @param enabled 是否开启
+     * @param captureBacktraces 是否在获取时采集调用栈（仅glibc平台）
+     */
+    void setAuditEnabled(bool enabled, bool captureBacktraces = false);
+    bool isAuditEnabled() const { return m_auditEnabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 列出审计开启后获取、尚未归还且持有时间不少于minHeldMs的对象，按持有时长降序
+     */
+    QList<AuditRecord> outstandingEvents(qint64 minHeldMs = 0) const;
+
+    /**
+     * @brief 审计开启后获取、尚未归还的对象数，不生成记录和调用栈符号
+     */
+    int outstandingCount() const;
+
+    /**
+     * @brief 以qWarning输出持有超过阈值的对象
+     * @return 超时对象数
+     */
+    int reportLongHeldEvents(qint64 thresholdMs) const;
+
+    /**
+     * @brief 已拦截的重复释放次数
+     */
+    quint64 doubleReleaseCount() const;
+
+    // 以下两个方法仅在审计开启时由 EventPool<T>/PoolAllocated<T> 调用
+    void auditAcquire(const void* block, const char* site);
+    bool auditRelease(const void* block);    // 返回false表示重复释放，调用方不得再归还
+
+private:
+    Q_DISABLE_COPY(EventStoragePool)
+
+    struct Slab;
+    struct Magazine;
+    struct ThreadCache;
+    struct AuditState;
+    friend struct EventPoolThreadBindings;
+
+    // 全局仓库：按索引寻址的弹匣数组上的两条Treiber栈；
+    // 频繁CAS的栈顶和共享计数器各占独立缓存行
+    std::unique_ptr<Magazine[]> m_magazines;
+    int m_magazineCount;
+    alignas(CacheLineSize) std::atomic<quint64> m_fullDepot;    // 装有内存块的弹匣
+    alignas(CacheLineSize) std::atomic<quint64> m_emptyDepot;   // 空弹匣
+    alignas(CacheLineSize) std::atomic<int> m_depotEvents;
+    alignas(CacheLineSize) std::atomic<quint64> m_casRetries;
+    std::atomic<bool> m_auditEnabled;
+    std::atomic<quint64> m_slowPathAcquires;
+    std::atomic<quint64> m_overflowSpills;
+    std::atomic<quint64> m_allocationMisses;
+    std::atomic<int> m_growthStep;
+
+    // 慢路径状态，受m_mutex保护
+    alignas(CacheLineSize) mutable QMutex m_mutex;
+    QStack<void*> m_overflow;
+    std::atomic<int> m_overflowCount;
+    QList<ThreadCache*> m_threadCaches;
+    QList<Slab*> m_slabs;
+    std::atomic<AuditState*> m_audit;       // 首次开启审计时创建，随池析构
+
+    std::atomic<int> m_totalEvents;
+    std::size_t m_blockSize;
+    std::size_t m_blockStride;
+    std::size_t m_slabHeaderBytes;
+    std::size_t m_slabBytes;
+    int m_blocksPerSlab;
+    int m_initialSize;
+    quint64 m_serial;
+    BlockHook m_constructBlock;
+    BlockHook m_destroyBlock;
+
+    ThreadCache* threadCache();
+    ThreadCache* bindThreadCache();
+    void retireThreadCache(ThreadCache* cache);
+    void refill(ThreadCache* cache);
+    void spill(ThreadCache* cache);
+    void stash(void* const* blocks, int count);
+    int drainShared(QList<void*>& blocks);
+    int depotPop(std::atomic<quint64>& head);
+    void depotPush(std::atomic<quint64>& head, int index);
+    void createBlocks(int count);
+    void createSlabs(int count, Magazine* loaded);
+    Slab* slabOf(void* block) const;
+    void* blockAt(Slab* slab, int index) const;
+    int releaseFreeSlabs(QList<void*>& blocks, int maxBlocks);
+};
+
+/**
+ * @brief EventPool 类型化事件对象池
+ *
+ * 对象在 EventStoragePool 的内存块新建时构造，此后一直存活：
+ * acquireEvent取出一个已构造的对象并调用setInUse(true)，releaseEvent
+ * 调用reset()后放回池中，对象持有的内存（如负载竞技场）随对象一起重用。
+ * 只有空闲块所在的slab被释放或池析构时才析构对象。
+ *
+ * T须可默认构造，并提供reset()和setInUse(bool)。acquireEvent得到的对象
+ * 必须通过同一个池的releaseEvent归还；若要交给Qt在分派后delete，
+ * 请让T继承 PoolAllocated<T> 并直接使用new。
+ */
+template<typename T>
+class EventPool : public EventStoragePool
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "EventPool只支持默认对齐的类型");
+
+public:
+    explicit EventPool(int initialSize = 100)
+        : EventStoragePool(sizeof(T), initialSize, &constructBlock, &destroyBlock) {}
+
+    // 获取事件对象
+    T* acquireEvent()
+    {
+        return acquireEventAt(nullptr);
+    }
+
+    // 获取事件对象并在审计模式下记录获取位置，配合 EVENT_POOL_SITE 使用
+    T* acquireEventAt(const char* site)
+    {
+        T* event = static_cast<T*>(allocate());
+        if (Q_UNLIKELY(isAuditEnabled())) {
+            auditAcquire(event, site);
+        }
+        event->setInUse(true);
+        return event;
+    }
+
+    // 重置事件对象并归还池中
+    void releaseEvent(T* event)
+    {
+        if (!event) return;
+        if (Q_UNLIKELY(isAuditEnabled()) && !auditRelease(event)) {
+            return;
+        }
+        event->reset();
+        deallocate(event);
+    }
+
+private:
+    static void constructBlock(void* block) { ::new (block) T(); }
+    static void destroyBlock(void* block) { static_cast<T*>(block)->~T(); }
+};
+
+/**
+ * @brief PoolAllocated 类级operator new/delete，把T的堆分配转到 storagePool()
+ *
+ * 调用方照常 new T(...) 并 postEvent，Qt分派后的delete会把内存块
+ * 透明地归还池中。派生类尺寸不同时回退到全局operator new/delete。
+ *
+ * 审计模式下，operator delete先在未归还集合中查找内存块：同一对象被
+ * 再次delete时查找失败，登记为重复释放，内存块不会被第二次归还。
+ * 析构函数在operator delete之前已经执行，这一点无法拦截。
+ */
+template<typename T>
+class PoolAllocated
+{
+public:
+    /**
+     * @brief 类型T的进程级共享存储池（只管理内存，不构造对象）
+     *
+     * 有意不析构：Qt可能在静态对象析构之后才删除残留的投递事件。
+     */
+    static EventStoragePool& storagePool()
+    {
+        static EventStoragePool* pool =
+            new EventStoragePool(sizeof(T), EventStoragePool::MagazineSize * 2);
+        return *pool;
+    }
+
+    static void* operator new(std::size_t size)
+    {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        EventStoragePool& pool = storagePool();
+        void* block = pool.allocate();
+        if (Q_UNLIKELY(pool.isAuditEnabled())) {
+            pool.auditAcquire(block, nullptr);
+        }
+        return block;
+    }
+
+    static void operator delete(void* block, std::size_t size)
+    {
+        if (!block) return;
+        if (size != sizeof(T)) {
+            ::operator delete(block);
+            return;
+        }
+        EventStoragePool& pool = storagePool();
+        if (Q_UNLIKELY(pool.isAuditEnabled()) && !pool.auditRelease(block)) {
+            return;
+        }
+        pool.deallocate(block);
+    }
+};
+
+// 审计模式下的获取位置标签，如 pool.acquireEventAt(EVENT_POOL_SITE)
+#define EVENT_POOL_SITE_STRINGIFY(x) #x
+#define EVENT_POOL_SITE_LINE(x) EVENT_POOL_SITE_STRINGIFY(x)
+#define EVENT_POOL_SITE (__FILE__ ":" EVENT_POOL_SITE_LINE(__LINE__))
+
+/**
+ * @brief 池化的鼠标事件，用于代替 new QMouseEvent 投递模拟输入
+ */
+class PooledMouseEvent : public QMouseEvent, public PoolAllocated<PooledMouseEvent>
+{
+public:
+    using QMouseEvent::QMouseEvent;
+};
+
+/**
+ * @brief 池化的键盘事件，用于代替 new QKeyEvent 投递模拟输入
+ */
+class PooledKeyEvent : public QKeyEvent, public PoolAllocated<PooledKeyEvent>
+{
+public:
+    using QKeyEvent::QKeyEvent;
+};
+
+#endif // EVENT_POOL_H
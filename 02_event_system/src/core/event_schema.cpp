@@ -0,0 +1,147 @@
+#include "event_schema.h"
+#include <QDebug>
+#include <QReadWriteLock>
+#include <algorithm>
+
+namespace {
+
+// 全局模式表
+QReadWriteLock g_schemaLock;
+QHash<int, std::shared_ptr<const EventSchema>> g_schemas;
+
+} // namespace
+
+// EventSchema 实现
+EventSchema::EventSchema(int eventType, quint16 version)
+    : m_eventType(eventType)
+    , m_version(version)
+{
+}
+
+EventSchema& EventSchema::addField(quint16 id, const QString& name, const QVariant& defaultValue)
+{
+    if (id == 0 || m_slots.contains(id)) {
+        qWarning() << "EventSchema: invalid or duplicate field id" << id << "for" << name;
+        return *this;
+    }
+    m_slots.insert(id, m_fields.size());
+    m_fields.append({ id, name, QStringList(), defaultValue });
+    return *this;
+}
+
+EventSchema& EventSchema::addPreviousName(quint16 id, const QString& name)
+{
+    const int slot = slotOf(id);
+    if (slot < 0) {
+        qWarning() << "EventSchema: unknown field id" << id << "for previous name" << name;
+        return *this;
+    }
+    m_fields[slot].previousNames.append(name);
+    return *this;
+}
+
+quint16 EventSchema::idOf(QStringView name) const
+{
+    // 当前名称优先，旧名称可能被后来的字段重新使用
+    for (const Field& field : m_fields) {
+        if (field.name == name) {
+            return field.id;
+        }
+    }
+    for (const Field& field : m_fields) {
+        for (const QString& previous : field.previousNames) {
+            if (previous == name) {
+                return field.id;
+            }
+        }
+    }
+    return 0;
+}
+
+void EventSchema::registerSchema(const EventSchema& schema)
+{
+    auto shared = std::make_shared<const EventSchema>(schema);
+
+    QWriteLocker locker(&g_schemaLock);
+    g_schemas.insert(schema.eventType(), std::move(shared));
+}
+
+std::shared_ptr<const EventSchema> EventSchema::find(int eventType)
+{
+    QReadLocker locker(&g_schemaLock);
+    return g_schemas.value(eventType);
+}
+
+// EventSchemaView 实现
+EventSchemaView::EventSchemaView()
+    : m_unknownFields(0)
+{
+}
+
+EventSchemaView::EventSchemaView(const EventWireView& view, std::shared_ptr<const EventSchema> schema,
+                                 int firstField)
+    : m_wire(view)
+    , m_schema(std::move(schema))
+    , m_unknownFields(0)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    m_indexOfSlot.resize(m_schema->fields().size());
+    std::fill(m_indexOfSlot.begin(), m_indexOfSlot.end(), -1);
+    m_idAt.resize(m_wire.fieldCount());
+    std::fill(m_idAt.begin(), m_idAt.end(), quint16(0));
+    for (int i = qMax(0, firstField); i < m_wire.fieldCount(); ++i) {
+        // 有字段ID时直接按ID识别，没有时退回到名称
+        quint16 id = m_wire.fieldId(i);
+        if (id == 0) {
+            id = m_schema->idOf(m_wire.fieldName(i));
+        }
+        const int slot = id != 0 ? m_schema->slotOf(id) : -1;
+        if (slot < 0) {
+            m_unknownFields++;
+            continue;
+        }
+        m_idAt[i] = id;
+        if (m_indexOfSlot[slot] < 0) {
+            m_indexOfSlot[slot] = i;
+        }
+    }
+}
+
+int EventSchemaView::indexOf(quint16 id) const
+{
+    if (!isValid()) {
+        return -1;
+    }
+    const int slot = m_schema->slotOf(id);
+    return slot >= 0 ? m_indexOfSlot[slot] : -1;
+}
+
+quint16 EventSchemaView::fieldIdAt(int index) const
+{
+    return index >= 0 && index < m_idAt.size() ? m_idAt[index] : 0;
+}
+
+QString EventSchemaView::fieldName(int index) const
+{
+    const quint16 id = fieldIdAt(index);
+    if (id != 0) {
+        return m_schema->fields().at(m_schema->slotOf(id)).name;
+    }
+    return m_wire.fieldName(index).toString();
+}
+
+QVariant EventSchemaView::value(quint16 id) const
+{
+    if (!isValid()) {
+        return QVariant();
+    }
+    const int slot = m_schema->slotOf(id);
+    if (slot < 0) {
+        return QVariant();
+    }
+    const int index = m_indexOfSlot[slot];
+    return index >= 0 ? m_wire.value(index) : m_schema->fields().at(slot).defaultValue;
+}
@@ -0,0 +1,159 @@
+#ifndef EVENT_SCHEMA_H
+#define EVENT_SCHEMA_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVarLengthArray>
+#include <QVariant>
+#include <QtGlobal>
+#include <memory>
+#include "event_wire_format.h"
+
+/**
+ * @brief 事件类型的字段模式：字段ID、当前名称、旧名称和默认值
+ *
+ * 每个字段有一个不随改名变化的ID（1-65535，0保留为“没有ID”）。登记了模式
+ * 的事件类型序列化时写出模式段（EventWire::FieldIds），记录模式版本和
+ * 各字段ID；读取端用 EventSchemaView 按ID定位字段。
+ *
+ * 布局演进的约定：
+ *   新增字段   分配新ID并给出默认值，旧事件读取时得到默认值
+ *   字段改名   保留原ID，旧名称用addPreviousName()登记
+ *   删除字段   从模式中去掉即可，旧事件中的该字段被当作未知字段跳过
+ *   修改类型   分配新ID，不要复用旧ID
+ *
+ * 模式段出现之前录制的事件没有字段ID，按当前名称和旧名称识别。
+ *
+ *   EventSchema schema(CommandEventType, 2);
+ *   schema.addField(1, "path")
+ *         .addPreviousName(1, "file")          // 版本1中叫file
+ *         .addField(2, "overwrite", false);     // 版本2新增
+ *   EventSchema::registerSchema(schema);
+ */
+class EventSchema
+{
+public:
+    struct Field {
+        quint16 id;
+        QString name;
+        QStringList previousNames;
+        QVariant defaultValue;      // 事件中缺少该字段时的值
+    };
+
+    explicit EventSchema(int eventType = 0, quint16 version = 0);
+
+    int eventType() const { return m_eventType; }
+    quint16 version() const { return m_version; }
+
+    /**
+     * @brief 添加字段；ID为0或与已有字段重复时忽略并警告
+     */
+    EventSchema& addField(quint16 id, const QString& name, const QVariant& defaultValue = QVariant());
+
+    /**
+     * @brief 登记字段在旧版本中使用过的名称
+     */
+    EventSchema& addPreviousName(quint16 id, const QString& name);
+
+    const QList<Field>& fields() const { return m_fields; }
+
+    /**
+     * @brief 字段ID在fields()中的下标，未知ID返回-1
+     */
+    int slotOf(quint16 id) const { return m_slots.value(id, -1); }
+
+    /**
+     * @brief 按当前名称或旧名称查找字段ID，未知名称返回0
+     *
+     * 逐个比较名称，只在事件没有字段ID时使用。
+     */
+    quint16 idOf(QStringView name) const;
+
+    /**
+     * @brief 登记模式，替换该事件类型已有的模式
+     */
+    static void registerSchema(const EventSchema& schema);
+
+    /**
+     * @brief 该事件类型登记的模式，未登记时返回nullptr
+     */
+    static std::shared_ptr<const EventSchema> find(int eventType);
+
+private:
+    int m_eventType;
+    quint16 m_version;
+    QList<Field> m_fields;
+    QHash<quint16, int> m_slots;    // 字段ID -> m_fields下标
+};
+
+/**
+ * @brief 按模式解读的线格式视图
+ *
+ * 构造时遍历一次偏移表（只读ID或名称，不解码值），建立字段ID到字段下标
+ * 的映射，之后按ID查找是O(1)。事件中模式不认识的字段只计数、不解码；
+ * 旧版本写入的事件按旧名称映射到当前字段，缺少的字段返回模式默认值。
+ * 整个过程共享原缓冲区，不复制也不重新编码。
+ */
+class EventSchemaView
+{
+public:
+    EventSchemaView();
+
+    /**
+     * @param firstField 从该下标开始按模式识别，之前的字段不参与（CommandEvent的命令字段）
+     */
+    EventSchemaView(const EventWireView& view, std::shared_ptr<const EventSchema> schema, int firstField = 0);
+
+    bool isValid() const { return m_wire.isValid() && m_schema != nullptr; }
+
+    const EventWireView& wire() const { return m_wire; }
+    const EventSchema* schema() const { return m_schema.get(); }
+
+    /**
+     * @brief 事件写入时的模式版本，没有模式段的事件为0
+     */
+    quint16 frameVersion() const { return m_wire.schemaVersion(); }
+
+    /**
+     * @brief 事件由旧版本模式写入，读取时经过了名称映射和默认值补全
+     */
+    bool isPromoted() const { return isValid() && frameVersion() < m_schema->version(); }
+
+    /**
+     * @brief 字段ID在事件中的下标，事件中没有该字段时返回-1
+     */
+    int indexOf(quint16 id) const;
+    bool contains(quint16 id) const { return indexOf(id) >= 0; }
+
+    /**
+     * @brief 事件中第index个字段对应的字段ID，模式不认识时返回0
+     */
+    quint16 fieldIdAt(int index) const;
+
+    /**
+     * @brief 事件中第index个字段的当前名称；模式不认识的字段返回事件中的名称
+     */
+    QString fieldName(int index) const;
+
+    /**
+     * @brief 按ID读取字段值，事件中没有该字段时返回模式默认值
+     */
+    QVariant value(quint16 id) const;
+
+    /**
+     * @brief 事件中模式不认识的字段数
+     */
+    int unknownFieldCount() const { return m_unknownFields; }
+
+private:
+    EventWireView m_wire;
+    std::shared_ptr<const EventSchema> m_schema;
+    QVarLengthArray<int, 16> m_indexOfSlot;     // 模式字段下标 -> 事件字段下标
+    QVarLengthArray<quint16, 16> m_idAt;        // 事件字段下标 -> 字段ID
+    int m_unknownFields;
+};
+
+#endif // EVENT_SCHEMA_H
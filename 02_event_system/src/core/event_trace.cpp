@@ -0,0 +1,395 @@
+#include "event_trace.h"
+#include "crc32c.h"
+#include "custom_events.h"
+#include "event_compression.h"
+#include "event_wire_format.h"
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const quint16 HostByteOrderFlag = QSysInfo::ByteOrder == QSysInfo::BigEndian ? EventWire::BigEndian : 0;
+const qint64 HeaderSize = sizeof(EventTrace::Header);
+const qint64 FrameHeaderSize = sizeof(EventTrace::FrameHeader);
+
+inline quint64 frameEnd(const EventTrace::IndexEntry& entry)
+{
+    return entry.offset + FrameHeaderSize + entry.length;
+}
+
+// 帧必须从文件头之后开始首尾相接，批量加载按此切分连续字节区间
+bool contiguous(const QList<EventTrace::IndexEntry>& index, quint64 end)
+{
+    quint64 offset = HeaderSize;
+    for (const EventTrace::IndexEntry& entry : index) {
+        if (entry.offset != offset) {
+            return false;
+        }
+        offset = frameEnd(entry);
+    }
+    return offset == end;
+}
+
+// 内置事件的deserialize()经EventWireView核对线格式自带的校验值，不必再算一遍帧CRC
+bool checkedOnDeserialize(int eventType, const QByteArray& frame)
+{
+    if ((eventType != DataEventType && eventType != CommandEventType)
+        || !EventWire::isWireFormat(frame) || frame.size() < qsizetype(sizeof(EventWire::Header))) {
+        return false;
+    }
+    EventWire::Header header;
+    std::memcpy(&header, frame.constData(), sizeof(header));
+    return header.flags & EventWire::Checksummed;
+}
+
+} // namespace
+
+BaseCustomEvent* EventTrace::createEvent(int eventType)
+{
+    switch (eventType) {
+    case DataEventType:
+        return new DataEvent();
+    case CommandEventType:
+        return new CommandEvent();
+    default:
+        return nullptr;
+    }
+}
+
+// EventTraceWriter 实现
+EventTraceWriter::EventTraceWriter(QIODevice* device)
+    : m_device(device)
+    , m_position(0)
+    , m_finished(false)
+{
+}
+
+bool EventTraceWriter::append(const BaseCustomEvent& event)
+{
+    return append(event.type(), event.timestamp(), event.serializeCompressed());
+}
+
+bool EventTraceWriter::append(int eventType, qint64 timestamp, const QByteArray& frame)
+{
+    if (m_finished || !m_device || !m_device->isWritable()
+        || quint64(frame.size()) > std::numeric_limits<quint32>::max()) {
+        return false;
+    }
+
+    if (m_position == 0 && !writeHeader()) {
+        return false;
+    }
+
+    EventTrace::FrameHeader frameHeader;
+    frameHeader.timestamp = timestamp;
+    frameHeader.eventType = eventType;
+    frameHeader.length = quint32(frame.size());
+    frameHeader.checksum = Crc32c::compute(frame.constData(), frame.size());
+    frameHeader.reserved = 0;
+
+    EventTrace::IndexEntry entry;
+    entry.offset = quint64(m_position);
+    entry.timestamp = timestamp;
+    entry.eventType = eventType;
+    entry.length = frameHeader.length;
+
+    if (!writeBytes(&frameHeader, sizeof(frameHeader)) || !writeBytes(frame.constData(), frame.size())) {
+        return false;
+    }
+    m_index.append(entry);
+    return true;
+}
+
+bool EventTraceWriter::finish()
+{
+    if (m_finished || !m_device) {
+        return false;
+    }
+    // 空录制也写出文件头，读取端才能识别
+    if (m_position == 0 && !writeHeader()) {
+        return false;
+    }
+
+    const qint64 indexBytes = m_index.size() * qint64(sizeof(EventTrace::IndexEntry));
+    EventTrace::Trailer trailer;
+    trailer.indexOffset = quint64(m_position);
+    trailer.frameCount = quint64(m_index.size());
+    trailer.indexChecksum = Crc32c::compute(m_index.constData(), indexBytes);
+    trailer.magic = EventTrace::TrailerMagic;
+
+    m_finished = true;
+    return writeBytes(m_index.constData(), indexBytes) && writeBytes(&trailer, sizeof(trailer));
+}
+
+bool EventTraceWriter::writeHeader()
+{
+    EventTrace::Header header;
+    header.magic = EventTrace::Magic;
+    header.version = EventTrace::Version;
+    header.flags = HostByteOrderFlag;
+    return writeBytes(&header, sizeof(header));
+}
+
+bool EventTraceWriter::writeBytes(const void* data, qint64 length)
+{
+    if (length == 0) {
+        return true;
+    }
+    if (!EventWire::writeChunked(m_device, QByteArray::fromRawData(static_cast<const char*>(data), length))) {
+        return false;
+    }
+    m_position += length;
+    return true;
+}
+
+// EventTraceReader 实现
+EventTraceReader::EventTraceReader(QIODevice* device)
+    : m_device(device)
+    , m_start(0)
+    , m_size(0)
+    , m_storedIndex(false)
+    , m_maxThreads(qMax(1, QThread::idealThreadCount()))
+    , m_chunkBytes(EventTrace::DefaultChunkBytes)
+    , m_decodePayloads(true)
+    , m_factory(EventTrace::createEvent)
+{
+}
+
+bool EventTraceReader::open()
+{
+    m_index.clear();
+    m_storedIndex = false;
+    if (!m_device || !m_device->isReadable() || m_device->isSequential()) {
+        return false;
+    }
+
+    m_start = m_device->pos();
+    m_size = m_device->size() - m_start;
+
+    EventTrace::Header header;
+    if (!readAt(0, reinterpret_cast<char*>(&header), sizeof(header))
+        || header.magic != EventTrace::Magic
+        || header.version != EventTrace::Version
+        || header.flags != HostByteOrderFlag) {
+        return false;
+    }
+
+    if (readIndex()) {
+        m_storedIndex = true;
+        return true;
+    }
+    return scanFrames();
+}
+
+QByteArray EventTraceReader::frame(qint64 index)
+{
+    if (index < 0 || index >= m_index.size()) {
+        return QByteArray();
+    }
+    const EventTrace::IndexEntry& entry = m_index[index];
+
+    EventTrace::FrameHeader header;
+    QByteArray data(entry.length, Qt::Uninitialized);
+    if (!readAt(entry.offset, reinterpret_cast<char*>(&header), sizeof(header))
+        || !readAt(entry.offset + FrameHeaderSize, data.data(), data.size())
+        || header.eventType != entry.eventType || header.length != entry.length
+        || Crc32c::compute(data.constData(), data.size()) != header.checksum) {
+        return QByteArray();
+    }
+    return data;
+}
+
+BaseCustomEvent* EventTraceReader::readEvent(qint64 index)
+{
+    if (index < 0 || index >= m_index.size()) {
+        return nullptr;
+    }
+    const EventTrace::IndexEntry& entry = m_index[index];
+
+    QByteArray record(FrameHeaderSize + entry.length, Qt::Uninitialized);
+    if (!readAt(entry.offset, record.data(), record.size())) {
+        return nullptr;
+    }
+    return decodeFrame(record.constData(), record.size(), entry, false);
+}
+
+bool EventTraceReader::loadEvents(QList<BaseCustomEvent*>* events, qint64 first, qint64 count)
+{
+    if (!events) {
+        return false;
+    }
+    events->clear();
+    if (count < 0) {
+        count = m_index.size() - first;
+    }
+    if (first < 0 || count < 0 || first + count > m_index.size()) {
+        return false;
+    }
+
+    events->resize(count);
+    BaseCustomEvent** results = events->data();
+
+    // 调用线程读区间，工作线程解码；在途区间数有上限，读取快于解码时在此等待
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_maxThreads);
+    QSemaphore inFlight(2 * m_maxThreads);
+    std::atomic<bool> failed(false);
+
+    const qint64 end = first + count;
+    qint64 next = first;
+    while (next < end && !failed.load(std::memory_order_relaxed)) {
+        const quint64 chunkStart = m_index[next].offset;
+        qint64 last = next + 1;
+        while (last < end && frameEnd(m_index[last]) - chunkStart <= quint64(m_chunkBytes)) {
+            ++last;
+        }
+
+        QByteArray chunk(qsizetype(frameEnd(m_index[last - 1]) - chunkStart), Qt::Uninitialized);
+        if (!readAt(qint64(chunkStart), chunk.data(), chunk.size())) {
+            failed = true;
+            break;
+        }
+
+        inFlight.acquire();
+        pool.start([this, chunk, chunkStart, next, last, first, results, &failed, &inFlight]() {
+            for (qint64 i = next; i < last && !failed.load(std::memory_order_relaxed); ++i) {
+                const EventTrace::IndexEntry& entry = m_index[i];
+                const qint64 at = qint64(entry.offset - chunkStart);
+                BaseCustomEvent* event = decodeFrame(chunk.constData() + at, chunk.size() - at,
+                                                     entry, m_decodePayloads);
+                if (!event) {
+                    failed = true;
+                    break;
+                }
+                results[i - first] = event;
+            }
+            inFlight.release();
+        });
+        next = last;
+    }
+    pool.waitForDone();
+
+    if (failed) {
+        qDeleteAll(*events);
+        events->clear();
+        return false;
+    }
+    return true;
+}
+
+bool EventTraceReader::readIndex()
+{
+    EventTrace::Trailer trailer;
+    const qint64 trailerSize = sizeof(trailer);
+    if (m_size < HeaderSize + trailerSize
+        || !readAt(m_size - trailerSize, reinterpret_cast<char*>(&trailer), trailerSize)
+        || trailer.magic != EventTrace::TrailerMagic) {
+        return false;
+    }
+
+    const quint64 indexEnd = quint64(m_size - trailerSize);
+    if (trailer.indexOffset < quint64(HeaderSize) || trailer.indexOffset > indexEnd
+        || (indexEnd - trailer.indexOffset) / sizeof(EventTrace::IndexEntry) != trailer.frameCount
+        || (indexEnd - trailer.indexOffset) % sizeof(EventTrace::IndexEntry) != 0) {
+        return false;
+    }
+    const qint64 indexBytes = qint64(indexEnd - trailer.indexOffset);
+
+    QList<EventTrace::IndexEntry> index(qsizetype(trailer.frameCount));
+    if (!readAt(qint64(trailer.indexOffset), reinterpret_cast<char*>(index.data()), indexBytes)
+        || Crc32c::compute(index.constData(), indexBytes) != trailer.indexChecksum
+        || !contiguous(index, trailer.indexOffset)) {
+        return false;
+    }
+
+    m_index = std::move(index);
+    return true;
+}
+
+bool EventTraceReader::scanFrames()
+{
+    // 没有尾部：逐个读取帧头，末尾不完整的帧丢弃
+    quint64 offset = HeaderSize;
+    while (offset + FrameHeaderSize <= quint64(m_size)) {
+        EventTrace::FrameHeader header;
+        if (!readAt(qint64(offset), reinterpret_cast<char*>(&header), sizeof(header))) {
+            return false;
+        }
+
+        EventTrace::IndexEntry entry;
+        entry.offset = offset;
+        entry.timestamp = header.timestamp;
+        entry.eventType = header.eventType;
+        entry.length = header.length;
+        if (header.reserved != 0 || frameEnd(entry) > quint64(m_size)) {
+            break;
+        }
+        m_index.append(entry);
+        offset = frameEnd(entry);
+    }
+    return true;
+}
+
+bool EventTraceReader::readAt(qint64 offset, char* data, qint64 length)
+{
+    if (offset < 0 || length > m_size - offset || !m_device->seek(m_start + offset)) {
+        return false;
+    }
+    while (length > 0) {
+        const qint64 got = m_device->read(data, length);
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        length -= got;
+    }
+    return true;
+}
+
+BaseCustomEvent* EventTraceReader::decodeFrame(const char* record, qint64 available,
+                                               const EventTrace::IndexEntry& entry, bool decodePayload) const
+{
+    EventTrace::FrameHeader header;
+    if (available < FrameHeaderSize + qint64(entry.length)) {
+        return nullptr;
+    }
+    std::memcpy(&header, record, sizeof(header));
+    const char* data = record + FrameHeaderSize;
+    if (header.eventType != entry.eventType || header.length != entry.length) {
+        return nullptr;
+    }
+
+    // 压缩帧先解压（解码器对任意输入都做边界检查），事件持有解压结果；
+    // 未压缩的帧拷贝一份，chunk在任务结束后释放
+    QByteArray frame;
+    if (EventCompression::isCompressed(QByteArrayView(data, header.length))) {
+        frame = EventCompression::decompress(QByteArray::fromRawData(data, header.length));
+        if (frame.isEmpty()) {
+            return nullptr;
+        }
+    } else {
+        frame = QByteArray(data, header.length);
+    }
+
+    // 每帧只校验一次：线格式自带校验值时交给反序列化，否则核对帧CRC
+    if (!checkedOnDeserialize(header.eventType, frame) && Crc32c::compute(data, header.length) != header.checksum) {
+        return nullptr;
+    }
+
+    BaseCustomEvent* event = m_factory ? m_factory(header.eventType) : nullptr;
+    if (!event) {
+        return nullptr;
+    }
+    if (!event->deserialize(frame)) {
+        delete event;
+        return nullptr;
+    }
+    if (decodePayload) {
+        event->data();
+    }
+    return event;
+}
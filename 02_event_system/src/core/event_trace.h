@@ -0,0 +1,210 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QtGlobal>
+#include <functional>
+
+class BaseCustomEvent;
+
+/**
+ * @brief 录制事件的带索引容器格式
+ *
+ * 布局：文件头 + 连续的事件帧 + 索引 + 尾部。
+ *
+ *   Header      8字节：魔数、版本、标志
+ *   Frame       24字节帧头（时间戳、事件类型、长度、CRC32C）+ serializeCompressed()的结果
+ *   Index       每帧24字节：帧头偏移、时间戳、事件类型、长度
+ *   Trailer     24字节：索引偏移、帧数、索引的CRC32C、魔数
+ *
+ * 索引使读取端不必顺序扫描就能得到每帧的位置，可以随机读取单帧，也能把
+ * 整个录制切成连续的字节区间分给多个线程同时解码。录制中断、没有写入
+ * 尾部的文件在打开时按帧头顺序扫描重建索引。
+ *
+ * 多字节字段按写入端的本机字节序存放，与 EventWire 线格式一致。
+ */
+namespace EventTrace {
+
+enum : quint32 { Magic = 0x52545645 };          // "EVTR"
+enum : quint32 { TrailerMagic = 0x49545645 };   // "EVTI"
+enum : quint16 { Version = 1 };
+enum : qint64 { DefaultChunkBytes = 4 * 1024 * 1024 };  // 批量加载时每个任务的字节数
+
+struct Header {
+    quint32 magic;
+    quint16 version;
+    quint16 flags;          // EventWire::BigEndian
+};
+
+struct FrameHeader {
+    qint64 timestamp;
+    qint32 eventType;
+    quint32 length;         // 帧头之后的字节数
+    quint32 checksum;       // 帧数据的CRC32C
+    quint32 reserved;
+};
+
+struct IndexEntry {
+    quint64 offset;         // 帧头相对文件头起始的偏移
+    qint64 timestamp;
+    qint32 eventType;
+    quint32 length;
+};
+
+struct Trailer {
+    quint64 indexOffset;
+    quint64 frameCount;
+    quint32 indexChecksum;
+    quint32 magic;
+};
+
+static_assert(sizeof(Header) == 8, "EventTrace::Header layout");
+static_assert(sizeof(FrameHeader) == 24, "EventTrace::FrameHeader layout");
+static_assert(sizeof(IndexEntry) == 24, "EventTrace::IndexEntry layout");
+static_assert(sizeof(Trailer) == 24, "EventTrace::Trailer layout");
+
+/**
+ * @brief 按事件类型创建空事件，供读取端反序列化
+ *
+ * 内置 DataEvent 和 CommandEvent，其他类型返回nullptr。
+ */
+BaseCustomEvent* createEvent(int eventType);
+
+} // namespace EventTrace
+
+/**
+ * @brief EventTraceWriter 顺序写出录制文件
+ *
+ * 每个事件写成一帧，索引保存在内存中，finish()时追加到文件末尾。
+ * 只顺序写入，可用于顺序设备；未调用finish()的文件仍可读取，只是打开时
+ * 需要扫描重建索引。
+ */
+class EventTraceWriter
+{
+public:
+    explicit EventTraceWriter(QIODevice* device);
+
+    /**
+     * @brief 以serializeCompressed()写入一个事件
+     */
+    bool append(const BaseCustomEvent& event);
+
+    /**
+     * @brief 写入已序列化的事件
+     * @param frame serialize()或serializeCompressed()的结果
+     */
+    bool append(int eventType, qint64 timestamp, const QByteArray& frame);
+
+    /**
+     * @brief 写出索引和尾部，之后不能再追加
+     */
+    bool finish();
+
+    qint64 frameCount() const { return m_index.size(); }
+
+private:
+    bool writeHeader();
+    bool writeBytes(const void* data, qint64 length);
+
+    QIODevice* m_device;
+    QList<EventTrace::IndexEntry> m_index;
+    qint64 m_position;          // 已写入的字节数（相对文件头起始）
+    bool m_finished;
+};
+
+/**
+ * @brief EventTraceReader 读取录制文件，支持随机访问和多线程批量加载
+ *
+ * 设备必须可随机访问（QFile、QBuffer）。open()读取尾部和索引，之后
+ * readEvent()按下标读取单帧；loadEvents()在调用线程按索引顺序读出连续
+ * 的字节区间，交给线程池解码，结果按帧顺序返回。读取与解码重叠进行，
+ * 在途的区间数有上限，内存占用与文件大小无关（不计返回的事件本身）。
+ *
+ * 每帧只校验一次：帧是带校验值的线格式（含解压后的结果）时由反序列化核对，
+ * 否则在解码前核对帧头中的CRC32C。任何一帧损坏或无法反序列化时整个加载失败。
+ */
+class EventTraceReader
+{
+public:
+    using EventFactory = std::function<BaseCustomEvent*(int eventType)>;
+
+    explicit EventTraceReader(QIODevice* device);
+
+    /**
+     * @brief 读取文件头和索引，没有有效尾部时扫描帧头重建索引
+     */
+    bool open();
+
+    /**
+     * @brief 索引是否从尾部读出（false表示由扫描重建或尚未open()）
+     */
+    bool hasStoredIndex() const { return m_storedIndex; }
+
+    qint64 frameCount() const { return m_index.size(); }
+    const QList<EventTrace::IndexEntry>& index() const { return m_index; }
+
+    /**
+     * @brief 读取并校验单帧数据，失败时返回空QByteArray
+     */
+    QByteArray frame(qint64 index);
+
+    /**
+     * @brief 读取单帧并反序列化，调用方负责删除返回的事件
+     */
+    BaseCustomEvent* readEvent(qint64 index);
+
+    /**
+     * @brief 多线程批量加载[first, first + count)范围内的事件
+     *
+     * 成功时events按帧顺序保存新建的事件，调用方负责删除；失败时events为空。
+     * @param count 帧数，-1表示到末尾
+     */
+    bool loadEvents(QList<BaseCustomEvent*>* events, qint64 first = 0, qint64 count = -1);
+
+    /**
+     * @brief 批量加载使用的线程数，默认QThread::idealThreadCount()
+     */
+    void setMaxThreads(int threads) { m_maxThreads = qMax(1, threads); }
+    int maxThreads() const { return m_maxThreads; }
+
+    /**
+     * @brief 每个解码任务读取的字节数，单帧更大时该任务只含一帧
+     */
+    void setChunkBytes(qint64 bytes) { m_chunkBytes = qMax<qint64>(1, bytes); }
+
+    /**
+     * @brief 是否在工作线程中完整解码负载
+     *
+     * 反序列化本身是惰性的，只校验缓冲区；开启后工作线程还会调用data()，
+     * 返回的事件访问字段时不再解码。默认开启。
+     */
+    void setDecodePayloads(bool decode) { m_decodePayloads = decode; }
+
+    /**
+     * @brief 替换按事件类型创建事件的工厂，默认 EventTrace::createEvent
+     *
+     * 工厂在工作线程中调用，必须线程安全。
+     */
+    void setEventFactory(const EventFactory& factory) { m_factory = factory; }
+
+private:
+    bool readIndex();
+    bool scanFrames();
+    bool readAt(qint64 offset, char* data, qint64 length);
+    BaseCustomEvent* decodeFrame(const char* record, qint64 available, const EventTrace::IndexEntry& entry,
+                                 bool decodePayload) const;
+
+    QIODevice* m_device;
+    qint64 m_start;             // 文件头在设备中的位置
+    qint64 m_size;              // 文件头之后的字节数
+    QList<EventTrace::IndexEntry> m_index;
+    bool m_storedIndex;
+    int m_maxThreads;
+    qint64 m_chunkBytes;
+    bool m_decodePayloads;
+    EventFactory m_factory;
+};
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,1277 @@
+#include "event_wire_format.h"
+#include "crc32c.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QIODevice>
+#include <QStringList>
+#include <QVariantHash>
+#include <QVariantList>
+#include <QVariantMap>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const quint16 HostByteOrderFlag = QSysInfo::ByteOrder == QSysInfo::BigEndian ? EventWire::BigEndian : 0;
+const quint16 MaxNameLength = 0xFFFF;
+const int DeviceTimeoutMs = 30000;
+const char ZeroPadding[8] = {};
+
+inline qint64 align8(qint64 offset)
+{
+    return (offset + 7) & ~qint64(7);
+}
+
+// 可映射到固定字段类型的QMetaType
+EventWire::FieldType fieldTypeOf(int metaType)
+{
+    switch (metaType) {
+    case QMetaType::Bool:
+        return EventWire::Bool;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+    case QMetaType::Long:
+    case QMetaType::Short:
+    case QMetaType::SChar:
+        return EventWire::Int;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+    case QMetaType::ULong:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+        return EventWire::UInt;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return EventWire::Double;
+    case QMetaType::QString:
+        return EventWire::String;
+    case QMetaType::QByteArray:
+        return EventWire::Bytes;
+    default:
+        return EventWire::Variant;
+    }
+}
+
+qint64 valueLength(EventWire::FieldType type, qsizetype length)
+{
+    switch (type) {
+    case EventWire::Null:
+        return 0;
+    case EventWire::Bool:
+        return 1;
+    case EventWire::Int:
+    case EventWire::UInt:
+    case EventWire::Double:
+        return 8;
+    default:
+        return length;
+    }
+}
+
+// QString的QDataStream编码长度：quint32长度（空串为0xFFFFFFFF）+ UTF-16数据
+inline qint64 stringStreamSize(const QString& string)
+{
+    return 4 + (string.isNull() ? 0 : string.size() * qint64(sizeof(char16_t)));
+}
+
+// 模式段：quint16模式版本 + 每字段一个quint16字段ID
+inline qint64 schemaSectionSize(quint16 flags, quint32 fieldCount)
+{
+    return (flags & EventWire::FieldIds) ? qint64(sizeof(quint16)) * (1 + qint64(fieldCount)) : 0;
+}
+
+bool validHeader(const EventWire::Header& header)
+{
+    return header.magic == EventWire::Magic
+        && header.version == EventWire::Version
+        && (header.flags & EventWire::BigEndian) == HostByteOrderFlag
+        && qint64(sizeof(EventWire::Header))
+           + qint64(header.fieldCount) * qint64(sizeof(EventWire::FieldEntry))
+           + schemaSectionSize(header.flags, header.fieldCount) <= qint64(header.totalSize);
+}
+
+bool validEntry(const EventWire::FieldEntry& entry, qint64 size)
+{
+    if (entry.nameOffset % alignof(char16_t) != 0
+        || qint64(entry.nameOffset) + qint64(entry.nameLength) * 2 > size
+        || qint64(entry.offset) + qint64(entry.length) > size
+        || entry.type == EventWire::Invalid || entry.type > EventWire::Variant) {
+        return false;
+    }
+    if (entry.length != valueLength(EventWire::FieldType(entry.type), entry.length)) {
+        return false;
+    }
+    return entry.type != EventWire::String
+        || (entry.offset % alignof(char16_t) == 0 && entry.length % sizeof(char16_t) == 0);
+}
+
+// 解码定长标量字段，并恢复写入时的原始类型（int、float等）
+QVariant scalarValue(const EventWire::FieldEntry& field, const char* data)
+{
+    QVariant result;
+    switch (field.type) {
+    case EventWire::Bool:
+        return QVariant(*data != 0);
+    case EventWire::Int: {
+        qint64 value;
+        std::memcpy(&value, data, sizeof(value));
+        result = QVariant(value);
+        break;
+    }
+    case EventWire::UInt: {
+        quint64 value;
+        std::memcpy(&value, data, sizeof(value));
+        result = QVariant(value);
+        break;
+    }
+    case EventWire::Double: {
+        double value;
+        std::memcpy(&value, data, sizeof(value));
+        result = QVariant(value);
+        break;
+    }
+    default:
+        return QVariant();
+    }
+
+    if (field.metaType != 0 && field.metaType != result.metaType().id()) {
+        result.convert(QMetaType(field.metaType));
+    }
+    return result;
+}
+
+// 把[cursor, aligned)的填充字节清零，避免把未初始化内存写进缓冲区
+inline qint64 padTo8(char* base, qint64 cursor)
+{
+    const qint64 aligned = align8(cursor);
+    std::memset(base + cursor, 0, aligned - cursor);
+    return aligned;
+}
+
+// 分块写入；设备写缓冲积压超过一个块时等待写出（套接字等），文件设备会自行刷新
+bool writeAll(QIODevice* device, const char* data, qint64 length, qint64 chunkBytes)
+{
+    while (length > 0) {
+        const qint64 written = device->write(data, qMin(length, chunkBytes));
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= written;
+
+        if (device->bytesToWrite() > chunkBytes) {
+            device->waitForBytesWritten(DeviceTimeoutMs);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 分块写入设备并累加写出字节的CRC32C
+ */
+struct ChecksumSink
+{
+    QIODevice* device;
+    qint64 chunkBytes;
+    quint32 checksum;
+
+    bool write(const char* data, qint64 length)
+    {
+        checksum = Crc32c::update(checksum, data, length);
+        return writeAll(device, data, length, chunkBytes);
+    }
+};
+
+/**
+ * @brief 把QDataStream的输出直接转发到目标设备并计数
+ */
+class ForwardingDevice : public QIODevice
+{
+public:
+    explicit ForwardingDevice(ChecksumSink* sink)
+        : m_sink(sink), m_written(0)
+    {
+        open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    }
+
+    qint64 written() const { return m_written; }
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char*, qint64) override { return -1; }
+
+    qint64 writeData(const char* data, qint64 length) override
+    {
+        if (!m_sink->write(data, length)) {
+            return -1;
+        }
+        m_written += length;
+        return length;
+    }
+
+private:
+    ChecksumSink* m_sink;
+    qint64 m_written;
+};
+
+/**
+ * @brief 只允许从源设备读取固定字节数，供QDataStream解码单个字段
+ */
+class LimitedReadDevice : public QIODevice
+{
+public:
+    LimitedReadDevice(QIODevice* source, qint64 limit, quint32* checksum)
+        : m_source(source), m_remaining(limit), m_consumed(0), m_checksum(checksum)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    qint64 consumed() const { return m_consumed; }
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+        const qint64 wanted = qMin(maxSize, m_remaining);
+        if (wanted <= 0) {
+            return m_remaining == 0 ? -1 : 0;
+        }
+
+        // QDataStream把短读视为数据结束，这里阻塞读满请求的长度
+        qint64 total = 0;
+        while (total < wanted) {
+            const qint64 got = m_source->read(data + total, wanted - total);
+            if (got < 0) {
+                break;
+            }
+            if (got == 0) {
+                if (!m_source->waitForReadyRead(DeviceTimeoutMs)) {
+                    break;
+                }
+                continue;
+            }
+            total += got;
+        }
+        m_remaining -= total;
+        m_consumed += total;
+        *m_checksum = Crc32c::update(*m_checksum, data, total);
+        return total > 0 ? total : -1;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    QIODevice* m_source;
+    qint64 m_remaining;
+    qint64 m_consumed;
+    quint32* m_checksum;
+};
+
+} // namespace
+
+bool EventWire::isWireFormat(const QByteArray& buffer)
+{
+    if (buffer.size() < qsizetype(sizeof(quint32))) {
+        return false;
+    }
+    quint32 magic;
+    std::memcpy(&magic, buffer.constData(), sizeof(magic));
+    return magic == Magic;
+}
+
+quint32 EventWire::frameChecksum(const char* frame, qint64 size)
+{
+    const qint64 checksumEnd = qint64(offsetof(Header, checksum) + sizeof(Header::checksum));
+    const quint32 head = Crc32c::compute(frame, offsetof(Header, checksum));
+    return Crc32c::update(head, frame + checksumEnd, size - checksumEnd);
+}
+
+EventWire::VerifyReport EventWire::verifyFrames(QIODevice* device, qint64 chunkBytes)
+{
+    VerifyReport report;
+    if (!device || !device->isReadable()) {
+        report.errorOffset = 0;
+        return report;
+    }
+
+    QByteArray buffer(qMax<qint64>(chunkBytes, sizeof(Header)), Qt::Uninitialized);
+    qint64 offset = 0;
+    for (;;) {
+        // 头部可能分几次到达，与数据部分一样读满为止，到达末尾或超时才停止
+        Header header;
+        char* headerBytes = reinterpret_cast<char*>(&header);
+        qint64 got = 0;
+        bool failed = false;
+        while (got < qint64(sizeof(header))) {
+            const qint64 read = device->read(headerBytes + got, qint64(sizeof(header)) - got);
+            if (read == 0 && device->waitForReadyRead(DeviceTimeoutMs)) {
+                continue;
+            }
+            if (read <= 0) {
+                failed = read < 0;
+                break;
+            }
+            got += read;
+        }
+        // 在帧边界上没有更多数据：正常结束
+        if (got == 0 && !failed) {
+            break;
+        }
+        if (got != qint64(sizeof(header)) || !validHeader(header)) {
+            report.errorOffset = offset;
+            break;
+        }
+
+        // 不带校验值的事件只检查长度是否完整
+        const bool checksummed = header.flags & Checksummed;
+        quint32 checksum = Crc32c::compute(&header, offsetof(Header, checksum));
+        qint64 remaining = qint64(header.totalSize) - qint64(sizeof(header));
+        while (remaining > 0) {
+            qint64 read = device->read(buffer.data(), qMin<qint64>(remaining, buffer.size()));
+            if (read == 0 && device->waitForReadyRead(DeviceTimeoutMs)) {
+                continue;
+            }
+            if (read <= 0) {
+                break;
+            }
+            if (checksummed) {
+                checksum = Crc32c::update(checksum, buffer.constData(), read);
+            }
+            remaining -= read;
+        }
+        if (remaining > 0 || (checksummed && checksum != header.checksum)) {
+            report.errorOffset = offset;
+            break;
+        }
+
+        report.frames++;
+        report.unchecked += checksummed ? 0 : 1;
+        report.bytes += header.totalSize;
+        offset += header.totalSize;
+    }
+    return report;
+}
+
+qint64 EventWire::variantStreamSize(const QVariant& value)
+{
+    // QVariant头部：quint32类型id + qint8空标志
+    const qint64 variantHeader = 5;
+    if (!value.isValid()) {
+        return variantHeader;
+    }
+
+    const int metaType = value.metaType().id();
+    if (metaType >= QMetaType::User) {
+        // 自定义类型还要写类型名，长度无法静态得到，退回实际编码
+        QByteArray encoded;
+        QDataStream stream(&encoded, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << value;
+        return encoded.size();
+    }
+
+    const void* data = value.constData();
+    switch (metaType) {
+    case QMetaType::Bool:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+        return variantHeader + 1;
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::QChar:
+        return variantHeader + 2;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+        return variantHeader + 4;
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:          // 默认双精度写出
+    case QMetaType::QPoint:
+    case QMetaType::QSize:
+        return variantHeader + 8;
+    case QMetaType::QPointF:
+    case QMetaType::QSizeF:
+    case QMetaType::QRect:
+    case QMetaType::QLine:
+        return variantHeader + 16;
+    case QMetaType::QRectF:
+    case QMetaType::QLineF:
+        return variantHeader + 32;
+    case QMetaType::QString:
+        return variantHeader + stringStreamSize(*static_cast<const QString*>(data));
+    case QMetaType::QByteArray: {
+        const QByteArray& bytes = *static_cast<const QByteArray*>(data);
+        return variantHeader + 4 + (bytes.isNull() ? 0 : bytes.size());
+    }
+    case QMetaType::QStringList: {
+        qint64 size = variantHeader + 4;
+        for (const QString& string : *static_cast<const QStringList*>(data)) {
+            size += stringStreamSize(string);
+        }
+        return size;
+    }
+    case QMetaType::QVariantList: {
+        qint64 size = variantHeader + 4;
+        for (const QVariant& item : *static_cast<const QVariantList*>(data)) {
+            size += variantStreamSize(item);
+        }
+        return size;
+    }
+    case QMetaType::QVariantMap: {
+        const QVariantMap& map = *static_cast<const QVariantMap*>(data);
+        qint64 size = variantHeader + 4;
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            size += stringStreamSize(it.key()) + variantStreamSize(it.value());
+        }
+        return size;
+    }
+    case QMetaType::QVariantHash: {
+        const QVariantHash& hash = *static_cast<const QVariantHash*>(data);
+        qint64 size = variantHeader + 4;
+        for (auto it = hash.constBegin(); it != hash.constEnd(); ++it) {
+            size += stringStreamSize(it.key()) + variantStreamSize(it.value());
+        }
+        return size;
+    }
+    default: {
+        // 其余内置类型（日期时间、颜色等）编码格式较复杂，实际编码测量
+        QByteArray encoded;
+        QDataStream stream(&encoded, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << value;
+        return encoded.size();
+    }
+    }
+}
+
+bool EventWire::writeChunked(QIODevice* device, const QByteArray& bytes, qint64 chunkBytes)
+{
+    return device && writeAll(device, bytes.constData(), bytes.size(), qMax<qint64>(1, chunkBytes));
+}
+
+// EventWireWriter 实现
+EventWireWriter::EventWireWriter(int eventType, qint64 timestamp)
+    : m_eventType(static_cast<quint32>(eventType))
+    , m_timestamp(timestamp)
+    , m_flags(0)
+    , m_hasSchema(false)
+    , m_schemaVersion(0)
+    , m_variantFields(0)
+{
+}
+
+void EventWireWriter::reserve(int fieldCount)
+{
+    m_fields.reserve(fieldCount);
+}
+
+void EventWireWriter::addField(QStringView name, EventWire::FieldType type, int metaType,
+                               const void* data, qsizetype length, quint64 scalar,
+                               const QVariant& variant)
+{
+    if (name.size() > MaxNameLength) {
+        qWarning() << "EventWireWriter: field name truncated to" << MaxNameLength << "characters";
+        name = name.left(MaxNameLength);
+    }
+    m_fields.append({ m_names.size(), name.size(), type, metaType, data, length, scalar, variant, 0 });
+    m_names.append(name);
+}
+
+void EventWireWriter::setSchemaVersion(quint16 version)
+{
+    m_hasSchema = true;
+    m_schemaVersion = version;
+}
+
+void EventWireWriter::setFieldId(int index, quint16 id)
+{
+    if (index >= 0 && index < m_fields.size()) {
+        m_fields[index].fieldId = id;
+    }
+}
+
+void EventWireWriter::addNull(QStringView name)
+{
+    addField(name, EventWire::Null, QMetaType::UnknownType, nullptr, 0, 0);
+}
+
+void EventWireWriter::addBool(QStringView name, bool value)
+{
+    addField(name, EventWire::Bool, QMetaType::Bool, nullptr, 0, value ? 1 : 0);
+}
+
+void EventWireWriter::addInt(QStringView name, qint64 value)
+{
+    addField(name, EventWire::Int, QMetaType::LongLong, nullptr, 0, static_cast<quint64>(value));
+}
+
+void EventWireWriter::addUInt(QStringView name, quint64 value)
+{
+    addField(name, EventWire::UInt, QMetaType::ULongLong, nullptr, 0, value);
+}
+
+void EventWireWriter::addDouble(QStringView name, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    addField(name, EventWire::Double, QMetaType::Double, nullptr, 0, bits);
+}
+
+void EventWireWriter::addString(QStringView name, QStringView value)
+{
+    addField(name, EventWire::String, QMetaType::QString,
+             value.utf16(), value.size() * qsizetype(sizeof(char16_t)), 0);
+}
+
+void EventWireWriter::addBytes(QStringView name, QByteArrayView value)
+{
+    addField(name, EventWire::Bytes, QMetaType::QByteArray, value.data(), value.size(), 0);
+}
+
+void EventWireWriter::addVariant(QStringView name, const QVariant& value)
+{
+    if (!value.isValid()) {
+        addNull(name);
+        return;
+    }
+
+    const int metaType = value.metaType().id();
+    switch (fieldTypeOf(metaType)) {
+    case EventWire::Bool:
+        addBool(name, value.toBool());
+        break;
+    case EventWire::Int:
+        addField(name, EventWire::Int, metaType, nullptr, 0, static_cast<quint64>(value.toLongLong()));
+        break;
+    case EventWire::UInt:
+        addField(name, EventWire::UInt, metaType, nullptr, 0, value.toULongLong());
+        break;
+    case EventWire::Double: {
+        const double number = value.toDouble();
+        quint64 bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        addField(name, EventWire::Double, metaType, nullptr, 0, bits);
+        break;
+    }
+    case EventWire::String: {
+        // 保存value的副本，数据指针指向共享的UTF-16数据，不受value生命周期影响
+        const QString* string = static_cast<const QString*>(value.constData());
+        addField(name, EventWire::String, metaType, string->utf16(),
+                 string->size() * qsizetype(sizeof(char16_t)), 0, value);
+        break;
+    }
+    case EventWire::Bytes: {
+        const QByteArray* bytes = static_cast<const QByteArray*>(value.constData());
+        addField(name, EventWire::Bytes, metaType, bytes->constData(), bytes->size(), 0, value);
+        break;
+    }
+    default:
+        addField(name, EventWire::Variant, metaType < 256 ? metaType : 0, nullptr, 0, 0, value);
+        m_variantFields++;
+        break;
+    }
+}
+
+qint64 EventWireWriter::fieldLength(int index, const QList<QByteArray>& encoded) const
+{
+    const PendingField& field = m_fields[index];
+    if (field.type == EventWire::Variant) {
+        return encoded.isEmpty() ? EventWire::variantStreamSize(field.variant)
+                                 : encoded[index].size();
+    }
+    return valueLength(field.type, field.length);
+}
+
+qint64 EventWireWriter::tableEnd() const
+{
+    return qint64(sizeof(EventWire::Header))
+         + qint64(m_fields.size()) * qint64(sizeof(EventWire::FieldEntry))
+         + schemaSectionSize(m_hasSchema ? EventWire::FieldIds : 0, quint32(m_fields.size()));
+}
+
+quint16 EventWireWriter::headerFlags(bool checksummed) const
+{
+    const quint16 derived = EventWire::BigEndian | EventWire::Checksummed | EventWire::FieldIds;
+    return quint16((m_flags & ~derived) | HostByteOrderFlag
+                   | (checksummed ? EventWire::Checksummed : 0)
+                   | (m_hasSchema ? EventWire::FieldIds : 0));
+}
+
+QByteArray EventWireWriter::schemaSection() const
+{
+    if (!m_hasSchema) {
+        return QByteArray();
+    }
+    QVarLengthArray<quint16, 16> section;
+    section.append(m_schemaVersion);
+    for (const PendingField& field : m_fields) {
+        section.append(field.fieldId);
+    }
+    return QByteArray(reinterpret_cast<const char*>(section.constData()),
+                      section.size() * qsizetype(sizeof(quint16)));
+}
+
+qint64 EventWireWriter::layoutSize(const QList<QByteArray>& encoded) const
+{
+    qint64 size = align8(tableEnd());
+    for (int i = 0; i < m_fields.size(); ++i) {
+        size = align8(size + m_fields[i].nameLength * qint64(sizeof(char16_t)));
+        size = align8(size + fieldLength(i, encoded));
+    }
+    return size;
+}
+
+qint64 EventWireWriter::size() const
+{
+    return layoutSize(QList<QByteArray>());
+}
+
+QByteArray EventWireWriter::finish() const
+{
+
+    // 第一遍：编码复合类型并计算总长度
+    QList<QByteArray> encoded;
+    if (m_variantFields > 0) {
+        encoded.resize(m_fields.size());
+        for (int i = 0; i < m_fields.size(); ++i) {
+            if (m_fields[i].type == EventWire::Variant) {
+                QDataStream stream(&encoded[i], QIODevice::WriteOnly);
+                stream.setVersion(QDataStream::Qt_6_0);
+                stream << m_fields[i].variant;
+            }
+        }
+    }
+
+    const qint64 size = layoutSize(encoded);
+    if (size > std::numeric_limits<quint32>::max()) {
+        qWarning() << "EventWireWriter: encoded event exceeds 4 GiB";
+        return QByteArray();
+    }
+
+    // 第二遍：一次分配，名称和值直接拷贝到位
+    QByteArray result(size, Qt::Uninitialized);
+    char* base = result.data();
+
+    EventWire::Header header;
+    header.magic = EventWire::Magic;
+    header.version = EventWire::Version;
+    header.flags = headerFlags(true);
+    header.eventType = m_eventType;
+    header.fieldCount = quint32(m_fields.size());
+    header.timestamp = m_timestamp;
+    header.totalSize = quint32(size);
+    header.checksum = 0;
+    std::memcpy(base, &header, sizeof(header));
+
+    const QByteArray section = schemaSection();
+    std::memcpy(base + tableEnd() - section.size(), section.constData(), section.size());
+
+    qint64 cursor = padTo8(base, tableEnd());
+    char* table = base + sizeof(EventWire::Header);
+    for (int i = 0; i < m_fields.size(); ++i) {
+        const PendingField& field = m_fields[i];
+        const void* data = field.type == EventWire::Variant ? encoded[i].constData() : field.data;
+
+        EventWire::FieldEntry entry;
+        entry.nameOffset = quint32(cursor);
+        entry.nameLength = quint16(field.nameLength);
+        entry.type = field.type;
+        entry.metaType = quint8(field.metaType > 0 && field.metaType < 256 ? field.metaType : 0);
+
+        const qint64 nameBytes = field.nameLength * qint64(sizeof(char16_t));
+        if (nameBytes > 0) {
+            std::memcpy(base + cursor, m_names.constData() + field.nameStart, nameBytes);
+        }
+        cursor = padTo8(base, cursor + nameBytes);
+
+        const qint64 length = fieldLength(i, encoded);
+        entry.offset = quint32(cursor);
+        entry.length = quint32(length);
+        if (field.type == EventWire::Bool) {
+            base[cursor] = field.scalar ? 1 : 0;
+        } else if (data) {
+            if (length > 0) {
+                std::memcpy(base + cursor, data, length);
+            }
+        } else if (length > 0) {
+            std::memcpy(base + cursor, &field.scalar, length);
+        }
+        cursor = padTo8(base, cursor + length);
+
+        std::memcpy(table, &entry, sizeof(entry));
+        table += sizeof(entry);
+    }
+
+    header.checksum = EventWire::frameChecksum(base, size);
+    std::memcpy(base + offsetof(EventWire::Header, checksum), &header.checksum, sizeof(header.checksum));
+    return result;
+}
+
+bool EventWireWriter::writeTo(QIODevice* device, qint64 chunkBytes) const
+{
+    if (!device || !device->isWritable()) {
+        return false;
+    }
+    chunkBytes = qMax<qint64>(1, chunkBytes);
+
+    // 复合类型按估算长度布局，写出后逐个核对
+    const QList<QByteArray> estimated;
+    const qint64 size = layoutSize(estimated);
+    if (size > std::numeric_limits<quint32>::max()) {
+        qWarning() << "EventWireWriter: encoded event exceeds 4 GiB";
+        return false;
+    }
+
+    // 校验值写完后回写到头部，只有可随机访问的设备才能回写
+    const bool checksummed = !device->isSequential();
+    const qint64 start = device->pos();
+
+    EventWire::Header header;
+    header.magic = EventWire::Magic;
+    header.version = EventWire::Version;
+    header.flags = headerFlags(checksummed);
+    header.eventType = m_eventType;
+    header.fieldCount = quint32(m_fields.size());
+    header.timestamp = m_timestamp;
+    header.totalSize = quint32(size);
+    header.checksum = 0;
+    if (!writeAll(device, reinterpret_cast<const char*>(&header), sizeof(header), chunkBytes)) {
+        return false;
+    }
+    ChecksumSink sink = { device, chunkBytes, Crc32c::compute(&header, offsetof(EventWire::Header, checksum)) };
+
+    // 第一遍：只根据长度生成偏移表
+    const qint64 dataStart = align8(tableEnd());
+    qint64 cursor = dataStart;
+    for (int i = 0; i < m_fields.size(); ++i) {
+        const PendingField& field = m_fields[i];
+
+        EventWire::FieldEntry entry;
+        entry.nameOffset = quint32(cursor);
+        entry.nameLength = quint16(field.nameLength);
+        entry.type = field.type;
+        entry.metaType = quint8(field.metaType > 0 && field.metaType < 256 ? field.metaType : 0);
+        cursor = align8(cursor + field.nameLength * qint64(sizeof(char16_t)));
+
+        const qint64 length = fieldLength(i, estimated);
+        entry.offset = quint32(cursor);
+        entry.length = quint32(length);
+        cursor = align8(cursor + length);
+
+        if (!sink.write(reinterpret_cast<const char*>(&entry), sizeof(entry))) {
+            return false;
+        }
+    }
+    const QByteArray section = schemaSection();
+    if (!sink.write(section.constData(), section.size())
+        || !sink.write(ZeroPadding, dataStart - tableEnd())) {
+        return false;
+    }
+
+    // 第二遍：按偏移顺序写出名称和值
+    for (int i = 0; i < m_fields.size(); ++i) {
+        const PendingField& field = m_fields[i];
+
+        const qint64 nameBytes = field.nameLength * qint64(sizeof(char16_t));
+        if (!sink.write(reinterpret_cast<const char*>(m_names.constData() + field.nameStart), nameBytes)
+            || !sink.write(ZeroPadding, align8(nameBytes) - nameBytes)) {
+            return false;
+        }
+
+        const qint64 length = fieldLength(i, estimated);
+        bool ok = true;
+        switch (field.type) {
+        case EventWire::Null:
+            break;
+        case EventWire::Bool: {
+            const char value = field.scalar ? 1 : 0;
+            ok = sink.write(&value, 1);
+            break;
+        }
+        case EventWire::Int:
+        case EventWire::UInt:
+        case EventWire::Double:
+            ok = sink.write(reinterpret_cast<const char*>(&field.scalar), length);
+            break;
+        case EventWire::String:
+        case EventWire::Bytes:
+            ok = sink.write(static_cast<const char*>(field.data), length);
+            break;
+        case EventWire::Variant: {
+            ForwardingDevice forward(&sink);
+            QDataStream stream(&forward);
+            stream.setVersion(QDataStream::Qt_6_0);
+            stream << field.variant;
+            if (forward.written() != length) {
+                // 偏移表已经写出，长度不符时这个事件无法再修正
+                qWarning() << "EventWireWriter: streamed variant size" << forward.written()
+                           << "does not match estimate" << length;
+                return false;
+            }
+            ok = stream.status() == QDataStream::Ok;
+            break;
+        }
+        default:
+            break;
+        }
+        if (!ok || !sink.write(ZeroPadding, align8(length) - length)) {
+            return false;
+        }
+    }
+
+    if (checksummed) {
+        const qint64 end = device->pos();
+        if (!device->seek(start + qint64(offsetof(EventWire::Header, checksum)))
+            || !writeAll(device, reinterpret_cast<const char*>(&sink.checksum), sizeof(sink.checksum), chunkBytes)
+            || !device->seek(end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// EventWireView 实现
+EventWireView::EventWireView()
+    : m_valid(false)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+EventWireView::EventWireView(const QByteArray& buffer)
+    : m_buffer(buffer)
+    , m_valid(false)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+
+    if (m_buffer.size() < qsizetype(sizeof(EventWire::Header))) {
+        return;
+    }
+    if (reinterpret_cast<quintptr>(m_buffer.constData()) % alignof(char16_t) != 0) {
+        m_buffer = QByteArray(buffer.constData(), buffer.size());
+    }
+
+    EventWire::Header header;
+    std::memcpy(&header, m_buffer.constData(), sizeof(header));
+    if (!validHeader(header) || header.totalSize != quint64(m_buffer.size())) {
+        return;
+    }
+
+    if ((header.flags & EventWire::Checksummed)
+        && EventWire::frameChecksum(m_buffer.constData(), m_buffer.size()) != header.checksum) {
+        return;
+    }
+
+    // 只校验边界，不解码值
+    const char* table = m_buffer.constData() + sizeof(EventWire::Header);
+    for (quint32 i = 0; i < header.fieldCount; ++i) {
+        EventWire::FieldEntry entry;
+        std::memcpy(&entry, table + i * sizeof(EventWire::FieldEntry), sizeof(entry));
+        if (!validEntry(entry, m_buffer.size())) {
+            return;
+        }
+    }
+
+    m_header = header;
+    m_valid = true;
+}
+
+int EventWireView::eventType() const
+{
+    return int(m_header.eventType);
+}
+
+qint64 EventWireView::timestamp() const
+{
+    return m_header.timestamp;
+}
+
+quint16 EventWireView::flags() const
+{
+    return m_header.flags;
+}
+
+int EventWireView::fieldCount() const
+{
+    return int(m_header.fieldCount);
+}
+
+quint16 EventWireView::schemaVersion() const
+{
+    return schemaValue(-1);
+}
+
+quint16 EventWireView::fieldId(int index) const
+{
+    return index >= 0 && index < fieldCount() ? schemaValue(index) : 0;
+}
+
+quint16 EventWireView::schemaValue(int index) const
+{
+    quint16 result = 0;
+    if (m_header.flags & EventWire::FieldIds) {
+        const qint64 section = qint64(sizeof(EventWire::Header))
+                             + qint64(m_header.fieldCount) * qint64(sizeof(EventWire::FieldEntry));
+        std::memcpy(&result, at(quint32(section + (index + 1) * qint64(sizeof(quint16)))), sizeof(result));
+    }
+    return result;
+}
+
+EventWire::FieldEntry EventWireView::entry(int index) const
+{
+    EventWire::FieldEntry result;
+    if (index < 0 || index >= fieldCount()) {
+        std::memset(&result, 0, sizeof(result));
+        return result;
+    }
+    std::memcpy(&result, at(sizeof(EventWire::Header) + index * sizeof(EventWire::FieldEntry)),
+                sizeof(result));
+    return result;
+}
+
+QStringView EventWireView::fieldName(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    if (field.type == EventWire::Invalid) {
+        return QStringView();
+    }
+    return QStringView(reinterpret_cast<const char16_t*>(at(field.nameOffset)), field.nameLength);
+}
+
+EventWire::FieldType EventWireView::fieldType(int index) const
+{
+    return EventWire::FieldType(entry(index).type);
+}
+
+int EventWireView::fieldMetaType(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    if (field.metaType != 0) {
+        return field.metaType;
+    }
+    switch (field.type) {
+    case EventWire::Bool:
+        return QMetaType::Bool;
+    case EventWire::Int:
+        return QMetaType::LongLong;
+    case EventWire::UInt:
+        return QMetaType::ULongLong;
+    case EventWire::Double:
+        return QMetaType::Double;
+    case EventWire::String:
+        return QMetaType::QString;
+    case EventWire::Bytes:
+        return QMetaType::QByteArray;
+    default:
+        return QMetaType::UnknownType;
+    }
+}
+
+int EventWireView::indexOf(QStringView name, int from) const
+{
+    for (int i = qMax(0, from); i < fieldCount(); ++i) {
+        if (fieldName(i) == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool EventWireView::toBool(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    switch (field.type) {
+    case EventWire::Bool:
+        return *at(field.offset) != 0;
+    case EventWire::Int:
+    case EventWire::UInt:
+        return toUInt(index) != 0;
+    case EventWire::Double:
+        return toDouble(index) != 0.0;
+    default:
+        return false;
+    }
+}
+
+qint64 EventWireView::toInt(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    switch (field.type) {
+    case EventWire::Bool:
+        return *at(field.offset) != 0 ? 1 : 0;
+    case EventWire::Int:
+    case EventWire::UInt: {
+        qint64 value;
+        std::memcpy(&value, at(field.offset), sizeof(value));
+        return value;
+    }
+    case EventWire::Double:
+        return qint64(toDouble(index));
+    default:
+        return 0;
+    }
+}
+
+quint64 EventWireView::toUInt(int index) const
+{
+    return static_cast<quint64>(toInt(index));
+}
+
+double EventWireView::toDouble(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    switch (field.type) {
+    case EventWire::Double: {
+        double value;
+        std::memcpy(&value, at(field.offset), sizeof(value));
+        return value;
+    }
+    case EventWire::UInt:
+        return double(toUInt(index));
+    case EventWire::Int:
+    case EventWire::Bool:
+        return double(toInt(index));
+    default:
+        return 0.0;
+    }
+}
+
+QStringView EventWireView::toStringView(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    if (field.type != EventWire::String) {
+        return QStringView();
+    }
+    return QStringView(reinterpret_cast<const char16_t*>(at(field.offset)),
+                       qsizetype(field.length / sizeof(char16_t)));
+}
+
+QByteArrayView EventWireView::toBytes(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+    if (field.type != EventWire::Bytes && field.type != EventWire::Variant) {
+        return QByteArrayView();
+    }
+    return QByteArrayView(at(field.offset), qsizetype(field.length));
+}
+
+QVariant EventWireView::value(int index) const
+{
+    const EventWire::FieldEntry field = entry(index);
+
+    switch (field.type) {
+    case EventWire::Bool:
+    case EventWire::Int:
+    case EventWire::UInt:
+    case EventWire::Double:
+        return scalarValue(field, at(field.offset));
+    case EventWire::String:
+        return QVariant(toStringView(index).toString());
+    case EventWire::Bytes:
+        return QVariant(toBytes(index).toByteArray());
+    case EventWire::Variant: {
+        // 原位解码，不复制编码数据
+        const QByteArray encoded = QByteArray::fromRawData(at(field.offset), qsizetype(field.length));
+        QDataStream stream(encoded);
+        stream.setVersion(QDataStream::Qt_6_0);
+        QVariant result;
+        stream >> result;
+        return stream.status() == QDataStream::Ok ? result : QVariant();
+    }
+    default:
+        return QVariant();
+    }
+}
+
+// EventWireStreamReader 实现
+EventWireStreamReader::EventWireStreamReader(QIODevice* device, qint64 chunkBytes)
+    : m_device(device)
+    , m_chunkBytes(qMax<qint64>(1, chunkBytes))
+    , m_headerRead(false)
+    , m_next(0)
+    , m_position(0)
+    , m_checksum(0)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+bool EventWireStreamReader::readHeader()
+{
+    if (!m_device || !m_device->isReadable() || m_headerRead) {
+        return false;
+    }
+
+    EventWire::Header header;
+    if (!readFully(reinterpret_cast<char*>(&header), sizeof(header)) || !validHeader(header)) {
+        return false;
+    }
+    // 校验值本身不计入
+    m_checksum = Crc32c::compute(&header, offsetof(EventWire::Header, checksum));
+
+    // 偏移表和模式段的大小只与字段数有关
+    m_table.resize(qsizetype(header.fieldCount) * qsizetype(sizeof(EventWire::FieldEntry))
+                   + schemaSectionSize(header.flags, header.fieldCount));
+    if (!readFully(m_table.data(), m_table.size())) {
+        return false;
+    }
+
+    m_header = header;
+    m_headerRead = true;
+    return true;
+}
+
+quint16 EventWireStreamReader::schemaVersion() const
+{
+    return schemaValue(-1);
+}
+
+quint16 EventWireStreamReader::fieldId(int index) const
+{
+    return index >= 0 && index < fieldCount() ? schemaValue(index) : 0;
+}
+
+quint16 EventWireStreamReader::schemaValue(int index) const
+{
+    quint16 result = 0;
+    if (m_headerRead && (m_header.flags & EventWire::FieldIds)) {
+        const qsizetype section = qsizetype(m_header.fieldCount) * qsizetype(sizeof(EventWire::FieldEntry));
+        std::memcpy(&result, m_table.constData() + section + (index + 1) * qsizetype(sizeof(quint16)),
+                    sizeof(result));
+    }
+    return result;
+}
+
+bool EventWireStreamReader::readNext(QString* name, QVariant* value)
+{
+    if (!hasNext()) {
+        return false;
+    }
+
+    EventWire::FieldEntry field;
+    std::memcpy(&field, m_table.constData() + m_next * sizeof(EventWire::FieldEntry), sizeof(field));
+    m_next++;
+
+    // 顺序读取要求名称和值都在当前位置之后
+    const qint64 nameEnd = qint64(field.nameOffset) + qint64(field.nameLength) * 2;
+    if (!validEntry(field, m_header.totalSize)
+        || field.nameOffset < m_position || field.offset < nameEnd) {
+        return false;
+    }
+
+    if (!skipTo(field.nameOffset)) {
+        return false;
+    }
+    if (name) {
+        QString fieldName(field.nameLength, Qt::Uninitialized);
+        if (!readFully(reinterpret_cast<char*>(fieldName.data()), nameEnd - field.nameOffset)) {
+            return false;
+        }
+        *name = fieldName;
+    }
+    if (!skipTo(field.offset)) {
+        return false;
+    }
+    if (!value) {
+        return skipTo(qint64(field.offset) + field.length);
+    }
+
+    switch (field.type) {
+    case EventWire::Null:
+        *value = QVariant();
+        return true;
+    case EventWire::Bool:
+    case EventWire::Int:
+    case EventWire::UInt:
+    case EventWire::Double: {
+        char scalar[8];
+        if (!readFully(scalar, field.length)) {
+            return false;
+        }
+        *value = scalarValue(field, scalar);
+        return true;
+    }
+    case EventWire::String: {
+        QString string(qsizetype(field.length / sizeof(char16_t)), Qt::Uninitialized);
+        if (!readFully(reinterpret_cast<char*>(string.data()), field.length)) {
+            return false;
+        }
+        *value = string;
+        return true;
+    }
+    case EventWire::Bytes: {
+        QByteArray bytes(qsizetype(field.length), Qt::Uninitialized);
+        if (!readFully(bytes.data(), field.length)) {
+            return false;
+        }
+        *value = bytes;
+        return true;
+    }
+    case EventWire::Variant: {
+        LimitedReadDevice limited(m_device, field.length, &m_checksum);
+        QDataStream stream(&limited);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream >> *value;
+        m_position += limited.consumed();
+        if (stream.status() != QDataStream::Ok) {
+            return false;
+        }
+        return skipTo(qint64(field.offset) + field.length);
+    }
+    default:
+        return false;
+    }
+}
+
+bool EventWireStreamReader::finish()
+{
+    if (!m_headerRead) {
+        return false;
+    }
+    while (hasNext()) {
+        if (!readNext(nullptr, nullptr)) {
+            return false;
+        }
+    }
+    if (!skipTo(m_header.totalSize)) {
+        return false;
+    }
+    return !(m_header.flags & EventWire::Checksummed) || m_checksum == m_header.checksum;
+}
+
+bool EventWireStreamReader::readFully(char* data, qint64 length)
+{
+    while (length > 0) {
+        const qint64 got = m_device->read(data, qMin(length, m_chunkBytes));
+        if (got < 0) {
+            return false;
+        }
+        if (got == 0) {
+            if (!m_device->waitForReadyRead(DeviceTimeoutMs)) {
+                return false;
+            }
+            continue;
+        }
+        m_checksum = Crc32c::update(m_checksum, data, got);
+        data += got;
+        length -= got;
+        m_position += got;
+    }
+    return true;
+}
+
+bool EventWireStreamReader::skipTo(qint64 position)
+{
+    if (position < m_position) {
+        return false;
+    }
+
+    char scratch[256];
+    while (m_position < position) {
+        if (!readFully(scratch, qMin<qint64>(position - m_position, sizeof(scratch)))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,371 @@
+#ifndef EVENT_WIRE_FORMAT_H
+#define EVENT_WIRE_FORMAT_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QVariant>
+#include <QVarLengthArray>
+#include <QtGlobal>
+
+/**
+ * @brief 事件二进制线格式
+ *
+ * 布局：定长头部 + 字段偏移表 + 数据区。每个字段在偏移表中记录名称和值
+ * 在缓冲区中的偏移与长度；名称和值都按8字节对齐存放，整数、浮点数和
+ * UTF-16字符串可以直接在缓冲区上原位读取。
+ *
+ *   Header      32字节：魔数、版本、标志、事件类型、字段数、时间戳、总长度
+ *   FieldEntry  每字段16字节：名称偏移/长度、字段类型、值偏移/长度
+ *   Schema      可选（FieldIds标志）：quint16模式版本 + 每字段一个quint16字段ID
+ *   Data        名称与值，各自按8字节对齐
+ *
+ * 多字节数值按写入端的本机字节序存放，头部标志记录字节序，字节序不同的
+ * 缓冲区视为无效。无法映射到固定类型的QVariant以QDataStream编码为
+ * Variant字段，读取时才解码。
+ *
+ * 字段按偏移表顺序连续存放，因此同一格式也能在QIODevice上流式读写：
+ * EventWireWriter::writeTo()分块写出，EventWireStreamReader逐字段读入。
+ *
+ * 每个事件带CRC32C校验（Checksummed标志），覆盖头部的checksum字段以外的
+ * 全部字节；EventWireView构造时和EventWireStreamReader::finish()时校验，
+ * 损坏的数据不会被当作有效事件加载。
+ *
+ * 模式段让事件布局可以演进：字段ID在改名后保持不变，读取端按ID定位字段，
+ * 不认识的ID直接跳过；没有模式段的旧缓冲区仍按名称识别，见 EventSchema。
+ * 模式段位于偏移表和数据区之间，不认识该标志的读取端按偏移读取时自然跳过。
+ */
+namespace EventWire {
+
+enum : quint32 { Magic = 0x46575645 };      // "EVWF"
+enum : quint16 { Version = 1 };
+enum : qint64 { DefaultChunkBytes = 64 * 1024 };     // 流式读写的单次块大小
+
+enum FieldType : quint8 {
+    Invalid = 0,
+    Null,
+    Bool,
+    Int,            // qint64
+    UInt,           // quint64
+    Double,
+    String,         // UTF-16
+    Bytes,
+    Variant         // QDataStream编码的QVariant
+};
+
+enum HeaderFlag : quint16 {
+    BigEndian = 0x0001,     // 写入端为大端字节序
+    MapRoot = 0x0002,       // 各字段组成一个QVariantMap（DataEvent）
+    Checksummed = 0x0004,   // Header::checksum有效
+    FieldIds = 0x0008       // 偏移表之后有模式段
+};
+
+struct Header {
+    quint32 magic;
+    quint16 version;
+    quint16 flags;
+    quint32 eventType;
+    quint32 fieldCount;
+    qint64 timestamp;
+    quint32 totalSize;
+    quint32 checksum;       // CRC32C，覆盖除本字段外的整个事件
+};
+
+struct FieldEntry {
+    quint32 nameOffset;
+    quint16 nameLength;     // UTF-16码元数
+    quint8 type;            // FieldType
+    quint8 metaType;        // 原QMetaType id（小于256时），还原QVariant时恢复原类型
+    quint32 offset;
+    quint32 length;         // 字节数
+};
+
+static_assert(sizeof(Header) == 32, "EventWire::Header layout");
+static_assert(sizeof(FieldEntry) == 16, "EventWire::FieldEntry layout");
+
+/**
+ * @brief 判断缓冲区是否以线格式魔数开头
+ */
+bool isWireFormat(const QByteArray& buffer);
+
+/**
+ * @brief 把已编码的缓冲区分块写入设备
+ */
+bool writeChunked(QIODevice* device, const QByteArray& bytes, qint64 chunkBytes = DefaultChunkBytes);
+
+/**
+ * @brief 事件的CRC32C，跳过头部的checksum字段
+ * @param frame 事件起始
+ * @param size 事件总长度，不小于头部长度
+ */
+quint32 frameChecksum(const char* frame, qint64 size);
+
+/**
+ * @brief verifyFrames()的结果
+ */
+struct VerifyReport {
+    qint64 frames;          // 读到的完整事件数
+    qint64 unchecked;       // 其中没有校验值的事件数
+    qint64 bytes;           // 已校验的字节数
+    qint64 errorOffset;     // 第一个损坏事件的起始位置，-1表示没有错误
+
+    VerifyReport() : frames(0), unchecked(0), bytes(0), errorOffset(-1) {}
+
+    bool isOk() const { return errorOffset < 0; }
+};
+
+/**
+ * @brief 顺序校验设备上连续存放的事件，不解码任何字段
+ *
+ * 每个事件只经过一个固定大小的读缓冲，CRC按块累加，校验速度受限于
+ * 设备读取速度而不是CPU。遇到头部无效、长度不足或校验不符时停止。
+ */
+VerifyReport verifyFrames(QIODevice* device, qint64 chunkBytes = DefaultChunkBytes);
+
+/**
+ * @brief 计算QVariant以QDataStream(Qt_6_0)编码后的字节数，不实际编码
+ *
+ * 逐层访问数值、字符串、字节数组、列表、映射和几何类型并累加长度；
+ * 其余类型退回到实际编码后测量。
+ */
+qint64 variantStreamSize(const QVariant& value);
+
+} // namespace EventWire
+
+/**
+ * @brief EventWireWriter 线格式编码器
+ *
+ * 先登记字段（字段名复制保存，字符串、字节数组值只记录来源视图），
+ * finish()时一次性分配最终缓冲区并把值直接拷贝到位，大负载只经历一次
+ * memcpy。经addString()/addBytes()登记的值在finish()之前必须保持有效。
+ * 复合类型的QDataStream编码也推迟到finish()，只需要长度时调用size()，
+ * 不会产生任何编码开销。
+ */
+class EventWireWriter
+{
+public:
+    EventWireWriter(int eventType, qint64 timestamp);
+
+    void setFlags(quint16 flags) { m_flags = flags; }
+    void reserve(int fieldCount);
+
+    void addNull(QStringView name);
+    void addBool(QStringView name, bool value);
+    void addInt(QStringView name, qint64 value);
+    void addUInt(QStringView name, quint64 value);
+    void addDouble(QStringView name, double value);
+    void addString(QStringView name, QStringView value);
+    void addBytes(QStringView name, QByteArrayView value);
+
+    /**
+     * @brief 按QVariant的类型选择字段类型，其余类型以QDataStream编码
+     *
+     * 写入器持有value的隐式共享副本，value可以是临时对象。
+     */
+    void addVariant(QStringView name, const QVariant& value);
+
+    int fieldCount() const { return m_fields.size(); }
+
+    /**
+     * @brief 写出模式段，记录模式版本和各字段ID
+     *
+     * 不调用时不写模式段，输出与没有模式的版本完全相同。
+     */
+    void setSchemaVersion(quint16 version);
+
+    /**
+     * @brief 设置第index个已登记字段的ID，0表示没有ID（读取端按名称识别）
+     */
+    void setFieldId(int index, quint16 id);
+
+    /**
+     * @brief finish()将生成的缓冲区长度，不编码任何字段
+     */
+    qint64 size() const;
+
+    /**
+     * @brief 生成缓冲区
+     */
+    QByteArray finish() const;
+
+    /**
+     * @brief 把与finish()相同的字节流分块写入设备，不在内存中生成整个缓冲区
+     *
+     * 偏移表按各字段长度先行写出；字符串、字节数组从来源直接分块写入，
+     * 复合类型经QDataStream直接编码到设备。设备写缓冲积压超过一个块时
+     * 等待其写出，峰值内存与负载大小无关。校验值在写出过程中累加，写完后
+     * 回写到头部，因此只有可随机访问的设备（文件、QBuffer）会带校验值。
+     * @param device 已打开的可写设备
+     * @param chunkBytes 单次写入上限
+     */
+    bool writeTo(QIODevice* device, qint64 chunkBytes = EventWire::DefaultChunkBytes) const;
+
+private:
+    struct PendingField {
+        qsizetype nameStart;        // 在m_names中的位置
+        qsizetype nameLength;
+        EventWire::FieldType type;
+        int metaType;
+        const void* data;           // 字符串/字节数组的来源
+        qsizetype length;
+        quint64 scalar;             // 标量按位保存
+        QVariant variant;           // addVariant()登记的值，Variant字段在finish()时编码
+        quint16 fieldId;
+    };
+
+    void addField(QStringView name, EventWire::FieldType type, int metaType,
+                  const void* data, qsizetype length, quint64 scalar,
+                  const QVariant& variant = QVariant());
+
+    // encoded为空时按估算长度计算Variant字段
+    qint64 fieldLength(int index, const QList<QByteArray>& encoded) const;
+    qint64 layoutSize(const QList<QByteArray>& encoded) const;
+    qint64 tableEnd() const;
+    quint16 headerFlags(bool checksummed) const;
+    QByteArray schemaSection() const;
+
+    quint32 m_eventType;
+    qint64 m_timestamp;
+    quint16 m_flags;
+    bool m_hasSchema;
+    quint16 m_schemaVersion;
+    QVarLengthArray<PendingField, 16> m_fields;
+    QString m_names;
+    int m_variantFields;
+};
+
+/**
+ * @brief EventWireView 线格式只读视图
+ *
+ * 构造时只校验头部和偏移表的边界（O(字段数)，不解码任何值）；访问器按
+ * 需读取单个字段，字符串和字节数组以视图形式直接指向缓冲区。视图持有
+ * 缓冲区的隐式共享引用，拷贝视图不会拷贝数据。若传入的缓冲区起始地址
+ * 不满足UTF-16对齐（如从奇数位置mid()得到的切片），会先复制一份副本。
+ */
+class EventWireView
+{
+public:
+    EventWireView();
+    explicit EventWireView(const QByteArray& buffer);
+
+    bool isValid() const { return m_valid; }
+
+    int eventType() const;
+    qint64 timestamp() const;
+    quint16 flags() const;
+    int fieldCount() const;
+
+    /**
+     * @brief 写入时的模式版本，没有模式段时返回0
+     */
+    quint16 schemaVersion() const;
+
+    /**
+     * @brief 字段ID，没有模式段或该字段没有ID时返回0
+     */
+    quint16 fieldId(int index) const;
+
+    QStringView fieldName(int index) const;
+    EventWire::FieldType fieldType(int index) const;
+
+    /**
+     * @brief 字段还原为QVariant后的QMetaType id，不解码值
+     *
+     * 以QDataStream编码的自定义类型返回QMetaType::UnknownType。
+     */
+    int fieldMetaType(int index) const;
+
+    /**
+     * @brief 按名称查找字段，线性比较偏移表中的名称，不解码值
+     * @param name 字段名
+     * @param from 起始下标
+     * @return 字段下标，不存在时返回-1
+     */
+    int indexOf(QStringView name, int from = 0) const;
+
+    bool toBool(int index) const;
+    qint64 toInt(int index) const;
+    quint64 toUInt(int index) const;
+    double toDouble(int index) const;
+    QStringView toStringView(int index) const;
+    QByteArrayView toBytes(int index) const;
+
+    /**
+     * @brief 把字段还原为QVariant（仅在需要时调用）
+     */
+    QVariant value(int index) const;
+
+    QByteArray buffer() const { return m_buffer; }
+
+private:
+    // 头部和偏移表只保证2字节对齐，按值读取
+    EventWire::FieldEntry entry(int index) const;
+    quint16 schemaValue(int index) const;      // -1为模式版本
+    const char* at(quint32 offset) const { return m_buffer.constData() + offset; }
+
+    QByteArray m_buffer;
+    EventWire::Header m_header;
+    bool m_valid;
+};
+
+/**
+ * @brief EventWireStreamReader 从设备增量读取线格式
+ *
+ * readHeader()读取头部和偏移表后，readNext()按顺序逐个解码字段：字符串
+ * 和字节数组分块直接读入结果对象，复合类型经QDataStream从设备增量解码，
+ * 不会先把整个事件读入内存。读取中途数据不足时会等待设备就绪。
+ * 校验值在finish()时才能确定，调用方必须以finish()的结果为准再使用已读出的字段。
+ */
+class EventWireStreamReader
+{
+public:
+    explicit EventWireStreamReader(QIODevice* device, qint64 chunkBytes = EventWire::DefaultChunkBytes);
+
+    /**
+     * @brief 读取并校验头部和偏移表
+     */
+    bool readHeader();
+
+    int eventType() const { return int(m_header.eventType); }
+    qint64 timestamp() const { return m_header.timestamp; }
+    quint16 flags() const { return m_header.flags; }
+    int fieldCount() const { return m_headerRead ? int(m_header.fieldCount) : 0; }
+    bool hasNext() const { return m_next < fieldCount(); }
+
+    /**
+     * @brief 模式版本和字段ID，含义同 EventWireView
+     */
+    quint16 schemaVersion() const;
+    quint16 fieldId(int index) const;
+
+    /**
+     * @brief 读取下一个字段
+     * @param name 字段名，可为nullptr
+     * @param value 字段值，可为nullptr（只跳过）
+     */
+    bool readNext(QString* name, QVariant* value);
+
+    /**
+     * @brief 跳过剩余字段和尾部填充，使设备停在本事件之后，并核对校验值
+     */
+    bool finish();
+
+private:
+    bool readFully(char* data, qint64 length);
+    quint16 schemaValue(int index) const;
+    bool skipTo(qint64 position);
+
+    QIODevice* m_device;
+    qint64 m_chunkBytes;
+    EventWire::Header m_header;
+    QByteArray m_table;         // 偏移表和模式段
+    bool m_headerRead;
+    int m_next;
+    qint64 m_position;          // 已读取的字节数（相对事件起始）
+    quint32 m_checksum;         // 已读取字节的CRC32C
+};
+
+#endif // EVENT_WIRE_FORMAT_H
@@ -0,0 +1,128 @@
+#include "hardware_counter_sampler.h"
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace {
+
+long perfEventOpen(perf_event_attr* attr, pid_t pid, int cpu, int groupFd, unsigned long flags)
+{
+    return syscall(__NR_perf_event_open, attr, pid, cpu, groupFd, flags);
+}
+
+} // namespace
+#endif
+
+HardwareCounterSampler* HardwareCounterSampler::forCurrentThread()
+{
+    // 计数器只统计打开它的线程，因此每个线程一份
+    thread_local HardwareCounterSampler sampler;
+    return &sampler;
+}
+
+HardwareCounterSampler::HardwareCounterSampler()
+    : m_available(false)
+{
+    for (int i = 0; i < CounterCount; ++i) {
+        m_fds[i] = -1;
+    }
+
+#ifdef Q_OS_LINUX
+    const quint64 configs[CounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int i = 0; i < CounterCount; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = (i == 0) ? 1 : 0;   // 组长启用时整组一起启用
+        attr.exclude_kernel = 1;            // 非特权用户通常只能统计用户态
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        int groupFd = (i == 0) ? -1 : m_fds[0];
+        long fd = perfEventOpen(&attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) {
+            qDebug() << "Hardware counters unavailable (perf_event_open failed for counter" << i << ")";
+            closeAll();
+            return;
+        }
+        m_fds[i] = static_cast<int>(fd);
+    }
+
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    m_available = true;
+#else
+    qDebug() << "Hardware counters are only supported on Linux";
+#endif
+}
+
+HardwareCounterSampler::~HardwareCounterSampler()
+{
+    closeAll();
+}
+
+bool HardwareCounterSampler::read(Sample& sample) const
+{
+    if (!m_available) {
+        return false;
+    }
+
+#ifdef Q_OS_LINUX
+    // PERF_FORMAT_GROUP 布局: nr, value[nr]
+    struct {
+        quint64 nr;
+        quint64 values[CounterCount];
+    } buffer;
+
+    ssize_t bytes = ::read(m_fds[0], &buffer, sizeof(buffer));
+    if (bytes != static_cast<ssize_t>(sizeof(buffer)) || buffer.nr != CounterCount) {
+        return false;
+    }
+
+    sample.cycles = buffer.values[0];
+    sample.instructions = buffer.values[1];
+    sample.cacheMisses = buffer.values[2];
+    sample.branchMisses = buffer.values[3];
+    return true;
+#else
+    Q_UNUSED(sample)
+    return false;
+#endif
+}
+
+HardwareCounterSampler::Sample HardwareCounterSampler::delta(const Sample& begin, const Sample& end)
+{
+    Sample result;
+    result.cycles = end.cycles - begin.cycles;
+    result.instructions = end.instructions - begin.instructions;
+    result.cacheMisses = end.cacheMisses - begin.cacheMisses;
+    result.branchMisses = end.branchMisses - begin.branchMisses;
+    return result;
+}
+
+void HardwareCounterSampler::closeAll()
+{
+#ifdef Q_OS_LINUX
+    // 先关闭成员计数器，最后关闭组长
+    for (int i = CounterCount - 1; i >= 0; --i) {
+        if (m_fds[i] >= 0) {
+            ::close(m_fds[i]);
+            m_fds[i] = -1;
+        }
+    }
+#endif
+    m_available = false;
+}
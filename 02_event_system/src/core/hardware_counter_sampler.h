@@ -0,0 +1,82 @@
+#ifndef HARDWARE_COUNTER_SAMPLER_H
+#define HARDWARE_COUNTER_SAMPLER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief HardwareCounterSampler 硬件性能计数器采样器
+ *
+ * 基于Linux perf_event_open 的线程级计数器组，一次读取即可获得
+ * 周期数、指令数、缓存未命中和分支预测失败次数。
+ * 每个线程拥有独立的计数器组（计数器只统计打开它的线程），
+ * 在非Linux平台或内核/权限不允许时自动降级为不可用状态。
+ */
+class HardwareCounterSampler
+{
+public:
+    /**
+     * @brief 计数器原始读数
+     */
+    struct Sample {
+        quint64 cycles;         // CPU周期数
+        quint64 instructions;   // 退休指令数
+        quint64 cacheMisses;    // 末级缓存未命中次数
+        quint64 branchMisses;   // 分支预测失败次数
+
+        Sample() : cycles(0), instructions(0), cacheMisses(0), branchMisses(0) {}
+    };
+
+    /**
+     * @brief 获取当前线程的采样器（首次调用时打开计数器）
+     * @return 当前线程的采样器
+     */
+    static HardwareCounterSampler* forCurrentThread();
+
+    /**
+     * @brief 检查计数器是否可用
+     * @return 计数器是否成功打开
+     */
+    bool isAvailable() const { return m_available; }
+
+    /**
+     * @brief 读取当前计数器值
+     * @param sample 输出的读数
+     * @return 读取是否成功
+     */
+    bool read(Sample& sample) const;
+
+    /**
+     * @brief 计算两次读数之间的增量
+     * @param begin 起始读数
+     * @param end 结束读数
+     * @return 增量读数
+     */
+    static Sample delta(const Sample& begin, const Sample& end);
+
+private:
+    /**
+     * @brief 私有构造函数，打开当前线程的计数器组
+     */
+    HardwareCounterSampler();
+
+    /**
+     * @brief 析构函数，线程退出时关闭计数器
+     */
+    ~HardwareCounterSampler();
+
+    // 禁用拷贝
+    HardwareCounterSampler(const HardwareCounterSampler&) = delete;
+    HardwareCounterSampler& operator=(const HardwareCounterSampler&) = delete;
+
+    /**
+     * @brief 关闭所有已打开的计数器
+     */
+    void closeAll();
+
+    enum { CounterCount = 4 };
+
+    int m_fds[CounterCount];    // 计数器文件描述符，m_fds[0]为组长
+    bool m_available;
+};
+
+#endif // HARDWARE_COUNTER_SAMPLER_H
@@ -0,0 +1,267 @@
+#include "key_value_update_channel.h"
+#include <QVarLengthArray>
+
+namespace {
+
+std::atomic<quint64> g_nextChannelSerial(1);
+
+// 存活的通道，线程退出时据此判断绑定的通道是否已销毁
+QMutex g_liveChannelsMutex;
+QHash<quint64, KeyValueUpdateChannel*> g_liveChannels;
+
+} // namespace
+
+/**
+ * @brief 生产者线程的双缓冲
+ *
+ * front由生产者写入时交换为nullptr独占，写完放回；消费者只在front非空时
+ * 以CAS换入spare并取走原表，front只有生产者会置空，所以生产者的交换总能
+ * 取到一张表。spare只由消费者访问。
+ */
+struct KeyValueUpdateChannel::Producer
+{
+    alignas(64) std::atomic<Buffer*> front;
+    std::atomic<quint64> writes;    // 单写者计数器
+    Buffer* spare;
+    Buffer buffers[2];
+    bool bound;
+
+    Producer() : front(&buffers[0]), writes(0), spare(&buffers[1]), bound(true) {}
+};
+
+/**
+ * @brief 线程到通道生产者的绑定表
+ *
+ * 线程退出时把仍存活的通道的生产者标记为空闲，缓冲中未交付的数据照常由消费者取走。
+ */
+struct KeyValueThreadBindings
+{
+    struct Binding {
+        KeyValueUpdateChannel* channel;
+        quint64 serial;
+        KeyValueUpdateChannel::Producer* producer;
+    };
+
+    QVarLengthArray<Binding, 4> bindings;
+
+    ~KeyValueThreadBindings()
+    {
+        QMutexLocker locker(&g_liveChannelsMutex);
+        for (const Binding& binding : bindings) {
+            if (g_liveChannels.value(binding.serial) == binding.channel) {
+                binding.channel->retireProducer(binding.producer);
+            }
+        }
+    }
+};
+
+namespace {
+thread_local KeyValueThreadBindings t_channelBindings;
+}
+
+KeyValueUpdateChannel::KeyValueUpdateChannel(QObject* parent)
+    : QObject(parent)
+    , m_sequence(0)
+    , m_armed(false)
+    , m_timer(new QTimer(this))
+    , m_frameIntervalMs(16)
+    , m_serial(g_nextChannelSerial.fetch_add(1, std::memory_order_relaxed))
+    , m_frames(0)
+    , m_keysDelivered(0)
+    , m_deferredSwaps(0)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &KeyValueUpdateChannel::deliverFrame);
+
+    QMutexLocker locker(&g_liveChannelsMutex);
+    g_liveChannels.insert(m_serial, this);
+}
+
+KeyValueUpdateChannel::~KeyValueUpdateChannel()
+{
+    {
+        QMutexLocker locker(&g_liveChannelsMutex);
+        g_liveChannels.remove(m_serial);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    qDeleteAll(m_producers);
+    m_producers.clear();
+}
+
+void KeyValueUpdateChannel::write(const QString& key, const QVariant& value)
+{
+    Producer* self = producer();
+
+    // 消费者从不把front置空，这里总能取到前台表或刚换入的后台表
+    Buffer* buffer = self->front.exchange(nullptr, std::memory_order_acquire);
+
+    Entry& entry = (*buffer)[key];
+    entry.value = value;
+    entry.sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+
+    self->front.store(buffer, std::memory_order_release);
+    self->writes.store(self->writes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    // 空闲后的首次写入负责唤醒消费者
+    arm();
+}
+
+QVariantHash KeyValueUpdateChannel::consume()
+{
+    // 先解除调度标记，此后的写入会重新投递帧调度，不会遗漏
+    m_armed.store(false, std::memory_order_release);
+
+    QList<Producer*> producers;
+    {
+        QMutexLocker locker(&m_mutex);
+        producers = m_producers;
+    }
+
+    bool deferred = false;
+    for (Producer* source : producers) {
+        // 生产者正在写入时不等待，下一帧再取
+        Buffer* full = source->front.load(std::memory_order_acquire);
+        if (!full || !source->front.compare_exchange_strong(full, source->spare,
+                                                            std::memory_order_acq_rel,
+                                                            std::memory_order_acquire)) {
+            m_deferredSwaps++;
+            deferred = true;
+            continue;
+        }
+        source->spare = full;
+
+        for (auto it = full->constBegin(); it != full->constEnd(); ++it) {
+            // 推迟交换的生产者可能带来比上一帧已交付值更旧的写入
+            auto delivered = m_deliveredSequences.constFind(it.key());
+            if (delivered != m_deliveredSequences.constEnd() && delivered.value() > it->sequence) {
+                continue;
+            }
+            auto existing = m_merged.find(it.key());
+            if (existing == m_merged.end()) {
+                m_merged.insert(it.key(), it.value());
+            } else if (existing->sequence < it->sequence) {
+                *existing = it.value();
+            }
+        }
+        clearRetainingCapacity(*full);
+    }
+
+    if (deferred) {
+        arm();
+    }
+
+    QVariantHash updates;
+    updates.reserve(m_merged.size());
+    for (auto it = m_merged.constBegin(); it != m_merged.constEnd(); ++it) {
+        updates.insert(it.key(), it->value);
+        m_deliveredSequences.insert(it.key(), it->sequence);
+    }
+    clearRetainingCapacity(m_merged);
+    return updates;
+}
+
+void KeyValueUpdateChannel::setFrameInterval(int intervalMs)
+{
+    m_frameIntervalMs = qMax(0, intervalMs);
+}
+
+KeyValueUpdateChannel::Metrics KeyValueUpdateChannel::metrics() const
+{
+    Metrics metrics;
+    metrics.frames = m_frames;
+    metrics.keysDelivered = m_keysDelivered;
+    metrics.deferredSwaps = m_deferredSwaps;
+
+    QMutexLocker locker(&m_mutex);
+    metrics.producers = m_producers.size();
+    for (const Producer* source : m_producers) {
+        metrics.writes += source->writes.load(std::memory_order_relaxed);
+    }
+    return metrics;
+}
+
+void KeyValueUpdateChannel::scheduleFrame()
+{
+    if (!m_timer->isActive()) {
+        m_timer->start(m_frameIntervalMs);
+    }
+}
+
+void KeyValueUpdateChannel::deliverFrame()
+{
+    const QVariantHash updates = consume();
+    if (updates.isEmpty()) {
+        return;
+    }
+
+    m_frames++;
+    m_keysDelivered += updates.size();
+    emit updatesReady(updates);
+}
+
+KeyValueUpdateChannel::Producer* KeyValueUpdateChannel::producer()
+{
+    for (const KeyValueThreadBindings::Binding& binding : t_channelBindings.bindings) {
+        if (binding.channel == this && binding.serial == m_serial) {
+            return binding.producer;
+        }
+    }
+    return bindProducer();
+}
+
+KeyValueUpdateChannel::Producer* KeyValueUpdateChannel::bindProducer()
+{
+    Producer* result = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Producer* candidate : m_producers) {
+            if (!candidate->bound) {
+                result = candidate;
+                break;
+            }
+        }
+        if (!result) {
+            result = new Producer();
+            m_producers.append(result);
+        }
+        result->bound = true;
+    }
+
+    // 顺便清理已销毁通道留下的绑定
+    QVarLengthArray<KeyValueThreadBindings::Binding, 4>& bindings = t_channelBindings.bindings;
+    {
+        QMutexLocker locker(&g_liveChannelsMutex);
+        for (int i = bindings.size() - 1; i >= 0; --i) {
+            if (g_liveChannels.value(bindings[i].serial) != bindings[i].channel) {
+                bindings.remove(i);
+            }
+        }
+    }
+
+    bindings.append({ this, m_serial, result });
+    return result;
+}
+
+void KeyValueUpdateChannel::arm()
+{
+    if (!m_armed.load(std::memory_order_relaxed)
+        && !m_armed.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &KeyValueUpdateChannel::scheduleFrame, Qt::QueuedConnection);
+    }
+}
+
+void KeyValueUpdateChannel::clearRetainingCapacity(Buffer& buffer)
+{
+    // QHash::clear()会释放全部存储，逐个删除则保留已分配的桶，下一帧不必重新分配
+    for (auto it = buffer.begin(); it != buffer.end(); ) {
+        it = buffer.erase(it);
+    }
+}
+
+void KeyValueUpdateChannel::retireProducer(Producer* producer)
+{
+    QMutexLocker locker(&m_mutex);
+    producer->bound = false;
+}
@@ -0,0 +1,125 @@
+#ifndef KEY_VALUE_UPDATE_CHANNEL_H
+#define KEY_VALUE_UPDATE_CHANNEL_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <QVariantHash>
+#include <atomic>
+
+/**
+ * @brief KeyValueUpdateChannel 跨线程键值更新通道（按键最后写入者胜出）
+ *
+ * 生产者可在任意线程调用write()，消费者（通道所在线程，通常是GUI线程）
+ * 每帧收到一份合并后的键值表：同一个键在一帧内被写多少次，消费者都只
+ * 处理一次最新值。
+ *
+ * 每个生产者线程持有自己的一对缓冲表（双缓冲）：写入时用原子交换取得
+ * 前台表、写完放回，不与其他生产者共享任何锁。消费者只用一次CAS把未被
+ * 占用的前台表换成空的后台表；生产者正在写入时不等待，该线程的更新推迟
+ * 到下一帧交付。因此生产者和消费者都不会自旋等待对方（wait-free），
+ * 代价是繁忙的生产者偶尔晚一帧。跨线程的先后由全局序号决定；消费者
+ * 记住每个键已交付的序号，晚到的旧写入不会覆盖已交付的新值。
+ * 通道空闲时不产生任何定时器唤醒，首次写入才投递一次帧调度。
+ *
+ * 各缓冲表和合并表逐帧复用，清空时保留已分配的桶，稳态下每帧只分配
+ * 交付给消费者的那份QVariantHash。
+ *
+ * 销毁通道前必须保证不再有线程调用write()。
+ */
+class KeyValueUpdateChannel : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 通道统计
+     */
+    struct Metrics {
+        quint64 writes;             // 生产者写入次数
+        quint64 frames;             // 交付的帧数
+        quint64 keysDelivered;      // 累计交付的键数
+        quint64 deferredSwaps;      // 交换时生产者正在写入、推迟到下一帧的次数
+        int producers;              // 已登记的生产者线程数
+
+        Metrics() : writes(0), frames(0), keysDelivered(0), deferredSwaps(0), producers(0) {}
+
+        // 被合并掉的写入占比
+        double compressionRatio() const
+        {
+            return writes > 0 ? 1.0 - static_cast<double>(keysDelivered) / writes : 0.0;
+        }
+    };
+
+    explicit KeyValueUpdateChannel(QObject* parent = nullptr);
+    ~KeyValueUpdateChannel() override;
+
+    /**
+     * @brief 写入一个键值，可在任意线程调用
+     */
+    void write(const QString& key, const QVariant& value);
+
+    /**
+     * @brief 立即取走所有线程已写入的更新，只能在通道所在线程调用
+     */
+    QVariantHash consume();
+
+    /**
+     * @brief 帧间隔（毫秒），默认16
+     */
+    void setFrameInterval(int intervalMs);
+    int frameInterval() const { return m_frameIntervalMs; }
+
+    Metrics metrics() const;
+
+signals:
+    /**
+     * @brief 每帧交付一次合并后的更新
+     */
+    void updatesReady(const QVariantHash& updates);
+
+private slots:
+    void scheduleFrame();
+    void deliverFrame();
+
+private:
+    Q_DISABLE_COPY(KeyValueUpdateChannel)
+
+    struct Entry {
+        QVariant value;
+        quint64 sequence;
+    };
+    using Buffer = QHash<QString, Entry>;
+    struct Producer;
+    friend struct KeyValueThreadBindings;
+
+    Producer* producer();
+    Producer* bindProducer();
+    void retireProducer(Producer* producer);
+    void arm();
+    static void clearRetainingCapacity(Buffer& buffer);
+
+    // 生产者表只增不减（线程退出后留给新线程复用），受m_mutex保护
+    mutable QMutex m_mutex;
+    QList<Producer*> m_producers;
+
+    alignas(64) std::atomic<quint64> m_sequence;
+    alignas(64) std::atomic<bool> m_armed;      // 已投递帧调度且尚未交付
+
+    QTimer* m_timer;
+    int m_frameIntervalMs;
+    quint64 m_serial;
+
+    // 消费者线程独占
+    Buffer m_merged;
+    QHash<QString, quint64> m_deliveredSequences;   // 每个键最近交付的序号
+    quint64 m_frames;
+    quint64 m_keysDelivered;
+    quint64 m_deferredSwaps;
+};
+
+#endif // KEY_VALUE_UPDATE_CHANNEL_H
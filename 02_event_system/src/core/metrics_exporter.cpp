@@ -0,0 +1,453 @@
+#include "metrics_exporter.h"
+#include "event_performance_analyzer.h"
+#include "event_logger.h"
+#include "event_manager.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+
+namespace {
+
+QByteArray escapeLabelValue(const QString& value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace("\\", "\\\\");
+    escaped.replace("\"", "\\\"");
+    escaped.replace("\n", "\\n");
+    return escaped;
+}
+
+QByteArray eventTypeLabel(const QString& typeName)
+{
+    return "event_type=\"" + escapeLabelValue(typeName) + "\"";
+}
+
+QByteArray eventTypeLabel(const QHash<QEvent::Type, QString>& typeNames, QEvent::Type type)
+{
+    // 名称表由快照发布方解析，这里不获取EventManager的锁
+    auto it = typeNames.constFind(type);
+    if (it != typeNames.constEnd()) {
+        return eventTypeLabel(it.value());
+    }
+    return eventTypeLabel(QString("UnknownEvent_%1").arg(static_cast<int>(type)));
+}
+
+QByteArray formatDouble(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+QByteArray formatSeconds(qint64 ns)
+{
+    return formatDouble(static_cast<double>(ns) / 1000000000.0);
+}
+
+void writeFamilyHeader(QByteArray& out, const char* name, const char* type,
+                       const char* help, const char* unit = nullptr)
+{
+    out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+    if (unit) {
+        out += "# UNIT "; out += name; out += ' '; out += unit; out += '\n';
+    }
+    out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+}
+
+void writeSample(QByteArray& out, const char* name, const char* suffix,
+                 const QByteArray& labels, const QByteArray& value)
+{
+    out += name;
+    out += suffix;
+    if (!labels.isEmpty()) {
+        out += '{'; out += labels; out += '}';
+    }
+    out += ' '; out += value; out += '\n';
+}
+
+void writeHistogram(QByteArray& out, const char* name, const QByteArray& labels,
+                    const EventPerformanceAnalyzer::LatencyHistogram& histogram)
+{
+    typedef EventPerformanceAnalyzer::LatencyHistogram Histogram;
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+
+    // OpenMetrics的桶是累计的
+    quint64 cumulative = 0;
+    for (int i = 0; i < Histogram::BucketCount; ++i) {
+        cumulative += histogram.buckets[i];
+        writeSample(out, name, "_bucket",
+                    prefix + "le=\"" + formatSeconds(Histogram::BucketBoundsNs[i]) + "\"",
+                    QByteArray::number(cumulative));
+    }
+    writeSample(out, name, "_bucket", prefix + "le=\"+Inf\"", QByteArray::number(histogram.count));
+    writeSample(out, name, "_count", labels, QByteArray::number(histogram.count));
+    writeSample(out, name, "_sum", labels, formatSeconds(histogram.sumNs));
+}
+
+} // namespace
+
+/**
+ * @brief MetricsExporterWorker 运行在导出线程中的服务端
+ *
+ * 持有监听器和刷新定时器；所有方法都只在导出线程中调用。
+ */
+class MetricsExporterWorker : public QObject
+{
+public:
+    explicit MetricsExporterWorker(MetricsExporter* owner)
+        : m_owner(owner)
+        , m_tcpServer(nullptr)
+        , m_localServer(nullptr)
+        , m_refreshTimer(nullptr)
+    {
+    }
+
+    void initialize(int refreshIntervalMs)
+    {
+        m_refreshTimer = new QTimer(this);
+        connect(m_refreshTimer, &QTimer::timeout, this, [this]() { refresh(); });
+        m_refreshTimer->start(refreshIntervalMs);
+        refresh();
+    }
+
+    void setRefreshInterval(int intervalMs)
+    {
+        if (m_refreshTimer) {
+            m_refreshTimer->start(intervalMs);
+        }
+    }
+
+    quint16 listenTcp(quint16 port)
+    {
+        if (!m_tcpServer) {
+            m_tcpServer = new QTcpServer(this);
+            connect(m_tcpServer, &QTcpServer::newConnection, this, [this]() {
+                while (QTcpSocket* socket = m_tcpServer->nextPendingConnection()) {
+                    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { serveHttp(socket); });
+                    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                }
+            });
+        }
+
+        if (!m_tcpServer->isListening() && !m_tcpServer->listen(QHostAddress::LocalHost, port)) {
+            qWarning() << "MetricsExporter: failed to listen on port" << port << "-"
+                       << m_tcpServer->errorString();
+            return 0;
+        }
+        return m_tcpServer->serverPort();
+    }
+
+    bool listenLocal(const QString& serverName)
+    {
+        if (!m_localServer) {
+            m_localServer = new QLocalServer(this);
+            connect(m_localServer, &QLocalServer::newConnection, this, [this]() {
+                while (QLocalSocket* socket = m_localServer->nextPendingConnection()) {
+                    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+                    socket->write(currentBody());
+                    socket->disconnectFromServer();
+                }
+            });
+        }
+
+        if (m_localServer->isListening()) {
+            return true;
+        }
+
+        // 清理上次异常退出残留的套接字文件
+        QLocalServer::removeServer(serverName);
+        if (!m_localServer->listen(serverName)) {
+            qWarning() << "MetricsExporter: failed to listen on" << serverName << "-"
+                       << m_localServer->errorString();
+            return false;
+        }
+        return true;
+    }
+
+    void shutdown()
+    {
+        if (m_refreshTimer) {
+            m_refreshTimer->stop();
+        }
+        if (m_tcpServer) {
+            m_tcpServer->close();
+        }
+        if (m_localServer) {
+            m_localServer->close();
+        }
+    }
+
+private:
+    void refresh()
+    {
+        m_owner->publishSnapshot(MetricsExporter::renderOpenMetrics());
+    }
+
+    QByteArray currentBody() const
+    {
+        std::shared_ptr<const QByteArray> snapshot = m_owner->snapshot();
+        return snapshot ? *snapshot : QByteArray("# EOF\n");
+    }
+
+    void serveHttp(QTcpSocket* socket)
+    {
+        if (socket->property("served").toBool()) {
+            socket->readAll();
+            return;
+        }
+
+        // 等待完整的请求头
+        const int maxHeaderSize = 8192;
+        if (!socket->peek(maxHeaderSize).contains("\r\n\r\n") && socket->bytesAvailable() < maxHeaderSize) {
+            return;
+        }
+
+        const QByteArray requestLine = socket->readLine().trimmed();
+        socket->readAll();
+        const QList<QByteArray> parts = requestLine.split(' ');
+
+        QByteArray status = "404 Not Found";
+        QByteArray contentType = "text/plain; charset=utf-8";
+        QByteArray body = "Not Found\n";
+        if (parts.size() >= 2 && parts.at(0) == "GET"
+            && (parts.at(1) == "/metrics" || parts.at(1).startsWith("/metrics?"))) {
+            status = "200 OK";
+            contentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+            body = currentBody();
+        }
+
+        QByteArray response;
+        response += "HTTP/1.1 " + status + "\r\n";
+        response += "Content-Type: " + contentType + "\r\n";
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        response += body;
+
+        socket->setProperty("served", true);
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    MetricsExporter* m_owner;
+    QTcpServer* m_tcpServer;
+    QLocalServer* m_localServer;
+    QTimer* m_refreshTimer;
+};
+
+MetricsExporter::MetricsExporter(QObject* parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_worker(nullptr)
+    , m_refreshIntervalMs(1000)
+    , m_tcpPort(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+bool MetricsExporter::startTcp(quint16 port)
+{
+    if (!ensureWorker()) {
+        return false;
+    }
+
+    MetricsExporterWorker* worker = m_worker;
+    quint16 boundPort = 0;
+    QMetaObject::invokeMethod(worker, [worker, port]() { return worker->listenTcp(port); },
+                              Qt::BlockingQueuedConnection, &boundPort);
+    if (boundPort == 0) {
+        return false;
+    }
+
+    m_tcpPort = boundPort;
+    qDebug() << "MetricsExporter serving OpenMetrics on http://127.0.0.1:" << m_tcpPort << "/metrics";
+    return true;
+}
+
+bool MetricsExporter::startLocal(const QString& serverName)
+{
+    if (!ensureWorker()) {
+        return false;
+    }
+
+    MetricsExporterWorker* worker = m_worker;
+    bool listening = false;
+    QMetaObject::invokeMethod(worker, [worker, serverName]() { return worker->listenLocal(serverName); },
+                              Qt::BlockingQueuedConnection, &listening);
+    if (listening) {
+        qDebug() << "MetricsExporter serving OpenMetrics on local socket" << serverName;
+    }
+    return listening;
+}
+
+void MetricsExporter::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    MetricsExporterWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() { worker->shutdown(); }, Qt::BlockingQueuedConnection);
+
+    // 工作对象在线程结束时通过deleteLater释放
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_worker = nullptr;
+    m_tcpPort = 0;
+
+    qDebug() << "MetricsExporter stopped";
+}
+
+bool MetricsExporter::isRunning() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+quint16 MetricsExporter::tcpPort() const
+{
+    return m_tcpPort;
+}
+
+void MetricsExporter::setRefreshInterval(int intervalMs)
+{
+    m_refreshIntervalMs = qMax(10, intervalMs);
+
+    if (m_worker) {
+        MetricsExporterWorker* worker = m_worker;
+        int interval = m_refreshIntervalMs;
+        QMetaObject::invokeMethod(worker, [worker, interval]() { worker->setRefreshInterval(interval); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+std::shared_ptr<const QByteArray> MetricsExporter::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void MetricsExporter::publishSnapshot(const QByteArray& text)
+{
+    std::atomic_store(&m_snapshot, std::shared_ptr<const QByteArray>(std::make_shared<QByteArray>(text)));
+}
+
+bool MetricsExporter::ensureWorker()
+{
+    if (m_thread) {
+        return true;
+    }
+
+    // 单例必须在调用线程中创建，否则它们的定时器会归属于导出线程
+    EventManager::instance();
+    EventLogger::instance();
+    EventPerformanceAnalyzer::instance();
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("MetricsExporter");
+    m_worker = new MetricsExporterWorker(this);
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread->start();
+
+    MetricsExporterWorker* worker = m_worker;
+    int interval = m_refreshIntervalMs;
+    QMetaObject::invokeMethod(worker, [worker, interval]() { worker->initialize(interval); },
+                              Qt::BlockingQueuedConnection);
+    return true;
+}
+
+QByteArray MetricsExporter::renderOpenMetrics()
+{
+    // 只读分析器发布的快照，不获取其数据锁
+    const std::shared_ptr<const EventPerformanceAnalyzer::ExportSnapshot> snapshot =
+        EventPerformanceAnalyzer::instance()->exportSnapshot();
+    QByteArray out;
+
+    // 事件处理时间直方图
+    const QHash<QEvent::Type, EventPerformanceAnalyzer::LatencyHistogram>& histograms = snapshot->eventHistograms;
+    writeFamilyHeader(out, "qt_event_processing_seconds", "histogram",
+                      "Time spent handling events, by event type.", "seconds");
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) {
+        writeHistogram(out, "qt_event_processing_seconds", eventTypeLabel(snapshot->typeNames, it.key()),
+                       it.value());
+    }
+
+    // 硬件计数器（仅在启用并采到数据时有样本）
+    struct CounterFamily {
+        const char* name;
+        const char* help;
+        quint64 EventPerformanceAnalyzer::HardwareCounters::*field;
+    };
+    const CounterFamily counterFamilies[] = {
+        { "qt_event_cpu_cycles", "CPU cycles spent handling events.",
+          &EventPerformanceAnalyzer::HardwareCounters::cycles },
+        { "qt_event_instructions", "Instructions retired while handling events.",
+          &EventPerformanceAnalyzer::HardwareCounters::instructions },
+        { "qt_event_cache_misses", "Cache misses while handling events.",
+          &EventPerformanceAnalyzer::HardwareCounters::cacheMisses },
+        { "qt_event_branch_misses", "Branch mispredictions while handling events.",
+          &EventPerformanceAnalyzer::HardwareCounters::branchMisses }
+    };
+    QHash<QEvent::Type, EventPerformanceAnalyzer::HardwareCounters> counters;
+    for (auto it = snapshot->eventCounters.begin(); it != snapshot->eventCounters.end(); ++it) {
+        if (it.value().sampleCount > 0) {
+            counters.insert(it.key(), it.value());
+        }
+    }
+    for (const CounterFamily& family : counterFamilies) {
+        writeFamilyHeader(out, family.name, "counter", family.help);
+        for (auto it = counters.begin(); it != counters.end(); ++it) {
+            writeSample(out, family.name, "_total", eventTypeLabel(snapshot->typeNames, it.key()),
+                        QByteArray::number(it.value().*family.field));
+        }
+    }
+
+    // 事件循环延迟与停顿
+    writeFamilyHeader(out, "qt_event_loop_lag_seconds", "histogram",
+                      "GUI event loop lag measured by the watchdog.", "seconds");
+    writeHistogram(out, "qt_event_loop_lag_seconds", QByteArray(), snapshot->lagHistogram);
+
+    writeFamilyHeader(out, "qt_event_loop_stalls", "counter",
+                      "GUI thread stalls longer than the watchdog threshold.");
+    writeSample(out, "qt_event_loop_stalls", "_total", QByteArray(),
+                QByteArray::number(snapshot->totalStalls));
+
+    // EventLogger 统计，同样只读其发布的快照
+    const std::shared_ptr<const EventLogger::PerformanceSnapshot> loggerSnapshot =
+        EventLogger::instance()->performanceSnapshot();
+
+    writeFamilyHeader(out, "qt_event_logger_records", "gauge", "Event records held by the logger.");
+    writeSample(out, "qt_event_logger_records", "", QByteArray(),
+                QByteArray::number(loggerSnapshot->totalEvents));
+
+    writeFamilyHeader(out, "qt_event_logger_events_per_second", "gauge",
+                      "Events logged during the last second.");
+    writeSample(out, "qt_event_logger_events_per_second", "", QByteArray(),
+                QByteArray::number(loggerSnapshot->eventsPerSecond));
+
+    const QHash<QString, EventLogger::TypeStats>& eventTypeStats = loggerSnapshot->eventTypes;
+    writeFamilyHeader(out, "qt_event_logger_type_samples", "gauge",
+                      "Recent processing time samples kept by the logger, by event type.");
+    for (auto it = eventTypeStats.begin(); it != eventTypeStats.end(); ++it) {
+        writeSample(out, "qt_event_logger_type_samples", "", eventTypeLabel(it.key()),
+                    QByteArray::number(it.value().sampleCount));
+    }
+    writeFamilyHeader(out, "qt_event_logger_type_avg_processing_seconds", "gauge",
+                      "Average processing time over the logger's recent samples, by event type.", "seconds");
+    for (auto it = eventTypeStats.begin(); it != eventTypeStats.end(); ++it) {
+        writeSample(out, "qt_event_logger_type_avg_processing_seconds", "", eventTypeLabel(it.key()),
+                    formatDouble(it.value().avgTimeMs / 1000.0));
+    }
+
+    out += "# EOF\n";
+    return out;
+}
@@ -0,0 +1,116 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <memory>
+
+class QThread;
+class MetricsExporterWorker;
+
+/**
+ * @brief MetricsExporter OpenMetrics指标导出器
+ *
+ * 以OpenMetrics文本格式导出EventPerformanceAnalyzer::exportSnapshot()和
+ * EventLogger::performanceSnapshot()的计数器、仪表和直方图，
+ * 供Prometheus等监控系统抓取。
+ *
+ * 服务端和快照刷新都运行在独立的工作线程中：刷新定时器定期
+ * 渲染一份不可变快照并原子发布，抓取请求只读取最新快照，
+ * 不会与事件处理争用任何锁。
+ *
+ * 支持两种监听方式：
+ * - 回环TCP（127.0.0.1），响应 HTTP GET /metrics
+ * - QLocalServer本地套接字，连接后直接写出指标文本
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象
+     */
+    explicit MetricsExporter(QObject* parent = nullptr);
+
+    /**
+     * @brief 析构函数，停止服务
+     */
+    ~MetricsExporter() override;
+
+    /**
+     * @brief 在回环地址上启动HTTP指标服务
+     * @param port 监听端口，0表示由系统分配
+     * @return 是否启动成功
+     */
+    bool startTcp(quint16 port = 9464);
+
+    /**
+     * @brief 在本地套接字上启动指标服务
+     * @param serverName 本地服务器名称
+     * @return 是否启动成功
+     */
+    bool startLocal(const QString& serverName);
+
+    /**
+     * @brief 停止服务并结束工作线程
+     */
+    void stop();
+
+    /**
+     * @brief 检查服务是否在运行
+     * @return 是否在运行
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief 获取实际监听的TCP端口
+     * @return 端口号，未监听TCP时为0
+     */
+    quint16 tcpPort() const;
+
+    /**
+     * @brief 设置快照刷新间隔
+     * @param intervalMs 刷新间隔（毫秒）
+     */
+    void setRefreshInterval(int intervalMs);
+
+    /**
+     * @brief 获取最新发布的快照（无锁，可从任意线程调用）
+     * @return 指标文本快照，尚未刷新时为空
+     */
+    std::shared_ptr<const QByteArray> snapshot() const;
+
+    /**
+     * @brief 从分析器的导出快照和日志记录器渲染当前指标
+     * @return OpenMetrics格式文本（以 "# EOF" 结尾）
+     */
+    static QByteArray renderOpenMetrics();
+
+private:
+    friend class MetricsExporterWorker;
+
+    /**
+     * @brief 确保工作线程已启动
+     * @return 工作线程是否可用
+     */
+    bool ensureWorker();
+
+    /**
+     * @brief 原子发布新快照
+     * @param text 指标文本
+     */
+    void publishSnapshot(const QByteArray& text);
+
+    QThread* m_thread;
+    MetricsExporterWorker* m_worker;
+    int m_refreshIntervalMs;
+    quint16 m_tcpPort;
+
+    // 通过 std::atomic_load / std::atomic_store 访问
+    std::shared_ptr<const QByteArray> m_snapshot;
+};
+
+#endif // METRICS_EXPORTER_H
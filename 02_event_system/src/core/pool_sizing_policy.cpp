@@ -0,0 +1,185 @@
+#include "pool_sizing_policy.h"
+#include <QtMath>
+
+PoolSizingPolicy::PoolSizingPolicy(QObject* parent)
+    : QObject(parent)
+    , m_pool(nullptr)
+    , m_timer(new QTimer(this))
+    , m_nextSample(0)
+    , m_sampleCount(0)
+    , m_idleTicks(0)
+    , m_cooldown(0)
+{
+    m_clock.start();
+    m_samples.resize(m_config.longWindow);
+    connect(m_timer, &QTimer::timeout, this, [this]() { evaluate(); });
+}
+
+PoolSizingPolicy::~PoolSizingPolicy()
+{
+}
+
+void PoolSizingPolicy::attach(EventStoragePool* pool)
+{
+    m_pool = pool;
+    m_nextSample = 0;
+    m_sampleCount = 0;
+    m_idleTicks = 0;
+    m_cooldown = 0;
+}
+
+void PoolSizingPolicy::setConfig(const Config& config)
+{
+    m_config = config;
+    m_config.shortWindow = qMax(2, m_config.shortWindow);
+    m_config.longWindow = qMax(m_config.shortWindow, m_config.longWindow);
+
+    m_samples.resize(m_config.longWindow);
+    m_nextSample = 0;
+    m_sampleCount = 0;
+
+    if (m_timer->isActive()) {
+        m_timer->start(m_config.intervalMs);
+    }
+}
+
+void PoolSizingPolicy::start()
+{
+    m_timer->start(m_config.intervalMs);
+}
+
+void PoolSizingPolicy::stop()
+{
+    m_timer->stop();
+}
+
+bool PoolSizingPolicy::isRunning() const
+{
+    return m_timer->isActive();
+}
+
+PoolSizingPolicy::Decision PoolSizingPolicy::evaluate()
+{
+    if (!m_pool) {
+        return NoChange;
+    }
+
+    // 采样
+    const qint64 now = m_clock.elapsed();
+    const EventStoragePool::ContentionStats stats = m_pool->contentionStats();
+    const int total = m_pool->totalEvents();
+    const int used = qMax(0, total - m_pool->availableEvents());
+
+    Sample& sample = m_samples[m_nextSample];
+    sample.timeMs = now;
+    sample.used = used;
+    sample.acquires = stats.acquires;
+    sample.misses = stats.allocationMisses;
+    m_nextSample = (m_nextSample + 1) % m_samples.size();
+    m_sampleCount = qMin(m_sampleCount + 1, static_cast<int>(m_samples.size()));
+    m_metrics.evaluations++;
+
+    // 窗口统计
+    const int shortSpan = qMin(m_config.shortWindow, m_sampleCount);
+    int shortHighWater = 0;
+    int longHighWater = 0;
+    for (int i = 0; i < m_sampleCount; ++i) {
+        const int value = sampleAgo(i).used;
+        longHighWater = qMax(longHighWater, value);
+        if (i < shortSpan) {
+            shortHighWater = qMax(shortHighWater, value);
+        }
+    }
+
+    const Sample& shortStart = sampleAgo(shortSpan - 1);
+    const Sample& longStart = sampleAgo(m_sampleCount - 1);
+    const qint64 shortElapsed = now - shortStart.timeMs;
+    const qint64 longElapsed = now - longStart.timeMs;
+
+    const double shortRate = shortElapsed > 0
+        ? (sample.acquires - shortStart.acquires) * 1000.0 / shortElapsed : 0.0;
+    const double longRate = longElapsed > 0
+        ? (sample.acquires - longStart.acquires) * 1000.0 / longElapsed : 0.0;
+    const double usedSlope = shortElapsed > 0
+        ? (sample.used - shortStart.used) * 1000.0 / shortElapsed : 0.0;
+
+    const quint64 windowAcquires = sample.acquires - longStart.acquires;
+    const quint64 windowMisses = sample.misses - longStart.misses;
+
+    m_metrics.highWaterMark = longHighWater;
+    m_metrics.shortHighWaterMark = shortHighWater;
+    m_metrics.acquireRate = shortRate;
+    m_metrics.longAcquireRate = longRate;
+    m_metrics.hitRate = windowAcquires > 0
+        ? 1.0 - static_cast<double>(windowMisses) / windowAcquires : 1.0;
+
+    // 池耗尽时的增长步长跟随一个采样周期内的获取量
+    const int step = qBound(static_cast<int>(EventStoragePool::MagazineSize),
+                            static_cast<int>(shortRate * m_config.intervalMs / 1000.0),
+                            qMax(static_cast<int>(EventStoragePool::MagazineSize),
+                                 m_config.maxBlocks / 4));
+    m_pool->setGrowthStep(step);
+    m_metrics.growthStep = step;
+
+    if (m_cooldown > 0) {
+        m_cooldown--;
+        return NoChange;
+    }
+
+    // 预测需求：当前用量按短窗口斜率外推；突发时至少恢复到长窗口高水位
+    double projected = used + qMax(0.0, usedSlope) * m_config.leadTimeMs / 1000.0;
+    if (m_sampleCount > shortSpan && shortRate > longRate * m_config.burstFactor) {
+        projected = qMax(projected, static_cast<double>(longHighWater));
+    }
+
+    if (projected > total * m_config.growThreshold && total < m_config.maxBlocks) {
+        m_idleTicks = 0;
+        const int target = qMin(m_config.maxBlocks, qCeil(projected * m_config.headroom));
+        const int delta = target - total;
+        if (delta > 0) {
+            m_pool->expandPool(delta);
+            m_metrics.growDecisions++;
+            m_metrics.blocksGrown += delta;
+            recordDecision(Grow, delta, now);
+            return Grow;
+        }
+        return NoChange;
+    }
+
+    // 收缩需要完整的长窗口历史，并且连续空闲足够多个周期
+    if (m_sampleCount >= m_config.longWindow
+        && longHighWater < total * m_config.shrinkThreshold
+        && total > m_config.minBlocks) {
+        if (++m_idleTicks >= m_config.idleTicksToShrink) {
+            m_idleTicks = 0;
+            const int target = qMax(m_config.minBlocks, qCeil(longHighWater * m_config.headroom));
+            const int released = m_pool->trimTo(target);
+            if (released > 0) {
+                m_metrics.shrinkDecisions++;
+                m_metrics.blocksReleased += released;
+                recordDecision(Shrink, -released, now);
+                return Shrink;
+            }
+        }
+        return NoChange;
+    }
+
+    m_idleTicks = 0;
+    return NoChange;
+}
+
+const PoolSizingPolicy::Sample& PoolSizingPolicy::sampleAgo(int ticks) const
+{
+    const int size = m_samples.size();
+    return m_samples[((m_nextSample - 1 - ticks) % size + size) % size];
+}
+
+void PoolSizingPolicy::recordDecision(Decision decision, int delta, qint64 nowMs)
+{
+    m_metrics.lastDecision = decision;
+    m_metrics.lastDelta = delta;
+    m_metrics.lastDecisionMs = nowMs;
+    m_cooldown = m_config.cooldownTicks;
+
+    emit decisionMade(decision, delta, m_pool->totalEvents());
+}
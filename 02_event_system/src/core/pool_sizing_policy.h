@@ -0,0 +1,150 @@
+#ifndef POOL_SIZING_POLICY_H
+#define POOL_SIZING_POLICY_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+#include "event_pool.h"
+
+/**
+ * @brief PoolSizingPolicy 事件池自适应容量策略
+ *
+ * 按固定间隔采样池的使用量和获取次数，在短/长两个滑动窗口上计算
+ * 使用量高水位、获取速率和命中率：
+ * - 短窗口内使用量上升或获取速率突增时，按外推需求提前扩容，
+ *   同时调大池耗尽时的增长步长；
+ * - 长窗口高水位持续低于收缩阈值若干个周期后，把池收缩到高水位加余量。
+ *
+ * 扩容/收缩阈值之间留有间隔，收缩需要连续空闲周期，每次决策后还有冷却期，
+ * 三者共同构成滞回，避免在边界附近反复扩缩。
+ */
+class PoolSizingPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 决策类型
+     */
+    enum Decision {
+        NoChange = 0,
+        Grow,
+        Shrink
+    };
+    Q_ENUM(Decision)
+
+    /**
+     * @brief 策略参数
+     */
+    struct Config {
+        int intervalMs;             // 采样间隔
+        int shortWindow;            // 短窗口采样数
+        int longWindow;             // 长窗口采样数
+        double growThreshold;       // 预测使用率超过此值时扩容
+        double shrinkThreshold;     // 长窗口高水位使用率低于此值视为空闲
+        double headroom;            // 目标容量相对需求的余量系数
+        double burstFactor;         // 短窗口速率超过长窗口的倍数视为突发
+        int leadTimeMs;             // 需求外推时长
+        int idleTicksToShrink;      // 连续空闲多少个周期才收缩
+        int cooldownTicks;          // 决策后的冷却周期
+        int minBlocks;              // 容量下限
+        int maxBlocks;              // 容量上限
+
+        Config()
+            : intervalMs(100), shortWindow(5), longWindow(100)
+            , growThreshold(0.85), shrinkThreshold(0.4), headroom(1.25)
+            , burstFactor(2.0), leadTimeMs(500), idleTicksToShrink(30)
+            , cooldownTicks(10), minBlocks(EventStoragePool::MagazineSize)
+            , maxBlocks(100000) {}
+    };
+
+    /**
+     * @brief 策略指标
+     */
+    struct Metrics {
+        quint64 evaluations;        // 评估次数
+        quint64 growDecisions;      // 扩容决策次数
+        quint64 shrinkDecisions;    // 收缩决策次数
+        quint64 blocksGrown;        // 累计预分配块数
+        quint64 blocksReleased;     // 累计释放块数
+        int highWaterMark;          // 长窗口使用量高水位
+        int shortHighWaterMark;     // 短窗口使用量高水位
+        double acquireRate;         // 短窗口获取速率（次/秒）
+        double longAcquireRate;     // 长窗口获取速率（次/秒）
+        double hitRate;             // 长窗口命中率（无需新建块的获取占比）
+        int growthStep;             // 当前池耗尽时的增长步长
+        Decision lastDecision;      // 最近一次非NoChange决策
+        int lastDelta;              // 最近一次决策的块数变化
+        qint64 lastDecisionMs;      // 最近一次决策时间（自策略启动起，毫秒）
+
+        Metrics()
+            : evaluations(0), growDecisions(0), shrinkDecisions(0)
+            , blocksGrown(0), blocksReleased(0), highWaterMark(0), shortHighWaterMark(0)
+            , acquireRate(0.0), longAcquireRate(0.0), hitRate(1.0), growthStep(0)
+            , lastDecision(NoChange), lastDelta(0), lastDecisionMs(-1) {}
+    };
+
+    explicit PoolSizingPolicy(QObject* parent = nullptr);
+    ~PoolSizingPolicy() override;
+
+    /**
+     * @brief 绑定要管理的池（不取得所有权），会清空采样历史
+     */
+    void attach(EventStoragePool* pool);
+    EventStoragePool* pool() const { return m_pool; }
+
+    void setConfig(const Config& config);
+    Config config() const { return m_config; }
+
+    /**
+     * @brief 以Config::intervalMs为周期自动评估
+     */
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief 立即采样并评估一次
+     * @return 本次决策
+     */
+    Decision evaluate();
+
+    Metrics metrics() const { return m_metrics; }
+
+signals:
+    /**
+     * @brief 做出扩容或收缩决策时发出
+     * @param decision 决策类型
+     * @param delta 块数变化（收缩为负）
+     * @param totalBlocks 调整后的总块数
+     */
+    void decisionMade(PoolSizingPolicy::Decision decision, int delta, int totalBlocks);
+
+private:
+    struct Sample {
+        qint64 timeMs;
+        int used;
+        quint64 acquires;
+        quint64 misses;
+    };
+
+    const Sample& sampleAgo(int ticks) const;
+    void recordDecision(Decision decision, int delta, qint64 nowMs);
+
+    EventStoragePool* m_pool;
+    Config m_config;
+    Metrics m_metrics;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+
+    // 长窗口环形缓冲
+    QVector<Sample> m_samples;
+    int m_nextSample;
+    int m_sampleCount;
+
+    int m_idleTicks;
+    int m_cooldown;
+};
+
+#endif // POOL_SIZING_POLICY_H
@@ -0,0 +1,115 @@
+#include "shared_data_event.h"
+#include <QCoreApplication>
+#include <QDateTime>
+
+// SharedPayload 实现
+SharedPayload::SharedPayload()
+{
+}
+
+SharedPayload::SharedPayload(const QVariant& value)
+    : SharedPayload(QVariant(value))
+{
+}
+
+SharedPayload::SharedPayload(QVariant&& value)
+{
+    auto data = std::make_shared<Data>();
+    data->value = std::move(value);
+    data->timestamp = QDateTime::currentMSecsSinceEpoch();
+    m_data = std::move(data);
+}
+
+const QVariant& SharedPayload::value() const
+{
+    static const QVariant empty;
+    return m_data ? m_data->value : empty;
+}
+
+qint64 SharedPayload::timestamp() const
+{
+    return m_data ? m_data->timestamp : 0;
+}
+
+// SharedDataEvent 实现
+SharedDataEvent::SharedDataEvent(const SharedPayload& payload)
+    : DataEvent(QMetaType())
+    , m_payload(payload)
+{
+    // 共享负载的事件时间戳一致，序列化结果才能共用
+    m_timestamp = m_payload.timestamp();
+}
+
+void SharedDataEvent::setData(const QVariant& data)
+{
+    m_payload = SharedPayload();
+    DataEvent::setData(data);
+}
+
+QByteArray SharedDataEvent::serialize() const
+{
+    if (m_payload.isNull()) {
+        return DataEvent::serialize();
+    }
+
+    const SharedPayload::Data& shared = *m_payload.m_data;
+    std::call_once(shared.encodeOnce, [this, &shared]() {
+        shared.encoded = DataEvent::serialize();
+        shared.encodedReady.store(true, std::memory_order_release);
+    });
+    return shared.encoded;
+}
+
+bool SharedDataEvent::writeTo(QIODevice* device) const
+{
+    if (m_payload.isNull()) {
+        return DataEvent::writeTo(device);
+    }
+    return EventWire::writeChunked(device, serialize());
+}
+
+qsizetype SharedDataEvent::serializedSize() const
+{
+    if (m_payload.isNull()) {
+        return DataEvent::serializedSize();
+    }
+
+    // 已经编码过就用实际长度；否则只估算，description()等日志路径不应触发编码
+    const SharedPayload::Data& shared = *m_payload.m_data;
+    if (shared.encodedReady.load(std::memory_order_acquire)) {
+        return shared.encoded.size();
+    }
+    qsizetype size = shared.estimatedSize.load(std::memory_order_relaxed);
+    if (size < 0) {
+        size = DataEvent::serializedSize();
+        shared.estimatedSize.store(size, std::memory_order_relaxed);
+    }
+    return size;
+}
+
+bool SharedDataEvent::deserialize(const QByteArray& data)
+{
+    if (!DataEvent::deserialize(data)) {
+        return false;
+    }
+    m_payload = SharedPayload();
+    return true;
+}
+
+int SharedDataEvent::post(const QList<QObject*>& receivers, const SharedPayload& payload, int priority)
+{
+    int posted = 0;
+    for (QObject* receiver : receivers) {
+        if (!receiver) {
+            continue;
+        }
+        QCoreApplication::postEvent(receiver, new SharedDataEvent(payload), priority);
+        posted++;
+    }
+    return posted;
+}
+
+QVariant SharedDataEvent::boxPayload() const
+{
+    return m_payload.value();
+}
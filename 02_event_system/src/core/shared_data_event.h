@@ -0,0 +1,126 @@
+#ifndef SHARED_DATA_EVENT_H
+#define SHARED_DATA_EVENT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QVariant>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "custom_events.h"
+#include "event_pool.h"
+
+/**
+ * @brief 不可变、引用计数的事件负载，供一对多投递共享
+ *
+ * 负载创建后不再修改，拷贝 SharedPayload 只增加引用计数。所有共享同一
+ * 负载的 SharedDataEvent 也共享同一份时间戳和序列化结果：第一次
+ * serialize()或writeTo()编码一次，之后各事件直接使用同一个缓冲区。
+ * serializedSize()只估算一次长度并缓存在负载上，不会触发编码。
+ */
+class SharedPayload
+{
+public:
+    SharedPayload();
+    explicit SharedPayload(const QVariant& value);
+    explicit SharedPayload(QVariant&& value);
+
+    template<typename T>
+    static SharedPayload fromValue(T&& value)
+    {
+        return SharedPayload(QVariant::fromValue(std::forward<T>(value)));
+    }
+
+    bool isNull() const { return !m_data; }
+
+    /**
+     * @brief 只读访问负载，不拷贝也不会触发隐式共享的分离
+     */
+    const QVariant& value() const;
+
+    /**
+     * @brief 负载类型为T时返回指向共享值的只读指针，否则返回nullptr
+     */
+    template<typename T>
+    const T* get() const
+    {
+        if (!m_data || m_data->value.metaType() != QMetaType::fromType<T>()) {
+            return nullptr;
+        }
+        return static_cast<const T*>(m_data->value.constData());
+    }
+
+    qint64 timestamp() const;
+
+    /**
+     * @brief 持有该负载的对象数（SharedPayload副本和尚未删除的事件）
+     */
+    long useCount() const { return m_data.use_count(); }
+
+private:
+    friend class SharedDataEvent;
+
+    struct Data {
+        QVariant value;
+        qint64 timestamp;
+
+        // 首次serialize()时编码，之后只读
+        mutable std::once_flag encodeOnce;
+        mutable QByteArray encoded;
+        mutable std::atomic<bool> encodedReady{false};
+
+        // 首次serializedSize()时估算，-1表示尚未估算
+        mutable std::atomic<qsizetype> estimatedSize{-1};
+    };
+
+    std::shared_ptr<const Data> m_data;
+};
+
+/**
+ * @brief 引用 SharedPayload 的轻量事件信封
+ *
+ * 事件类型仍是DataEventType，接收者照常调用data()，得到的QVariant与
+ * 负载隐式共享；只读访问请用payload()或get<T>()，完全不涉及拷贝。
+ * setData()/deserialize()后事件脱离共享负载，变为普通DataEvent。
+ *
+ * 通过 PoolAllocated 从 SharedDataEvent 专用的存储池分配。
+ */
+class SharedDataEvent : public DataEvent, public PoolAllocated<SharedDataEvent>
+{
+public:
+    using PoolAllocated<SharedDataEvent>::operator new;
+    using PoolAllocated<SharedDataEvent>::operator delete;
+
+    explicit SharedDataEvent(const SharedPayload& payload);
+
+    const SharedPayload& payload() const { return m_payload; }
+
+    template<typename T>
+    const T* get() const { return m_payload.get<T>(); }
+
+    void setData(const QVariant& data) override;
+    QByteArray serialize() const override;
+    bool deserialize(const QByteArray& data) override;
+    bool writeTo(QIODevice* device) const override;
+    qsizetype serializedSize() const override;
+
+    /**
+     * @brief 为每个接收者投递一个共享payload的事件
+     *
+     * 负载只有一份，每个接收者只多一个事件信封；空的接收者被跳过。
+     * @return 实际投递的事件数
+     */
+    static int post(const QList<QObject*>& receivers, const SharedPayload& payload,
+                    int priority = Qt::NormalEventPriority);
+
+protected:
+    QVariant boxPayload() const override;
+
+private:
+    SharedPayload m_payload;
+};
+
+#endif // SHARED_DATA_EVENT_H
@@ -0,0 +1,107 @@
+#ifndef TYPED_DATA_EVENT_H
+#define TYPED_DATA_EVENT_H
+
+#include <QEvent>
+#include <QMetaType>
+#include <QVariant>
+#include <utility>
+#include "custom_events.h"
+#include "event_pool.h"
+
+/**
+ * @brief 按值携带T的数据事件，不经过QVariant装箱
+ *
+ * 负载以移动语义放进事件，接收方用cast()按编译期类型ID识别后take()移出，
+ * 整个投递过程没有拷贝。事件类型仍是DataEventType，只认识DataEvent的
+ * 接收者照常调用data()，此时才把负载装箱成QVariant（只装箱一次）。
+ *
+ * 通过 PoolAllocated 从各自的存储池分配，每个负载类型
+ * 一个池。
+ *
+ *   auto* event = new TypedDataEvent<QVector<float>>(std::move(samples));
+ *   QCoreApplication::postEvent(receiver, event);
+ *   ...
+ *   if (auto* typed = TypedDataEvent<QVector<float>>::cast(event)) {
+ *       QVector<float> samples = typed->take();
+ *   }
+ */
+template<typename T>
+class TypedDataEvent : public DataEvent, public PoolAllocated<TypedDataEvent<T>>
+{
+public:
+    using PoolAllocated<TypedDataEvent<T>>::operator new;
+    using PoolAllocated<TypedDataEvent<T>>::operator delete;
+
+    TypedDataEvent() : DataEvent(typeId()), m_value() {}
+    explicit TypedDataEvent(const T& value) : DataEvent(typeId()), m_value(value) {}
+    explicit TypedDataEvent(T&& value) : DataEvent(typeId()), m_value(std::move(value)) {}
+
+    /**
+     * @brief 编译期类型ID
+     */
+    static constexpr QMetaType typeId() { return QMetaType::fromType<T>(); }
+
+    /**
+     * @brief 事件携带T时返回类型化事件，否则返回nullptr
+     */
+    static TypedDataEvent* cast(QEvent* event)
+    {
+        if (!event || event->type() != static_cast<QEvent::Type>(DataEventType)) {
+            return nullptr;
+        }
+        DataEvent* dataEvent = static_cast<DataEvent*>(event);
+        return dataEvent->payloadType() == typeId() ? static_cast<TypedDataEvent*>(dataEvent) : nullptr;
+    }
+
+    const T& value() const { return m_value; }
+
+    void setValue(const T& value)
+    {
+        m_value = value;
+        payloadChanged();
+    }
+
+    void setValue(T&& value)
+    {
+        m_value = std::move(value);
+        payloadChanged();
+    }
+
+    /**
+     * @brief 移出负载，事件随后持有默认构造的T
+     *
+     * 负载尚未被data()装箱时不涉及任何拷贝；已装箱时与QVariant隐式共享，
+     * 修改取出的值才会分离。
+     */
+    T take()
+    {
+        T value = std::move(m_value);
+        m_value = T();
+        payloadChanged();
+        return value;
+    }
+
+    // QVariant接口：setData()写回类型化负载，无法转换为T时负载为默认值
+    void setData(const QVariant& data) override
+    {
+        DataEvent::setData(data);
+        m_value = data.value<T>();
+    }
+
+    bool deserialize(const QByteArray& data) override
+    {
+        if (!DataEvent::deserialize(data)) {
+            return false;
+        }
+        m_value = DataEvent::data().value<T>();
+        return true;
+    }
+
+protected:
+    QVariant boxPayload() const override { return QVariant::fromValue(m_value); }
+
+private:
+    T m_value;
+};
+
+#endif // TYPED_DATA_EVENT_H
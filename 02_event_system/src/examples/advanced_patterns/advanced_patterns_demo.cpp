@@ -1,4 +1,5 @@
 #include "advanced_patterns_demo.h"
+#include "../../core/allocation_profiler.h"
 #include <QApplication>
 #include <QFileDialog>
 #include <QMessageBox>
@@ -167,10 +168,18 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     logBenchmarkResult(QString("测试时间: %1").arg(QDateTime::currentDateTime().toString()));
     logBenchmarkResult("");
     
+    // 编译了分配钩子时用实测的堆分配字节数，否则按sizeof估算
+    bool allocationTrackingWasEnabled = AllocationProfiler::isEnabled();
+    AllocationProfiler::setEnabled(true);
+    bool measureAllocations = AllocationProfiler::isEnabled();
+    logBenchmarkResult(QString("内存统计: %1").arg(measureAllocations ? "实测堆分配" : "sizeof估算"));
+    logBenchmarkResult("");
+    
     // 测试1: 事件压缩性能
     logBenchmarkResult("测试1: 事件压缩性能测试");
     logBenchmarkResult("----------------------------------------");
     
+    AllocationProfiler::Counters allocationStart = AllocationProfiler::currentThreadCounters();
     QElapsedTimer timer;
     timer.start();
     
@@ -202,7 +211,10 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     compressionResult.executionTime = compressionTime;
     compressionResult.eventsProcessed = eventCount;
     compressionResult.eventsPerSecond = (double)eventCount * 1000.0 / compressionTime;
-    compressionResult.memoryUsed = eventQueue.size() * sizeof(QPoint);
+    compressionResult.memoryUsed = measureAllocations
+        ? static_cast<qint64>(AllocationProfiler::delta(allocationStart,
+              AllocationProfiler::currentThreadCounters()).allocatedBytes)
+        : static_cast<qint64>(eventQueue.size() * sizeof(QPoint));
     
     m_benchmarkResultsList.append(compressionResult);
     
@@ -217,10 +229,11 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     logBenchmarkResult("测试2: 事件池化性能测试");
     logBenchmarkResult("----------------------------------------");
     
+    allocationStart = AllocationProfiler::currentThreadCounters();
     timer.restart();
     
     // 创建事件池
-    EventPool eventPool(1000);
+    EventPool<PooledEvent> eventPool(1000);
     QList<PooledEvent*> acquiredEvents;
     
     // 获取事件对象
@@ -247,7 +260,10 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     poolingResult.executionTime = totalPoolingTime;
     poolingResult.eventsProcessed = eventCount;
     poolingResult.eventsPerSecond = (double)eventCount * 1000.0 / totalPoolingTime;
-    poolingResult.memoryUsed = eventPool.totalEvents() * sizeof(PooledEvent);
+    poolingResult.memoryUsed = measureAllocations
+        ? static_cast<qint64>(AllocationProfiler::delta(allocationStart,
+              AllocationProfiler::currentThreadCounters()).allocatedBytes)
+        : static_cast<qint64>(eventPool.totalEvents() * sizeof(PooledEvent));
     
     m_benchmarkResultsList.append(poolingResult);
     
@@ -262,6 +278,7 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     logBenchmarkResult("测试3: 传统事件处理对比");
     logBenchmarkResult("----------------------------------------");
     
+    allocationStart = AllocationProfiler::currentThreadCounters();
     timer.restart();
     
     // 模拟传统的事件处理方式
@@ -286,7 +303,12 @@ void AdvancedPatternsDemo::runPerformanceBenchmark()
     traditionalResult.executionTime = totalTraditionalTime;
     traditionalResult.eventsProcessed = eventCount;
     traditionalResult.eventsPerSecond = (double)eventCount * 1000.0 / totalTraditionalTime;
-    traditionalResult.memoryUsed = eventCount * sizeof(QEvent);
+    traditionalResult.memoryUsed = measureAllocations
+        ? static_cast<qint64>(AllocationProfiler::delta(allocationStart,
+              AllocationProfiler::currentThreadCounters()).allocatedBytes)
+        : static_cast<qint64>(eventCount * sizeof(QEvent));
+    
+    AllocationProfiler::setEnabled(allocationTrackingWasEnabled);
     
     m_benchmarkResultsList.append(traditionalResult);
     
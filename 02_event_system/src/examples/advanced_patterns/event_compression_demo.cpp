@@ -13,7 +13,9 @@ EventCompressionDemo::EventCompressionDemo(QWidget *parent)
     , m_logGroup(nullptr)
     , m_compressionEnabled(nullptr)
     , m_compressionInterval(nullptr)
+    , m_adaptiveInterval(nullptr)
     , m_generateEventsBtn(nullptr)
+    , m_streamTestBtn(nullptr)
     , m_clearLogBtn(nullptr)
     , m_statusLabel(nullptr)
     , m_eventLoadBar(nullptr)
@@ -21,37 +23,45 @@ EventCompressionDemo::EventCompressionDemo(QWidget *parent)
     , m_paintCountLabel(nullptr)
     , m_dataUpdateLabel(nullptr)
     , m_compressionRatioLabel(nullptr)
+    , m_adaptiveLabel(nullptr)
+    , m_streamLabel(nullptr)
     , m_logTextEdit(nullptr)
-    , m_mouseCompressionTimer(nullptr)
-    , m_paintCompressionTimer(nullptr)
-    , m_dataCompressionTimer(nullptr)
-    , m_totalMouseEvents(0)
-    , m_compressedMouseEvents(0)
-    , m_totalPaintEvents(0)
-    , m_compressedPaintEvents(0)
-    , m_totalDataUpdates(0)
-    , m_compressedDataUpdates(0)
-    , m_compressionEnabledFlag(true)
-    , m_compressionIntervalMs(50)
+    , m_coalescer(nullptr)
+    , m_mouseChannel(-1)
+    , m_paintChannel(-1)
+    , m_dataChannel(-1)
+    , m_paintCount(0)
+    , m_dataBatchCount(0)
+    , m_intervalController(nullptr)
+    , m_dataStream(nullptr)
 {
     setupUI();
     
-    // 初始化定时器
-    m_mouseCompressionTimer = new QTimer(this);
-    m_paintCompressionTimer = new QTimer(this);
-    m_dataCompressionTimer = new QTimer(this);
+    // 初始化事件合并器
+    m_coalescer = new EventCoalescer(this);
+    m_coalescer->setFlushPolicy(EventCoalescer::FlushOnInterval);
+    m_coalescer->setInterval(m_compressionInterval->value());
     
-    m_mouseCompressionTimer->setSingleShot(true);
-    m_paintCompressionTimer->setSingleShot(true);
-    m_dataCompressionTimer->setSingleShot(true);
+    m_mouseChannel = m_coalescer->addChannel("mouse", EventCoalescer::LatestWins,
+        [this](const QVariant &merged, int) { applyMousePosition(merged.toPoint()); });
+    m_paintChannel = m_coalescer->addChannel("paint", EventCoalescer::RegionUnion,
+        [this](const QVariant &merged, int) { applyPaintRegion(merged.value<QRegion>()); });
+    m_dataChannel = m_coalescer->addChannel("data", EventCoalescer::KeyWiseLastWriter,
+        [this](const QVariant &merged, int) { applyDataUpdates(merged.toMap()); });
     
-    // 连接定时器信号
-    connect(m_mouseCompressionTimer, &QTimer::timeout,
-            this, &EventCompressionDemo::processCompressedMouseEvents);
-    connect(m_paintCompressionTimer, &QTimer::timeout,
-            this, &EventCompressionDemo::processCompressedPaintEvents);
-    connect(m_dataCompressionTimer, &QTimer::timeout,
-            this, &EventCompressionDemo::processBatchedDataUpdates);
+    connect(m_coalescer, &EventCoalescer::channelFlushed,
+            this, &EventCompressionDemo::onChannelFlushed);
+    
+    // 自适应间隔控制器，默认关闭，使用手动设置的间隔
+    m_intervalController = new CoalescingIntervalController(this);
+    m_intervalController->attach(m_coalescer);
+    connect(m_intervalController, &CoalescingIntervalController::intervalChanged,
+            this, &EventCompressionDemo::onAdaptiveIntervalChanged);
+    
+    // 跨线程数据通道
+    m_dataStream = new KeyValueUpdateChannel(this);
+    connect(m_dataStream, &KeyValueUpdateChannel::updatesReady,
+            this, &EventCompressionDemo::onStreamUpdates);
     
     // 启用鼠标跟踪
     setMouseTracking(true);
@@ -64,7 +74,16 @@ EventCompressionDemo::EventCompressionDemo(QWidget *parent)
 
 EventCompressionDemo::~EventCompressionDemo()
 {
-    // 析构函数，Qt会自动清理子对象
+    // 通道销毁前必须等待所有写入线程结束；线程对象没有父对象，在此删除
+    for (QThread *thread : m_streamThreads) {
+        thread->wait();
+    }
+    qDeleteAll(m_streamThreads);
+}
+
+void EventCompressionDemo::flushCoalescedEvents()
+{
+    m_coalescer->flush();
 }
 
 void EventCompressionDemo::setupUI()
@@ -86,7 +105,12 @@ void EventCompressionDemo::setupUI()
     m_compressionInterval->setValue(50);
     m_compressionInterval->setSuffix(" ms");
     
+    m_adaptiveInterval = new QCheckBox("自适应间隔", this);
+    m_adaptiveInterval->setToolTip("低负载时立即交付，高负载时按处理代价放大间隔以限制CPU占用");
+    
     m_generateEventsBtn = new QPushButton("生成测试事件", this);
+    m_streamTestBtn = new QPushButton("多线程数据流", this);
+    m_streamTestBtn->setToolTip("4个工作线程在1000个键上共写入10万次更新，GUI线程每帧只处理每个键的最新值");
     m_clearLogBtn = new QPushButton("清空日志", this);
     
     m_statusLabel = new QLabel("状态: 就绪", this);
@@ -96,7 +120,9 @@ void EventCompressionDemo::setupUI()
     m_controlLayout->addWidget(m_compressionEnabled);
     m_controlLayout->addWidget(new QLabel("压缩间隔:"));
     m_controlLayout->addWidget(m_compressionInterval);
+    m_controlLayout->addWidget(m_adaptiveInterval);
     m_controlLayout->addWidget(m_generateEventsBtn);
+    m_controlLayout->addWidget(m_streamTestBtn);
     m_controlLayout->addWidget(m_clearLogBtn);
     m_controlLayout->addStretch();
     m_controlLayout->addWidget(m_statusLabel);
@@ -110,11 +136,15 @@ void EventCompressionDemo::setupUI()
     m_paintCountLabel = new QLabel("重绘次数: 0", this);
     m_dataUpdateLabel = new QLabel("数据更新: 0", this);
     m_compressionRatioLabel = new QLabel("压缩比率: 0%", this);
+    m_adaptiveLabel = new QLabel("自适应间隔: 未启用", this);
+    m_streamLabel = new QLabel("跨线程数据流: 0 次写入", this);
     
     displayLayout->addWidget(m_mousePositionLabel);
     displayLayout->addWidget(m_paintCountLabel);
     displayLayout->addWidget(m_dataUpdateLabel);
     displayLayout->addWidget(m_compressionRatioLabel);
+    displayLayout->addWidget(m_adaptiveLabel);
+    displayLayout->addWidget(m_streamLabel);
     
     // 日志区域
     m_logGroup = new QGroupBox("事件日志", this);
@@ -136,8 +166,12 @@ void EventCompressionDemo::setupUI()
             this, &EventCompressionDemo::onCompressionEnabledChanged);
     connect(m_compressionInterval, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &EventCompressionDemo::onCompressionIntervalChanged);
+    connect(m_adaptiveInterval, &QCheckBox::toggled,
+            this, &EventCompressionDemo::onAdaptiveIntervalToggled);
     connect(m_generateEventsBtn, &QPushButton::clicked,
             this, &EventCompressionDemo::onGenerateEventsClicked);
+    connect(m_streamTestBtn, &QPushButton::clicked,
+            this, &EventCompressionDemo::onStreamTestClicked);
     connect(m_clearLogBtn, &QPushButton::clicked,
             this, &EventCompressionDemo::onClearLogClicked);
 }
@@ -148,18 +182,8 @@ bool EventCompressionDemo::event(QEvent *event)
     switch (event->type()) {
     case QEvent::UpdateRequest:
         // 处理更新请求事件
-        if (m_compressionEnabledFlag) {
-            PaintEventData paintData;
-            paintData.region = rect();
-            paintData.timestamp = QDateTime::currentDateTime();
-            
-            m_paintEventQueue.enqueue(paintData);
-            m_totalPaintEvents++;
-            
-            if (!m_paintCompressionTimer->isActive()) {
-                m_paintCompressionTimer->start(m_compressionIntervalMs);
-            }
-            
+        if (m_coalescer->isEnabled()) {
+            m_coalescer->submit(m_paintChannel, rect());
             return true; // 事件已处理
         }
         break;
@@ -173,26 +197,9 @@ bool EventCompressionDemo::event(QEvent *event)
 
 void EventCompressionDemo::mouseMoveEvent(QMouseEvent *event)
 {
-    if (m_compressionEnabledFlag) {
-        // 将鼠标事件添加到队列中进行压缩处理
-        MouseEventData mouseData;
-        mouseData.position = event->pos();
-        mouseData.buttons = event->buttons();
-        mouseData.timestamp = QDateTime::currentDateTime();
-        
-        m_mouseEventQueue.enqueue(mouseData);
-        m_totalMouseEvents++;
-        
-        // 启动或重启压缩定时器
-        if (!m_mouseCompressionTimer->isActive()) {
-            m_mouseCompressionTimer->start(m_compressionIntervalMs);
-        }
-    } else {
-        // 直接处理鼠标事件
-        m_mousePositionLabel->setText(QString("鼠标位置: (%1, %2)")
-                                     .arg(event->pos().x())
-                                     .arg(event->pos().y()));
-        m_totalMouseEvents++;
+    // 启用压缩时只保留合并窗口内的最新位置，禁用时合并器直接交付
+    m_coalescer->submit(m_mouseChannel, event->pos());
+    if (!m_coalescer->isEnabled()) {
         updateStatistics();
     }
     
@@ -213,118 +220,150 @@ void EventCompressionDemo::paintEvent(QPaintEvent *event)
 
 void EventCompressionDemo::onCompressionEnabledChanged(bool enabled)
 {
-    m_compressionEnabledFlag = enabled;
+    m_coalescer->setEnabled(enabled);
     m_statusLabel->setText(enabled ? "状态: 压缩已启用" : "状态: 压缩已禁用");
     logEvent(QString("事件压缩%1").arg(enabled ? "已启用" : "已禁用"));
 }
 
 void EventCompressionDemo::onCompressionIntervalChanged(int interval)
 {
-    m_compressionIntervalMs = interval;
+    m_coalescer->setInterval(interval);
     logEvent(QString("压缩间隔设置为 %1 ms").arg(interval));
 }
 
+void EventCompressionDemo::onAdaptiveIntervalToggled(bool enabled)
+{
+    m_compressionInterval->setEnabled(!enabled);
+    if (enabled) {
+        m_intervalController->start();
+    } else {
+        m_intervalController->stop();
+        m_coalescer->setInterval(m_compressionInterval->value());
+    }
+    logEvent(QString("自适应间隔%1").arg(enabled ? "已启用" : "已禁用，恢复手动间隔"));
+    updateStatistics();
+}
+
+void EventCompressionDemo::onAdaptiveIntervalChanged(int interval)
+{
+    logEvent(QString("自适应间隔调整为 %1 ms").arg(interval));
+    updateStatistics();
+}
+
 void EventCompressionDemo::onGenerateEventsClicked()
 {
     generateTestEvents();
 }
 
+void EventCompressionDemo::onStreamTestClicked()
+{
+    const int threadCount = 4;
+    const int writesPerThread = 25000;
+    const int keyCount = 1000;
+    
+    m_streamTestBtn->setEnabled(false);
+    logEvent(QString("启动 %1 个写入线程，共 %2 次更新、%3 个键")
+             .arg(threadCount).arg(threadCount * writesPerThread).arg(keyCount));
+    
+    for (int t = 0; t < threadCount; ++t) {
+        QThread *thread = QThread::create([this, t, writesPerThread, keyCount]() {
+            for (int i = 0; i < writesPerThread; ++i) {
+                m_dataStream->write(QString("sensor_%1").arg((t * writesPerThread + i) % keyCount),
+                                    t * writesPerThread + i);
+            }
+        });
+        connect(thread, &QThread::finished, this, [this, thread]() {
+            m_streamThreads.removeOne(thread);
+            thread->deleteLater();
+            if (m_streamThreads.isEmpty()) {
+                m_streamTestBtn->setEnabled(true);
+                logEvent("写入线程全部结束");
+            }
+        });
+        m_streamThreads.append(thread);
+        thread->start();
+    }
+}
+
+void EventCompressionDemo::onStreamUpdates(const QVariantHash &updates)
+{
+    // 每帧每个键只应用一次
+    for (auto it = updates.constBegin(); it != updates.constEnd(); ++it) {
+        m_streamValues.insert(it.key(), it.value());
+    }
+    
+    KeyValueUpdateChannel::Metrics metrics = m_dataStream->metrics();
+    m_streamLabel->setText(QString("跨线程数据流: %1 次写入 -> %2 帧共 %3 个键 | 合并 %4% | 生产者 %5 | 推迟交换 %6")
+                          .arg(metrics.writes)
+                          .arg(metrics.frames)
+                          .arg(metrics.keysDelivered)
+                          .arg(QString::number(metrics.compressionRatio() * 100.0, 'f', 1))
+                          .arg(metrics.producers)
+                          .arg(metrics.deferredSwaps));
+}
+
 void EventCompressionDemo::onClearLogClicked()
 {
     m_logTextEdit->clear();
     
     // 重置统计信息
-    m_totalMouseEvents = 0;
-    m_compressedMouseEvents = 0;
-    m_totalPaintEvents = 0;
-    m_compressedPaintEvents = 0;
-    m_totalDataUpdates = 0;
-    m_compressedDataUpdates = 0;
+    m_coalescer->resetMetrics();
+    m_paintCount = 0;
+    m_dirtyRegion.resetMetrics();
+    m_dataBatchCount = 0;
     
     updateStatistics();
     logEvent("日志和统计信息已清空");
 }
 
-void EventCompressionDemo::processCompressedMouseEvents()
+void EventCompressionDemo::onChannelFlushed(int channel, int sourceCount, int deliveredCount)
 {
-    if (m_mouseEventQueue.isEmpty()) {
-        return;
+    if (channel == m_mouseChannel) {
+        logEvent(QString("压缩处理 %1 个鼠标事件 -> 1 个事件")
+                 .arg(sourceCount));
+    } else if (channel == m_paintChannel) {
+        logEvent(QString("压缩处理 %1 个重绘事件 -> 1 个重绘区域")
+                 .arg(sourceCount));
+    } else if (channel == m_dataChannel) {
+        logEvent(QString("批处理 %1 个数据更新 -> %2 个唯一更新")
+                 .arg(sourceCount)
+                 .arg(deliveredCount));
     }
     
-    // 压缩算法：只保留最新的鼠标位置
-    MouseEventData latestEvent = m_mouseEventQueue.last();
-    int queueSize = m_mouseEventQueue.size();
-    m_mouseEventQueue.clear();
-    
-    // 更新UI
-    m_mousePositionLabel->setText(QString("鼠标位置: (%1, %2)")
-                                 .arg(latestEvent.position.x())
-                                 .arg(latestEvent.position.y()));
-    
-    m_compressedMouseEvents++;
-    
-    logEvent(QString("压缩处理 %1 个鼠标事件 -> 1 个事件")
-             .arg(queueSize));
-    
     updateStatistics();
 }
 
-void EventCompressionDemo::processCompressedPaintEvents()
+void EventCompressionDemo::applyMousePosition(const QPoint &position)
 {
-    if (m_paintEventQueue.isEmpty()) {
-        return;
-    }
-    
-    // 压缩算法：合并所有重绘区域
-    QRect combinedRegion;
-    int queueSize = m_paintEventQueue.size();
-    
-    while (!m_paintEventQueue.isEmpty()) {
-        PaintEventData paintData = m_paintEventQueue.dequeue();
-        combinedRegion = combinedRegion.united(paintData.region);
-    }
-    
-    m_compressedPaintEvents++;
-    
-    // 触发实际的重绘
-    update(combinedRegion);
-    
-    logEvent(QString("压缩处理 %1 个重绘事件 -> 1 个重绘区域")
-             .arg(queueSize));
-    
-    updateStatistics();
+    m_mousePositionLabel->setText(QString("鼠标位置: (%1, %2)")
+                                 .arg(position.x())
+                                 .arg(position.y()));
 }
 
-void EventCompressionDemo::processBatchedDataUpdates()
+void EventCompressionDemo::applyPaintRegion(const QRegion &region)
 {
-    if (m_dataUpdateQueue.isEmpty()) {
-        return;
-    }
+    m_paintCount++;
     
-    // 批处理数据更新：按键分组，只保留最新值
-    QMap<QString, QVariant> latestUpdates;
-    int queueSize = m_dataUpdateQueue.size();
-    
-    while (!m_dataUpdateQueue.isEmpty()) {
-        DataUpdateEvent updateData = m_dataUpdateQueue.dequeue();
-        latestUpdates[updateData.key] = updateData.value;
+    if (m_dirtyRegion.area() != size()) {
+        m_dirtyRegion.setArea(size());
     }
+    m_dirtyRegion.markDirty(region);
     
-    m_compressedDataUpdates++;
+    // 直接重绘合并后的区域；update()会再次产生UpdateRequest并被重新合并
+    repaint(m_dirtyRegion.takeRegion());
+}
+
+void EventCompressionDemo::applyDataUpdates(const QVariantMap &updates)
+{
+    m_dataBatchCount++;
     
     // 应用批量更新
-    for (auto it = latestUpdates.begin(); it != latestUpdates.end(); ++it) {
+    for (auto it = updates.begin(); it != updates.end(); ++it) {
         // 这里可以执行实际的数据更新操作
     }
     
     m_dataUpdateLabel->setText(QString("数据更新: %1 批次")
-                              .arg(m_compressedDataUpdates));
-    
-    logEvent(QString("批处理 %1 个数据更新 -> %2 个唯一更新")
-             .arg(queueSize)
-             .arg(latestUpdates.size()));
-    
-    updateStatistics();
+                              .arg(m_dataBatchCount));
 }
 
 void EventCompressionDemo::logEvent(const QString &message)
@@ -342,22 +381,40 @@ void EventCompressionDemo::logEvent(const QString &message)
 
 void EventCompressionDemo::updateStatistics()
 {
-    m_paintCountLabel->setText(QString("重绘次数: %1").arg(m_compressedPaintEvents));
+    DirtyRegionTracker::Metrics paint = m_dirtyRegion.metrics();
+    m_paintCountLabel->setText(QString("重绘次数: %1 | 平均矩形数 %2 | 外接框重绘 %3 次 | 重绘像素 %4")
+                              .arg(m_paintCount)
+                              .arg(paint.flushes > 0 ? QString::number(double(paint.rectsEmitted) / paint.flushes, 'f', 1) : QString("0"))
+                              .arg(paint.boundingBoxFlushes)
+                              .arg(paint.repaintedPixels));
     updateCompressionRatio();
+    
+    // 延迟与CPU占用的权衡指标
+    if (m_intervalController->isRunning()) {
+        CoalescingIntervalController::Metrics adaptive = m_intervalController->metrics();
+        m_adaptiveLabel->setText(QString("自适应间隔: %1 ms (目标 %2 ms) | 输入 %3 事件/秒 | 交付代价 %4 µs | CPU %5% | 平均延迟 %6 ms")
+                                .arg(adaptive.intervalMs)
+                                .arg(adaptive.targetIntervalMs)
+                                .arg(QString::number(adaptive.inputRate, 'f', 0))
+                                .arg(QString::number(adaptive.deliveryCostUs, 'f', 1))
+                                .arg(QString::number(adaptive.cpuLoad * 100.0, 'f', 1))
+                                .arg(QString::number(adaptive.meanLatencyMs, 'f', 1)));
+    } else {
+        m_adaptiveLabel->setText("自适应间隔: 未启用");
+    }
 }
 
 void EventCompressionDemo::updateCompressionRatio()
 {
-    int totalEvents = m_totalMouseEvents + m_totalPaintEvents + m_totalDataUpdates;
-    int compressedEvents = m_compressedMouseEvents + m_compressedPaintEvents + m_compressedDataUpdates;
+    EventCoalescer::Metrics metrics = m_coalescer->metrics();
     
-    if (totalEvents > 0) {
-        double ratio = (1.0 - (double)compressedEvents / totalEvents) * 100.0;
+    if (metrics.submitted > 0) {
+        double ratio = metrics.compressionRatio() * 100.0;
         m_compressionRatioLabel->setText(QString("压缩比率: %1%")
                                         .arg(QString::number(ratio, 'f', 1)));
         
         // 更新进度条
-        m_eventLoadBar->setValue(qMin(100, totalEvents / 10));
+        m_eventLoadBar->setValue(static_cast<int>(qMin<quint64>(100, metrics.submitted / 10)));
     }
 }
 
@@ -372,38 +429,19 @@ void EventCompressionDemo::generateTestEvents()
     
     // 生成模拟的鼠标移动事件
     for (int i = 0; i < 50; ++i) {
-        MouseEventData mouseData;
-        mouseData.position = QPoint(
+        QPoint position(
             QRandomGenerator::global()->bounded(width()),
             QRandomGenerator::global()->bounded(height())
         );
-        mouseData.buttons = Qt::NoButton;
-        mouseData.timestamp = QDateTime::currentDateTime();
-        
-        m_mouseEventQueue.enqueue(mouseData);
-        m_totalMouseEvents++;
+        m_coalescer->submit(m_mouseChannel, position);
     }
     
     // 生成模拟的数据更新事件
     QStringList keys = {"temperature", "humidity", "pressure", "wind_speed"};
     for (int i = 0; i < 30; ++i) {
-        DataUpdateEvent updateData;
-        updateData.key = keys[QRandomGenerator::global()->bounded(keys.size())];
-        updateData.value = QRandomGenerator::global()->bounded(100);
-        updateData.timestamp = QDateTime::currentDateTime();
-        
-        m_dataUpdateQueue.enqueue(updateData);
-        m_totalDataUpdates++;
-    }
-    
-    // 启动压缩定时器
-    if (m_compressionEnabledFlag) {
-        if (!m_mouseCompressionTimer->isActive()) {
-            m_mouseCompressionTimer->start(m_compressionIntervalMs);
-        }
-        if (!m_dataCompressionTimer->isActive()) {
-            m_dataCompressionTimer->start(m_compressionIntervalMs);
-        }
+        m_coalescer->submit(m_dataChannel,
+                            keys[QRandomGenerator::global()->bounded(keys.size())],
+                            QRandomGenerator::global()->bounded(100));
     }
     
     logEvent(QString("生成了 %1 个鼠标事件和 %2 个数据更新事件")
@@ -418,5 +456,5 @@ void EventCompressionDemo::measureCompressionPerformance()
     
     logEvent(QString("性能测试 - 运行时间: %1 ms, 总事件数: %2")
              .arg(elapsed)
-             .arg(m_totalMouseEvents + m_totalPaintEvents + m_totalDataUpdates));
+             .arg(m_coalescer->metrics().submitted));
 }
\ No newline at end of file
@@ -11,12 +11,16 @@
 #include <QMouseEvent>
 #include <QProgressBar>
 #include <QPushButton>
-#include <QQueue>
 #include <QSpinBox>
 #include <QTextEdit>
+#include <QThread>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
+#include "../../core/event_coalescer.h"
+#include "../../core/coalescing_interval_controller.h"
+#include "../../core/dirty_region_tracker.h"
+#include "../../core/key_value_update_channel.h"
 
 /**
  * EventCompressionDemo - 演示事件压缩和合并技术
@@ -26,6 +30,7 @@
  * 2. 重绘事件合并 - 将多个重绘请求合并为一次
  * 3. 数据更新事件批处理 - 将频繁的数据更新合并处理
  * 4. 定时器事件优化 - 避免过于频繁的定时器触发
+ * 5. 跨线程数据流 - 多个工作线程高频写入，GUI线程每帧只处理每个键的最新值
  */
 class EventCompressionDemo : public QWidget {
   Q_OBJECT
@@ -34,6 +39,11 @@ public:
   explicit EventCompressionDemo(QWidget *parent = nullptr);
   ~EventCompressionDemo();
 
+  /**
+   * @brief 立即交付合并器中所有待处理的事件
+   */
+  void flushCoalescedEvents();
+
 protected:
   // 重写事件处理函数来演示事件压缩
   bool event(QEvent *event) override;
@@ -44,13 +54,17 @@ private slots:
   // 控制面板槽函数
   void onCompressionEnabledChanged(bool enabled);
   void onCompressionIntervalChanged(int interval);
+  void onAdaptiveIntervalToggled(bool enabled);
+  void onAdaptiveIntervalChanged(int interval);
   void onGenerateEventsClicked();
+  void onStreamTestClicked();
   void onClearLogClicked();
 
-  // 事件处理槽函数
-  void processCompressedMouseEvents();
-  void processCompressedPaintEvents();
-  void processBatchedDataUpdates();
+  // 合并器完成一批交付
+  void onChannelFlushed(int channel, int sourceCount, int deliveredCount);
+
+  // 跨线程数据通道交付一帧
+  void onStreamUpdates(const QVariantHash &updates);
 
 private:
   // UI组件
@@ -64,7 +78,9 @@ private:
   // 控制面板
   QCheckBox *m_compressionEnabled;
   QSpinBox *m_compressionInterval;
+  QCheckBox *m_adaptiveInterval;
   QPushButton *m_generateEventsBtn;
+  QPushButton *m_streamTestBtn;
   QPushButton *m_clearLogBtn;
   QLabel *m_statusLabel;
   QProgressBar *m_eventLoadBar;
@@ -74,51 +90,30 @@ private:
   QLabel *m_paintCountLabel;
   QLabel *m_dataUpdateLabel;
   QLabel *m_compressionRatioLabel;
+  QLabel *m_adaptiveLabel;
+  QLabel *m_streamLabel;
 
   // 日志区域
   QTextEdit *m_logTextEdit;
 
-  // 事件压缩相关
-  struct MouseEventData {
-    QPoint position;
-    Qt::MouseButtons buttons;
-    QDateTime timestamp;
-  };
-
-  struct PaintEventData {
-    QRect region;
-    QDateTime timestamp;
-  };
-
-  struct DataUpdateEvent {
-    QString key;
-    QVariant value;
-    QDateTime timestamp;
-  };
-
-  // 事件队列和压缩状态
-  QQueue<MouseEventData> m_mouseEventQueue;
-  QQueue<PaintEventData> m_paintEventQueue;
-  QQueue<DataUpdateEvent> m_dataUpdateQueue;
-
-  // 定时器用于批处理
-  QTimer *m_mouseCompressionTimer;
-  QTimer *m_paintCompressionTimer;
-  QTimer *m_dataCompressionTimer;
-
-  // 统计信息
-  int m_totalMouseEvents;
-  int m_compressedMouseEvents;
-  int m_totalPaintEvents;
-  int m_compressedPaintEvents;
-  int m_totalDataUpdates;
-  int m_compressedDataUpdates;
+  // 事件合并器：鼠标位置取最新值，重绘区域求并集，数据更新按键保留最新值
+  EventCoalescer *m_coalescer;
+  int m_mouseChannel;
+  int m_paintChannel;
+  int m_dataChannel;
+  int m_paintCount;
+  DirtyRegionTracker m_dirtyRegion;  // 把合并后的重绘区域对齐到瓦片并限制矩形数
+  int m_dataBatchCount;
 
-  QElapsedTimer m_performanceTimer;
+  // 按输入速率和处理代价自动调整合并间隔
+  CoalescingIntervalController *m_intervalController;
 
-  // 配置参数
-  bool m_compressionEnabledFlag;
-  int m_compressionIntervalMs;
+  // 工作线程写入的键值更新，按帧合并后交付到GUI线程
+  KeyValueUpdateChannel *m_dataStream;
+  QList<QThread *> m_streamThreads;
+  QVariantHash m_streamValues;
+
+  QElapsedTimer m_performanceTimer;
 
   // 辅助方法
   void logEvent(const QString &message);
@@ -126,10 +121,10 @@ private:
   void updateCompressionRatio();
   QString formatTimestamp(const QDateTime &timestamp);
 
-  // 事件压缩算法
-  void compressMouseEvents();
-  void compressPaintEvents();
-  void compressDataUpdates();
+  // 合并结果处理
+  void applyMousePosition(const QPoint &position);
+  void applyPaintRegion(const QRegion &region);
+  void applyDataUpdates(const QVariantMap &updates);
 
   // 性能测试
   void generateTestEvents();
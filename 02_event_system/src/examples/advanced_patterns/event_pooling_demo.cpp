@@ -4,82 +4,6 @@
 #include <QDebug>
 #include <QCheckBox>
 
-// EventPool 实现
-EventPool::EventPool(int initialSize)
-    : m_totalEvents(0)
-    , m_initialSize(initialSize)
-{
-    createEvents(initialSize);
-}
-
-EventPool::~EventPool()
-{
-    clearPool();
-}
-
-PooledEvent* EventPool::acquireEvent()
-{
-    QMutexLocker locker(&m_mutex);
-    
-    if (m_availableEvents.isEmpty()) {
-        // 池为空，创建新的事件对象
-        createEvents(m_initialSize / 2); // 扩展一半的初始大小
-    }
-    
-    PooledEvent* event = m_availableEvents.pop();
-    event->setInUse(true);
-    return event;
-}
-
-void EventPool::releaseEvent(PooledEvent* event)
-{
-    if (!event) return;
-    
-    QMutexLocker locker(&m_mutex);
-    
-    event->reset();
-    event->setInUse(false);
-    m_availableEvents.push(event);
-}
-
-void EventPool::expandPool(int additionalSize)
-{
-    QMutexLocker locker(&m_mutex);
-    createEvents(additionalSize);
-}
-
-void EventPool::shrinkPool()
-{
-    QMutexLocker locker(&m_mutex);
-    
-    // 只保留一半的可用事件
-    int targetSize = m_availableEvents.size() / 2;
-    while (m_availableEvents.size() > targetSize) {
-        PooledEvent* event = m_availableEvents.pop();
-        delete event;
-        m_totalEvents--;
-    }
-}
-
-void EventPool::clearPool()
-{
-    QMutexLocker locker(&m_mutex);
-    
-    while (!m_availableEvents.isEmpty()) {
-        delete m_availableEvents.pop();
-    }
-    m_totalEvents = 0;
-}
-
-void EventPool::createEvents(int count)
-{
-    for (int i = 0; i < count; ++i) {
-        PooledEvent* event = new PooledEvent();
-        m_availableEvents.push(event);
-        m_totalEvents++;
-    }
-}
-
 // EventPoolingDemo 实现
 EventPoolingDemo::EventPoolingDemo(QWidget *parent)
     : QWidget(parent)
@@ -91,6 +15,7 @@ EventPoolingDemo::EventPoolingDemo(QWidget *parent)
     , m_clearPoolBtn(nullptr)
     , m_poolSizeSpinBox(nullptr)
     , m_autoExpandCheckBox(nullptr)
+    , m_auditCheckBox(nullptr)
     , m_statusLabel(nullptr)
     , m_totalEventsLabel(nullptr)
     , m_availableEventsLabel(nullptr)
@@ -99,8 +24,12 @@ EventPoolingDemo::EventPoolingDemo(QWidget *parent)
     , m_poolUsageBar(nullptr)
     , m_memoryUsageLabel(nullptr)
     , m_performanceLabel(nullptr)
+    , m_contentionLabel(nullptr)
+    , m_policyLabel(nullptr)
+    , m_auditLabel(nullptr)
     , m_logTextEdit(nullptr)
     , m_eventPool(nullptr)
+    , m_sizingPolicy(nullptr)
     , m_statisticsTimer(nullptr)
     , m_eventProcessingTimer(nullptr)
     , m_eventsProcessed(0)
@@ -112,7 +41,20 @@ EventPoolingDemo::EventPoolingDemo(QWidget *parent)
     setupUI();
     
     // 初始化事件池
-    m_eventPool = std::make_unique<EventPool>(100);
+    m_eventPool = std::make_unique<EventPool<PooledEvent>>(100);
+    
+    // 初始化自适应容量策略
+    PoolSizingPolicy::Config policyConfig;
+    policyConfig.minBlocks = m_poolSizeSpinBox->minimum();
+    policyConfig.maxBlocks = m_maxPoolSize;
+    m_sizingPolicy = new PoolSizingPolicy(this);
+    m_sizingPolicy->setConfig(policyConfig);
+    m_sizingPolicy->attach(m_eventPool.get());
+    connect(m_sizingPolicy, &PoolSizingPolicy::decisionMade,
+            this, &EventPoolingDemo::onPolicyDecision);
+    if (m_autoExpandEnabled) {
+        m_sizingPolicy->start();
+    }
     
     // 初始化定时器
     m_statisticsTimer = new QTimer(this);
@@ -164,6 +106,9 @@ void EventPoolingDemo::setupUI()
     m_autoExpandCheckBox = new QCheckBox("自动扩展池", this);
     m_autoExpandCheckBox->setChecked(true);
     
+    m_auditCheckBox = new QCheckBox("审计模式", this);
+    m_auditCheckBox->setToolTip("记录每个事件的获取位置，检测长期未归还和重复释放");
+    
     m_statusLabel = new QLabel("状态: 就绪", this);
     
     controlLayout->addWidget(m_generateEventsBtn);
@@ -171,6 +116,7 @@ void EventPoolingDemo::setupUI()
     controlLayout->addWidget(new QLabel("池大小:"));
     controlLayout->addWidget(m_poolSizeSpinBox);
     controlLayout->addWidget(m_autoExpandCheckBox);
+    controlLayout->addWidget(m_auditCheckBox);
     controlLayout->addStretch();
     controlLayout->addWidget(m_statusLabel);
     
@@ -196,11 +142,18 @@ void EventPoolingDemo::setupUI()
     statsRow2->addWidget(m_memoryUsageLabel);
     statsRow2->addWidget(m_performanceLabel);
     
+    m_contentionLabel = new QLabel("竞争: 快速路径 0 / 仓库交换 0 / 慢路径 0", this);
+    m_policyLabel = new QLabel("容量策略: 未运行", this);
+    m_auditLabel = new QLabel("审计: 未开启", this);
+    
     m_poolUsageBar = new QProgressBar(this);
     m_poolUsageBar->setRange(0, 100);
     
     statsLayout->addLayout(statsRow1);
     statsLayout->addLayout(statsRow2);
+    statsLayout->addWidget(m_contentionLabel);
+    statsLayout->addWidget(m_policyLabel);
+    statsLayout->addWidget(m_auditLabel);
     statsLayout->addWidget(new QLabel("池使用率:", this));
     statsLayout->addWidget(m_poolUsageBar);
     
@@ -228,6 +181,8 @@ void EventPoolingDemo::setupUI()
             this, &EventPoolingDemo::onPoolSizeChanged);
     connect(m_autoExpandCheckBox, &QCheckBox::toggled,
             this, &EventPoolingDemo::onAutoExpandToggled);
+    connect(m_auditCheckBox, &QCheckBox::toggled,
+            this, &EventPoolingDemo::onAuditToggled);
 }
 
 bool EventPoolingDemo::event(QEvent *event)
@@ -256,7 +211,9 @@ void EventPoolingDemo::onClearPoolClicked()
     
     // 清空事件池
     m_eventPool->clearPool();
-    m_eventPool = std::make_unique<EventPool>(m_poolSizeSpinBox->value());
+    m_eventPool = std::make_unique<EventPool<PooledEvent>>(m_poolSizeSpinBox->value());
+    m_sizingPolicy->attach(m_eventPool.get());
+    m_eventPool->setAuditEnabled(m_auditCheckBox->isChecked(), true);
     
     // 重置统计
     m_eventsProcessed = 0;
@@ -280,9 +237,21 @@ void EventPoolingDemo::onPoolSizeChanged(int size)
 void EventPoolingDemo::onAutoExpandToggled(bool enabled)
 {
     m_autoExpandEnabled = enabled;
+    if (enabled) {
+        m_sizingPolicy->start();
+    } else {
+        m_sizingPolicy->stop();
+    }
     logMessage(QString("自动扩展池%1").arg(enabled ? "已启用" : "已禁用"));
 }
 
+void EventPoolingDemo::onAuditToggled(bool enabled)
+{
+    m_eventPool->setAuditEnabled(enabled, true);
+    logMessage(QString("审计模式%1").arg(enabled ? "已开启" : "已关闭"));
+    updateStatistics();
+}
+
 void EventPoolingDemo::updateStatistics()
 {
     if (!m_eventPool) return;
@@ -304,9 +273,49 @@ void EventPoolingDemo::updateStatistics()
     int usagePercent = total > 0 ? (used * 100) / total : 0;
     m_poolUsageBar->setValue(usagePercent);
     
-    // 估算内存使用
-    qint64 memoryUsage = total * sizeof(PooledEvent);
-    m_memoryUsageLabel->setText(QString("内存使用: %1").arg(formatMemorySize(memoryUsage)));
+    // 实际占用：池中全部slab的字节数（含块间距填充和slab头）
+    qint64 memoryUsage = m_eventPool->reservedBytes();
+    m_memoryUsageLabel->setText(QString("内存使用: %1 (%2 个slab)")
+                               .arg(formatMemorySize(memoryUsage))
+                               .arg(m_eventPool->slabCount()));
+    
+    // 竞争统计
+    EventStoragePool::ContentionStats contention = m_eventPool->contentionStats();
+    m_contentionLabel->setText(QString("竞争: 快速路径 %1 / 仓库交换 %2 / 慢路径 %3 / CAS重试 %4 / 溢出 %5")
+                              .arg(contention.fastAcquires + contention.fastReleases)
+                              .arg(contention.depotExchanges)
+                              .arg(contention.slowPathAcquires)
+                              .arg(contention.casRetries)
+                              .arg(contention.overflowSpills));
+    
+    // 容量策略指标
+    PoolSizingPolicy::Metrics policy = m_sizingPolicy->metrics();
+    m_policyLabel->setText(QString("容量策略: %1 | 命中率 %2% | 高水位 %3 | 获取速率 %4/秒 | 扩容 %5 次 / 收缩 %6 次")
+                          .arg(m_sizingPolicy->isRunning() ? "运行中" : "已停止")
+                          .arg(QString::number(policy.hitRate * 100.0, 'f', 1))
+                          .arg(policy.highWaterMark)
+                          .arg(QString::number(policy.acquireRate, 'f', 0))
+                          .arg(policy.growDecisions)
+                          .arg(policy.shrinkDecisions));
+    
+    // 审计结果：持有超过5秒的事件视为疑似泄漏
+    if (m_eventPool->isAuditEnabled()) {
+        const qint64 leakThresholdMs = 5000;
+        QList<EventStoragePool::AuditRecord> longHeld = m_eventPool->outstandingEvents(leakThresholdMs);
+        QString auditText = QString("审计: 未归还 %1 | 持有超过 %2 秒 %3 | 重复释放 %4")
+                            .arg(m_eventPool->outstandingCount())
+                            .arg(leakThresholdMs / 1000)
+                            .arg(longHeld.size())
+                            .arg(m_eventPool->doubleReleaseCount());
+        if (!longHeld.isEmpty()) {
+            auditText += QString(" | 最久 %1 ms @ %2")
+                         .arg(longHeld.first().heldMs)
+                         .arg(longHeld.first().site);
+        }
+        m_auditLabel->setText(auditText);
+    } else {
+        m_auditLabel->setText("审计: 未开启");
+    }
     
     // 计算处理性能
     qint64 elapsed = m_performanceTimer.elapsed();
@@ -341,6 +350,16 @@ void EventPoolingDemo::processPooledEvents()
     }
 }
 
+void EventPoolingDemo::onPolicyDecision(PoolSizingPolicy::Decision decision, int delta, int totalBlocks)
+{
+    if (decision == PoolSizingPolicy::Grow) {
+        logMessage(QString("容量策略: 预扩容 %1 个事件对象，当前共 %2 个").arg(delta).arg(totalBlocks));
+    } else if (decision == PoolSizingPolicy::Shrink) {
+        logMessage(QString("容量策略: 持续空闲，释放 %1 个事件对象，当前共 %2 个").arg(-delta).arg(totalBlocks));
+    }
+    updateStatistics();
+}
+
 void EventPoolingDemo::logMessage(const QString &message)
 {
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
@@ -362,7 +381,7 @@ void EventPoolingDemo::generateTestEvents(int count)
     timer.start();
     
     for (int i = 0; i < count; ++i) {
-        PooledEvent* event = m_eventPool->acquireEvent();
+        PooledEvent* event = m_eventPool->acquireEventAt(EVENT_POOL_SITE);
         
         // 设置事件数据
         event->setData("id", i);
@@ -20,6 +20,9 @@
 #include <QDateTime>
 #include <QThread>
 #include <memory>
+#include "../../core/event_pool.h"
+#include "../../core/event_payload.h"
+#include "../../core/pool_sizing_policy.h"
 
 // 自定义事件类型
 class PooledEvent : public QEvent
@@ -27,25 +30,35 @@ class PooledEvent : public QEvent
 public:
     static const QEvent::Type PooledEventType = static_cast<QEvent::Type>(QEvent::User + 1000);
     
-    PooledEvent() : QEvent(PooledEventType), m_inUse(false) {}
+    PooledEvent() : QEvent(PooledEventType), m_priority(0), m_inUse(false) {}
     
-    // 重置事件状态以便重用
+    // 重置事件状态以便重用，负载竞技场O(1)回拨并保留内存
     void reset() {
-        m_data.clear();
+        m_payload.clear();
         m_timestamp = QDateTime();
         m_priority = 0;
         m_inUse = false;
     }
     
-    // 设置事件数据
+    // 设置事件数据（键名会被驻留，热点路径可先用 EventPayload::internKey 取得键ID）
     void setData(const QString &key, const QVariant &value) {
-        m_data[key] = value;
+        m_payload.setValue(key, value);
+    }
+    
+    void setData(int keyId, const QVariant &value) {
+        m_payload.setValue(keyId, value);
     }
     
     QVariant getData(const QString &key) const {
-        return m_data.value(key);
+        return m_payload.value(key);
+    }
+    
+    QVariant getData(int keyId) const {
+        return m_payload.value(keyId);
     }
     
+    const EventPayload& payload() const { return m_payload; }
+    
     void setTimestamp(const QDateTime &timestamp) { m_timestamp = timestamp; }
     QDateTime timestamp() const { return m_timestamp; }
     
@@ -56,44 +69,12 @@ public:
     bool isInUse() const { return m_inUse; }
 
 private:
-    QMap<QString, QVariant> m_data;
+    EventPayload m_payload;
     QDateTime m_timestamp;
     int m_priority;
     bool m_inUse;
 };
 
-// 事件池管理器
-class EventPool
-{
-public:
-    EventPool(int initialSize = 100);
-    ~EventPool();
-    
-    // 获取事件对象
-    PooledEvent* acquireEvent();
-    
-    // 释放事件对象回池中
-    void releaseEvent(PooledEvent* event);
-    
-    // 统计信息
-    int totalEvents() const { return m_totalEvents; }
-    int availableEvents() const { return m_availableEvents.size(); }
-    int usedEvents() const { return m_totalEvents - m_availableEvents.size(); }
-    
-    // 池管理
-    void expandPool(int additionalSize);
-    void shrinkPool();
-    void clearPool();
-
-private:
-    QStack<PooledEvent*> m_availableEvents;
-    QMutex m_mutex;
-    int m_totalEvents;
-    int m_initialSize;
-    
-    void createEvents(int count);
-};
-
 /**
  * EventPoolingDemo - 演示事件对象池化技术
  * 
@@ -119,8 +100,10 @@ private slots:
     void onClearPoolClicked();
     void onPoolSizeChanged(int size);
     void onAutoExpandToggled(bool enabled);
+    void onAuditToggled(bool enabled);
     void updateStatistics();
     void processPooledEvents();
+    void onPolicyDecision(PoolSizingPolicy::Decision decision, int delta, int totalBlocks);
 
 private:
     // UI组件
@@ -135,6 +118,7 @@ private:
     QPushButton *m_clearPoolBtn;
     QSpinBox *m_poolSizeSpinBox;
     QCheckBox *m_autoExpandCheckBox;
+    QCheckBox *m_auditCheckBox;
     QLabel *m_statusLabel;
     
     // 统计显示
@@ -145,12 +129,16 @@ private:
     QProgressBar *m_poolUsageBar;
     QLabel *m_memoryUsageLabel;
     QLabel *m_performanceLabel;
+    QLabel *m_contentionLabel;
+    QLabel *m_policyLabel;
+    QLabel *m_auditLabel;
     
     // 日志区域
     QTextEdit *m_logTextEdit;
     
     // 事件池和处理
-    std::unique_ptr<EventPool> m_eventPool;
+    std::unique_ptr<EventPool<PooledEvent>> m_eventPool;
+    PoolSizingPolicy *m_sizingPolicy;
     QTimer *m_statisticsTimer;
     QTimer *m_eventProcessingTimer;
     QQueue<PooledEvent*> m_pendingEvents;
@@ -1,5 +1,6 @@
 #include "custom_event_demo.h"
 #include <QApplication>
+#include <QBuffer>
 #include <QMessageBox>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -403,6 +404,23 @@ void CustomEventDemo::demonstrateDataSerialization()
         delete deserializedEvent;
     }
     
+    // 演示流式读写：逐字段写入设备，再从设备逐字段读回
+    QBuffer journal;
+    journal.open(QIODevice::ReadWrite);
+    if (event->writeTo(&journal)) {
+        m_eventFlowDisplay->append(QString("流式写入: %1 字节").arg(journal.size()));
+        journal.seek(0);
+        
+        DataEvent* streamedEvent = new DataEvent();
+        if (streamedEvent->readFrom(&journal)) {
+            m_eventFlowDisplay->append("流式读取成功");
+            QApplication::postEvent(m_receiver, streamedEvent);
+        } else {
+            m_eventFlowDisplay->append("流式读取失败");
+            delete streamedEvent;
+        }
+    }
+    
     delete event;
     m_eventFlowDisplay->append("=== 序列化演示完成 ===");
 }
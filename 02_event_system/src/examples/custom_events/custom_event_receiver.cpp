@@ -212,7 +212,7 @@ bool CustomEventReceiver::handleDataEvent(DataEvent* event)
                     .arg(QDateTime::fromMSecsSinceEpoch(event->timestamp()).toString())
                     .arg(event->dataTypeName())
                     .arg(formatEventData(event->data()))
-                    .arg(event->serialize().size());
+                    .arg(event->serializedSize());
     m_lastEventDetail->setPlainText(detail);
     
     // 发送信号
@@ -253,9 +253,9 @@ bool CustomEventReceiver::handleCommandEvent(CommandEvent* event)
     QString detail = QString("命令事件详情:\n时间戳: %1\n命令: %2\n参数数量: %3\n参数内容: %4\n序列化大小: %5 字节")
                     .arg(QDateTime::fromMSecsSinceEpoch(event->timestamp()).toString())
                     .arg(event->command())
-                    .arg(event->parameters().size())
+                    .arg(event->parameterCount())
                     .arg(formatEventData(QVariant(event->parameters())))
-                    .arg(event->serialize().size());
+                    .arg(event->serializedSize());
     m_lastEventDetail->setPlainText(detail);
     
     // 发送信号
@@ -277,7 +277,7 @@ QString CustomEventReceiver::formatDataEventInfo(DataEvent* event)
 
 QString CustomEventReceiver::formatCommandEventInfo(CommandEvent* event)
 {
-    return QString("命令: %1 (%2个参数)").arg(event->command()).arg(event->parameters().size());
+    return QString("命令: %1 (%2个参数)").arg(event->command()).arg(event->parameterCount());
 }
 
 QString CustomEventReceiver::formatEventData(const QVariant& data)
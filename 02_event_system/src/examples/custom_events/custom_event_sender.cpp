@@ -140,10 +140,13 @@ void CustomEventSender::setupBatchControls()
     m_batchTypeCombo->addItems({"数据事件", "命令事件", "混合事件"});
     
     m_sendBatchBtn = new QPushButton("批量发送", this);
+    m_broadcastBtn = new QPushButton("共享负载广播", this);
+    m_broadcastBtn->setToolTip("把字符串数据以同一份共享负载投递批量数量次");
     
     batchLayout->addWidget(m_batchCountSpin);
     batchLayout->addWidget(m_batchTypeCombo);
     batchLayout->addWidget(m_sendBatchBtn);
+    batchLayout->addWidget(m_broadcastBtn);
     layout->addLayout(batchLayout);
     
     // 定时发送
@@ -166,6 +169,7 @@ void CustomEventSender::setupBatchControls()
     
     // 连接信号
     connect(m_sendBatchBtn, &QPushButton::clicked, this, &CustomEventSender::sendBatchEvents);
+    connect(m_broadcastBtn, &QPushButton::clicked, this, &CustomEventSender::sendSharedBroadcast);
     connect(m_startPeriodicBtn, &QPushButton::clicked, this, &CustomEventSender::startPeriodicSending);
     connect(m_stopPeriodicBtn, &QPushButton::clicked, this, &CustomEventSender::stopPeriodicSending);
 }
@@ -187,6 +191,15 @@ QObject* CustomEventSender::eventTarget() const
     return m_eventTarget;
 }
 
+int CustomEventSender::broadcastDataEvent(const QList<QObject*>& targets, const QVariant& data)
+{
+    const int posted = SharedDataEvent::post(targets, SharedPayload(data));
+    m_eventsSent += posted;
+    m_statusLabel->setText(QString("已发送事件: %1").arg(m_eventsSent));
+    emit eventSent("DataEvent", QString("广播到 %1 个接收者").arg(posted));
+    return posted;
+}
+
 void CustomEventSender::sendDataEvent()
 {
     // 发送一个通用的数据事件
@@ -328,6 +341,16 @@ void CustomEventSender::sendBatchEvents()
     emit eventSent("BatchEvents", QString("批量发送 %1 个 %2").arg(count).arg(type));
 }
 
+void CustomEventSender::sendSharedBroadcast()
+{
+    if (!m_eventTarget) return;
+    
+    // 演示中只有一个接收者，向它投递多个共享同一负载的事件信封
+    const QList<QObject*> targets(m_batchCountSpin->value(), m_eventTarget);
+    const int posted = broadcastDataEvent(targets, QVariant(m_stringDataEdit->text()));
+    emit batchEventsSent(posted);
+}
+
 void CustomEventSender::startPeriodicSending()
 {
     int interval = m_intervalSpin->value();
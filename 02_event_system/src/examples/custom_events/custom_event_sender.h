@@ -13,6 +13,7 @@
 #include <QGroupBox>
 #include <QTimer>
 #include "../../core/custom_events.h"
+#include "../../core/shared_data_event.h"
 
 /**
  * @brief 自定义事件发送器组件
@@ -30,6 +31,14 @@ public:
     // 设置事件接收目标
     void setEventTarget(QObject* target);
     QObject* eventTarget() const;
+    
+    /**
+     * @brief 把同一份数据投递给多个接收者
+     *
+     * 所有事件共享一个不可变负载，内存占用与接收者数量无关。
+     * @return 实际投递的事件数
+     */
+    int broadcastDataEvent(const QList<QObject*>& targets, const QVariant& data);
 
 public slots:
     // 发送数据事件
@@ -47,6 +56,9 @@ public slots:
     // 批量发送事件
     void sendBatchEvents();
     
+    // 以共享负载广播字符串数据，份数取批量数量
+    void sendSharedBroadcast();
+    
     // 定时发送事件
     void startPeriodicSending();
     void stopPeriodicSending();
@@ -95,6 +107,7 @@ private:
     QSpinBox* m_batchCountSpin;
     QComboBox* m_batchTypeCombo;
     QPushButton* m_sendBatchBtn;
+    QPushButton* m_broadcastBtn;
     
     // 定时发送控件
     QGroupBox* m_periodicGroup;
@@ -16,6 +16,7 @@ InteractionDemo::InteractionDemo(QWidget *parent)
     , m_statsGroup(nullptr)
     , m_resetButton(nullptr)
     , m_animationCheckBox(nullptr)
+    , m_coalescingCheckBox(nullptr)
     , m_speedSlider(nullptr)
     , m_sizeSpinBox(nullptr)
     , m_modeComboBox(nullptr)
@@ -121,6 +122,11 @@ void InteractionDemo::setupInteractiveArea()
     m_animationCheckBox->setChecked(true);
     connect(m_animationCheckBox, &QCheckBox::toggled, this, &InteractionDemo::toggleAnimation);
     
+    // 鼠标移动合并，默认关闭
+    m_coalescingCheckBox = new QCheckBox("按帧合并鼠标移动", m_controlGroup);
+    m_coalescingCheckBox->setChecked(false);
+    connect(m_coalescingCheckBox, &QCheckBox::toggled, this, &InteractionDemo::toggleInputCoalescing);
+    
     // 速度控制
     QLabel *speedLabel = new QLabel("动画速度:", m_controlGroup);
     m_speedSlider = new QSlider(Qt::Horizontal, m_controlGroup);
@@ -136,6 +142,7 @@ void InteractionDemo::setupInteractiveArea()
     controlGroupLayout->addWidget(sizeLabel);
     controlGroupLayout->addWidget(m_sizeSpinBox);
     controlGroupLayout->addWidget(m_animationCheckBox);
+    controlGroupLayout->addWidget(m_coalescingCheckBox);
     controlGroupLayout->addWidget(speedLabel);
     controlGroupLayout->addWidget(m_speedSlider);
     controlGroupLayout->addWidget(m_resetButton);
@@ -237,6 +244,15 @@ void InteractionDemo::toggleAnimation(bool enabled)
     }
 }
 
+void InteractionDemo::toggleInputCoalescing(bool enabled)
+{
+    // 鼠标跟踪下移动事件频率远高于屏幕刷新率，开启后每帧只处理最新的一个
+    m_mouseWidget->inputCoalescer()->setInstalled(m_mouseWidget, enabled);
+    if (auto drawArea = qobject_cast<InteractiveDrawArea*>(m_interactiveArea)) {
+        drawArea->inputCoalescer()->setInstalled(drawArea, enabled);
+    }
+}
+
 void InteractionDemo::updateInteractionStats()
 {
     m_mouseStatsLabel->setText(QString("鼠标事件: %1").arg(m_mouseEventCount));
@@ -255,6 +271,8 @@ InteractiveDrawArea::InteractiveDrawArea(QWidget *parent)
     , m_animationTimer(new QTimer(this))
     , m_animationEnabled(true)
     , m_animationStep(0)
+    , m_inputCoalescer(new EventCoalescer(this))
+    , m_repaintPending(false)
     , m_selectedObject(-1)
     , m_dragging(false)
 {
@@ -264,6 +282,7 @@ InteractiveDrawArea::InteractiveDrawArea(QWidget *parent)
     
     // 初始化画布
     m_canvas.fill(Qt::white);
+    m_dirtyRegion.setArea(size());
     
     // 设置动画定时器
     m_animationTimer->setInterval(50);  // 20 FPS
@@ -361,19 +380,22 @@ void InteractiveDrawArea::mouseMoveEvent(QMouseEvent *event)
 {
     if (m_drawing && (event->buttons() & Qt::LeftButton)) {
         if (m_dragging && m_selectedObject >= 0) {
-            // 拖拽对象
-            QPoint newPos = event->pos() - m_objects[m_selectedObject].dragOffset;
-            m_objects[m_selectedObject].rect.moveTo(newPos);
+            // 拖拽对象：重绘旧位置和新位置（含选中边框）
+            QRect &objectRect = m_objects[m_selectedObject].rect;
+            markDirty(objectRect.adjusted(-3, -3, 3, 3));
+            objectRect.moveTo(event->pos() - m_objects[m_selectedObject].dragOffset);
+            markDirty(objectRect.adjusted(-3, -3, 3, 3));
             emit objectInteraction("Dragged", m_selectedObject);
         } else if (m_drawMode == 1) {
-            // 线绘制
+            // 线绘制：只重绘线段覆盖的范围
+            int margin = m_brushSize / 2 + 2;
             drawLine(m_lastPoint, event->pos(), getCurrentColor());
+            markDirty(QRect(m_lastPoint, event->pos()).normalized().adjusted(-margin, -margin, margin, margin));
             m_lastPoint = event->pos();
             emit drawingAction("Draw", event->pos());
         }
     }
     
-    update();
     QWidget::mouseMoveEvent(event);
 }
 
@@ -477,16 +499,20 @@ void InteractiveDrawArea::wheelEvent(QWheelEvent *event)
 
 void InteractiveDrawArea::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event)  // 参数暂未使用，但保留以符合Qt接口
-    
     QPainter painter(this);
     
-    // 绘制画布内容
-    painter.drawPixmap(0, 0, m_canvas);
+    // 只绘制画布上需要更新的部分
+    QRect dirtyRect = event->rect() & m_canvas.rect();
+    if (!dirtyRect.isEmpty()) {
+        painter.drawPixmap(dirtyRect, m_canvas, dirtyRect);
+    }
     
     // 绘制交互对象
     for (int i = 0; i < m_objects.size(); ++i) {
         const auto &obj = m_objects[i];
+        if (!event->region().intersects(obj.rect.adjusted(-3, -3, 3, 3))) {
+            continue;
+        }
         
         // 设置颜色和样式
         QColor color = obj.color;
@@ -528,7 +554,32 @@ void InteractiveDrawArea::updateAnimation()
     }
     
     // 只更新动画区域
-    update(QRect(width() - 70, 10, 80, 80));
+    markDirty(QRect(width() - 70, 10, 80, 80));
+}
+
+void InteractiveDrawArea::resizeEvent(QResizeEvent *event)
+{
+    m_dirtyRegion.setArea(size());
+    QWidget::resizeEvent(event);
+}
+
+void InteractiveDrawArea::markDirty(const QRect &rect)
+{
+    m_dirtyRegion.markDirty(rect);
+    
+    // 同一轮事件中的多次标记合并为一次update
+    if (!m_repaintPending) {
+        m_repaintPending = true;
+        QMetaObject::invokeMethod(this, &InteractiveDrawArea::flushDirtyRegion, Qt::QueuedConnection);
+    }
+}
+
+void InteractiveDrawArea::flushDirtyRegion()
+{
+    m_repaintPending = false;
+    if (m_dirtyRegion.isDirty()) {
+        update(m_dirtyRegion.takeRegion());
+    }
 }
 
 void InteractiveDrawArea::drawPoint(const QPoint &point, const QColor &color)
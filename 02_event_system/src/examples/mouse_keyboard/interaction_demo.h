@@ -23,6 +23,7 @@
 
 #include "mouse_event_widget.h"
 #include "keyboard_event_widget.h"
+#include "../../core/dirty_region_tracker.h"
 
 /**
  * @brief 鼠标键盘交互演示控件
@@ -47,6 +48,7 @@ private slots:
     void onShortcutTriggered(const QString &shortcut);
     void resetDemo();
     void toggleAnimation(bool enabled);
+    void toggleInputCoalescing(bool enabled);
 
 private:
     void setupUI();
@@ -72,6 +74,7 @@ private:
     // 控制面板
     QPushButton *m_resetButton;
     QCheckBox *m_animationCheckBox;
+    QCheckBox *m_coalescingCheckBox;
     QSlider *m_speedSlider;
     QSpinBox *m_sizeSpinBox;
     QComboBox *m_modeComboBox;
@@ -109,6 +112,9 @@ public:
     void setBrushSize(int size);
     void setAnimationEnabled(bool enabled);
     void clearCanvas();
+    
+    // 按帧合并鼠标移动事件的合并器，默认未安装
+    EventCoalescer *inputCoalescer() const { return m_inputCoalescer; }
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -117,11 +123,14 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private slots:
     void updateAnimation();
+    void flushDirtyRegion();
 
 private:
+    void markDirty(const QRect &rect);
     void drawPoint(const QPoint &point, const QColor &color);
     void drawLine(const QPoint &start, const QPoint &end, const QColor &color);
     QColor getCurrentColor();
@@ -139,6 +148,13 @@ private:
     bool m_animationEnabled;
     int m_animationStep;
     
+    // 按帧合并鼠标移动事件，开启后才安装
+    EventCoalescer *m_inputCoalescer;
+    
+    // 局部重绘：积累本轮事件的脏区域，在事件处理完后统一update(QRegion)
+    DirtyRegionTracker m_dirtyRegion;
+    bool m_repaintPending;
+    
     // 交互对象
     struct InteractiveObject {
         QRect rect;
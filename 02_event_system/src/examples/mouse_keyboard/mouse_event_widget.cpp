@@ -15,6 +15,7 @@ MouseEventWidget::MouseEventWidget(QWidget *parent)
     , m_modifiersLabel(nullptr)
     , m_wheelDeltaLabel(nullptr)
     , m_trailTimer(new QTimer(this))
+    , m_inputCoalescer(new EventCoalescer(this))
     , m_mouseInside(false)
     , m_clickCount(0)
     , m_moveCount(0)
@@ -11,6 +11,7 @@
 #include <QPaintEvent>
 #include <QPainter>
 #include <QTimer>
+#include "../../core/event_coalescer.h"
 
 /**
  * @brief 鼠标事件演示控件
@@ -30,6 +31,14 @@ class MouseEventWidget : public QWidget
 public:
     explicit MouseEventWidget(QWidget *parent = nullptr);
 
+    /**
+     * @brief 本控件的鼠标移动合并器，默认未安装
+     *
+     * 用 inputCoalescer()->setInstalled(widget, true) 开启后，移动事件先进入
+     * 合并器，刷新时只交付最新的一个；点击、滚轮、按键到达前会先交付积压的移动。
+     */
+    EventCoalescer *inputCoalescer() const { return m_inputCoalescer; }
+
 protected:
     // 鼠标事件处理函数
     void mousePressEvent(QMouseEvent *event) override;
@@ -70,6 +79,7 @@ private:
     QList<QPoint> m_mouseTrail;  // 鼠标轨迹
     QPoint m_lastClickPos;       // 最后点击位置
     QTimer *m_trailTimer;        // 轨迹清除定时器
+    EventCoalescer *m_inputCoalescer;  // 按帧合并鼠标移动事件，开启后才安装
     bool m_mouseInside;          // 鼠标是否在控件内
     
     // 统计信息
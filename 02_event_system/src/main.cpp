@@ -4,6 +4,8 @@
 #include "widgets/main_window.h"
 #include "core/event_manager.h"
 #include "core/event_logger.h"
+#include "core/metrics_exporter.h"
+#include "core/event_performance_analyzer.h"
 
 int main(int argc, char *argv[])
 {
@@ -22,6 +24,16 @@ int main(int argc, char *argv[])
     Q_UNUSED(eventManager)
     Q_UNUSED(eventLogger)
     
+    // 可选：设置 QT_EVENT_METRICS_PORT 后在回环地址导出OpenMetrics指标，
+    // 同时启动事件循环看门狗，使导出的停顿和延迟指标有数据
+    MetricsExporter metricsExporter;
+    bool metricsPortSet = false;
+    int metricsPort = qEnvironmentVariableIntValue("QT_EVENT_METRICS_PORT", &metricsPortSet);
+    if (metricsPortSet && metricsPort > 0 && metricsPort <= 65535) {
+        metricsExporter.startTcp(static_cast<quint16>(metricsPort));
+        EventPerformanceAnalyzer::instance()->startStallDetection();
+    }
+    
     // 创建并显示主窗口
     MainWindow window;
     window.show();
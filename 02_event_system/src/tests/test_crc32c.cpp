@@ -0,0 +1,110 @@
+#include "test_crc32c.h"
+#include "../core/event_wire_format.h"
+#include <cstddef>
+#include <cstring>
+
+QByteArray TestCrc32c::patternBytes(int size) const
+{
+    QByteArray bytes(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) {
+        bytes[i] = char((i * 131 + 7) & 0xFF);
+    }
+    return bytes;
+}
+
+void TestCrc32c::testKnownVectors_data()
+{
+    QTest::addColumn<QByteArray>("input");
+    QTest::addColumn<quint32>("expected");
+
+    QByteArray ascending(32, Qt::Uninitialized);
+    QByteArray descending(32, Qt::Uninitialized);
+    for (int i = 0; i < 32; ++i) {
+        ascending[i] = char(i);
+        descending[i] = char(31 - i);
+    }
+
+    QTest::newRow("empty") << QByteArray() << quint32(0);
+    QTest::newRow("check string") << QByteArray("123456789") << quint32(0xE3069283);
+    QTest::newRow("32 zeros") << QByteArray(32, '\0') << quint32(0x8A9136AA);
+    QTest::newRow("32 ones") << QByteArray(32, '\xff') << quint32(0x62A8AB43);
+    QTest::newRow("ascending") << ascending << quint32(0x46DD794E);
+    QTest::newRow("descending") << descending << quint32(0x113FDB5C);
+}
+
+void TestCrc32c::testKnownVectors()
+{
+    QFETCH(QByteArray, input);
+    QFETCH(quint32, expected);
+
+    QCOMPARE(Crc32c::compute(input.constData(), input.size()), expected);
+    QCOMPARE(Crc32c::updateSoftware(0, input.constData(), input.size()), expected);
+    QCOMPARE(Crc32c::updateHardware(0, input.constData(), input.size()), expected);
+}
+
+void TestCrc32c::testHardwareMatchesSoftware_data()
+{
+    QTest::addColumn<int>("length");
+
+    // 覆盖逐字节尾部、8字节字和三路并行分段（3 × 4096字节）的边界
+    const int lengths[] = { 1, 7, 8, 9, 63, 4095, 4096, 12287, 12288, 12289, 3 * 12288 + 5, 100000 };
+    for (int length : lengths) {
+        QTest::newRow(qPrintable(QString::number(length))) << length;
+    }
+}
+
+void TestCrc32c::testHardwareMatchesSoftware()
+{
+    if (!Crc32c::isHardwareAccelerated()) {
+        QSKIP("CPU does not provide CRC32C instructions");
+    }
+
+    QFETCH(int, length);
+
+    const QByteArray bytes = patternBytes(length + 8);
+    for (int offset = 0; offset < 8; ++offset) {
+        const char* data = bytes.constData() + offset;
+        QCOMPARE(Crc32c::updateHardware(0, data, length), Crc32c::updateSoftware(0, data, length));
+        QCOMPARE(Crc32c::updateHardware(0x12345678, data, length), Crc32c::updateSoftware(0x12345678, data, length));
+    }
+}
+
+void TestCrc32c::testIncrementalUpdate()
+{
+    const QByteArray bytes = patternBytes(40000);
+    const quint32 whole = Crc32c::compute(bytes.constData(), bytes.size());
+
+    const int splits[] = { 0, 1, 5, 4096, 12289, 39999, 40000 };
+    for (int split : splits) {
+        // 两段交替使用不同实现，结果仍应一致
+        quint32 crc = Crc32c::updateSoftware(0, bytes.constData(), split);
+        crc = Crc32c::updateHardware(crc, bytes.constData() + split, bytes.size() - split);
+        QCOMPARE(crc, whole);
+
+        crc = Crc32c::update(0, bytes.constData(), split);
+        crc = Crc32c::update(crc, bytes.constData() + split, bytes.size() - split);
+        QCOMPARE(crc, whole);
+    }
+}
+
+void TestCrc32c::testFrameChecksum()
+{
+    EventWireWriter writer(1000 + 5, 42);
+    writer.addInt(u"value", 7);
+    writer.addString(u"name", u"checksum");
+    const QByteArray frame = writer.finish();
+
+    EventWire::Header header;
+    std::memcpy(&header, frame.constData(), sizeof(header));
+    QVERIFY(header.flags & EventWire::Checksummed);
+    QCOMPARE(EventWire::frameChecksum(frame.constData(), frame.size()), header.checksum);
+
+    // 校验值覆盖除checksum字段外的全部字节
+    const qsizetype checksumOffset = offsetof(EventWire::Header, checksum);
+    quint32 expected = Crc32c::compute(frame.constData(), checksumOffset);
+    expected = Crc32c::update(expected, frame.constData() + sizeof(header), frame.size() - qsizetype(sizeof(header)));
+    QCOMPARE(header.checksum, expected);
+}
+
+// 注册测试类
+QTEST_MAIN(TestCrc32c)
@@ -0,0 +1,45 @@
+#ifndef TEST_CRC32C_H
+#define TEST_CRC32C_H
+
+#include <QObject>
+#include <QTest>
+#include <QByteArray>
+#include "../core/crc32c.h"
+
+/**
+ * @brief TestCrc32c CRC32C校验的单元测试类
+ *
+ * 测试内容：
+ * 1. 标准测试向量（"123456789" -> 0xE3069283，RFC 3720中的32字节向量）
+ * 2. 硬件指令与查表实现对任意长度、任意对齐的数据结果相同
+ * 3. 分段累加与一次计算结果相同
+ * 4. 线格式头部中的校验值与frameChecksum()一致
+ */
+class TestCrc32c : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试已知向量
+     */
+    void testKnownVectors_data();
+    void testKnownVectors();
+
+    /**
+     * @brief 测试各实现一致
+     */
+    void testHardwareMatchesSoftware_data();
+    void testHardwareMatchesSoftware();
+    void testIncrementalUpdate();
+
+    /**
+     * @brief 测试线格式校验值
+     */
+    void testFrameChecksum();
+
+private:
+    QByteArray patternBytes(int size) const;
+};
+
+#endif // TEST_CRC32C_H
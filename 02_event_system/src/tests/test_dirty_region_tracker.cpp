@@ -0,0 +1,230 @@
+#include "test_dirty_region_tracker.h"
+#include <algorithm>
+
+namespace {
+
+// 10x10个32像素瓦片
+const QSize TrackedArea(320, 320);
+const int TileSize = 32;
+
+} // namespace
+
+QList<QRect> TestDirtyRegionTracker::sorted(QList<QRect> rects)
+{
+    std::sort(rects.begin(), rects.end(), [](const QRect& a, const QRect& b) {
+        if (a.top() != b.top()) return a.top() < b.top();
+        if (a.left() != b.left()) return a.left() < b.left();
+        if (a.width() != b.width()) return a.width() < b.width();
+        return a.height() < b.height();
+    });
+    return rects;
+}
+
+void TestDirtyRegionTracker::markTiles(DirtyRegionTracker& tracker, const QRect& tiles)
+{
+    tracker.markDirty(QRect(tiles.x() * TileSize, tiles.y() * TileSize,
+                            tiles.width() * TileSize, tiles.height() * TileSize));
+}
+
+void TestDirtyRegionTracker::markPlus(DirtyRegionTracker& tracker)
+{
+    // 十字：第4列整列加第4行整行，tileRects()得到上竖段、横条、下竖段三个矩形
+    markTiles(tracker, QRect(4, 0, 1, 10));
+    markTiles(tracker, QRect(0, 4, 10, 1));
+}
+
+void TestDirtyRegionTracker::testTileRects()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    markTiles(tracker, QRect(1, 1, 3, 2));
+    markTiles(tracker, QRect(6, 5, 2, 3));
+
+    // 不足一个瓦片的请求也对齐到整个瓦片
+    tracker.markDirty(QRect(9 * TileSize + 3, 9 * TileSize + 5, 2, 2));
+
+    const QList<QRect> expected = { QRect(1, 1, 3, 2), QRect(6, 5, 2, 3), QRect(9, 9, 1, 1) };
+    QCOMPARE(sorted(tracker.tileRects()), sorted(expected));
+}
+
+void TestDirtyRegionTracker::testTileRectsSplitsMismatchedSpans()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    markTiles(tracker, QRect(4, 8, 2, 1));
+    markTiles(tracker, QRect(4, 9, 3, 1));
+    markPlus(tracker);
+
+    const QList<QRect> expected = {
+        QRect(4, 0, 1, 4), QRect(0, 4, 10, 1), QRect(4, 5, 1, 3),
+        QRect(4, 8, 2, 1), QRect(4, 9, 3, 1)
+    };
+    QCOMPARE(sorted(tracker.tileRects()), sorted(expected));
+}
+
+void TestDirtyRegionTracker::testMergeToLimitGreedy()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setMaxRects(2);
+
+    // 相邻的两个瓦片合并不浪费面积，远处的瓦片保持独立
+    const QList<QRect> input = { QRect(0, 0, 1, 1), QRect(1, 0, 1, 1), QRect(9, 9, 1, 1) };
+    const QList<QRect> expected = { QRect(0, 0, 2, 1), QRect(9, 9, 1, 1) };
+    QCOMPARE(sorted(tracker.mergeToLimit(input)), sorted(expected));
+
+    // 未超过上限时原样返回
+    tracker.setMaxRects(3);
+    QCOMPARE(sorted(tracker.mergeToLimit(input)), sorted(input));
+}
+
+void TestDirtyRegionTracker::testMergeToLimitCoversInput()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setMaxRects(2);
+
+    // 第二轮合并的外接框包含了另一个矩形，被包含的矩形直接去掉，不再多合并一轮
+    const QList<QRect> input = {
+        QRect(5, 4, 1, 4), QRect(2, 1, 1, 4), QRect(0, 3, 1, 3),
+        QRect(2, 7, 3, 1), QRect(3, 2, 3, 2)
+    };
+    const QList<QRect> merged = tracker.mergeToLimit(input);
+    const QList<QRect> expected = { QRect(0, 3, 1, 3), QRect(2, 1, 4, 7) };
+    QCOMPARE(sorted(merged), sorted(expected));
+
+    for (const QRect& rect : input) {
+        const bool covered = std::any_of(merged.begin(), merged.end(),
+                                         [&rect](const QRect& m) { return m.contains(rect); });
+        QVERIFY2(covered, "every input rect must be covered by a merged rect");
+    }
+    for (int i = 0; i < merged.size(); ++i) {
+        for (int j = 0; j < merged.size(); ++j) {
+            QVERIFY(i == j || !merged[i].contains(merged[j]));
+        }
+    }
+}
+
+void TestDirtyRegionTracker::testMergeIntoBands()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setMaxRects(2);
+
+    // 10行分为两个5行的条带，跨条带的矩形按顶边归入上面的条带
+    const QList<QRect> input = {
+        QRect(0, 0, 1, 1), QRect(3, 3, 2, 1), QRect(2, 4, 1, 3),
+        QRect(1, 6, 1, 1), QRect(8, 9, 2, 1)
+    };
+    const QList<QRect> expected = { QRect(0, 0, 5, 7), QRect(1, 6, 9, 4) };
+    QCOMPARE(sorted(tracker.mergeIntoBands(input)), sorted(expected));
+
+    // 空条带不输出
+    const QList<QRect> lowerOnly = { QRect(2, 7, 1, 1) };
+    QCOMPARE(tracker.mergeIntoBands(lowerOnly), lowerOnly);
+}
+
+void TestDirtyRegionTracker::testMergeToLimitFallsBackToBands()
+{
+    // 20x20棋盘格的每个瓦片都是孤立的，tileRects()得到200个矩形
+    DirtyRegionTracker tracker(QSize(640, 640), TileSize);
+    for (int row = 0; row < 20; ++row) {
+        for (int column = row % 2; column < 20; column += 2) {
+            markTiles(tracker, QRect(column, row, 1, 1));
+        }
+    }
+
+    const QList<QRect> rects = tracker.tileRects();
+    QCOMPARE(rects.size(), 200);
+    QVERIFY(rects.size() > DirtyRegionTracker::MaxGreedyRects);
+
+    // 上限8时每个条带3行，20行共7个条带
+    const QList<QRect> merged = tracker.mergeToLimit(rects);
+    QCOMPARE(merged, tracker.mergeIntoBands(rects));
+    QCOMPARE(merged.size(), 7);
+    QVERIFY(merged.size() <= tracker.maxRects());
+}
+
+void TestDirtyRegionTracker::testCostChoice_data()
+{
+    QTest::addColumn<qint64>("perRectCost");
+    QTest::addColumn<bool>("boundingBox");
+
+    // 两个角落瓦片：多矩形代价2*1024+2c，外接框代价320*320+c
+    QTest::newRow("no per-rect cost") << qint64(0) << false;
+    QTest::newRow("default per-rect cost") << qint64(TileSize * TileSize) << false;
+    QTest::newRow("expensive rects") << qint64(200000) << true;
+}
+
+void TestDirtyRegionTracker::testCostChoice()
+{
+    QFETCH(qint64, perRectCost);
+    QFETCH(bool, boundingBox);
+
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setPerRectCost(perRectCost);
+    markTiles(tracker, QRect(0, 0, 1, 1));
+    markTiles(tracker, QRect(9, 9, 1, 1));
+
+    const QRegion region = tracker.takeRegion();
+    const DirtyRegionTracker::Metrics metrics = tracker.metrics();
+    QCOMPARE(metrics.flushes, quint64(1));
+
+    if (boundingBox) {
+        QCOMPARE(region, QRegion(QRect(QPoint(0, 0), TrackedArea)));
+        QCOMPARE(metrics.boundingBoxFlushes, quint64(1));
+        QCOMPARE(metrics.rectsEmitted, quint64(1));
+    } else {
+        QRegion expected;
+        expected += QRect(0, 0, TileSize, TileSize);
+        expected += QRect(9 * TileSize, 9 * TileSize, TileSize, TileSize);
+        QCOMPARE(region, expected);
+        QCOMPARE(metrics.boundingBoxFlushes, quint64(0));
+        QCOMPARE(metrics.rectsEmitted, quint64(2));
+    }
+    QVERIFY(!tracker.isDirty());
+}
+
+void TestDirtyRegionTracker::testRectCapAppliesAfterUnion()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setMaxRects(2);
+    tracker.setPerRectCost(0);
+    markPlus(tracker);
+
+    // 贪心合并得到两个重叠的矩形，像素并集却仍是三个矩形
+    const QList<QRect> merged = tracker.mergeToLimit(tracker.tileRects());
+    QCOMPARE(sorted(merged), sorted({ QRect(4, 0, 1, 10), QRect(0, 4, 10, 1) }));
+    QRegion pixels;
+    for (const QRect& rect : merged) {
+        pixels += tracker.toPixels(rect);
+    }
+    QCOMPARE(pixels.rectCount(), 3);
+
+    const QRegion region = tracker.takeRegion();
+    QVERIFY(region.rectCount() <= tracker.maxRects());
+    QCOMPARE(region, QRegion(QRect(QPoint(0, 0), TrackedArea)));
+
+    const DirtyRegionTracker::Metrics metrics = tracker.metrics();
+    QCOMPARE(metrics.boundingBoxFlushes, quint64(1));
+    QCOMPARE(metrics.rectsEmitted, quint64(1));
+}
+
+void TestDirtyRegionTracker::testRectsEmittedCountsOutput()
+{
+    DirtyRegionTracker tracker(TrackedArea, TileSize);
+    tracker.setMaxRects(3);
+    tracker.setPerRectCost(0);
+    markPlus(tracker);
+
+    QRegion expected;
+    expected += QRect(4 * TileSize, 0, TileSize, 10 * TileSize);
+    expected += QRect(0, 4 * TileSize, 10 * TileSize, TileSize);
+
+    const QRegion region = tracker.takeRegion();
+    QCOMPARE(region, expected);
+
+    const DirtyRegionTracker::Metrics metrics = tracker.metrics();
+    QCOMPARE(metrics.boundingBoxFlushes, quint64(0));
+    QCOMPARE(metrics.rectsEmitted, quint64(region.rectCount()));
+    QCOMPARE(metrics.rectsEmitted, quint64(3));
+    QCOMPARE(metrics.repaintedPixels, qint64(19 * TileSize * TileSize));
+}
+
+// 注册测试类
+QTEST_MAIN(TestDirtyRegionTracker)
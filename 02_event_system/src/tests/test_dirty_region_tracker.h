@@ -0,0 +1,54 @@
+#ifndef TEST_DIRTY_REGION_TRACKER_H
+#define TEST_DIRTY_REGION_TRACKER_H
+
+#include <QObject>
+#include <QTest>
+#include <QList>
+#include <QRect>
+#include <QRegion>
+#include "../core/dirty_region_tracker.h"
+
+/**
+ * @brief TestDirtyRegionTracker 脏区域跟踪器的单元测试类
+ *
+ * 测试内容：
+ * 1. tileRects()按行提取连续脏瓦片，只纵向合并左右边界相同的行段
+ * 2. mergeToLimit()贪心合并浪费面积最小的一对，结果覆盖全部输入且互不包含
+ * 3. mergeIntoBands()按顶边所在条带取外接框，矩形过多时mergeToLimit()改用它
+ * 4. 按代价在多矩形和外接框之间取舍
+ * 5. 合并后的矩形求并集仍多于上限时退回外接框，rectsEmitted按输出区域计
+ */
+class TestDirtyRegionTracker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试瓦片矩形提取
+     */
+    void testTileRects();
+    void testTileRectsSplitsMismatchedSpans();
+
+    /**
+     * @brief 测试矩形合并
+     */
+    void testMergeToLimitGreedy();
+    void testMergeToLimitCoversInput();
+    void testMergeIntoBands();
+    void testMergeToLimitFallsBackToBands();
+
+    /**
+     * @brief 测试输出区域
+     */
+    void testCostChoice_data();
+    void testCostChoice();
+    void testRectCapAppliesAfterUnion();
+    void testRectsEmittedCountsOutput();
+
+private:
+    static QList<QRect> sorted(QList<QRect> rects);
+    static void markTiles(DirtyRegionTracker& tracker, const QRect& tiles);
+    static void markPlus(DirtyRegionTracker& tracker);
+};
+
+#endif // TEST_DIRTY_REGION_TRACKER_H
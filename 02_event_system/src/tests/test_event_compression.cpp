@@ -0,0 +1,221 @@
+#include "test_event_compression.h"
+#include "../core/event_wire_format.h"
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <cstring>
+
+namespace {
+
+const quint16 HostByteOrderFlag = QSysInfo::ByteOrder == QSysInfo::BigEndian ? EventWire::BigEndian : 0;
+
+const int DictionaryEventType = 1000 + 77;
+
+} // namespace
+
+QByteArray TestEventCompression::envelope(EventCompression::Codec codec, quint32 rawSize,
+                                          const QByteArray& stored, quint32 dictionaryId) const
+{
+    EventCompression::Header header;
+    header.magic = EventCompression::Magic;
+    header.codec = codec;
+    header.reserved = 0;
+    header.flags = HostByteOrderFlag;
+    header.rawSize = rawSize;
+    header.storedSize = quint32(stored.size());
+    header.dictionaryId = dictionaryId;
+
+    QByteArray result(reinterpret_cast<const char*>(&header), sizeof(header));
+    result.append(stored);
+    return result;
+}
+
+QByteArray TestEventCompression::repetitiveSample() const
+{
+    QByteArray sample;
+    for (int i = 0; i < 200; ++i) {
+        sample.append("command=draw;x=");
+        sample.append(QByteArray::number(i % 17));
+        sample.append(";color=#336699;");
+    }
+    return sample;
+}
+
+void TestEventCompression::testRoundTrip_data()
+{
+    QTest::addColumn<int>("codec");
+    QTest::addColumn<QByteArray>("raw");
+
+    // 单字节重复是偏移为1的重叠匹配
+    const QByteArray run(3000, 'a');
+    QByteArray pattern;
+    for (int i = 0; i < 500; ++i) {
+        pattern.append("abc");
+    }
+
+    QTest::newRow("lz text") << int(EventCompression::Lz) << repetitiveSample();
+    QTest::newRow("lz run") << int(EventCompression::Lz) << run;
+    QTest::newRow("lz pattern") << int(EventCompression::Lz) << pattern;
+    QTest::newRow("zlib text") << int(EventCompression::Zlib) << repetitiveSample();
+    QTest::newRow("zlib run") << int(EventCompression::Zlib) << run;
+}
+
+void TestEventCompression::testRoundTrip()
+{
+    QFETCH(int, codec);
+    QFETCH(QByteArray, raw);
+
+    const QByteArray compressed = EventCompression::compress(raw, EventCompression::Codec(codec));
+    QVERIFY(EventCompression::isCompressed(compressed));
+    QVERIFY(compressed.size() < raw.size());
+    QCOMPARE(EventCompression::envelopeSize(compressed), qint64(compressed.size()));
+    QCOMPARE(EventCompression::decompress(compressed), raw);
+}
+
+void TestEventCompression::testDictionaryRoundTrip()
+{
+    QList<QByteArray> samples;
+    for (int i = 0; i < 8; ++i) {
+        EventWireWriter writer(DictionaryEventType, i);
+        writer.addString(u"command", u"moveTo");
+        writer.addString(u"target", u"drawingCanvas.strokeLayer");
+        writer.addInt(u"x", i);
+        writer.addInt(u"y", i * 2);
+        samples.append(writer.finish());
+    }
+
+    const QByteArray dictionary = EventCompression::trainDictionary(samples);
+    QVERIFY(!dictionary.isEmpty());
+    const quint32 id = EventCompression::registerDictionary(DictionaryEventType, dictionary);
+    QVERIFY(id != 0);
+    QCOMPARE(EventCompression::dictionaryId(DictionaryEventType), id);
+
+    // 小事件单独压缩不划算，借助字典才能变小
+    const QByteArray raw = samples.first();
+    const QByteArray compressed = EventCompression::compress(raw, EventCompression::Lz, id);
+    QVERIFY(EventCompression::isCompressed(compressed));
+    QCOMPARE(EventCompression::decompress(compressed), raw);
+}
+
+void TestEventCompression::testIncompressibleKeptRaw()
+{
+    QByteArray noise(1024, Qt::Uninitialized);
+    QRandomGenerator generator(1234);
+    generator.fillRange(reinterpret_cast<quint32*>(noise.data()), noise.size() / int(sizeof(quint32)));
+
+    const QByteArray result = EventCompression::compress(noise, EventCompression::Lz);
+    QVERIFY(!EventCompression::isCompressed(result));
+    QCOMPARE(result, noise);
+    QCOMPARE(EventCompression::decompress(result), noise);
+}
+
+void TestEventCompression::testTruncatedEnvelopeRejected()
+{
+    const QByteArray compressed = EventCompression::compress(repetitiveSample(), EventCompression::Lz);
+    QVERIFY(EventCompression::isCompressed(compressed));
+
+    for (int length = 4; length < compressed.size(); ++length) {
+        QVERIFY(EventCompression::decompress(compressed.left(length)).isEmpty());
+    }
+
+    // 头部长度与截断后的数据一致时，由解码器发现数据不足
+    const QByteArray stored = compressed.mid(sizeof(EventCompression::Header));
+    for (int length = 0; length < stored.size(); length += 7) {
+        const QByteArray truncated = envelope(EventCompression::Lz, repetitiveSample().size(), stored.left(length));
+        QVERIFY(EventCompression::decompress(truncated).isEmpty());
+    }
+}
+
+void TestEventCompression::testUnregisteredDictionaryRejected()
+{
+    const QByteArray raw = repetitiveSample();
+    QByteArray compressed = EventCompression::compress(raw, EventCompression::Lz);
+    QVERIFY(EventCompression::isCompressed(compressed));
+
+    EventCompression::Header header;
+    std::memcpy(&header, compressed.constData(), sizeof(header));
+    header.dictionaryId = 0xDEADBEEF;
+    std::memcpy(compressed.data(), &header, sizeof(header));
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("is not registered"));
+    QVERIFY(EventCompression::decompress(compressed).isEmpty());
+}
+
+void TestEventCompression::testMalformedLzBlock_data()
+{
+    QTest::addColumn<QByteArray>("stored");
+    QTest::addColumn<int>("rawSize");
+
+    // 令牌高4位为字面量长度，低4位为匹配长度-4，匹配偏移为2字节小端
+    QTest::newRow("empty block") << QByteArray() << 4;
+    QTest::newRow("zero offset") << QByteArray("\x10" "a" "\x00\x00" "\x00", 5) << 5;
+    QTest::newRow("offset before start") << QByteArray("\x10" "a" "\x05\x00" "\x00", 5) << 5;
+    QTest::newRow("match past output") << QByteArray("\x1F" "a" "\x01\x00" "\x40" "\x00", 6) << 8;
+    QTest::newRow("literals past input") << QByteArray("\x50" "ab", 3) << 5;
+    QTest::newRow("literals past output") << QByteArray("\x30" "abc", 4) << 2;
+    QTest::newRow("unterminated length") << QByteArray("\xF0" "\xFF\xFF", 3) << 1000;
+    QTest::newRow("short offset") << QByteArray("\x10" "a" "\x01", 3) << 5;
+    QTest::newRow("output too short") << QByteArray("\x20" "ab", 3) << 4;
+}
+
+void TestEventCompression::testMalformedLzBlock()
+{
+    QFETCH(QByteArray, stored);
+    QFETCH(int, rawSize);
+
+    QVERIFY(EventCompression::decompress(envelope(EventCompression::Lz, rawSize, stored)).isEmpty());
+
+    // 对照：同样布局的合法块可以解码
+    const QByteArray valid("\x10" "a" "\x01\x00" "\x00", 5);
+    QCOMPARE(EventCompression::decompress(envelope(EventCompression::Lz, 5, valid)), QByteArray("aaaaa"));
+}
+
+void TestEventCompression::testZlibLengthMismatchRejected()
+{
+    const QByteArray raw = repetitiveSample();
+    QByteArray compressed = EventCompression::compress(raw, EventCompression::Zlib);
+    QVERIFY(EventCompression::isCompressed(compressed));
+
+    // 信封记录的原始长度与qCompress前缀不一致
+    EventCompression::Header header;
+    std::memcpy(&header, compressed.constData(), sizeof(header));
+    header.rawSize += 1;
+    std::memcpy(compressed.data(), &header, sizeof(header));
+    QVERIFY(EventCompression::decompress(compressed).isEmpty());
+}
+
+void TestEventCompression::testFuzzedLzBlock()
+{
+    const QByteArray raw = repetitiveSample();
+    const QByteArray compressed = EventCompression::compress(raw, EventCompression::Lz);
+    QVERIFY(EventCompression::isCompressed(compressed));
+    const int headerBytes = int(sizeof(EventCompression::Header));
+
+    // 固定种子，失败可复现；解码器不能越界，结果要么为空要么长度与头部一致
+    QRandomGenerator generator(20240611);
+    for (int round = 0; round < 2000; ++round) {
+        QByteArray fuzzed = compressed;
+        const int mutations = 1 + generator.bounded(4);
+        for (int i = 0; i < mutations; ++i) {
+            const int position = headerBytes + generator.bounded(fuzzed.size() - headerBytes);
+            fuzzed[position] = char(generator.bounded(256));
+        }
+
+        const QByteArray result = EventCompression::decompress(fuzzed);
+        QVERIFY(result.isEmpty() || result.size() == raw.size());
+    }
+
+    // 完全随机的块
+    for (int round = 0; round < 500; ++round) {
+        QByteArray stored(1 + generator.bounded(256), Qt::Uninitialized);
+        for (char& byte : stored) {
+            byte = char(generator.bounded(256));
+        }
+        const quint32 rawSize = 1 + generator.bounded(4096);
+        const QByteArray result = EventCompression::decompress(envelope(EventCompression::Lz, rawSize, stored));
+        QVERIFY(result.isEmpty() || result.size() == qsizetype(rawSize));
+    }
+}
+
+// 注册测试类
+QTEST_MAIN(TestEventCompression)
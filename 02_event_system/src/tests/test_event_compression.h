@@ -0,0 +1,47 @@
+#ifndef TEST_EVENT_COMPRESSION_H
+#define TEST_EVENT_COMPRESSION_H
+
+#include <QObject>
+#include <QTest>
+#include <QByteArray>
+#include "../core/event_compression.h"
+
+/**
+ * @brief TestEventCompression 事件压缩层的单元测试类
+ *
+ * 测试内容：
+ * 1. Lz/Zlib压缩后解压得到原始数据，包括重叠匹配和预置字典
+ * 2. 截断的信封、未登记的字典被拒绝
+ * 3. 手工构造的非法偏移、越界长度被拒绝
+ * 4. 随机篡改的压缩数据要么被拒绝，要么输出长度与头部一致
+ */
+class TestEventCompression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试往返
+     */
+    void testRoundTrip_data();
+    void testRoundTrip();
+    void testDictionaryRoundTrip();
+    void testIncompressibleKeptRaw();
+
+    /**
+     * @brief 测试损坏输入
+     */
+    void testTruncatedEnvelopeRejected();
+    void testUnregisteredDictionaryRejected();
+    void testMalformedLzBlock_data();
+    void testMalformedLzBlock();
+    void testZlibLengthMismatchRejected();
+    void testFuzzedLzBlock();
+
+private:
+    QByteArray envelope(EventCompression::Codec codec, quint32 rawSize,
+                        const QByteArray& stored, quint32 dictionaryId = 0) const;
+    QByteArray repetitiveSample() const;
+};
+
+#endif // TEST_EVENT_COMPRESSION_H
@@ -0,0 +1,429 @@
+#include "test_event_pool.h"
+#include <QMutex>
+#include <QRegularExpression>
+#include <QScopeGuard>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief 启动一组执行同一函数的线程，析构时等待全部结束
+ *
+ * 用std::thread而不是QThread：join()返回时线程已彻底退出，thread_local
+ * 析构（本地弹匣归还仓库）已经执行；QThread::wait()可能早于这一步返回。
+ */
+class ThreadGroup
+{
+public:
+    template<typename Function>
+    ThreadGroup(int count, Function function)
+    {
+        for (int i = 0; i < count; ++i) {
+            m_threads.emplace_back(function, i);
+        }
+    }
+
+    ~ThreadGroup() { wait(); }
+
+    void wait()
+    {
+        for (std::thread& thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+};
+
+/**
+ * @brief 内存块开头的持有标记，块新建时为0（slab分配后清零）
+ */
+std::atomic<int>* ownerFlag(void* block)
+{
+    return static_cast<std::atomic<int>*>(block);
+}
+
+/**
+ * @brief 记录构造、析构、重置次数的池化对象
+ */
+class CountedObject
+{
+public:
+    static int constructed;
+    static int destroyed;
+    static int resets;
+
+    CountedObject() : m_value(0), m_inUse(false) { constructed++; }
+    ~CountedObject() { destroyed++; }
+
+    void reset() { m_value = 0; resets++; }
+    void setInUse(bool inUse) { m_inUse = inUse; }
+    bool isInUse() const { return m_inUse; }
+
+    int value() const { return m_value; }
+    void setValue(int value) { m_value = value; }
+
+private:
+    int m_value;
+    bool m_inUse;
+};
+
+int CountedObject::constructed = 0;
+int CountedObject::destroyed = 0;
+int CountedObject::resets = 0;
+
+struct PooledRecord : public PoolAllocated<PooledRecord>
+{
+    qint64 values[4];
+};
+
+// 尺寸不同的派生类回退到全局operator new/delete
+struct LargerRecord : public PooledRecord
+{
+    qint64 extra[8];
+};
+
+} // namespace
+
+void TestEventPool::testConcurrentAcquireRelease_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<int>("initialSize");
+
+    QTest::newRow("2 threads") << 2 << 64;
+    QTest::newRow("8 threads") << 8 << 64;
+    // 初始块数极少，迫使池在并发下扩容
+    QTest::newRow("8 threads, growing") << 8 << 0;
+}
+
+void TestEventPool::testConcurrentAcquireRelease()
+{
+    QFETCH(int, threads);
+    QFETCH(int, initialSize);
+
+    EventStoragePool pool(48, initialSize);
+    const int rounds = 2000;
+    std::atomic<quint64> acquired(0);
+    std::atomic<int> duplicates(0);
+
+    {
+        ThreadGroup group(threads, [&](int thread) {
+            std::vector<void*> held;
+            for (int round = 0; round < rounds; ++round) {
+                // 批量大小跨越弹匣容量，覆盖本地命中、仓库交换和溢出
+                const int batch = 1 + (round * 7 + thread * 13) % 100;
+                for (int i = 0; i < batch; ++i) {
+                    void* block = pool.allocate();
+                    if (ownerFlag(block)->exchange(1, std::memory_order_acq_rel) != 0) {
+                        duplicates.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    held.push_back(block);
+                }
+                acquired.fetch_add(batch, std::memory_order_relaxed);
+                while (!held.empty()) {
+                    void* block = held.back();
+                    held.pop_back();
+                    ownerFlag(block)->store(0, std::memory_order_release);
+                    pool.deallocate(block);
+                }
+            }
+        });
+    }
+
+    QCOMPARE(duplicates.load(), 0);
+
+    // 线程全部退出，本地弹匣已归还，所有块都可用
+    QCOMPARE(pool.usedEvents(), 0);
+    QCOMPARE(pool.availableEvents(), pool.totalEvents());
+
+    const EventStoragePool::ContentionStats stats = pool.contentionStats();
+    QCOMPARE(stats.acquires, acquired.load());
+    QCOMPARE(stats.fastReleases, acquired.load());
+    QCOMPARE(stats.threadCaches, 0);
+}
+
+void TestEventPool::testThreadExitFlushesCache()
+{
+    EventStoragePool pool(48, 0);
+
+    QMutex mutex;
+    QWaitCondition changed;
+    bool cached = false;
+    bool exitAllowed = false;
+
+    std::thread thread([&]() {
+        // 获取后立即归还，块留在本线程的弹匣中
+        void* blocks[20];
+        for (void*& block : blocks) {
+            block = pool.allocate();
+        }
+        for (void* block : blocks) {
+            pool.deallocate(block);
+        }
+
+        QMutexLocker locker(&mutex);
+        cached = true;
+        changed.wakeAll();
+        while (!exitAllowed) {
+            changed.wait(&mutex);
+        }
+    });
+
+    // 校验失败提前返回时也要放行并等待线程，否则std::thread析构会终止进程
+    auto finishThread = qScopeGuard([&]() {
+        {
+            QMutexLocker locker(&mutex);
+            exitAllowed = true;
+            changed.wakeAll();
+        }
+        thread.join();
+    });
+
+    {
+        QMutexLocker locker(&mutex);
+        while (!cached) {
+            changed.wait(&mutex);
+        }
+    }
+
+    // 线程存活时它弹匣中的块不在共享存储中，所在slab不能释放
+    const int total = pool.totalEvents();
+    QVERIFY(total > 0);
+    QCOMPARE(pool.contentionStats().threadCaches, 1);
+    QCOMPARE(pool.trimTo(0), 0);
+    QCOMPARE(pool.totalEvents(), total);
+
+    finishThread.dismiss();
+    {
+        QMutexLocker locker(&mutex);
+        exitAllowed = true;
+        changed.wakeAll();
+    }
+    thread.join();
+
+    QCOMPARE(pool.contentionStats().threadCaches, 0);
+    QCOMPARE(pool.availableEvents(), total);
+    QCOMPARE(pool.trimTo(0), total);
+    QCOMPARE(pool.totalEvents(), 0);
+    QCOMPARE(pool.slabCount(), 0);
+}
+
+void TestEventPool::testTrimTo()
+{
+    EventStoragePool probe(64, 0);
+    const int perSlab = probe.blocksPerSlab();
+    QVERIFY(perSlab > EventStoragePool::MagazineSize);
+
+    EventStoragePool pool(64, perSlab * 4);
+    QCOMPARE(pool.slabCount(), 4);
+    QCOMPARE(pool.totalEvents(), perSlab * 4);
+
+    // 已在目标之下，或超出量不足一整个slab，都不释放
+    QCOMPARE(pool.trimTo(perSlab * 4), 0);
+    QCOMPARE(pool.trimTo(perSlab * 5), 0);
+    QCOMPARE(pool.trimTo(perSlab * 4 - 1), 0);
+
+    QCOMPARE(pool.trimTo(perSlab * 2), perSlab * 2);
+    QCOMPARE(pool.slabCount(), 2);
+    QCOMPARE(pool.totalEvents(), perSlab * 2);
+    QCOMPARE(pool.availableEvents(), perSlab * 2);
+
+    // 负目标按0处理
+    QCOMPARE(pool.trimTo(-10), perSlab * 2);
+    QCOMPARE(pool.slabCount(), 0);
+    QCOMPARE(pool.totalEvents(), 0);
+
+    // 持有一个块后，它所在的弹匣留在调用线程，对应slab不能释放
+    EventStoragePool held(64, perSlab * 2);
+    void* block = held.allocate();
+    QCOMPARE(held.trimTo(0), perSlab);
+    QCOMPARE(held.slabCount(), 1);
+    QCOMPARE(held.totalEvents(), perSlab);
+    QCOMPARE(held.usedEvents(), 1);
+    held.deallocate(block);
+}
+
+void TestEventPool::testClearPool()
+{
+    EventStoragePool pool(64, 0);
+    const int perSlab = pool.blocksPerSlab();
+
+    // clearPool连同调用线程的弹匣一起回收
+    QList<void*> blocks;
+    for (int i = 0; i < perSlab * 2; ++i) {
+        blocks.append(pool.allocate());
+    }
+    QCOMPARE(pool.usedEvents(), perSlab * 2);
+    for (void* block : blocks) {
+        pool.deallocate(block);
+    }
+
+    pool.clearPool();
+    QCOMPARE(pool.totalEvents(), 0);
+    QCOMPARE(pool.availableEvents(), 0);
+    QCOMPARE(pool.slabCount(), 0);
+
+    // 清空后仍可继续分配
+    void* block = pool.allocate();
+    QVERIFY(block);
+    QVERIFY(pool.totalEvents() > 0);
+    pool.deallocate(block);
+}
+
+void TestEventPool::testTypedPoolRecyclesObjects()
+{
+    CountedObject::constructed = 0;
+    CountedObject::destroyed = 0;
+    CountedObject::resets = 0;
+
+    {
+        EventPool<CountedObject> pool(16);
+        const int created = CountedObject::constructed;
+        QCOMPARE(created, pool.totalEvents());
+
+        CountedObject* object = pool.acquireEvent();
+        QVERIFY(object->isInUse());
+        object->setValue(42);
+        pool.releaseEvent(object);
+        QCOMPARE(CountedObject::resets, 1);
+        QCOMPARE(object->value(), 0);
+
+        // 同一线程立即再次获取，拿回刚归还的存活对象，不再构造
+        CountedObject* again = pool.acquireEvent();
+        QCOMPARE(again, object);
+        QCOMPARE(CountedObject::constructed, created);
+        QCOMPARE(CountedObject::destroyed, 0);
+        pool.releaseEvent(again);
+        pool.releaseEvent(nullptr);
+        QCOMPARE(CountedObject::resets, 2);
+    }
+
+    // 所有对象都已归还，池析构时全部析构
+    QCOMPARE(CountedObject::destroyed, CountedObject::constructed);
+}
+
+void TestEventPool::testPoolAllocatedUsesStoragePool()
+{
+    EventStoragePool& pool = PoolAllocated<PooledRecord>::storagePool();
+    const int usedBefore = pool.usedEvents();
+
+    PooledRecord* record = new PooledRecord();
+    QCOMPARE(pool.usedEvents(), usedBefore + 1);
+    delete record;
+    QCOMPARE(pool.usedEvents(), usedBefore);
+
+    // 派生类尺寸不同，走全局分配器，不占用池中的块
+    LargerRecord* larger = new LargerRecord();
+    QCOMPARE(pool.usedEvents(), usedBefore);
+    delete larger;
+    QCOMPARE(pool.usedEvents(), usedBefore);
+}
+
+void TestEventPool::testBlockLayout()
+{
+    EventStoragePool pool(24, 100);
+    QCOMPARE(pool.blockSize(), std::size_t(24));
+    QCOMPARE(pool.blockStride() % EventStoragePool::CacheLineSize, std::size_t(0));
+
+    QList<void*> blocks;
+    for (int i = 0; i < 100; ++i) {
+        void* block = pool.allocate();
+        QCOMPARE(reinterpret_cast<std::uintptr_t>(block) % EventStoragePool::CacheLineSize, std::uintptr_t(0));
+        blocks.append(block);
+    }
+    for (void* block : blocks) {
+        pool.deallocate(block);
+    }
+
+    const QHash<int, int> perNode = pool.slabsPerNumaNode();
+    int slabs = 0;
+    for (int count : perNode) {
+        slabs += count;
+    }
+    QCOMPARE(slabs, pool.slabCount());
+    QCOMPARE(pool.reservedBytes(), qint64(pool.slabCount()) * qint64(pool.slabBytes()));
+    QVERIFY(pool.reservedBytes() >= qint64(pool.totalEvents()) * qint64(pool.blockStride()));
+}
+
+void TestEventPool::testAuditTracksOutstanding()
+{
+    EventPool<CountedObject> pool(16);
+    pool.setAuditEnabled(true);
+    QVERIFY(pool.isAuditEnabled());
+
+    CountedObject* first = pool.acquireEventAt(EVENT_POOL_SITE);
+    CountedObject* second = pool.acquireEvent();
+    QCOMPARE(pool.outstandingCount(), 2);
+
+    const QList<EventStoragePool::AuditRecord> records = pool.outstandingEvents();
+    QCOMPARE(records.size(), 2);
+    bool foundSite = false;
+    for (const EventStoragePool::AuditRecord& record : records) {
+        QCOMPARE(record.thread, QThread::currentThreadId());
+        if (record.object == first) {
+            QVERIFY(record.site.contains("test_event_pool.cpp"));
+            foundSite = true;
+        }
+    }
+    QVERIFY(foundSite);
+
+    // 阈值以上才报告
+    QCOMPARE(pool.outstandingEvents(60 * 60 * 1000).size(), 0);
+
+    pool.releaseEvent(first);
+    pool.releaseEvent(second);
+    QCOMPARE(pool.outstandingCount(), 0);
+    QCOMPARE(pool.doubleReleaseCount(), quint64(0));
+
+    pool.setAuditEnabled(false);
+    QVERIFY(!pool.isAuditEnabled());
+}
+
+void TestEventPool::testAuditRejectsDoubleRelease()
+{
+    EventPool<CountedObject> pool(16);
+    pool.setAuditEnabled(true);
+
+    CountedObject* object = pool.acquireEvent();
+    pool.releaseEvent(object);
+    const int available = pool.availableEvents();
+    const int resets = CountedObject::resets;
+
+    // 第二次归还被拦截：不重置对象，也不把块再次放回池中
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("重复释放"));
+    pool.releaseEvent(object);
+    QCOMPARE(pool.doubleReleaseCount(), quint64(1));
+    QCOMPARE(pool.availableEvents(), available);
+    QCOMPARE(CountedObject::resets, resets);
+
+    // 重新获取后再归还是正常的
+    CountedObject* again = pool.acquireEvent();
+    QCOMPARE(again, object);
+    pool.releaseEvent(again);
+    QCOMPARE(pool.doubleReleaseCount(), quint64(1));
+
+    // 类级operator delete同样经由未归还集合拦截；直接调用以免析构函数再次执行
+    EventStoragePool& shared = PoolAllocated<PooledRecord>::storagePool();
+    shared.setAuditEnabled(true);
+    const quint64 doubleReleases = shared.doubleReleaseCount();
+    PooledRecord* record = new PooledRecord();
+    delete record;
+    const int sharedAvailable = shared.availableEvents();
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("重复释放"));
+    PooledRecord::operator delete(record, sizeof(PooledRecord));
+    QCOMPARE(shared.doubleReleaseCount(), doubleReleases + 1);
+    QCOMPARE(shared.availableEvents(), sharedAvailable);
+    shared.setAuditEnabled(false);
+}
+
+// 注册测试类
+QTEST_MAIN(TestEventPool)
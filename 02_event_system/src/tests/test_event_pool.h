@@ -0,0 +1,54 @@
+#ifndef TEST_EVENT_POOL_H
+#define TEST_EVENT_POOL_H
+
+#include <QObject>
+#include <QTest>
+#include "../core/event_pool.h"
+
+/**
+ * @brief TestEventPool 事件存储池与对象池的单元测试类
+ *
+ * 测试内容：
+ * 1. 多线程并发获取/归还：计数平衡，同一内存块不会同时交给两个持有者
+ * 2. 线程退出时本地弹匣归还仓库；trimTo/clearPool只释放整块空闲的slab
+ * 3. EventPool<T>复用存活对象，PoolAllocated<T>把new/delete转到存储池
+ * 4. 内存块按缓存行对齐，slab按NUMA节点统计
+ * 5. 审计模式记录未归还对象并拦截重复释放
+ */
+class TestEventPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试并发正确性
+     */
+    void testConcurrentAcquireRelease_data();
+    void testConcurrentAcquireRelease();
+    void testThreadExitFlushesCache();
+
+    /**
+     * @brief 测试容量管理
+     */
+    void testTrimTo();
+    void testClearPool();
+
+    /**
+     * @brief 测试类型化对象池
+     */
+    void testTypedPoolRecyclesObjects();
+    void testPoolAllocatedUsesStoragePool();
+
+    /**
+     * @brief 测试内存布局
+     */
+    void testBlockLayout();
+
+    /**
+     * @brief 测试审计模式
+     */
+    void testAuditTracksOutstanding();
+    void testAuditRejectsDoubleRelease();
+};
+
+#endif // TEST_EVENT_POOL_H
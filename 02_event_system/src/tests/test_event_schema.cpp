@@ -0,0 +1,152 @@
+#include "test_event_schema.h"
+#include <QBuffer>
+
+void TestEventSchema::init()
+{
+    // 每个测试从版本1的模式开始
+    EventSchema schema(CommandEventType, 1);
+    schema.addField(1, "file");
+    EventSchema::registerSchema(schema);
+}
+
+QByteArray TestEventSchema::versionOneFrame(const QVariantMap& parameters) const
+{
+    const CommandEvent event("save", parameters);
+    return event.serialize();
+}
+
+void TestEventSchema::registerVersionTwo() const
+{
+    // 版本2：file改名为path，新增overwrite（默认false）和mode（无默认值）
+    EventSchema schema(CommandEventType, 2);
+    schema.addField(1, "path")
+          .addPreviousName(1, "file")
+          .addField(2, "overwrite", false)
+          .addField(3, "mode");
+    EventSchema::registerSchema(schema);
+}
+
+void TestEventSchema::testPromotesRenamedField()
+{
+    const QByteArray frame = versionOneFrame(QVariantMap{ { "file", "a.txt" } });
+    registerVersionTwo();
+
+    CommandEvent event;
+    QVERIFY(event.deserialize(frame));
+    QVERIFY(event.schemaView().isValid());
+    QCOMPARE(event.schemaView().frameVersion(), quint16(1));
+    QVERIFY(event.schemaView().isPromoted());
+
+    // 按需读取：旧名称写入的字段以当前名称读出，缺少的字段取默认值
+    QCOMPARE(event.parameter("path").toString(), QStringLiteral("a.txt"));
+    QVERIFY(event.hasParameter("overwrite"));
+    QCOMPARE(event.parameter("overwrite", true).toBool(), false);
+    QVERIFY(!event.hasParameter("mode"));
+    QCOMPARE(event.parameter("mode", "fallback").toString(), QStringLiteral("fallback"));
+    QCOMPARE(event.parameterCount(), 2);
+
+    const int overwriteKey = EventPayload::internKey("overwrite");
+    QVERIFY(event.hasParameter(overwriteKey));
+    QCOMPARE(event.parameter(overwriteKey).toBool(), false);
+
+    // 未修改的事件原样转发缓冲区
+    QCOMPARE(event.serialize(), frame);
+}
+
+void TestEventSchema::testLegacyFrameWithoutIds()
+{
+    // 模式段出现之前的录制：没有字段ID
+    EventWireWriter writer(CommandEventType, 1);
+    writer.addString(QStringView(), u"save");
+    writer.addString(u"file", u"b.txt");
+    const QByteArray frame = writer.finish();
+    registerVersionTwo();
+
+    CommandEvent event;
+    QVERIFY(event.deserialize(frame));
+    QCOMPARE(event.schemaView().frameVersion(), quint16(0));
+    QVERIFY(event.schemaView().isPromoted());
+    QCOMPARE(event.parameter("path").toString(), QStringLiteral("b.txt"));
+    QCOMPARE(event.parameter("overwrite", true).toBool(), false);
+}
+
+void TestEventSchema::testMaterializeAppliesDefaults()
+{
+    const QByteArray frame = versionOneFrame(QVariantMap{ { "file", "c.txt" } });
+    registerVersionTwo();
+
+    CommandEvent event;
+    QVERIFY(event.deserialize(frame));
+
+    // parameters()解码全部参数，结果与按需读取一致
+    const QVariantMap parameters = event.parameters();
+    QCOMPARE(parameters.size(), 2);
+    QCOMPARE(parameters.value("path").toString(), QStringLiteral("c.txt"));
+    QVERIFY(parameters.contains("overwrite"));
+    QCOMPARE(parameters.value("overwrite").toBool(), false);
+    QVERIFY(!parameters.contains("file"));
+    QCOMPARE(event.parameterCount(), 2);
+
+    // 修改后重新编码，新事件带有版本2的模式段
+    event.setParameter("overwrite", true);
+    CommandEvent copy;
+    QVERIFY(copy.deserialize(event.serialize()));
+    QCOMPARE(copy.schemaView().frameVersion(), quint16(2));
+    QVERIFY(!copy.schemaView().isPromoted());
+    QCOMPARE(copy.parameter("overwrite").toBool(), true);
+}
+
+void TestEventSchema::testReadFromAppliesDefaults()
+{
+    QByteArray bytes = versionOneFrame(QVariantMap{ { "file", "d.txt" } });
+    registerVersionTwo();
+
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    CommandEvent event;
+    QVERIFY(event.readFrom(&device));
+    QCOMPARE(event.command(), QStringLiteral("save"));
+    QCOMPARE(event.parameterCount(), 2);
+    QCOMPARE(event.parameter("path").toString(), QStringLiteral("d.txt"));
+    QVERIFY(event.hasParameter("overwrite"));
+    QCOMPARE(event.parameter("overwrite", true).toBool(), false);
+    QVERIFY(!event.hasParameter("mode"));
+}
+
+void TestEventSchema::testPresentFieldOverridesDefault()
+{
+    registerVersionTwo();
+    const CommandEvent original("save", QVariantMap{ { "path", "e.txt" }, { "overwrite", true } });
+
+    CommandEvent event;
+    QVERIFY(event.deserialize(original.serialize()));
+    QVERIFY(!event.schemaView().isPromoted());
+    QCOMPARE(event.parameter("overwrite").toBool(), true);
+    QCOMPARE(event.parameterCount(), 2);
+    QCOMPARE(event.parameters().value("overwrite").toBool(), true);
+}
+
+void TestEventSchema::testSchemaViewSkipsUnknownFields()
+{
+    const QByteArray frame = versionOneFrame(QVariantMap{ { "file", "f.txt" }, { "legacyFlag", 1 } });
+    registerVersionTwo();
+
+    const EventWireView view(frame);
+    QVERIFY(view.isValid());
+    const EventSchemaView schemaView(view, EventSchema::find(CommandEventType), 1);
+    QVERIFY(schemaView.isValid());
+    QCOMPARE(schemaView.unknownFieldCount(), 1);
+    QCOMPARE(schemaView.value(1).toString(), QStringLiteral("f.txt"));
+    QCOMPARE(schemaView.value(2).toBool(), false);
+    QVERIFY(!schemaView.contains(2));
+    QVERIFY(!schemaView.value(3).isValid());
+
+    // 模式不认识的字段仍可按事件中的名称读取
+    CommandEvent event;
+    QVERIFY(event.deserialize(frame));
+    QCOMPARE(event.parameter("legacyFlag").toInt(), 1);
+    QCOMPARE(event.parameterCount(), 3);
+}
+
+// 注册测试类
+QTEST_MAIN(TestEventSchema)
@@ -0,0 +1,48 @@
+#ifndef TEST_EVENT_SCHEMA_H
+#define TEST_EVENT_SCHEMA_H
+
+#include <QObject>
+#include <QTest>
+#include <QByteArray>
+#include "../core/event_schema.h"
+#include "../core/custom_events.h"
+
+/**
+ * @brief TestEventSchema 字段模式与旧录制升级的单元测试类
+ *
+ * 测试内容：
+ * 1. 旧版本写入的CommandEvent按字段ID映射到改名后的参数
+ * 2. 没有模式段的旧事件按旧名称识别
+ * 3. 缺少的字段在按需读取、完整解码和流式读取时都得到模式默认值
+ * 4. 模式不认识的字段被跳过但仍可按名称读取
+ */
+class TestEventSchema : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试初始化和清理
+     */
+    void init();
+
+    /**
+     * @brief 测试版本升级
+     */
+    void testPromotesRenamedField();
+    void testLegacyFrameWithoutIds();
+    void testMaterializeAppliesDefaults();
+    void testReadFromAppliesDefaults();
+    void testPresentFieldOverridesDefault();
+
+    /**
+     * @brief 测试模式视图
+     */
+    void testSchemaViewSkipsUnknownFields();
+
+private:
+    QByteArray versionOneFrame(const QVariantMap& parameters) const;
+    void registerVersionTwo() const;
+};
+
+#endif // TEST_EVENT_SCHEMA_H
@@ -0,0 +1,253 @@
+#include "test_event_trace.h"
+#include "../core/event_compression.h"
+#include <cstring>
+
+namespace {
+
+const int TraceEventCount = 40;
+
+} // namespace
+
+void TestEventTrace::cleanup()
+{
+    enableCompression(false);
+}
+
+void TestEventTrace::enableCompression(bool enabled) const
+{
+    EventCompression::Policy policy;
+    if (enabled) {
+        policy.codec = EventCompression::Lz;
+        policy.minimumSize = 0;
+    }
+    EventCompression::setPolicy(DataEventType, policy);
+}
+
+QByteArray TestEventTrace::recordTrace(bool finish) const
+{
+    QByteArray bytes;
+    QBuffer device(&bytes);
+    device.open(QIODevice::WriteOnly);
+
+    // 数据事件和命令事件交替，数据事件内容重复，开启压缩时能压小
+    EventTraceWriter writer(&device);
+    for (int i = 0; i < TraceEventCount; ++i) {
+        if (i % 2 == 0) {
+            QVariantMap payload;
+            payload["index"] = i;
+            payload["label"] = QString("sample-").repeated(8) + QString::number(i);
+            writer.append(DataEvent(payload));
+        } else {
+            writer.append(CommandEvent("step", QVariantMap{ { "index", i } }));
+        }
+    }
+    if (finish) {
+        writer.finish();
+    }
+    return bytes;
+}
+
+void TestEventTrace::verifyEvents(const QList<BaseCustomEvent*>& events) const
+{
+    QCOMPARE(events.size(), TraceEventCount);
+    for (int i = 0; i < events.size(); ++i) {
+        BaseCustomEvent* event = events[i];
+        QVERIFY(event);
+        if (i % 2 == 0) {
+            QCOMPARE(int(event->type()), int(DataEventType));
+            QCOMPARE(event->data().toMap().value("index").toInt(), i);
+        } else {
+            auto command = static_cast<CommandEvent*>(event);
+            QCOMPARE(int(command->type()), int(CommandEventType));
+            QCOMPARE(command->command(), QStringLiteral("step"));
+            QCOMPARE(command->parameter("index").toInt(), i);
+        }
+    }
+}
+
+void TestEventTrace::testRoundTrip_data()
+{
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void TestEventTrace::testRoundTrip()
+{
+    QFETCH(bool, compressed);
+    enableCompression(compressed);
+
+    QByteArray bytes = recordTrace(true);
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(reader.hasStoredIndex());
+    QCOMPARE(reader.frameCount(), qint64(TraceEventCount));
+
+    if (compressed) {
+        QVERIFY(EventCompression::isCompressed(reader.frame(0)));
+    }
+
+    // 随机读取单帧
+    BaseCustomEvent* single = reader.readEvent(7);
+    QVERIFY(single);
+    QCOMPARE(static_cast<CommandEvent*>(single)->parameter("index").toInt(), 7);
+    delete single;
+
+    // 小区间、多线程批量加载，结果仍按帧顺序
+    reader.setMaxThreads(3);
+    reader.setChunkBytes(256);
+    QList<BaseCustomEvent*> events;
+    QVERIFY(reader.loadEvents(&events));
+    verifyEvents(events);
+    qDeleteAll(events);
+
+    QVERIFY(reader.loadEvents(&events, 10, 5));
+    QCOMPARE(events.size(), 5);
+    QCOMPARE(events.first()->data().toMap().value("index").toInt(), 10);
+    qDeleteAll(events);
+}
+
+void TestEventTrace::testEmptyTrace()
+{
+    QByteArray bytes;
+    QBuffer output(&bytes);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    EventTraceWriter writer(&output);
+    QVERIFY(writer.finish());
+    output.close();
+
+    QBuffer input(&bytes);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    EventTraceReader reader(&input);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.frameCount(), qint64(0));
+
+    QList<BaseCustomEvent*> events;
+    QVERIFY(reader.loadEvents(&events));
+    QVERIFY(events.isEmpty());
+}
+
+void TestEventTrace::testLoadWithoutTrailer()
+{
+    QByteArray bytes = recordTrace(false);
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(!reader.hasStoredIndex());
+    QCOMPARE(reader.frameCount(), qint64(TraceEventCount));
+
+    QList<BaseCustomEvent*> events;
+    QVERIFY(reader.loadEvents(&events));
+    verifyEvents(events);
+    qDeleteAll(events);
+}
+
+void TestEventTrace::testTruncatedLastFrame()
+{
+    // 录制中断在最后一帧中间：扫描时丢弃不完整的帧
+    QByteArray bytes = recordTrace(false);
+    bytes.chop(5);
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(!reader.hasStoredIndex());
+    QCOMPARE(reader.frameCount(), qint64(TraceEventCount - 1));
+
+    QList<BaseCustomEvent*> events;
+    QVERIFY(reader.loadEvents(&events));
+    QCOMPARE(events.size(), TraceEventCount - 1);
+    qDeleteAll(events);
+}
+
+void TestEventTrace::testCorruptIndexFallsBackToScan()
+{
+    QByteArray bytes = recordTrace(true);
+
+    EventTrace::Trailer trailer;
+    std::memcpy(&trailer, bytes.constData() + bytes.size() - sizeof(trailer), sizeof(trailer));
+    const qsizetype indexAt = qsizetype(trailer.indexOffset) + qsizetype(sizeof(EventTrace::IndexEntry)) * 3;
+    bytes[indexAt] = char(bytes.at(indexAt) ^ 0x40);
+
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(!reader.hasStoredIndex());
+    QCOMPARE(reader.frameCount(), qint64(TraceEventCount));
+
+    QList<BaseCustomEvent*> events;
+    QVERIFY(reader.loadEvents(&events));
+    verifyEvents(events);
+    qDeleteAll(events);
+}
+
+void TestEventTrace::testCorruptTrailerFallsBackToScan()
+{
+    QByteArray bytes = recordTrace(true);
+
+    // 尾部声明的帧数与索引长度不符
+    EventTrace::Trailer trailer;
+    char* trailerAt = bytes.data() + bytes.size() - sizeof(trailer);
+    std::memcpy(&trailer, trailerAt, sizeof(trailer));
+    trailer.frameCount += 1;
+    std::memcpy(trailerAt, &trailer, sizeof(trailer));
+
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(!reader.hasStoredIndex());
+    QCOMPARE(reader.frameCount(), qint64(TraceEventCount));
+}
+
+void TestEventTrace::testCorruptFrameRejected_data()
+{
+    testRoundTrip_data();
+}
+
+void TestEventTrace::testCorruptFrameRejected()
+{
+    QFETCH(bool, compressed);
+    enableCompression(compressed);
+
+    QByteArray bytes = recordTrace(true);
+    QList<EventTrace::IndexEntry> index;
+    {
+        QBuffer device(&bytes);
+        QVERIFY(device.open(QIODevice::ReadOnly));
+        EventTraceReader reader(&device);
+        QVERIFY(reader.open());
+        index = reader.index();
+    }
+
+    // 改动第4帧（数据事件）数据中间的一个字节
+    const EventTrace::IndexEntry& entry = index[4];
+    const qsizetype at = qsizetype(entry.offset + sizeof(EventTrace::FrameHeader) + entry.length / 2);
+    bytes[at] = char(bytes.at(at) ^ 0x08);
+
+    QBuffer device(&bytes);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    EventTraceReader reader(&device);
+    QVERIFY(reader.open());
+    QVERIFY(reader.frame(4).isEmpty());
+    QVERIFY(reader.readEvent(4) == nullptr);
+
+    BaseCustomEvent* intact = reader.readEvent(3);
+    QVERIFY(intact);
+    delete intact;
+
+    QList<BaseCustomEvent*> events;
+    QVERIFY(!reader.loadEvents(&events));
+    QVERIFY(events.isEmpty());
+}
+
+// 注册测试类
+QTEST_MAIN(TestEventTrace)
@@ -0,0 +1,57 @@
+#ifndef TEST_EVENT_TRACE_H
+#define TEST_EVENT_TRACE_H
+
+#include <QObject>
+#include <QTest>
+#include <QBuffer>
+#include <QByteArray>
+#include "../core/event_trace.h"
+#include "../core/custom_events.h"
+
+/**
+ * @brief TestEventTrace 录制文件容器的单元测试类
+ *
+ * 测试内容：
+ * 1. 写出并读回带索引的录制，随机读取单帧和多线程批量加载
+ * 2. 没有尾部的录制（包括末尾帧不完整）扫描重建索引
+ * 3. 索引或尾部损坏时退回扫描
+ * 4. 帧数据损坏（含压缩帧）时读取和批量加载失败
+ */
+class TestEventTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试初始化和清理
+     */
+    void cleanup();
+
+    /**
+     * @brief 测试正常读写
+     */
+    void testRoundTrip_data();
+    void testRoundTrip();
+    void testEmptyTrace();
+
+    /**
+     * @brief 测试索引恢复
+     */
+    void testLoadWithoutTrailer();
+    void testTruncatedLastFrame();
+    void testCorruptIndexFallsBackToScan();
+    void testCorruptTrailerFallsBackToScan();
+
+    /**
+     * @brief 测试损坏帧
+     */
+    void testCorruptFrameRejected_data();
+    void testCorruptFrameRejected();
+
+private:
+    QByteArray recordTrace(bool finish) const;
+    void verifyEvents(const QList<BaseCustomEvent*>& events) const;
+    void enableCompression(bool enabled) const;
+};
+
+#endif // TEST_EVENT_TRACE_H
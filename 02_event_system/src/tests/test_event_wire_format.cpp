@@ -0,0 +1,450 @@
+#include "test_event_wire_format.h"
+#include <QPoint>
+#include <QVariantList>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+const QString TextValue = QStringLiteral("线格式 wire format");
+const QByteArray BytesValue("\x00\x01\x02\xff binary", 11);
+
+const int SampleEventType = 1000 + 42;
+const qint64 SampleTimestamp = 1234567890123;
+
+/**
+ * @brief 模拟套接字的顺序设备：每次最多给出几个字节，之后要等待才有新数据
+ */
+class TrickleDevice : public QIODevice
+{
+public:
+    TrickleDevice(const QByteArray& data, qint64 step)
+        : m_data(data), m_step(step), m_position(0), m_stalled(false) {}
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        return (m_stalled ? 0 : m_data.size() - m_position) + QIODevice::bytesAvailable();
+    }
+
+    bool waitForReadyRead(int) override
+    {
+        m_stalled = false;
+        return m_position < m_data.size();
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+        if (m_stalled) {
+            return 0;
+        }
+        const qint64 count = qMin(qMin(maxSize, m_step), m_data.size() - m_position);
+        std::memcpy(data, m_data.constData() + m_position, count);
+        m_position += count;
+        m_stalled = true;
+        return count;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    QByteArray m_data;
+    qint64 m_step;
+    qint64 m_position;
+    bool m_stalled;
+};
+
+} // namespace
+
+void TestEventWireFormat::addSampleFields(EventWireWriter& writer) const
+{
+    QVariantMap nested;
+    nested["x"] = 1;
+    nested["point"] = QPoint(3, 4);
+    nested["list"] = QVariantList{ 1, QStringLiteral("two"), 3.0 };
+
+    writer.addNull(u"null");
+    writer.addBool(u"flag", true);
+    writer.addInt(u"count", -42);
+    writer.addUInt(u"mask", Q_UINT64_C(0xFFFFFFFF00));
+    writer.addDouble(u"ratio", 0.25);
+    writer.addString(u"text", TextValue);
+    writer.addBytes(u"bytes", BytesValue);
+    writer.addVariant(u"nested", nested);
+}
+
+QByteArray TestEventWireFormat::sampleEvent() const
+{
+    EventWireWriter writer(SampleEventType, SampleTimestamp);
+    addSampleFields(writer);
+    return writer.finish();
+}
+
+bool TestEventWireFormat::readAll(const QByteArray& bytes, qint64 chunkBytes) const
+{
+    QBuffer device;
+    device.setData(bytes);
+    if (!device.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    EventWireStreamReader reader(&device, chunkBytes);
+    if (!reader.readHeader()) {
+        return false;
+    }
+    QString name;
+    QVariant value;
+    while (reader.hasNext()) {
+        if (!reader.readNext(&name, &value)) {
+            return false;
+        }
+    }
+    return reader.finish();
+}
+
+void TestEventWireFormat::testFinishMatchesWriteTo_data()
+{
+    QTest::addColumn<qint64>("chunkBytes");
+
+    QTest::newRow("single byte") << qint64(1);
+    QTest::newRow("odd chunk") << qint64(7);
+    QTest::newRow("small chunk") << qint64(64);
+    QTest::newRow("default chunk") << qint64(EventWire::DefaultChunkBytes);
+}
+
+void TestEventWireFormat::testFinishMatchesWriteTo()
+{
+    QFETCH(qint64, chunkBytes);
+
+    EventWireWriter writer(SampleEventType, SampleTimestamp);
+    addSampleFields(writer);
+    const QByteArray finished = writer.finish();
+    QVERIFY(!finished.isEmpty());
+
+    QByteArray written;
+    QBuffer device(&written);
+    QVERIFY(device.open(QIODevice::WriteOnly));
+    QVERIFY(writer.writeTo(&device, chunkBytes));
+    device.close();
+
+    // 随机访问设备上writeTo()回填校验值，结果应与finish()逐字节相同
+    QCOMPARE(written.size(), finished.size());
+    QCOMPARE(written, finished);
+}
+
+void TestEventWireFormat::testSizeMatchesFinish()
+{
+    EventWireWriter empty(SampleEventType, SampleTimestamp);
+    QCOMPARE(empty.size(), qint64(empty.finish().size()));
+
+    EventWireWriter writer(SampleEventType, SampleTimestamp);
+    addSampleFields(writer);
+    QCOMPARE(writer.size(), qint64(writer.finish().size()));
+
+    writer.setSchemaVersion(3);
+    writer.setFieldId(0, 7);
+    QCOMPARE(writer.size(), qint64(writer.finish().size()));
+}
+
+void TestEventWireFormat::testViewReadsFields()
+{
+    const QByteArray buffer = sampleEvent();
+    QVERIFY(EventWire::isWireFormat(buffer));
+
+    EventWireView view(buffer);
+    QVERIFY(view.isValid());
+    QCOMPARE(view.eventType(), SampleEventType);
+    QCOMPARE(view.timestamp(), SampleTimestamp);
+    QCOMPARE(view.fieldCount(), 8);
+
+    QCOMPARE(view.fieldName(0), QStringView(u"null"));
+    QCOMPARE(view.fieldType(0), EventWire::Null);
+    QCOMPARE(view.toBool(view.indexOf(u"flag")), true);
+    QCOMPARE(view.toInt(view.indexOf(u"count")), qint64(-42));
+    QCOMPARE(view.toUInt(view.indexOf(u"mask")), Q_UINT64_C(0xFFFFFFFF00));
+    QCOMPARE(view.toDouble(view.indexOf(u"ratio")), 0.25);
+    QCOMPARE(view.toStringView(view.indexOf(u"text")).toString(), TextValue);
+    QCOMPARE(view.toBytes(view.indexOf(u"bytes")).toByteArray(), BytesValue);
+    QCOMPARE(view.indexOf(u"missing"), -1);
+
+    const QVariantMap nested = view.value(view.indexOf(u"nested")).toMap();
+    QCOMPARE(nested.value("x").toInt(), 1);
+    QCOMPARE(nested.value("point").toPoint(), QPoint(3, 4));
+    QCOMPARE(nested.value("list").toList().size(), 3);
+}
+
+void TestEventWireFormat::testUnalignedBuffer()
+{
+    const QByteArray buffer = sampleEvent();
+    QByteArray padded(1, 'x');
+    padded.append(buffer);
+
+    // fromRawData不拷贝，数据起点落在奇数地址上
+    const QByteArray unaligned = QByteArray::fromRawData(padded.constData() + 1, buffer.size());
+    EventWireView view(unaligned);
+    QVERIFY(view.isValid());
+    QCOMPARE(view.toStringView(view.indexOf(u"text")).toString(), TextValue);
+    QCOMPARE(view.toBytes(view.indexOf(u"bytes")).toByteArray(), BytesValue);
+}
+
+void TestEventWireFormat::testTruncatedBufferRejected_data()
+{
+    QTest::addColumn<int>("length");
+
+    const int size = sampleEvent().size();
+    QTest::newRow("empty") << 0;
+    QTest::newRow("partial header") << int(sizeof(EventWire::Header)) - 1;
+    QTest::newRow("header only") << int(sizeof(EventWire::Header));
+    QTest::newRow("partial table") << int(sizeof(EventWire::Header) + sizeof(EventWire::FieldEntry) / 2);
+    QTest::newRow("half") << size / 2;
+    QTest::newRow("missing last byte") << size - 1;
+}
+
+void TestEventWireFormat::testTruncatedBufferRejected()
+{
+    QFETCH(int, length);
+
+    const QByteArray truncated = sampleEvent().left(length);
+    QVERIFY(!EventWireView(truncated).isValid());
+}
+
+void TestEventWireFormat::testCorruptedBufferRejected_data()
+{
+    QTest::addColumn<int>("position");
+
+    const int size = sampleEvent().size();
+    QTest::newRow("magic") << int(offsetof(EventWire::Header, magic));
+    QTest::newRow("event type") << int(offsetof(EventWire::Header, eventType));
+    QTest::newRow("field count") << int(offsetof(EventWire::Header, fieldCount));
+    QTest::newRow("total size") << int(offsetof(EventWire::Header, totalSize));
+    QTest::newRow("field table") << int(sizeof(EventWire::Header) + offsetof(EventWire::FieldEntry, length));
+    QTest::newRow("middle") << size / 2;
+    QTest::newRow("last byte") << size - 1;
+}
+
+void TestEventWireFormat::testCorruptedBufferRejected()
+{
+    QFETCH(int, position);
+
+    QByteArray buffer = sampleEvent();
+    QVERIFY(EventWireView(buffer).isValid());
+
+    buffer[position] = char(buffer.at(position) ^ 0x5A);
+    QVERIFY(!EventWireView(buffer).isValid());
+}
+
+void TestEventWireFormat::testOutOfRangeEntryRejected()
+{
+    QByteArray buffer = sampleEvent();
+
+    // 去掉校验标志，确认仅凭偏移表检查也能拒绝越界字段
+    EventWire::Header header;
+    std::memcpy(&header, buffer.constData(), sizeof(header));
+    header.flags &= ~EventWire::Checksummed;
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    QVERIFY(EventWireView(buffer).isValid());
+
+    // 改写bytes字段（第7个）的偏移表项
+    EventWire::FieldEntry entry;
+    char* table = buffer.data() + sizeof(EventWire::Header) + 6 * sizeof(EventWire::FieldEntry);
+    std::memcpy(&entry, table, sizeof(entry));
+    entry.offset = header.totalSize + 8;
+    std::memcpy(table, &entry, sizeof(entry));
+    QVERIFY(!EventWireView(buffer).isValid());
+
+    entry.offset = header.totalSize - 4;
+    entry.length = 16;
+    std::memcpy(table, &entry, sizeof(entry));
+    QVERIFY(!EventWireView(buffer).isValid());
+
+    entry.offset = 0;
+    entry.length = 0;
+    entry.nameOffset = header.totalSize;
+    entry.nameLength = 4;
+    std::memcpy(table, &entry, sizeof(entry));
+    QVERIFY(!EventWireView(buffer).isValid());
+}
+
+void TestEventWireFormat::testStreamReaderRoundTrip_data()
+{
+    testFinishMatchesWriteTo_data();
+}
+
+void TestEventWireFormat::testStreamReaderRoundTrip()
+{
+    QFETCH(qint64, chunkBytes);
+
+    EventWireWriter writer(SampleEventType, SampleTimestamp);
+    addSampleFields(writer);
+    writer.setSchemaVersion(2);
+    writer.setFieldId(5, 11);
+
+    QByteArray bytes;
+    QBuffer output(&bytes);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    QVERIFY(writer.writeTo(&output, chunkBytes));
+    output.close();
+
+    const EventWireView view(bytes);
+    QVERIFY(view.isValid());
+
+    QBuffer input(&bytes);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    EventWireStreamReader reader(&input, chunkBytes);
+    QVERIFY(reader.readHeader());
+    QCOMPARE(reader.eventType(), SampleEventType);
+    QCOMPARE(reader.timestamp(), SampleTimestamp);
+    QCOMPARE(reader.fieldCount(), view.fieldCount());
+    QCOMPARE(reader.schemaVersion(), quint16(2));
+    QCOMPARE(reader.fieldId(5), quint16(11));
+
+    // 流式读出的每个字段都应与整块视图解码的结果相同
+    QString name;
+    QVariant value;
+    for (int i = 0; i < view.fieldCount(); ++i) {
+        QVERIFY(reader.hasNext());
+        QVERIFY(reader.readNext(&name, &value));
+        QCOMPARE(name, view.fieldName(i).toString());
+        QCOMPARE(value, view.value(i));
+    }
+    QVERIFY(!reader.hasNext());
+    QVERIFY(reader.finish());
+    QVERIFY(input.atEnd());
+}
+
+void TestEventWireFormat::testStreamReaderSkipsFields()
+{
+    // 两个事件首尾相接，跳过第一个事件的字段后设备应停在第二个事件开头
+    QByteArray bytes = sampleEvent();
+    EventWireWriter second(SampleEventType + 1, SampleTimestamp + 1);
+    second.addString(u"text", TextValue);
+    bytes.append(second.finish());
+
+    QBuffer input(&bytes);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+
+    EventWireStreamReader first(&input);
+    QVERIFY(first.readHeader());
+    QVERIFY(first.readNext(nullptr, nullptr));
+    QVERIFY(first.finish());
+
+    EventWireStreamReader next(&input);
+    QVERIFY(next.readHeader());
+    QCOMPARE(next.eventType(), SampleEventType + 1);
+    QString name;
+    QVariant value;
+    QVERIFY(next.readNext(&name, &value));
+    QCOMPARE(name, QStringLiteral("text"));
+    QCOMPARE(value.toString(), TextValue);
+    QVERIFY(next.finish());
+    QVERIFY(input.atEnd());
+}
+
+void TestEventWireFormat::testStreamReaderRejectsTruncated()
+{
+    const QByteArray bytes = sampleEvent();
+    QVERIFY(readAll(bytes));
+
+    const int lengths[] = { 0, int(sizeof(EventWire::Header)) - 1, int(sizeof(EventWire::Header)),
+                            int(bytes.size()) / 2, int(bytes.size()) - 1 };
+    for (int length : lengths) {
+        QVERIFY2(!readAll(bytes.left(length), 7), qPrintable(QString("length %1").arg(length)));
+    }
+}
+
+void TestEventWireFormat::testStreamReaderRejectsCorrupted()
+{
+    const QByteArray bytes = sampleEvent();
+
+    // 任意一个字节被改动，要么读取中途失败，要么finish()校验失败
+    for (int position = 0; position < bytes.size(); position += 5) {
+        QByteArray corrupted = bytes;
+        corrupted[position] = char(corrupted.at(position) ^ 0x21);
+        QVERIFY2(!readAll(corrupted, 16), qPrintable(QString("position %1").arg(position)));
+    }
+}
+
+void TestEventWireFormat::testEventStreamRoundTrip()
+{
+    QVariantMap payload;
+    payload["name"] = QStringLiteral("sensor");
+    payload["value"] = 3.5;
+    payload["raw"] = BytesValue;
+
+    DataEvent data(payload);
+    CommandEvent command(QStringLiteral("draw"), QVariantMap{ { "x", 10 }, { "label", TextValue } });
+
+    QByteArray bytes;
+    QBuffer output(&bytes);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    QVERIFY(data.writeTo(&output));
+    QVERIFY(command.writeTo(&output));
+    output.close();
+
+    QBuffer input(&bytes);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+
+    DataEvent dataCopy;
+    QVERIFY(dataCopy.readFrom(&input));
+    QCOMPARE(dataCopy.data().toMap(), payload);
+    QCOMPARE(dataCopy.timestamp(), data.timestamp());
+
+    CommandEvent commandCopy;
+    QVERIFY(commandCopy.readFrom(&input));
+    QCOMPARE(commandCopy.command(), QStringLiteral("draw"));
+    QCOMPARE(commandCopy.parameter("x").toInt(), 10);
+    QCOMPARE(commandCopy.parameter("label").toString(), TextValue);
+    QCOMPARE(commandCopy.parameterCount(), 2);
+    QVERIFY(input.atEnd());
+}
+
+void TestEventWireFormat::testVerifyFrames()
+{
+    const QByteArray frame = sampleEvent();
+    QByteArray bytes = frame + frame + frame;
+
+    QBuffer intact(&bytes);
+    QVERIFY(intact.open(QIODevice::ReadOnly));
+    EventWire::VerifyReport report = EventWire::verifyFrames(&intact, 16);
+    QVERIFY(report.isOk());
+    QCOMPARE(report.frames, qint64(3));
+    QCOMPARE(report.bytes, qint64(bytes.size()));
+
+    // 第二帧的数据被改动：报告停在第二帧起点
+    bytes[frame.size() + frame.size() / 2] = char(bytes.at(frame.size() + frame.size() / 2) ^ 0x10);
+    QBuffer corrupted(&bytes);
+    QVERIFY(corrupted.open(QIODevice::ReadOnly));
+    report = EventWire::verifyFrames(&corrupted);
+    QVERIFY(!report.isOk());
+    QCOMPARE(report.frames, qint64(1));
+    QCOMPARE(report.errorOffset, qint64(frame.size()));
+
+    // 末尾只有半个头部
+    QByteArray partial = frame + frame.left(sizeof(EventWire::Header) / 2);
+    QBuffer truncated(&partial);
+    QVERIFY(truncated.open(QIODevice::ReadOnly));
+    report = EventWire::verifyFrames(&truncated);
+    QVERIFY(!report.isOk());
+    QCOMPARE(report.errorOffset, qint64(frame.size()));
+}
+
+void TestEventWireFormat::testVerifyFramesTrickledInput()
+{
+    const QByteArray frame = sampleEvent();
+    const QByteArray bytes = frame + frame;
+
+    // 头部被拆成多次到达，中间还有一次读不到数据，不应被当成损坏
+    const qint64 steps[] = { 1, 3, 5, 31 };
+    for (qint64 step : steps) {
+        TrickleDevice device(bytes, step);
+        QVERIFY(device.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+        const EventWire::VerifyReport report = EventWire::verifyFrames(&device);
+        QVERIFY2(report.isOk(), qPrintable(QString("step %1").arg(step)));
+        QCOMPARE(report.frames, qint64(2));
+    }
+}
+
+// 注册测试类
+QTEST_MAIN(TestEventWireFormat)
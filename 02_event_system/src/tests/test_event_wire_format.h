@@ -0,0 +1,73 @@
+#ifndef TEST_EVENT_WIRE_FORMAT_H
+#define TEST_EVENT_WIRE_FORMAT_H
+
+#include <QObject>
+#include <QTest>
+#include <QBuffer>
+#include <QByteArray>
+#include <QVariantMap>
+#include "../core/event_wire_format.h"
+#include "../core/custom_events.h"
+
+/**
+ * @brief TestEventWireFormat 二进制事件线格式的单元测试类
+ *
+ * 测试内容：
+ * 1. EventWireWriter::finish()与writeTo()生成的字节完全相同
+ * 2. EventWireView按类型读回各字段
+ * 3. 截断、篡改、越界的缓冲区被EventWireView拒绝
+ * 4. 未对齐的缓冲区仍可正确读取
+ * 5. EventWireStreamReader逐字段读回writeTo()写出的事件，并发现截断和篡改
+ * 6. DataEvent/CommandEvent经writeTo()/readFrom()往返
+ * 7. verifyFrames()在数据分几次到达的顺序设备上逐帧校验
+ */
+class TestEventWireFormat : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试写出路径
+     */
+    void testFinishMatchesWriteTo_data();
+    void testFinishMatchesWriteTo();
+    void testSizeMatchesFinish();
+
+    /**
+     * @brief 测试读取视图
+     */
+    void testViewReadsFields();
+    void testUnalignedBuffer();
+
+    /**
+     * @brief 测试损坏输入
+     */
+    void testTruncatedBufferRejected_data();
+    void testTruncatedBufferRejected();
+    void testCorruptedBufferRejected_data();
+    void testCorruptedBufferRejected();
+    void testOutOfRangeEntryRejected();
+
+    /**
+     * @brief 测试流式读取
+     */
+    void testStreamReaderRoundTrip_data();
+    void testStreamReaderRoundTrip();
+    void testStreamReaderSkipsFields();
+    void testStreamReaderRejectsTruncated();
+    void testStreamReaderRejectsCorrupted();
+    void testEventStreamRoundTrip();
+
+    /**
+     * @brief 测试逐帧校验
+     */
+    void testVerifyFrames();
+    void testVerifyFramesTrickledInput();
+
+private:
+    void addSampleFields(EventWireWriter& writer) const;
+    QByteArray sampleEvent() const;
+    bool readAll(const QByteArray& bytes, qint64 chunkBytes = EventWire::DefaultChunkBytes) const;
+};
+
+#endif // TEST_EVENT_WIRE_FORMAT_H
@@ -0,0 +1,299 @@
+#include "test_key_value_update_channel.h"
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QScopeGuard>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int ProducerThreads = 4;
+const int KeyCount = 16;
+
+QString keyName(int index)
+{
+    return QStringLiteral("key%1").arg(index);
+}
+
+/**
+ * @brief 启动一组执行同一函数的线程，析构时等待全部结束
+ *
+ * 生产者在线程的thread_local析构中退役，QThread::wait()可能在此之前返回；
+ * std::thread::join()返回时线程已彻底退出。
+ */
+class ThreadGroup
+{
+public:
+    template<typename Function>
+    ThreadGroup(int count, Function function)
+    {
+        for (int i = 0; i < count; ++i) {
+            m_threads.emplace_back(function, i);
+        }
+    }
+
+    ~ThreadGroup() { wait(); }
+
+    void wait()
+    {
+        for (std::thread& thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+};
+
+/**
+ * @brief 在生产者写入过程中挡住它的闸门
+ *
+ * arm()之后的第一次GatedValue拷贝会停在闸门处，直到release()。
+ */
+class WriteGate
+{
+public:
+    WriteGate() : m_armed(false), m_entered(false), m_released(false) {}
+
+    void arm()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_armed = true;
+    }
+
+    void pass()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_armed) {
+            return;
+        }
+        m_armed = false;
+        m_entered = true;
+        m_changed.wakeAll();
+        while (!m_released) {
+            m_changed.wait(&m_mutex);
+        }
+    }
+
+    bool waitEntered(int timeoutMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        QDeadlineTimer deadline(timeoutMs);
+        while (!m_entered) {
+            if (!m_changed.wait(&m_mutex, deadline)) {
+                return m_entered;
+            }
+        }
+        return true;
+    }
+
+    void release()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_armed = false;
+        m_released = true;
+        m_changed.wakeAll();
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_changed;
+    bool m_armed;
+    bool m_entered;
+    bool m_released;
+};
+
+} // namespace
+
+/**
+ * @brief 拷贝时经过 WriteGate 的值；write()把值拷进缓冲表时会被挡住
+ */
+class GatedValue
+{
+public:
+    GatedValue() : m_gate(nullptr) {}
+    explicit GatedValue(WriteGate* gate) : m_gate(gate) {}
+
+    GatedValue(const GatedValue& other) : m_gate(other.m_gate)
+    {
+        if (m_gate) {
+            m_gate->pass();
+        }
+    }
+
+    GatedValue(GatedValue&& other) noexcept : m_gate(other.m_gate) {}
+    GatedValue& operator=(const GatedValue& other) = default;
+
+private:
+    WriteGate* m_gate;
+};
+
+// 可重定位且只有一个指针大，QVariant原位保存并在拷贝时调用拷贝构造
+Q_DECLARE_TYPEINFO(GatedValue, Q_RELOCATABLE_TYPE);
+Q_DECLARE_METATYPE(GatedValue)
+
+void TestKeyValueUpdateChannel::testLastWriterWinsAcrossThreads()
+{
+    KeyValueUpdateChannel channel;
+
+    // 写入在锁内进行并以写入次序作为值，值越大的写入越晚
+    QMutex orderMutex;
+    int order = 0;
+    QHash<QString, int> expected;
+    const int writesPerThread = 2000;
+
+    QHash<QString, int> received;
+    int regressions = 0;
+    auto apply = [&received, &regressions](const QVariantHash& updates) {
+        for (auto it = updates.begin(); it != updates.end(); ++it) {
+            // 后到的帧不能交付比已交付值更早的写入
+            const int value = it.value().toInt();
+            if (value < received.value(it.key(), -1)) {
+                regressions++;
+            }
+            received.insert(it.key(), value);
+        }
+    };
+
+    std::atomic<int> finished(0);
+    {
+        ThreadGroup producers(ProducerThreads, [&](int thread) {
+            for (int i = 0; i < writesPerThread; ++i) {
+                const QString key = keyName((i * 7 + thread) % KeyCount);
+                QMutexLocker locker(&orderMutex);
+                channel.write(key, order);
+                expected.insert(key, order);
+                order++;
+            }
+            finished.fetch_add(1);
+        });
+
+        // 生产者运行期间持续取走更新
+        while (finished.load() < ProducerThreads) {
+            apply(channel.consume());
+        }
+    }
+    apply(channel.consume());
+
+    QCOMPARE(regressions, 0);
+    QCOMPARE(received, expected);
+    QCOMPARE(channel.metrics().writes, quint64(ProducerThreads * writesPerThread));
+    QVERIFY(channel.consume().isEmpty());
+}
+
+void TestKeyValueUpdateChannel::testDeferredSwapDeliversLater()
+{
+    KeyValueUpdateChannel channel;
+    channel.setFrameInterval(0);
+
+    QVariantHash received;
+    connect(&channel, &KeyValueUpdateChannel::updatesReady, this, [&received](const QVariantHash& updates) {
+        for (auto it = updates.begin(); it != updates.end(); ++it) {
+            received.insert(it.key(), it.value());
+        }
+    });
+
+    // 生产者A先写入shared，再在写入gated的过程中被挡住，前台表保持被占用
+    WriteGate gate;
+    std::thread blocked([&channel, &gate]() {
+        channel.write(QStringLiteral("shared"), 1);
+        const QVariant value = QVariant::fromValue(GatedValue(&gate));
+        gate.arm();
+        channel.write(QStringLiteral("gated"), value);
+    });
+    auto finishBlocked = qScopeGuard([&]() {
+        gate.release();
+        blocked.join();
+    });
+
+    if (!gate.waitEntered(5000)) {
+        QSKIP("QVariant did not copy GatedValue in place, cannot hold the producer inside write()");
+    }
+
+    // 生产者B随后为同一个键写入更新的值
+    {
+        ThreadGroup newer(1, [&channel](int) {
+            channel.write(QStringLiteral("shared"), 2);
+        });
+    }
+
+    // A正在写入，交换被推迟；本帧只交付B的值
+    const QVariantHash first = channel.consume();
+    QCOMPARE(channel.metrics().deferredSwaps, quint64(1));
+    QCOMPARE(first.size(), 1);
+    QCOMPARE(first.value(QStringLiteral("shared")).toInt(), 2);
+
+    finishBlocked.dismiss();
+    gate.release();
+    blocked.join();
+
+    // 推迟的更新由通道自己在之后的帧交付；A缓冲中更早的shared不能覆盖已交付的新值
+    QTRY_VERIFY(received.contains(QStringLiteral("gated")));
+    QVERIFY(!received.contains(QStringLiteral("shared")));
+    QCOMPARE(channel.metrics().writes, quint64(3));
+    QVERIFY(channel.consume().isEmpty());
+}
+
+void TestKeyValueUpdateChannel::testProducerReusedAfterThreadExit()
+{
+    KeyValueUpdateChannel channel;
+
+    {
+        ThreadGroup first(1, [&channel](int) {
+            channel.write(QStringLiteral("first"), 1);
+        });
+    }
+    QCOMPARE(channel.metrics().producers, 1);
+
+    // 线程已退出，生产者空闲并被下一个线程接管
+    {
+        ThreadGroup second(1, [&channel](int) {
+            channel.write(QStringLiteral("second"), 2);
+        });
+    }
+    QCOMPARE(channel.metrics().producers, 1);
+
+    const QVariantHash updates = channel.consume();
+    QCOMPARE(updates.size(), 2);
+    QCOMPARE(updates.value(QStringLiteral("first")).toInt(), 1);
+    QCOMPARE(updates.value(QStringLiteral("second")).toInt(), 2);
+
+    // 同时存活的线程各自登记生产者，退出后全部可复用
+    QMutex mutex;
+    QWaitCondition allWritten;
+    int written = 0;
+    {
+        ThreadGroup concurrent(ProducerThreads, [&](int thread) {
+            channel.write(keyName(thread), thread);
+            QMutexLocker locker(&mutex);
+            written++;
+            allWritten.wakeAll();
+            while (written < ProducerThreads) {
+                allWritten.wait(&mutex);
+            }
+        });
+    }
+    QCOMPARE(channel.metrics().producers, ProducerThreads);
+
+    {
+        ThreadGroup again(ProducerThreads, [&channel](int thread) {
+            channel.write(keyName(thread), thread + 100);
+        });
+    }
+    QCOMPARE(channel.metrics().producers, ProducerThreads);
+
+    const QVariantHash reused = channel.consume();
+    QCOMPARE(reused.size(), ProducerThreads);
+    for (int thread = 0; thread < ProducerThreads; ++thread) {
+        QCOMPARE(reused.value(keyName(thread)).toInt(), thread + 100);
+    }
+    QCOMPARE(channel.metrics().writes, quint64(2 + 2 * ProducerThreads));
+}
+
+// 注册测试类
+QTEST_MAIN(TestKeyValueUpdateChannel)
@@ -0,0 +1,35 @@
+#ifndef TEST_KEY_VALUE_UPDATE_CHANNEL_H
+#define TEST_KEY_VALUE_UPDATE_CHANNEL_H
+
+#include <QObject>
+#include <QTest>
+#include <QVariantHash>
+#include "../core/key_value_update_channel.h"
+
+/**
+ * @brief TestKeyValueUpdateChannel 跨线程键值更新通道的单元测试类
+ *
+ * 测试内容：
+ * 1. 多个生产者线程写入重叠的键，按全局序号最后写入者胜出
+ * 2. 生产者写入时交换被推迟（deferredSwaps > 0），更新在之后的帧照常交付，
+ *    其缓冲中较旧的写入不会覆盖已交付的新值
+ * 3. 线程退出后其生产者被新线程复用，退出前的写入仍被交付
+ */
+class TestKeyValueUpdateChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief 测试合并语义
+     */
+    void testLastWriterWinsAcrossThreads();
+    void testDeferredSwapDeliversLater();
+
+    /**
+     * @brief 测试生产者登记
+     */
+    void testProducerReusedAfterThreadExit();
+};
+
+#endif // TEST_KEY_VALUE_UPDATE_CHANNEL_H
@@ -97,6 +97,33 @@ void TestMouseKeyboard::testMouseMoveEvent()
     QCOMPARE(arguments.at(1).toPoint(), QPoint(50, 50));
 }
 
+void TestMouseKeyboard::testMouseMoveCoalescing()
+{
+    // 默认不合并，开启后移动事件在刷新时只交付最新的一个
+    EventCoalescer* coalescer = m_mouseWidget->inputCoalescer();
+    QVERIFY(!coalescer->isInstalledOn(m_mouseWidget));
+    coalescer->setInstalled(m_mouseWidget, true);
+    QVERIFY(coalescer->isInstalledOn(m_mouseWidget));
+    
+    QSignalSpy spy(m_mouseWidget, &MouseEventWidget::mouseEventOccurred);
+    simulateMouseEvent(m_mouseWidget, QEvent::MouseMove, QPoint(10, 10));
+    simulateMouseEvent(m_mouseWidget, QEvent::MouseMove, QPoint(20, 20));
+    simulateMouseEvent(m_mouseWidget, QEvent::MouseMove, QPoint(30, 30));
+    
+    coalescer->flush();
+    
+    QCOMPARE(spy.count(), 1);
+    QList<QVariant> arguments = spy.takeFirst();
+    QCOMPARE(arguments.at(0).toString(), QString("MouseMove"));
+    QCOMPARE(arguments.at(1).toPoint(), QPoint(30, 30));
+    
+    // 关闭后恢复逐个交付
+    coalescer->setInstalled(m_mouseWidget, false);
+    QVERIFY(!coalescer->isInstalledOn(m_mouseWidget));
+    simulateMouseEvent(m_mouseWidget, QEvent::MouseMove, QPoint(40, 40));
+    QCOMPARE(spy.count(), 1);
+}
+
 void TestMouseKeyboard::testMouseDoubleClickEvent()
 {
     // 测试鼠标双击事件
@@ -35,6 +35,7 @@ private slots:
     void testMousePressEvent();
     void testMouseReleaseEvent();
     void testMouseMoveEvent();
+    void testMouseMoveCoalescing();
     void testMouseDoubleClickEvent();
     void testWheelEvent();
     void testMouseEnterLeaveEvents();
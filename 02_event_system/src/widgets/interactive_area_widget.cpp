@@ -1,6 +1,7 @@
 #include "interactive_area_widget.h"
 #include "../core/event_logger.h"
 #include "../core/custom_events.h"
+#include "../core/event_pool.h"
 #include <QPainter>
 #include <QApplication>
 #include <QDebug>
@@ -327,10 +328,10 @@ void InteractiveAreaWidget::simulateMouseEvent()
 {
     // 模拟鼠标点击事件
     QPoint center = rect().center();
-    QMouseEvent* pressEvent = new QMouseEvent(QEvent::MouseButtonPress, center, center,
-                                            Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
-    QMouseEvent* releaseEvent = new QMouseEvent(QEvent::MouseButtonRelease, center, center,
-                                              Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QMouseEvent* pressEvent = new PooledMouseEvent(QEvent::MouseButtonPress, center, center,
+                                                 Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QMouseEvent* releaseEvent = new PooledMouseEvent(QEvent::MouseButtonRelease, center, center,
+                                                   Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
     
     QApplication::postEvent(this, pressEvent);
     QApplication::postEvent(this, releaseEvent);
@@ -341,8 +342,8 @@ void InteractiveAreaWidget::simulateMouseEvent()
 void InteractiveAreaWidget::simulateKeyEvent()
 {
     // 模拟按键事件
-    QKeyEvent* pressEvent = new QKeyEvent(QEvent::KeyPress, Qt::Key_Space, Qt::NoModifier, " ");
-    QKeyEvent* releaseEvent = new QKeyEvent(QEvent::KeyRelease, Qt::Key_Space, Qt::NoModifier, " ");
+    QKeyEvent* pressEvent = new PooledKeyEvent(QEvent::KeyPress, Qt::Key_Space, Qt::NoModifier, " ");
+    QKeyEvent* releaseEvent = new PooledKeyEvent(QEvent::KeyRelease, Qt::Key_Space, Qt::NoModifier, " ");
     
     QApplication::postEvent(this, pressEvent);
     QApplication::postEvent(this, releaseEvent);
@@ -379,15 +380,15 @@ void InteractiveAreaWidget::generateEventStorm()
         {
             QPoint randomPos(QRandomGenerator::global()->bounded(width()),
                            QRandomGenerator::global()->bounded(height()));
-            QMouseEvent* event = new QMouseEvent(QEvent::MouseButtonPress, randomPos, randomPos,
-                                               Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+            QMouseEvent* event = new PooledMouseEvent(QEvent::MouseButtonPress, randomPos, randomPos,
+                                                    Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
             QApplication::postEvent(this, event);
         }
         break;
     case 1: // 键盘事件
         {
             int key = Qt::Key_A + QRandomGenerator::global()->bounded(26);
-            QKeyEvent* event = new QKeyEvent(QEvent::KeyPress, key, Qt::NoModifier);
+            QKeyEvent* event = new PooledKeyEvent(QEvent::KeyPress, key, Qt::NoModifier);
             QApplication::postEvent(this, event);
         }
         break;